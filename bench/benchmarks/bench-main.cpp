@@ -0,0 +1,14 @@
+#include "bench.h"
+
+// Usage: bench-anyset [substring]
+// Runs every benchmark whose name contains 'substring' (all of them by default).
+int main(int argc, char** argv)
+{
+	std::string filter = (argc > 1) ? argv[1] : "";
+	for(const auto& bm: benchmark_registry())
+	{
+		if(bm.name.find(filter) != std::string::npos)
+			run_benchmark(bm);
+	}
+	return 0;
+}
@@ -0,0 +1,64 @@
+#ifndef ANY_SET_BENCH_INCLUDE_H
+#define ANY_SET_BENCH_INCLUDE_H
+#include "anyset/AnySet.h"
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+using any_set_t = te::AnySet<>;
+
+// A benchmark is a named function that runs some workload and returns the number of
+// operations it performed.  bench-main.cpp runs every registered benchmark.
+struct Benchmark
+{
+	std::string name;
+	std::function<std::size_t()> run;
+};
+
+inline std::vector<Benchmark>& benchmark_registry()
+{
+	static std::vector<Benchmark> registry;
+	return registry;
+}
+
+struct RegisterBenchmark
+{
+	RegisterBenchmark(std::string name, std::function<std::size_t()> run)
+	{ benchmark_registry().push_back(Benchmark{std::move(name), std::move(run)}); }
+};
+
+#define ANYSET_BENCH_CONCAT_IMPL(a, b) a ## b
+#define ANYSET_BENCH_CONCAT(a, b) ANYSET_BENCH_CONCAT_IMPL(a, b)
+#define BENCHMARK(name, ...) \
+	static const RegisterBenchmark ANYSET_BENCH_CONCAT(anyset_benchmark_, __LINE__){name, __VA_ARGS__}
+
+// Keep the optimizer from discarding results.
+template <class T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r"(&value) : "memory");
+#else
+	static const void* volatile sink;
+	sink = static_cast<const void*>(&value);
+#endif
+}
+
+// Run 'bm' once and print the average time per operation.
+inline void run_benchmark(const Benchmark& bm)
+{
+	using clock = std::chrono::steady_clock;
+	auto start = clock::now();
+	std::size_t ops = bm.run();
+	auto stop = clock::now();
+	double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+	std::cout << std::left << std::setw(48) << bm.name
+		<< std::right << std::setw(10) << std::fixed << std::setprecision(2)
+		<< (ops ? ns / ops : 0.0) << " ns/op\n";
+}
+
+#endif /* ANY_SET_BENCH_INCLUDE_H */
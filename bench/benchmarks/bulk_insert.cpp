@@ -0,0 +1,39 @@
+#include "bench.h"
+#include <random>
+
+namespace {
+
+constexpr std::size_t value_count = 4'000'000;
+
+// Decoded values, about 10% of them repeated.
+const std::vector<std::size_t>& input_values()
+{
+	static const auto values = []() {
+		std::mt19937_64 gen(0);
+		std::uniform_int_distribution<std::size_t> dist(0, value_count * 9 - 1);
+		std::vector<std::size_t> v(value_count);
+		for(auto& x: v)
+			x = dist(gen);
+		return v;
+	}();
+	return values;
+}
+
+// Build the inputs before any benchmark starts its clock.
+[[maybe_unused]] const auto& build_inputs = input_values();
+
+} /* namespace */
+
+BENCHMARK("bulk build: AnySet(first, last)", []() -> std::size_t {
+	const auto& values = input_values();
+	any_set_t set(values.begin(), values.end());
+	do_not_optimize(set.size());
+	return values.size();
+});
+
+BENCHMARK("bulk build: AnySet(te::par, first, last)", []() -> std::size_t {
+	const auto& values = input_values();
+	any_set_t set(te::par, values.begin(), values.end());
+	do_not_optimize(set.size());
+	return values.size();
+});
@@ -0,0 +1,214 @@
+#include "bench.h"
+#include "anyset/ConcurrentAnySet.h"
+#include "anyset/RcuAnySet.h"
+#include "anyset/ShardedAnySet.h"
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+
+namespace {
+
+constexpr std::size_t ops_per_thread = 1'000'000;
+constexpr std::size_t key_range = 4'000'000;
+
+// The baseline: an AnySet behind a reader/writer lock.
+struct LockedAnySet
+{
+	bool insert(std::size_t key)
+	{
+		std::unique_lock<std::shared_mutex> lock(mutex);
+		return set.insert(key).second;
+	}
+
+	bool contains(std::size_t key) const
+	{
+		std::shared_lock<std::shared_mutex> lock(mutex);
+		return set.contains(key);
+	}
+
+	mutable std::shared_mutex mutex;
+	any_set_t set;
+};
+
+struct ShardedSet
+{
+	bool insert(std::size_t key)
+	{ return set.insert(key); }
+
+	bool contains(std::size_t key) const
+	{ return set.contains(key); }
+
+	te::ShardedAnySet<64> set;
+};
+
+struct LockFreeAnySet
+{
+	bool insert(std::size_t key)
+	{ return set.insert(key).second; }
+
+	bool contains(std::size_t key) const
+	{ return set.contains(key); }
+
+	te::ConcurrentAnySet<> set;
+};
+
+// Each thread does 20% inserts and 80% lookups of random keys.  Prints the throughput
+// for each thread count.
+template <class Set>
+std::size_t mixed_workload(const char* name)
+{
+	using clock = std::chrono::steady_clock;
+	std::size_t max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	std::size_t total_ops = 0;
+	std::cout << "  " << name << ":";
+	for(std::size_t thread_count = 1; thread_count <= max_threads; thread_count *= 2)
+	{
+		Set set;
+		std::vector<std::thread> threads;
+		std::atomic<std::size_t> found{0};
+		auto start = clock::now();
+		for(std::size_t t = 0; t < thread_count; ++t)
+		{
+			threads.emplace_back([&, t]() {
+				std::mt19937_64 gen(t);
+				std::uniform_int_distribution<std::size_t> dist(0, key_range - 1);
+				std::size_t hits = 0;
+				for(std::size_t i = 0; i < ops_per_thread; ++i)
+				{
+					auto key = dist(gen);
+					if(i % 5 == 0)
+						set.insert(key);
+					else
+						hits += set.contains(key);
+				}
+				found += hits;
+			});
+		}
+		for(auto& th: threads)
+			th.join();
+		auto stop = clock::now();
+		double seconds = std::chrono::duration<double>(stop - start).count();
+		do_not_optimize(found);
+		total_ops += thread_count * ops_per_thread;
+		std::cout << std::fixed << std::setprecision(1) << "  " << thread_count << "T "
+			<< (thread_count * ops_per_thread / seconds / 1e6) << " Mops/s";
+	}
+	std::cout << '\n';
+	return total_ops;
+}
+
+constexpr std::size_t read_mostly_keys = 100'000;
+constexpr std::size_t write_batch_size = 64;
+
+// Readers look up random keys while one writer keeps inserting batches of new keys.
+// Prints the lookup throughput of the readers for each reader count.
+template <class Set>
+std::size_t read_mostly_workload(const char* name)
+{
+	using clock = std::chrono::steady_clock;
+	std::size_t max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	std::size_t total_ops = 0;
+	std::cout << "  " << name << ":";
+	for(std::size_t thread_count = 1; thread_count <= max_threads; thread_count *= 2)
+	{
+		Set set;
+		set.insert_batch(0, read_mostly_keys);
+		std::atomic<bool> done{false};
+		std::thread writer([&]() {
+			for(std::size_t first = read_mostly_keys; not done.load(); first += write_batch_size)
+			{
+				set.insert_batch(first, first + write_batch_size);
+				std::this_thread::yield();
+			}
+		});
+		std::vector<std::thread> threads;
+		std::atomic<std::size_t> found{0};
+		auto start = clock::now();
+		for(std::size_t t = 0; t < thread_count; ++t)
+		{
+			threads.emplace_back([&, t]() {
+				auto&& reader = set.make_reader();
+				std::mt19937_64 gen(t);
+				std::uniform_int_distribution<std::size_t> dist(0, 2 * read_mostly_keys - 1);
+				std::size_t hits = 0;
+				for(std::size_t i = 0; i < ops_per_thread; ++i)
+					hits += reader.contains(dist(gen));
+				found += hits;
+			});
+		}
+		for(auto& th: threads)
+			th.join();
+		auto stop = clock::now();
+		done = true;
+		writer.join();
+		double seconds = std::chrono::duration<double>(stop - start).count();
+		do_not_optimize(found);
+		total_ops += thread_count * ops_per_thread;
+		std::cout << std::fixed << std::setprecision(1) << "  " << thread_count << "T "
+			<< (thread_count * ops_per_thread / seconds / 1e6) << " Mops/s";
+	}
+	std::cout << '\n';
+	return total_ops;
+}
+
+struct LockedReadMostlySet
+{
+	void insert_batch(std::size_t first, std::size_t last)
+	{
+		std::unique_lock<std::shared_mutex> lock(mutex);
+		for(auto key = first; key < last; ++key)
+			set.insert(key);
+	}
+
+	const LockedReadMostlySet& make_reader() const
+	{ return *this; }
+
+	bool contains(std::size_t key) const
+	{
+		std::shared_lock<std::shared_mutex> lock(mutex);
+		return set.contains(key);
+	}
+
+	mutable std::shared_mutex mutex;
+	any_set_t set;
+};
+
+struct RcuSet
+{
+	void insert_batch(std::size_t first, std::size_t last)
+	{
+		auto batch = set.make_batch();
+		for(auto key = first; key < last; ++key)
+			batch.insert(key);
+		set.publish(std::move(batch));
+	}
+
+	auto make_reader()
+	{ return set.make_reader(); }
+
+	te::RcuAnySet<> set;
+};
+
+} /* namespace */
+
+BENCHMARK("concurrent: AnySet + shared_mutex", []() -> std::size_t {
+	return mixed_workload<LockedAnySet>("AnySet + shared_mutex");
+});
+
+BENCHMARK("concurrent: ShardedAnySet<64>", []() -> std::size_t {
+	return mixed_workload<ShardedSet>("ShardedAnySet<64>");
+});
+
+BENCHMARK("concurrent: ConcurrentAnySet", []() -> std::size_t {
+	return mixed_workload<LockFreeAnySet>("ConcurrentAnySet");
+});
+
+BENCHMARK("read-mostly: AnySet + shared_mutex", []() -> std::size_t {
+	return read_mostly_workload<LockedReadMostlySet>("AnySet + shared_mutex");
+});
+
+BENCHMARK("read-mostly: RcuAnySet", []() -> std::size_t {
+	return read_mostly_workload<RcuSet>("RcuAnySet");
+});
@@ -0,0 +1,41 @@
+#include "bench.h"
+#include "anyset/CowAnySet.h"
+
+namespace {
+
+constexpr std::size_t set_size = 20'000;
+constexpr std::size_t copy_count = 200;
+
+any_set_t make_set()
+{
+	any_set_t set;
+	set.reserve(set_size);
+	for(std::size_t i = 0; i < set_size; ++i)
+		set.insert(i);
+	return set;
+}
+
+// Pass a set by value, read one element from it, and throw it away.
+template <class Set>
+std::size_t read_copy(Set set)
+{ return set.count(set_size / 2u); }
+
+} /* namespace */
+
+BENCHMARK("copy + read: AnySet", []() -> std::size_t {
+	const auto set = make_set();
+	std::size_t found = 0;
+	for(std::size_t i = 0; i < copy_count; ++i)
+		found += read_copy(set);
+	do_not_optimize(found);
+	return copy_count;
+});
+
+BENCHMARK("copy + read: CowAnySet", []() -> std::size_t {
+	const te::CowAnySet<> set(make_set());
+	std::size_t found = 0;
+	for(std::size_t i = 0; i < copy_count; ++i)
+		found += read_copy(set);
+	do_not_optimize(found);
+	return copy_count;
+});
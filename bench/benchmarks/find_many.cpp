@@ -0,0 +1,71 @@
+#include "bench.h"
+#include <algorithm>
+#include <random>
+
+namespace {
+
+constexpr std::size_t set_size = 4'000'000;
+constexpr std::size_t key_count = 1 << 20;
+constexpr std::size_t repeat_count = 4;
+
+// A set much larger than the cache, so that every lookup misses.
+const any_set_t& big_set()
+{
+	static const any_set_t set = []() {
+		any_set_t s;
+		s.reserve(set_size);
+		for(std::size_t i = 0; i < set_size; ++i)
+			s.insert(i);
+		return s;
+	}();
+	return set;
+}
+
+// Half hits, half misses.
+std::vector<std::size_t> lookup_keys()
+{
+	std::mt19937_64 gen(0);
+	std::uniform_int_distribution<std::size_t> dist(0, 2 * set_size);
+	std::vector<std::size_t> keys(key_count);
+	for(auto& k: keys)
+		k = dist(gen);
+	return keys;
+}
+
+} /* namespace */
+
+// Building the set dominates the total, so time the two lookup loops separately and
+// print them.  The keys are the same for both.
+BENCHMARK("lookup: contains() vs contains_many()", []() -> std::size_t {
+	using clock = std::chrono::steady_clock;
+	const auto& set = big_set();
+	auto keys = lookup_keys();
+	auto per_key = [](auto start, auto stop) {
+		return std::chrono::duration<double, std::nano>(stop - start).count() / (repeat_count * key_count);
+	};
+
+	std::size_t found_single = 0;
+	auto start = clock::now();
+	for(std::size_t r = 0; r < repeat_count; ++r)
+		for(auto k: keys)
+			found_single += set.contains(k);
+	auto stop = clock::now();
+	double single_ns = per_key(start, stop);
+
+	std::vector<char> results(key_count);
+	std::size_t found_many = 0;
+	start = clock::now();
+	for(std::size_t r = 0; r < repeat_count; ++r)
+	{
+		set.contains_many(keys.begin(), keys.end(), results.begin());
+		found_many += std::count(results.begin(), results.end(), 1);
+	}
+	stop = clock::now();
+	double many_ns = per_key(start, stop);
+
+	do_not_optimize(found_single);
+	do_not_optimize(found_many);
+	std::cout << std::fixed << std::setprecision(2) << "  contains(): " << single_ns
+		<< " ns/key, contains_many(): " << many_ns << " ns/key\n";
+	return 2 * repeat_count * key_count;
+});
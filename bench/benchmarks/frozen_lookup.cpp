@@ -0,0 +1,68 @@
+#include "bench.h"
+#include "anyset/FrozenAnySet.h"
+#include <random>
+
+namespace {
+
+constexpr std::size_t set_size = 4'000'000;
+constexpr std::size_t key_count = 1 << 20;
+constexpr std::size_t repeat_count = 4;
+
+const any_set_t& source_set()
+{
+	static const any_set_t set = []() {
+		any_set_t s;
+		s.reserve(set_size);
+		for(std::size_t i = 0; i < set_size; ++i)
+			s.insert(i);
+		return s;
+	}();
+	return set;
+}
+
+// Half hits, half misses.
+std::vector<std::size_t> lookup_keys()
+{
+	std::mt19937_64 gen(0);
+	std::uniform_int_distribution<std::size_t> dist(0, 2 * set_size);
+	std::vector<std::size_t> keys(key_count);
+	for(auto& k: keys)
+		k = dist(gen);
+	return keys;
+}
+
+template <class Set>
+double time_lookups(const Set& set, const std::vector<std::size_t>& keys)
+{
+	using clock = std::chrono::steady_clock;
+	std::size_t found = 0;
+	auto start = clock::now();
+	for(std::size_t r = 0; r < repeat_count; ++r)
+		for(auto k: keys)
+			found += set.contains(k);
+	auto stop = clock::now();
+	do_not_optimize(found);
+	return std::chrono::duration<double, std::nano>(stop - start).count() / (repeat_count * key_count);
+}
+
+} /* namespace */
+
+// Building the sets dominates the total, so time the build and the lookup loops
+// separately and print them.
+BENCHMARK("lookup: AnySet vs FrozenAnySet", []() -> std::size_t {
+	using clock = std::chrono::steady_clock;
+	const auto& set = source_set();
+	auto keys = lookup_keys();
+
+	auto start = clock::now();
+	const te::FrozenAnySet<> frozen(set);
+	auto stop = clock::now();
+	double build_ns = std::chrono::duration<double, std::nano>(stop - start).count() / set_size;
+
+	double set_ns = time_lookups(set, keys);
+	double frozen_ns = time_lookups(frozen, keys);
+	std::cout << std::fixed << std::setprecision(2) << "  AnySet: " << set_ns
+		<< " ns/key, FrozenAnySet: " << frozen_ns << " ns/key (build: "
+		<< build_ns << " ns/value)\n";
+	return 2 * repeat_count * key_count;
+});
@@ -0,0 +1,76 @@
+#include "bench.h"
+#include <algorithm>
+
+namespace {
+
+constexpr std::size_t insert_count = 1'000'000;
+
+// Time every insert() individually and print the latency distribution.  Rehashes happen
+// inside whichever insert crosses the load factor, so they show up in the tail.
+template <class Set>
+std::size_t insert_latencies(const char* name)
+{
+	using clock = std::chrono::steady_clock;
+	std::vector<double> latencies;
+	latencies.reserve(insert_count);
+	Set set;
+	for(std::size_t i = 0; i < insert_count; ++i)
+	{
+		auto start = clock::now();
+		set.insert(i);
+		auto stop = clock::now();
+		latencies.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+	}
+	do_not_optimize(set);
+	std::sort(latencies.begin(), latencies.end());
+	auto percentile = [&](double p) {
+		return latencies[static_cast<std::size_t>(p * (latencies.size() - 1))];
+	};
+	std::cout << std::fixed << std::setprecision(0) << "  " << name << ": p50 " << percentile(0.5) << " ns, p99 " << percentile(0.99)
+		<< " ns, p99.9 " << percentile(0.999) << " ns, max " << latencies.back() << " ns\n";
+	return insert_count;
+}
+
+} /* namespace */
+
+BENCHMARK("insert latency: chained", []() -> std::size_t {
+	return insert_latencies<any_set_t>("chained");
+});
+
+BENCHMARK("insert latency: open addressing", []() -> std::size_t {
+	return insert_latencies<
+		te::AnySet<
+			te::AnyHash,
+			std::equal_to<>,
+			std::allocator<te::AnyValue<te::AnyHash, std::equal_to<>>>,
+			te::OpenAddressing
+		>
+	>("open addressing");
+});
+
+BENCHMARK("insert latency: incremental rehash", []() -> std::size_t {
+	return insert_latencies<
+		te::AnySet<
+			te::AnyHash,
+			std::equal_to<>,
+			std::allocator<te::AnyValue<te::AnyHash, std::equal_to<>>>,
+			te::IncrementalRehash
+		>
+	>("incremental rehash");
+});
+
+BENCHMARK("rehash: grow and shrink 1M elements", []() -> std::size_t {
+	any_set_t set;
+	for(std::size_t i = 0; i < insert_count; ++i)
+		set.insert(i);
+	auto bcount = set.bucket_count();
+	for(int r = 0; r < 5; ++r)
+	{
+		set.rehash(bcount * 4);
+		set.max_load_factor(4.0);
+		set.rehash(0);
+		set.max_load_factor(1.0);
+	}
+	do_not_optimize(set);
+	return 10 * insert_count;
+});
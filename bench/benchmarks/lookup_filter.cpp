@@ -0,0 +1,83 @@
+#include "bench.h"
+#include <random>
+
+namespace {
+
+constexpr std::size_t set_size = 4'000'000;
+constexpr std::size_t key_count = 1 << 20;
+constexpr std::size_t repeat_count = 4;
+
+// A set much larger than the cache, so that every lookup that reaches the table misses it.
+any_set_t& big_set()
+{
+	static any_set_t set = []() {
+		any_set_t s;
+		s.reserve(set_size);
+		for(std::size_t i = 0; i < set_size; ++i)
+			s.insert(i);
+		return s;
+	}();
+	return set;
+}
+
+// 95% of the keys aren't in the set.
+std::vector<std::size_t> lookup_keys()
+{
+	std::mt19937_64 gen(0);
+	std::uniform_int_distribution<std::size_t> dist(0, 20 * set_size);
+	std::vector<std::size_t> keys(key_count);
+	for(auto& k: keys)
+		k = dist(gen);
+	return keys;
+}
+
+double time_lookups(const any_set_t& set, const std::vector<std::size_t>& keys)
+{
+	using clock = std::chrono::steady_clock;
+	std::size_t found = 0;
+	auto start = clock::now();
+	for(std::size_t r = 0; r < repeat_count; ++r)
+		for(auto k: keys)
+			found += set.contains(k);
+	auto stop = clock::now();
+	do_not_optimize(found);
+	return std::chrono::duration<double, std::nano>(stop - start).count() / (repeat_count * key_count);
+}
+
+double time_many_lookups(const any_set_t& set, const std::vector<std::size_t>& keys)
+{
+	using clock = std::chrono::steady_clock;
+	std::vector<char> results(keys.size());
+	auto start = clock::now();
+	for(std::size_t r = 0; r < repeat_count; ++r)
+		set.contains_many(keys.begin(), keys.end(), results.begin());
+	auto stop = clock::now();
+	do_not_optimize(results);
+	return std::chrono::duration<double, std::nano>(stop - start).count() / (repeat_count * key_count);
+}
+
+} /* namespace */
+
+// Building the set dominates the total, so time the lookup loops separately and print
+// them.  The keys are the same for all of them.
+BENCHMARK("lookup: contains() with and without a lookup filter", []() -> std::size_t {
+	auto& set = big_set();
+	auto keys = lookup_keys();
+
+	set.disable_lookup_filter();
+	double plain_ns = time_lookups(set, keys);
+	double plain_many_ns = time_many_lookups(set, keys);
+	set.enable_lookup_filter();
+	double filtered_ns = time_lookups(set, keys);
+	double filtered_many_ns = time_many_lookups(set, keys);
+	auto stats = set.lookup_filter_stats();
+
+	std::cout << std::fixed << std::setprecision(2)
+		<< "  contains(): " << plain_ns << " ns/key without the filter, "
+		<< filtered_ns << " ns/key with it\n"
+		<< "  contains_many(): " << plain_many_ns << " ns/key without the filter, "
+		<< filtered_many_ns << " ns/key with it\n"
+		<< "  filter: " << stats.memory_bytes / 1024 << " KiB, "
+		<< std::setprecision(4) << stats.expected_false_positive_rate << " expected false-positive rate\n";
+	return 4 * repeat_count * key_count;
+});
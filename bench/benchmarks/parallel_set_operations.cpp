@@ -0,0 +1,51 @@
+#include "bench.h"
+#include "anyset/SetOperations.h"
+
+namespace {
+
+constexpr std::size_t set_size = 2'000'000;
+
+// Two sets of 'set_size' integers that overlap by half.
+const std::pair<any_set_t, any_set_t>& input_sets()
+{
+	static const auto sets = []() {
+		std::pair<any_set_t, any_set_t> result;
+		for(std::size_t i = 0; i < set_size; ++i)
+		{
+			result.first.insert(i);
+			result.second.insert(i + set_size / 2);
+		}
+		return result;
+	}();
+	return sets;
+}
+
+// Build the inputs before any benchmark starts its clock.
+[[maybe_unused]] const auto& build_inputs = input_sets();
+
+template <class Op>
+std::size_t run_set_operation(Op op)
+{
+	const auto& [a, b] = input_sets();
+	auto result = op(a, b);
+	do_not_optimize(result.size());
+	return a.size() + b.size();
+}
+
+} /* namespace */
+
+BENCHMARK("set operations: intersection_of()", []() -> std::size_t {
+	return run_set_operation([](const auto& a, const auto& b) { return te::intersection_of(a, b); });
+});
+
+BENCHMARK("set operations: intersection_of(te::par)", []() -> std::size_t {
+	return run_set_operation([](const auto& a, const auto& b) { return te::intersection_of(te::par, a, b); });
+});
+
+BENCHMARK("set operations: union_of()", []() -> std::size_t {
+	return run_set_operation([](const auto& a, const auto& b) { return te::union_of(a, b); });
+});
+
+BENCHMARK("set operations: union_of(te::par)", []() -> std::size_t {
+	return run_set_operation([](const auto& a, const auto& b) { return te::union_of(te::par, a, b); });
+});
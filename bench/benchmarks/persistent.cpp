@@ -0,0 +1,76 @@
+#include "bench.h"
+#include "anyset/PersistentAnySet.h"
+#include <random>
+
+namespace {
+
+constexpr std::size_t set_size = 20'000;
+constexpr std::size_t version_count = 200;
+constexpr std::size_t lookup_count = 1 << 20;
+
+template <class Set>
+Set make_set()
+{
+	Set set;
+	for(std::size_t i = 0; i < set_size; ++i)
+		set = set.insert(i);
+	return set;
+}
+
+} /* namespace */
+
+// Keep 'version_count' versions of a configuration, each differing from the last by one
+// element.  AnySet needs a full copy per version; PersistentAnySet shares all but one path.
+BENCHMARK("versions: AnySet copy + insert", []() -> std::size_t {
+	any_set_t base;
+	base.reserve(set_size);
+	for(std::size_t i = 0; i < set_size; ++i)
+		base.insert(i);
+	std::vector<any_set_t> versions;
+	versions.push_back(base);
+	for(std::size_t i = 0; i < version_count; ++i)
+	{
+		versions.push_back(versions.back());
+		versions.back().insert(set_size + i);
+	}
+	do_not_optimize(versions);
+	return version_count;
+});
+
+BENCHMARK("versions: PersistentAnySet insert", []() -> std::size_t {
+	auto base = make_set<te::PersistentAnySet<>>();
+	std::vector<te::PersistentAnySet<>> versions;
+	versions.push_back(base);
+	for(std::size_t i = 0; i < version_count; ++i)
+		versions.push_back(versions.back().insert(set_size + i));
+	do_not_optimize(versions);
+	return version_count;
+});
+
+// Lookup cost of the trie relative to the hash table.
+BENCHMARK("lookup: AnySet vs PersistentAnySet", []() -> std::size_t {
+	using clock = std::chrono::steady_clock;
+	any_set_t set;
+	for(std::size_t i = 0; i < set_size; ++i)
+		set.insert(i);
+	const te::PersistentAnySet<> persistent(set);
+	std::mt19937_64 gen(0);
+	std::uniform_int_distribution<std::size_t> dist(0, 2 * set_size);
+	std::vector<std::size_t> keys(lookup_count);
+	for(auto& k: keys)
+		k = dist(gen);
+	auto time_lookups = [&](const auto& s) {
+		std::size_t found = 0;
+		auto start = clock::now();
+		for(auto k: keys)
+			found += s.contains(k);
+		auto stop = clock::now();
+		do_not_optimize(found);
+		return std::chrono::duration<double, std::nano>(stop - start).count() / lookup_count;
+	};
+	double set_ns = time_lookups(set);
+	double persistent_ns = time_lookups(persistent);
+	std::cout << std::fixed << std::setprecision(2) << "  AnySet: " << set_ns
+		<< " ns/key, PersistentAnySet: " << persistent_ns << " ns/key\n";
+	return 2 * lookup_count;
+});
@@ -0,0 +1,89 @@
+#include "bench.h"
+#include "anyset/SetOperations.h"
+
+namespace {
+
+constexpr std::size_t set_size = 2'000'000;
+
+// Two sets of 'set_size' integers that overlap by half.
+const std::pair<any_set_t, any_set_t>& set_operation_inputs()
+{
+	static const auto sets = []() {
+		std::pair<any_set_t, any_set_t> result;
+		for(std::size_t i = 0; i < set_size; ++i)
+		{
+			result.first.insert(i);
+			result.second.insert(i + set_size / 2);
+		}
+		return result;
+	}();
+	return sets;
+}
+
+[[maybe_unused]] const auto& build_set_operation_inputs = set_operation_inputs();
+
+// The first input with one element replaced.
+const any_set_t& almost_first_input()
+{
+	static const any_set_t set = []() {
+		auto result = set_operation_inputs().first;
+		result.erase(set_size - 1u);
+		result.insert(set_size * 4u);
+		return result;
+	}();
+	return set;
+}
+
+[[maybe_unused]] const auto& build_almost_first_input = almost_first_input();
+
+} /* namespace */
+
+// The copies are included in the time of each of these.
+BENCHMARK("set operations: update()", []() -> std::size_t {
+	const auto& [a, b] = set_operation_inputs();
+	auto result = a;
+	result.update(b);
+	do_not_optimize(result.size());
+	return a.size() + b.size();
+});
+
+BENCHMARK("set operations: intersection_of(rvalue)", []() -> std::size_t {
+	const auto& [a, b] = set_operation_inputs();
+	auto result = te::intersection_of(any_set_t(a), b);
+	do_not_optimize(result.size());
+	return a.size() + b.size();
+});
+
+BENCHMARK("set operations: difference_of()", []() -> std::size_t {
+	const auto& [a, b] = set_operation_inputs();
+	auto result = te::difference_of(a, b);
+	do_not_optimize(result.size());
+	return a.size() + b.size();
+});
+
+BENCHMARK("set operations: intersection_of().size()", []() -> std::size_t {
+	const auto& [a, b] = set_operation_inputs();
+	do_not_optimize(te::intersection_of(a, b).size());
+	return a.size() + b.size();
+});
+
+BENCHMARK("set operations: intersection_size()", []() -> std::size_t {
+	const auto& [a, b] = set_operation_inputs();
+	do_not_optimize(te::intersection_size(a, b));
+	return a.size() + b.size();
+});
+
+BENCHMARK("set operations: jaccard_index()", []() -> std::size_t {
+	const auto& [a, b] = set_operation_inputs();
+	do_not_optimize(te::jaccard_index(a, b));
+	return a.size() + b.size();
+});
+
+// The sets have the same size and differ by one element.
+BENCHMARK("set operations: operator== (unequal)", []() -> std::size_t {
+	const auto& a = set_operation_inputs().first;
+	const auto& almost_a = almost_first_input();
+	for(int i = 0; i < 1000; ++i)
+		do_not_optimize(a == almost_a);
+	return 1000u;
+});
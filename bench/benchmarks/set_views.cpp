@@ -0,0 +1,70 @@
+#include "bench.h"
+#include "anyset/SetViews.h"
+#include <array>
+
+namespace {
+
+constexpr std::size_t view_set_size = 1'000'000;
+
+// Three sets of 'view_set_size' integers; each overlaps the next by half.
+const std::array<any_set_t, 3>& view_inputs()
+{
+	static const auto sets = []() {
+		std::array<any_set_t, 3> result;
+		for(std::size_t i = 0; i < view_set_size; ++i)
+		{
+			result[0].insert(i);
+			result[1].insert(i + view_set_size / 2);
+			result[2].insert(i + view_set_size);
+		}
+		return result;
+	}();
+	return sets;
+}
+
+[[maybe_unused]] const auto& build_view_inputs = view_inputs();
+
+template <class Set>
+std::size_t count_ints(const Set& set)
+{
+	std::size_t count = 0;
+	for(const auto& v: set)
+		count += static_cast<std::size_t>(te::is<std::size_t>(v));
+	return count;
+}
+
+} /* namespace */
+
+// Iterate (a | b) - c once, by materializing it and through a view.
+BENCHMARK("set views: iterate difference_of(union_of())", []() -> std::size_t {
+	const auto& [a, b, c] = view_inputs();
+	do_not_optimize(count_ints(te::difference_of(te::union_of(a, b), c)));
+	return a.size() + b.size();
+});
+
+BENCHMARK("set views: iterate set_difference(set_union())", []() -> std::size_t {
+	const auto& [a, b, c] = view_inputs();
+	do_not_optimize(count_ints(te::views::set_difference(te::views::set_union(a, b), c)));
+	return a.size() + b.size();
+});
+
+// Test every element of 'c' for membership in (a & b).
+BENCHMARK("set views: contains() on intersection_of()", []() -> std::size_t {
+	const auto& [a, b, c] = view_inputs();
+	auto result = te::intersection_of(a, b);
+	std::size_t count = 0;
+	for(const auto& v: c)
+		count += result.contains_value(v);
+	do_not_optimize(count);
+	return c.size();
+});
+
+BENCHMARK("set views: contains() on set_intersection()", []() -> std::size_t {
+	const auto& [a, b, c] = view_inputs();
+	auto view = te::views::set_intersection(a, b);
+	std::size_t count = 0;
+	for(const auto& v: c)
+		count += view.contains_value(v);
+	do_not_optimize(count);
+	return c.size();
+});
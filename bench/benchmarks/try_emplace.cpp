@@ -0,0 +1,48 @@
+#include "bench.h"
+#include <random>
+
+namespace {
+
+constexpr std::size_t op_count = 4'000'000;
+constexpr std::size_t distinct_count = 100'000;
+
+// Event ids with lots of repeats.
+std::vector<std::size_t> event_ids()
+{
+	std::mt19937_64 gen(0);
+	std::uniform_int_distribution<std::size_t> dist(0, distinct_count - 1);
+	std::vector<std::size_t> ids(op_count);
+	for(auto& id: ids)
+		id = dist(gen);
+	return ids;
+}
+
+template <class Emplace>
+std::size_t dedup_events(Emplace emplace)
+{
+	auto ids = event_ids();
+	any_set_t set;
+	std::size_t inserted = 0;
+	for(std::size_t i = 0; i < ids.size(); ++i)
+	{
+		// Every third id is new; the rest are almost all duplicates.
+		auto id = (i % 3 == 0) ? distinct_count + i : ids[i];
+		inserted += emplace(set, id);
+	}
+	do_not_optimize(inserted);
+	return op_count;
+}
+
+} /* namespace */
+
+BENCHMARK("dedup: emplace()", []() -> std::size_t {
+	return dedup_events([](any_set_t& set, std::size_t id) {
+		return set.emplace<std::size_t>(id).second;
+	});
+});
+
+BENCHMARK("dedup: try_emplace()", []() -> std::size_t {
+	return dedup_events([](any_set_t& set, std::size_t id) {
+		return set.try_emplace<std::size_t>(id).second;
+	});
+});
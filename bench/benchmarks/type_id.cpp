@@ -0,0 +1,80 @@
+#include "bench.h"
+#include <memory>
+
+namespace {
+
+constexpr std::size_t value_count = 1000;
+constexpr std::size_t repeat_count = 2000;
+
+// Equal values of several integer types.  With te::AnyHash these collide, so lookups have
+// to type-check each of their neighbours.
+any_set_t make_mixed_set()
+{
+	any_set_t set;
+	for(std::size_t i = 0; i < value_count; ++i)
+	{
+		set.insert(static_cast<int>(i));
+		set.insert(static_cast<long>(i));
+		set.insert(static_cast<unsigned>(i));
+		set.insert(static_cast<short>(i));
+		set.insert(static_cast<long long>(i));
+	}
+	return set;
+}
+
+std::vector<const te::AnyValue<te::AnyHash, std::equal_to<>>*> values_of(const any_set_t& set)
+{
+	std::vector<const te::AnyValue<te::AnyHash, std::equal_to<>>*> values;
+	for(const auto& v: set)
+		values.push_back(&v);
+	return values;
+}
+
+const any_set_t& mixed_set()
+{
+	static const any_set_t set = make_mixed_set();
+	return set;
+}
+
+} /* namespace */
+
+BENCHMARK("type check: typeinfo() == typeid(T)", []() -> std::size_t {
+	auto values = values_of(mixed_set());
+	std::size_t count = 0;
+	for(std::size_t r = 0; r < repeat_count; ++r)
+		for(const auto* v: values)
+			count += (v->typeinfo() == typeid(long));
+	do_not_optimize(count);
+	return repeat_count * values.size();
+});
+
+BENCHMARK("type check: is<T>()", []() -> std::size_t {
+	auto values = values_of(mixed_set());
+	std::size_t count = 0;
+	for(std::size_t r = 0; r < repeat_count; ++r)
+		for(const auto* v: values)
+			count += te::is<long>(*v);
+	do_not_optimize(count);
+	return repeat_count * values.size();
+});
+
+BENCHMARK("cast: try_as<T>()", []() -> std::size_t {
+	auto values = values_of(mixed_set());
+	long sum = 0;
+	for(std::size_t r = 0; r < repeat_count; ++r)
+		for(const auto* v: values)
+			if(const long* p = te::try_as<long>(*v))
+				sum += *p;
+	do_not_optimize(sum);
+	return repeat_count * values.size();
+});
+
+BENCHMARK("lookup: find() among colliding types", []() -> std::size_t {
+	const auto& set = mixed_set();
+	std::size_t found = 0;
+	for(std::size_t r = 0; r < repeat_count / 10; ++r)
+		for(std::size_t i = 0; i < value_count; ++i)
+			found += (set.find(static_cast<long long>(i)) != set.end());
+	do_not_optimize(found);
+	return (repeat_count / 10) * value_count;
+});
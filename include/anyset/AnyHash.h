@@ -7,6 +7,7 @@
 
 #include <functional>
 #include <cstddef>
+#include <cstdint>
 #include <type_traits>
 
 namespace te {
@@ -130,6 +131,259 @@ struct AnyHash {
 	}
 };
 
+namespace detail {
+
+template <class T>
+struct TypeSeedAnchor
+{
+	// Not const: identical read-only constants may be folded into one by the linker (e.g. 
+	// MSVC's /OPT:ICF), which would give every type the same seed.  Writable objects aren't.
+	static inline char anchor = 0;
+};
+
+/**
+ * @brief Get a seed value that is unique to the type @p T within the program.
+ *
+ * The seed is derived from the address of a static object, so computing it is a single 
+ * multiplication.  Seeds are not stable across program runs and, on platforms that don't 
+ * merge template static data across shared libraries, may differ between libraries.
+ */
+template <class T>
+std::size_t type_seed() noexcept
+{
+	auto addr = reinterpret_cast<std::uintptr_t>(&TypeSeedAnchor<T>::anchor);
+	if constexpr(sizeof(std::size_t) >= sizeof(std::uint64_t))
+		return static_cast<std::size_t>(addr * 0x9e3779b97f4a7c15ull);
+	else
+		return static_cast<std::size_t>(addr * 0x9e3779b9u);
+}
+
+} /* namespace detail */
+
+/**
+ * @brief Generic hash function object that also hashes the type of its argument.
+ *
+ * Computes the same hash codes as te::AnyHash, but with a per-type seed folded in.  Values of 
+ * different types that te::AnyHash would give equal hash codes (such as `int(1)`, `long(1)` and 
+ * `char(1)`) are thus very likely to get different hash codes.  AnySet compares hash codes before
+ * comparing elements, so using TypedAnyHash lets lookups skip over elements of other types without 
+ * calling any of their virtual member functions.  Opt in by using TypedAnyHash as the @p HashFn 
+ * template argument of AnySet.
+ *
+ * @note Hash codes computed by TypedAnyHash are not stable across program runs.
+ *
+ * @see AnyHash - The default hash function type for AnySet.
+ */
+struct TypedAnyHash {
+
+	/**
+	 * @brief Hash @p value along with its type.
+	 * 
+	 * @param value - object to compute the hash of.
+	 * @return the computed hash of @p value, combined with a per-type seed.
+	 */
+	template <class T>
+	std::size_t operator()(const T& value) const
+	{ return AnyHash{}(value) ^ detail::type_seed<T>(); }
+};
+
+/**
+ * @brief Trait that tells AnySet whether a hash function already produces well-mixed hash codes.
+ *
+ * AnySet picks buckets using the low-order bits of hash codes.  Many hash functions, 
+ * including std::hash for integers on common implementations, return the key itself, so 
+ * keys that differ only in their high-order bits would pile up in a handful of buckets.
+ * Unless this trait is true for the set's hash function type, AnySet runs hash codes 
+ * through a finalizer before computing bucket indices.  Stored hash codes are unaffected.
+ *
+ * Derives from std::true_type if @p HashFn declares a member type named `is_avalanching`,
+ * otherwise derives from std::false_type.  Users may also specialize this template.
+ *
+ * @tparam HashFn - The hash function type.
+ */
+template <class HashFn, class = void>
+struct hash_is_avalanching: std::false_type {};
+
+template <class HashFn>
+struct hash_is_avalanching<HashFn, std::void_t<typename HashFn::is_avalanching>>: std::true_type {};
+
+template <class HashFn>
+inline constexpr const bool hash_is_avalanching_v = hash_is_avalanching<HashFn>::value;
+
+/**
+ * @brief A reference to a key together with its precomputed hash code.
+ *
+ * AnySet's lookup, insertion, and erasure member functions accept a Hashed<T> in place of a
+ * `T` and use the stored hash code instead of hashing the key again.  This pays off when the
+ * same key is looked up in several sets that use the same hash function, or when the key is
+ * expensive to hash.  Obtain one from AnySet::hashed() or make_hashed().
+ *
+ * Hashed<T> does not own the key; the referenced object must outlive it.
+ *
+ * @tparam T - The type of the key.
+ *
+ * @note The hash code is a "trust me" value, like the one passed to
+ *       make_any_value(std::size_t, Args&&...).  Only use a Hashed<T> with sets whose hash
+ *       function computes the same hash code for the key.
+ */
+template <class T>
+struct Hashed
+{
+	/**
+	 * @brief Pair @p key with @p hash_value.
+	 *
+	 * @param key        - The key.  Must outlive this object.
+	 * @param hash_value - The hash code of @p key.
+	 */
+	Hashed(const T& key, std::size_t hash_value) noexcept:
+		value(key), hash(hash_value)
+	{
+
+	}
+
+	Hashed(const T&&, std::size_t) = delete;
+
+	/// The key.
+	const T& value;
+	/// The hash code of the key.
+	const std::size_t hash;
+};
+
+/**
+ * @brief Hash @p key once with @p hasher and pair it with the result.
+ *
+ * @param key    - The key to hash.  Must outlive the returned object.
+ * @param hasher - The hash function.  Should be the same as that of the sets that the
+ *                 result is used with.
+ *
+ * @return A Hashed<T> referring to @p key.
+ */
+template <class T, class HashFn = AnyHash>
+Hashed<T> make_hashed(const T& key, const HashFn& hasher = HashFn{})
+{ return Hashed<T>(key, hasher(key)); }
+
+template <class T, class HashFn = AnyHash>
+Hashed<T> make_hashed(const T&&, const HashFn& = HashFn{}) = delete;
+
+namespace detail {
+
+template <class T>
+struct is_hashed: std::false_type {};
+
+template <class T>
+struct is_hashed<Hashed<T>>: std::true_type {};
+
+template <class T>
+inline constexpr const bool is_hashed_v = is_hashed<T>::value;
+
+/**
+ * @brief The murmur3 finalizer.  Makes every bit of the result depend on every bit of @p hash.
+ */
+inline std::size_t finalize_hash(std::size_t hash) noexcept
+{
+	if constexpr(sizeof(std::size_t) >= sizeof(std::uint64_t))
+	{
+		std::uint64_t h = hash;
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ull;
+		h ^= h >> 33;
+		return static_cast<std::size_t>(h);
+	}
+	else
+	{
+		std::uint32_t h = static_cast<std::uint32_t>(hash);
+		h ^= h >> 16;
+		h *= 0x85ebca6bu;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35u;
+		h ^= h >> 16;
+		return static_cast<std::size_t>(h);
+	}
+}
+
+/**
+ * @brief Function object applied to hash codes computed by @p HashFn before they are mapped to 
+ *        buckets.  The identity function if te::hash_is_avalanching_v<HashFn>, otherwise
+ *        finalize_hash().
+ */
+template <class HashFn>
+struct BucketHashMixer
+{
+	std::size_t operator()(std::size_t hash) const noexcept
+	{
+		if constexpr(hash_is_avalanching_v<HashFn>)
+			return hash;
+		else
+			return finalize_hash(hash);
+	}
+};
+
+} /* namespace detail */
+
+/**
+ * @brief An order-independent digest of the hash codes of a set's elements.
+ *
+ * Each element contributes its mixed hash code to a sum and to an exclusive or, so the digest
+ * can be updated in O(1) as elements are added and removed, in any order.  Sets with the same
+ * elements (and the same hash function) have the same digest, so sets with different digests
+ * are certainly different.  Equal digests do not imply equal sets.
+ *
+ * A digest only means something alongside the hash function that produced it.  Digests of
+ * sets in different processes are comparable when the hash codes of the elements are the same
+ * in both, which is not the case for e.g. te::TypedAnyHash.
+ */
+struct ContentDigest
+{
+	/// Sum of the mixed hash codes of the elements, modulo 2^N.
+	std::size_t sum{0u};
+	/// Exclusive or of the mixed hash codes of the elements.
+	std::size_t bits{0u};
+
+	/// Add an element with the hash code @p hash.
+	void add(std::size_t hash) noexcept
+	{
+		const std::size_t mixed = detail::finalize_hash(hash);
+		sum += mixed;
+		bits ^= mixed;
+	}
+
+	/// Remove an element with the hash code @p hash, which must have been added.
+	void remove(std::size_t hash) noexcept
+	{
+		const std::size_t mixed = detail::finalize_hash(hash);
+		sum -= mixed;
+		bits ^= mixed;
+	}
+
+	/// Add every element of a disjoint set with the digest @p other.
+	ContentDigest& operator+=(const ContentDigest& other) noexcept
+	{
+		sum += other.sum;
+		bits ^= other.bits;
+		return *this;
+	}
+
+	/// Remove every element of a subset with the digest @p other.
+	ContentDigest& operator-=(const ContentDigest& other) noexcept
+	{
+		sum -= other.sum;
+		bits ^= other.bits;
+		return *this;
+	}
+
+	/// Fold the digest into a single hash code.
+	std::size_t value() const noexcept
+	{ return detail::finalize_hash(sum ^ detail::finalize_hash(bits)); }
+
+	friend bool operator==(const ContentDigest& left, const ContentDigest& right) noexcept
+	{ return left.sum == right.sum and left.bits == right.bits; }
+
+	friend bool operator!=(const ContentDigest& left, const ContentDigest& right) noexcept
+	{ return not (left == right); }
+};
+
 } /* namespace te */
 
 #endif /* ANY_HASH_H */
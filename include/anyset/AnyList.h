@@ -6,6 +6,7 @@
 #endif 
 
 #include "AnyNode.h"
+#include "AnyHash.h"
 #include <iterator>
 #include <memory>
 #include <algorithm>
@@ -120,7 +121,7 @@ private:
 		pos_type pos_ = nullptr;
 
 		friend struct AnyList<Hash, Compare>;
-		template <class, class, class>
+		template <class, class, class, class>
 		friend struct ::te::AnySet;
 	};
 
@@ -144,6 +145,12 @@ public:
 			assert(static_cast<bool>(head_));
 		}
 		assert(static_cast<size_type>(std::distance(begin(), end())) == size());
+		assert(digest_ == [&]() {
+			ContentDigest dg;
+			for(const auto& any_v: *this)
+				dg.add(any_v.hash);
+			return dg;
+		}());
 	}
 
 	AnyList() noexcept = default;
@@ -151,11 +158,12 @@ public:
 	AnyList(const self_type&) = delete;
 
 	AnyList(self_type&& other) noexcept:
-		head_(other.head_), tail_(other.tail_), count_(other.count_)
+		head_(other.head_), tail_(other.tail_), count_(other.count_), digest_(other.digest_)
 	{
 		other.head_ = nullptr;
 		other.tail_ = &(other.head_);
 		other.count_ = 0u;
+		other.digest_ = ContentDigest{};
 		if(size() == 0)
 		{
 			assert(tail_ == std::addressof(other.head_));
@@ -168,13 +176,26 @@ public:
 	struct MakeCopyTag{};
 
 	// Make copying possible, but not conventionally
-	AnyList(const self_type& other, MakeCopyTag)
+	AnyList(const self_type& other, MakeCopyTag tag):
+		AnyList(other, tag, [](const value_type& any_v) { return any_v.clone(); })
 	{
-		auto it = begin();
-		for(const auto& any_v: other)
+		
+	}
+
+	// Same as above, but each node is copied with 'clone(any_v)'.
+	template <class Clone>
+	AnyList(const self_type& other, MakeCopyTag, Clone clone)
+	{
+		try
+		{
+			for(const auto& any_v: other)
+				push_back(clone(any_v));
+		}
+		catch(...)
 		{
-			splice(it, any_v.clone());
-			++it;
+			// The destructor won't run if we throw from here.
+			clear();
+			throw;
 		}
 	}
 
@@ -188,10 +209,12 @@ public:
 		clear();
 		head_ = other.head_;
 		count_ = other.count_;
+		digest_ = other.digest_;
 		tail_ = (other.tail_ == &(other.head_)) ? &head_ : other.tail_;
 		other.head_ = nullptr;
 		other.tail_ = &(other.head_);
 		other.count_ = 0u;
+		other.digest_ = ContentDigest{};
 		return *this;
 	}
 	
@@ -228,6 +251,7 @@ public:
 		std::swap(head_, other.head_);
 		std::swap(tail_, other.tail_);
 		std::swap(count_, other.count_);
+		std::swap(digest_, other.digest_);
 		if(tail_ == std::addressof(other.head_))
 		{
 			assert(size() == 0);
@@ -258,11 +282,41 @@ public:
 		*tail_ = node.release();
 		iterator old_tail(tail_);
 		++count_;
+		digest_.add((*tail_)->hash);
 		tail_ = std::addressof((*tail_)->next);
 		assert(not static_cast<bool>(*tail_));
 		return old_tail;
 	}
 	
+	// Give up ownership of every node without destroying them.  The nodes remain linked 
+	// through their 'next' pointers; returns the first one (or null if the list was empty).
+	// The caller must hand the nodes back with adopt_nodes().
+	value_type* release_nodes() noexcept
+	{
+		value_type* first = head_;
+		head_ = nullptr;
+		tail_ = std::addressof(head_);
+		count_ = 0u;
+		digest_ = ContentDigest{};
+		return first;
+	}
+
+	// Take ownership of 'count' nodes linked from 'first', whose digest is 'digest'.  
+	// 'last_next' is the address of the last node's 'next' pointer, which must be null.
+	void adopt_nodes(value_type* first, value_type** last_next, size_type count, const ContentDigest& digest) noexcept
+	{
+		assert(empty());
+		assert(static_cast<bool>(first) == static_cast<bool>(count));
+		if(not first)
+			return;
+		assert(last_next);
+		assert(not static_cast<bool>(*last_next));
+		head_ = first;
+		tail_ = last_next;
+		count_ = count;
+		digest_ = digest;
+	}
+
 	std::pair<std::unique_ptr<value_type>, iterator> pop(const_iterator p)
 	{
 		assert(not static_cast<bool>(*tail_));
@@ -274,6 +328,7 @@ public:
 		pos = pos->next;
 		node->next = nullptr;
 		--count_;
+		digest_.remove(node->hash);
 		assert(not static_cast<bool>(*tail_));
 		return std::make_pair(std::move(node), iterator(&pos));
 	}
@@ -287,6 +342,28 @@ public:
 		node->next = pos;
 		pos = node.release();
 		++count_;
+		digest_.add(pos->hash);
+		assert(not static_cast<bool>(*tail_));
+		return p.to_non_const();
+	}
+
+	// Move every node from 'other' into this list before 'p', keeping their order.
+	iterator splice(const_iterator p, self_type&& other) noexcept
+	{
+		assert(not static_cast<bool>(*tail_));
+		if(other.empty())
+			return p.to_non_const();
+		value_type*& pos = *p.to_non_const().pos_;
+		if(not static_cast<bool>(pos))
+			tail_ = other.tail_;
+		*other.tail_ = pos;
+		pos = other.head_;
+		count_ += other.count_;
+		digest_ += other.digest_;
+		other.head_ = nullptr;
+		other.tail_ = std::addressof(other.head_);
+		other.count_ = 0u;
+		other.digest_ = ContentDigest{};
 		assert(not static_cast<bool>(*tail_));
 		return p.to_non_const();
 	}
@@ -312,6 +389,9 @@ public:
 	size_type size() const noexcept
 	{ return count_; }
 
+	const ContentDigest& digest() const noexcept
+	{ return digest_; }
+
 	bool empty() const noexcept
 	{
 		assert(static_cast<bool>(size()) == static_cast<bool>(head_));
@@ -330,6 +410,7 @@ private:
 	value_type* head_{nullptr};
 	value_type** tail_{&head_};
 	size_type count_{0u};
+	ContentDigest digest_;
 };
 
 template <class Hash, class Compare>
@@ -7,20 +7,31 @@
 
 #include <typeinfo>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <new>
 #include <type_traits>
 #include <ostream>
 #include <memory>
+#include <cstring>
 #include "ValueHolder.h"
 
 namespace te {
 
 /* Forward declarations. */
 
-template <class H, class E, class A>
+template <class H, class E, class A, class P>
 struct AnySet;
 
 template <class H, class E, class A>
-std::ostream& operator<<(std::ostream& os, const AnySet<H, E, A>& set);
+struct FrozenAnySet;
+
+template <class H, class E, class A>
+struct PersistentAnySet;
+
+template <class H, class E, class A, class P>
+std::ostream& operator<<(std::ostream& os, const AnySet<H, E, A, P>& set);
 
 
 /// @internal
@@ -81,9 +92,152 @@ struct TypedValue;
 template <class Value, class HashFn, class Compare>
 struct AnyValueLink;
 
+template <class Value, class HashFn, class Compare>
+struct AllocatedValueLink;
+
 template <class HashFn, class Compare>
 struct AnyList;
 
+/* Allocator support for nodes. */
+
+template <class Alloc>
+struct is_std_allocator: 
+	std::is_same<Alloc, std::allocator<typename std::allocator_traits<Alloc>::value_type>>
+{
+	
+};
+
+template <class Alloc>
+inline constexpr const bool is_std_allocator_v = is_std_allocator<Alloc>::value;
+
+/**
+ * @brief Unit of storage that allocator-aware nodes are allocated in.
+ */
+struct alignas(alignof(std::max_align_t)) NodeBlock
+{
+	unsigned char bytes[alignof(std::max_align_t)];
+};
+
+/**
+ * @brief Function that frees the storage of an allocator-aware node.  A pointer to one of these
+ *        is stored immediately before each node that is allocated through a NodeAllocator.
+ */
+using NodeDeallocator = void (*)(void* node, std::size_t node_size) noexcept;
+
+/**
+ * @brief Free the storage of a node that was allocated by NodeAllocatorBase::allocate_node().
+ *        The node must already have been destroyed.
+ */
+inline void deallocate_node(void* node, std::size_t node_size) noexcept
+{
+	NodeDeallocator dealloc;
+	std::memcpy(&dealloc, static_cast<unsigned char*>(node) - sizeof(NodeDeallocator), sizeof(dealloc));
+	dealloc(node, node_size);
+}
+
+/**
+ * @brief Type-erased node allocator.
+ * 
+ * TypedValue knows the type of the node to create, while AnySet knows the allocator
+ * to create it with.  AnySet passes one of these to AnyValue::clone() to bridge the two.
+ */
+struct NodeAllocatorBase
+{
+	/**
+	 * @brief Allocate storage for a node of @p node_size bytes that is suitably aligned for
+	 *        any type whose alignment does not exceed alignof(std::max_align_t).  The storage 
+	 *        must later be freed with deallocate_node().
+	 */
+	virtual void* allocate_node(std::size_t node_size) const = 0;
+
+protected:
+	~NodeAllocatorBase() = default;
+};
+
+/**
+ * @brief NodeAllocatorBase implementation that allocates from an instance of @p Alloc.
+ *
+ * Nodes are laid out as follows:
+@verbatim
+   | rebound allocator | ... padding ... | NodeDeallocator | node |
+@endverbatim 
+ * so a node can always free itself, no matter which set it ends up in.
+ */
+template <class Alloc>
+struct NodeAllocator final:
+	public NodeAllocatorBase
+{
+	using block_allocator = typename std::allocator_traits<Alloc>::template rebind_alloc<NodeBlock>;
+	using block_traits = std::allocator_traits<block_allocator>;
+
+	static_assert(
+		std::is_same_v<typename block_traits::pointer, NodeBlock*>,
+		"AnySet requires allocators whose pointer type is a raw pointer to allocate nodes."
+	);
+
+	explicit NodeAllocator(const Alloc& alloc):
+		alloc_(alloc)
+	{
+		
+	}
+
+	void* allocate_node(std::size_t node_size) const final override
+	{
+		block_allocator alloc(alloc_);
+		NodeBlock* block = block_traits::allocate(alloc, block_count(node_size));
+		auto* base = reinterpret_cast<unsigned char*>(block);
+		::new(static_cast<void*>(base)) block_allocator(std::move(alloc));
+		NodeDeallocator dealloc = &deallocate;
+		std::memcpy(base + header_size - sizeof(NodeDeallocator), &dealloc, sizeof(dealloc));
+		return base + header_size;
+	}
+
+private:
+	static constexpr const std::size_t header_size = (
+		(sizeof(block_allocator) + sizeof(NodeDeallocator) + sizeof(NodeBlock) - 1u) / sizeof(NodeBlock)
+	) * sizeof(NodeBlock);
+
+	static std::size_t block_count(std::size_t node_size) noexcept
+	{ return (header_size + node_size + sizeof(NodeBlock) - 1u) / sizeof(NodeBlock); }
+
+	static void deallocate(void* node, std::size_t node_size) noexcept
+	{
+		auto* base = static_cast<unsigned char*>(node) - header_size;
+		auto* stored = std::launder(reinterpret_cast<block_allocator*>(base));
+		block_allocator alloc(std::move(*stored));
+		stored->~block_allocator();
+		block_traits::deallocate(alloc, reinterpret_cast<NodeBlock*>(base), block_count(node_size));
+	}
+
+	block_allocator alloc_;
+};
+
+/* Process-wide registry of compact type ids. */
+
+/// Integer type used to identify the type of an AnyValue's contained object.
+using type_id_t = std::uint32_t;
+
+/// Hand out the next unused type id.  Ids start at 1.
+inline type_id_t next_type_id() noexcept
+{
+	static std::atomic<type_id_t> counter{0};
+	return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+/**
+ * @brief Get the compact id of type @p T.
+ * 
+ * Ids are assigned the first time they're requested, so they are small, but not stable 
+ * across program runs.  Like other function-local statics in inline functions, the registry
+ * is only shared between shared libraries on platforms that merge such objects at load time.
+ */
+template <class T>
+type_id_t type_id() noexcept
+{
+	static const type_id_t id = next_type_id();
+	return id;
+}
+
 } /* namespace detail */
 /// @endinternal
 
@@ -182,6 +336,11 @@ std::unique_ptr<TypedValue<T, H, C>> make_typed_value(std::size_t hash_v, Args&&
 template <class T, class H, class C, class ... Args>
 std::unique_ptr<TypedValue<T, H, C>> make_typed_value(H hash_fn, Args&& ... args);
 
+template <class T, class H, class C, class HashArg, class ... Args>
+std::unique_ptr<TypedValue<T, H, C>> allocate_typed_value(
+	const NodeAllocatorBase& alloc, HashArg&& hash_arg, Args&& ... args
+);
+
 } /* namespace detail */
 /// @endinternal
 
@@ -238,6 +397,45 @@ std::unique_ptr<AnyValue<H, C>> make_any_value(std::size_t hash_value, Args&& ..
 template <class T, class H, class C, class ... Args>
 std::unique_ptr<AnyValue<H, C>> make_any_value(H hasher, Args&& ... args);
 
+/**
+ * @brief Same as make_any_value(std::size_t, Args&&...), but allocates the node using a copy 
+ *        of @p alloc.
+ * 
+ * The returned node remembers its allocator.  It may be pushed into any AnySet whose @p HashFn
+ * and @p KeyEqual types are @p H and @p C, regardless of that set's allocator, and is always 
+ * freed using a copy of @p alloc.
+ *
+ * @param alloc      - The allocator to allocate the node with.
+ * @param hash_value - The resultant hash code obtained from hashing the to-be-constructed 
+ *                     @p T instance.
+ * @param args       - arguments to forward to @p T's constructor.
+ *
+ * @relates AnyValue.
+ */
+template <class T, class H, class C, class Alloc, class ... Args>
+std::unique_ptr<AnyValue<H, C>> make_any_value(
+	std::allocator_arg_t, const Alloc& alloc, std::size_t hash_value, Args&& ... args
+);
+
+/**
+ * @brief Same as make_any_value(H, Args&&...), but allocates the node using a copy of @p alloc.
+ * 
+ * The returned node remembers its allocator.  It may be pushed into any AnySet whose @p HashFn
+ * and @p KeyEqual types are @p H and @p C, regardless of that set's allocator, and is always 
+ * freed using a copy of @p alloc.
+ *
+ * @param alloc  - The allocator to allocate the node with.
+ * @param hasher - The instance of @p H to use to compute the hash of contained @p T
+ *                 object after it is constructed in the AnyValue.
+ * @param args   - Arguments to forward to @p T's constructor.
+ *
+ * @relates AnyValue.
+ */
+template <class T, class H, class C, class Alloc, class ... Args>
+std::unique_ptr<AnyValue<H, C>> make_any_value(
+	std::allocator_arg_t, const Alloc& alloc, H hasher, Args&& ... args
+);
+
 /// @}
 
 /**
@@ -430,8 +628,8 @@ struct AnyValue
 	virtual const std::type_info& typeinfo() const = 0;
 
 protected:
-	AnyValue(std::size_t hash_v):
-		hash(hash_v)
+	AnyValue(std::size_t hash_v, detail::type_id_t type_id_v):
+		hash(hash_v), type_id(type_id_v)
 	{
 		
 	}
@@ -441,6 +639,7 @@ protected:
 	virtual bool not_equals(const AnyValue& other) const = 0;
 	virtual void write(std::ostream& os) const = 0;
 	virtual std::unique_ptr<self_type> clone() const = 0;
+	virtual std::unique_ptr<self_type> clone(const detail::NodeAllocatorBase& alloc) const = 0;
 
 public:
 	/**
@@ -451,10 +650,24 @@ public:
 	 * object, which requires virtual dispatch.
 	 */
 	const std::size_t hash;
+
+	/**
+	 * @brief Compact id of the contained object's type.
+	 *
+	 * Exact type checks (is(), exact_cast(), try_as()) compare this against the id of the
+	 * requested type instead of calling typeinfo(), which needs a virtual call and, on some 
+	 * platforms, a string comparison.  Ids are assigned at run time; typeinfo() remains the
+	 * way to identify the contained type across program runs.
+	 */
+	const detail::type_id_t type_id;
 private:
 	self_type* next{nullptr};
-	template <class, class, class>	
+	template <class, class, class, class>
 	friend struct AnySet;
+	template <class, class, class>
+	friend struct FrozenAnySet;
+	template <class, class, class>
+	friend struct PersistentAnySet;
 	friend struct detail::AnyList<HashFn, Compare>;
 
 };
@@ -499,7 +712,7 @@ struct TypedValue:
 
 protected:
 	TypedValue(std::size_t hash_v):
-		base_type(hash_v)
+		base_type(hash_v, detail::type_id<Value>())
 	{
 		
 	}
@@ -549,6 +762,14 @@ public:
 			throw NoCopyConstructorError<Value>();
 	}
 
+	std::unique_ptr<base_type> clone(const NodeAllocatorBase& alloc) const final override
+	{
+		if constexpr(std::is_copy_constructible_v<Value>)
+			return allocate_typed_value<Value, HashFn, Compare>(alloc, this->hash, this->value());
+		else
+			throw NoCopyConstructorError<Value>();
+	}
+
 	const std::type_info& typeinfo() const final override
 	{ return typeid(Value); }
 
@@ -582,7 +803,10 @@ private:
         TypedValue  ConstValueHolder
              ^            ^
               \          /
-              AnyValueLink (final)
+              AnyValueLink
+                   ^
+                   |               <<< Only for nodes created with an allocator
+           AllocatedValueLink (final)
 @endverbatim  
  * This allows us to implement polymorphic_cast() with a simple dynamic_cast.  Since AnyValue
  * introduces RTTI into the heirarchy, polymorphic_cast() can cast through @p Value's public 
@@ -590,7 +814,7 @@ private:
  * that Value may not even be a polymorphic type itself.  
  */
 template <class Value, class HashFn, class Compare>
-struct AnyValueLink final:
+struct AnyValueLink:
 	public ConstValueHolder<Value>,
 	public TypedValue<Value, HashFn, Compare>
 {
@@ -599,7 +823,7 @@ struct AnyValueLink final:
 	using holder_type = ConstValueHolder<Value>;
 	using base_type = TypedValue<Value, HashFn, Compare>;
 public:
-	virtual ~AnyValueLink() final = default;
+	virtual ~AnyValueLink() = default;
 
 	template <class ... Args>
 	AnyValueLink(std::size_t hash_v, Args&& ... args):
@@ -625,6 +849,37 @@ public:
 
 };
 
+/**
+ * @brief This class is an implementation detail and is not part of the public interface
+ * of AnyValue.
+ *
+ * An AnyValueLink whose storage was obtained from NodeAllocatorBase::allocate_node().  
+ * Deleting an AllocatedValueLink through a pointer to any of its bases calls the class-specific
+ * operator delete below, which hands the storage back to the allocator it came from.  This 
+ * lets node handles remain plain std::unique_ptrs.
+ */
+template <class Value, class HashFn, class Compare>
+struct AllocatedValueLink final:
+	public AnyValueLink<Value, HashFn, Compare>
+{
+	using AnyValueLink<Value, HashFn, Compare>::AnyValueLink;
+
+	virtual ~AllocatedValueLink() final = default;
+
+	static void* operator new(std::size_t) = delete;
+
+	static void* operator new(std::size_t, void* where) noexcept
+	{ return where; }
+
+	static void operator delete(void* p, std::size_t size) noexcept
+	{ deallocate_node(p, size); }
+
+	static void operator delete(void*, void*) noexcept
+	{ 
+		
+	}
+};
+
 } /* namespace detail */
 /// @endinternal
 
@@ -647,6 +902,34 @@ std::unique_ptr<detail::TypedValue<T, H, C>> detail::make_typed_value(H hash_fn,
 	);
 }
 
+template <class T, class H, class C, class HashArg, class ... Args>
+std::unique_ptr<detail::TypedValue<T, H, C>> detail::allocate_typed_value(
+	const NodeAllocatorBase& alloc, HashArg&& hash_arg, Args&& ... args
+)
+{
+	using node_type = AllocatedValueLink<T, H, C>;
+	if constexpr(alignof(node_type) > alignof(std::max_align_t))
+	{
+		// Over-aligned types get their alignment from operator new.
+		return make_typed_value<T, H, C>(std::forward<HashArg>(hash_arg), std::forward<Args>(args)...);
+	}
+	else
+	{
+		void* mem = alloc.allocate_node(sizeof(node_type));
+		node_type* node = nullptr;
+		try
+		{
+			node = new(mem) node_type(std::forward<HashArg>(hash_arg), std::forward<Args>(args)...);
+		}
+		catch(...)
+		{
+			deallocate_node(mem, sizeof(node_type));
+			throw;
+		}
+		return std::unique_ptr<TypedValue<T, H, C>>(static_cast<TypedValue<T, H, C>*>(node));
+	}
+}
+
 template <class T, class H, class C, class ... Args>
 std::unique_ptr<AnyValue<H, C>> make_any_value(std::size_t hash_value, Args&& ... args)
 {
@@ -665,6 +948,32 @@ std::unique_ptr<AnyValue<H, C>> make_any_value(H hasher, Args&& ... args)
 	);
 }
 
+template <class T, class H, class C, class Alloc, class ... Args>
+std::unique_ptr<AnyValue<H, C>> make_any_value(
+	std::allocator_arg_t, const Alloc& alloc, std::size_t hash_value, Args&& ... args
+)
+{
+	auto tmp = detail::allocate_typed_value<T, H, C>(
+		detail::NodeAllocator<Alloc>(alloc), hash_value, std::forward<Args>(args)...
+	);
+	return std::unique_ptr<AnyValue<H, C>>(
+		static_cast<AnyValue<H, C>*>(tmp.release())
+	);
+}
+
+template <class T, class H, class C, class Alloc, class ... Args>
+std::unique_ptr<AnyValue<H, C>> make_any_value(
+	std::allocator_arg_t, const Alloc& alloc, H hasher, Args&& ... args
+)
+{
+	auto tmp = detail::allocate_typed_value<T, H, C>(
+		detail::NodeAllocator<Alloc>(alloc), hasher, std::forward<Args>(args)...
+	);
+	return std::unique_ptr<AnyValue<H, C>>(
+		static_cast<AnyValue<H, C>*>(tmp.release())
+	);
+}
+
 
 /// @name Casts 
 /// @{
@@ -935,7 +1244,7 @@ const T& as(const AnyValue<H, C>& self)
 
 template <class T, class H, class C>
 bool is(const AnyValue<H, C>& any_v)
-{ return any_v.typeinfo() == typeid(T); }
+{ return any_v.type_id == detail::type_id<std::remove_cv_t<std::remove_reference_t<T>>>(); }
 
 
 /**
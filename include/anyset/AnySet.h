@@ -16,6 +16,12 @@
 #include <bitset>
 #include "AnyHash.h"
 #include "CompressedPair.h"
+#include "OpenTable.h"
+#include "LookupFilter.h"
+#include "Parallel.h"
+#if __has_include(<memory_resource>)
+# include <memory_resource>
+#endif
 
 /**
  * @mainpage AnySet Docs
@@ -31,12 +37,20 @@
  * ## Quick Reference
  * * te::AnySet - A type-erased hash set.
  *     * SetOperations.h - Free functions and operator overloads for common set operations on te::AnySet instances.
+ * * te::ConcurrentAnySet - A type-erased hash set with lock-free insertion and lookup (ConcurrentAnySet.h).
+ * * te::ShardedAnySet - A thread-safe set of independently locked AnySet shards (ShardedAnySet.h).
+ * * te::RcuAnySet - A read-mostly AnySet with wait-free readers and batched, published writes (RcuAnySet.h).
+ * * te::FrozenAnySet - An immutable copy of an AnySet with a perfect-hash index (FrozenAnySet.h).
+ * * te::PersistentAnySet - An immutable AnySet whose versions share structure, with O(1) snapshots (PersistentAnySet.h).
+ * * te::CowAnySet - A copy-on-write AnySet whose copies share one set until one of them changes (CowAnySet.h).
  * * te::AnyValue - Type of elements stored in AnySet instances.
  * * te::AnyHash - Generic hash function object.
  *     * te::Hash - Customization point for te::AnyHash.
  *     * hash_value() - Customization point for te::AnyHash (compatible with boost::container_hash).
+ *     * te::TypedAnyHash - Like te::AnyHash, but also hashes the type of the value.
  *     * extra-hash.h - Utilities for building hash functions, intended to be compatible with boost::container_hash.
  *                      Also includes specializations of te::Hash for standard types like std::pair and std::tuple.
+ * * te::Hashed - A key paired with its precomputed hash code, accepted by AnySet's lookup and insertion functions.
  */
 
 
@@ -61,8 +75,80 @@ struct is_iterator<T, std::enable_if_t<!std::is_same_v<typename std::iterator_tr
 template <class T>
 inline constexpr const bool is_iterator_v = is_iterator<T>::value;
 
+/// True if the first type in @p Args is (a reference to) Hashed<T>.
+template <class T, class ... Args>
+struct leads_with_hashed_key: std::false_type {};
+
+template <class T, class First, class ... Rest>
+struct leads_with_hashed_key<T, First, Rest...>: std::is_same<std::decay_t<First>, Hashed<T>> {};
+
+template <class T, class ... Args>
+inline constexpr const bool leads_with_hashed_key_v = leads_with_hashed_key<T, Args...>::value;
+
 } /* namespace detail */
 
+/// @name Table Policies
+/// @{
+
+/**
+ * @brief Table policy for AnySet that uses separate chaining (the default).
+ *
+ * Elements are kept in a single linked list, grouped by bucket and sorted by hash within each
+ * bucket.  The bucket table holds, for each bucket, an iterator to the bucket's first element.
+ * 
+ * @see AnySet
+ * @see OpenAddressing
+ */
+struct ChainedBuckets {};
+
+/**
+ * @brief Table policy for AnySet that uses a Swiss-table style open-addressed index.
+ *
+ * Elements are kept in a single linked list in insertion order.  Lookups go through
+ * an open-addressed index that stores a 7-bit fingerprint of each element's hash in a
+ * separate array of control bytes, which is scanned 16 bytes at a time.  Most mismatched
+ * elements are rejected from the control bytes alone, without touching the elements
+ * themselves.
+ *
+ * This layout favors lookup-heavy workloads.  Compared to ChainedBuckets:
+ * - Each "bucket" is a single slot of the index, which holds at most one element.  
+ *   bucket_count() is the number of slots and bucket_size() is zero or one.
+ * - The effective maximum load factor is at most 0.875, regardless of max_load_factor().
+ * - Rehashing rebuilds only the index; the order of the elements does not change and no
+ *   iterators are invalidated.
+ * 
+ * @see AnySet
+ * @see ChainedBuckets
+ */
+struct OpenAddressing {};
+
+/**
+ * @brief Table policy for AnySet that uses separate chaining like ChainedBuckets, but spreads the
+ *        work of growing the bucket table over the insertions that follow.
+ *
+ * When an insertion pushes the load factor past max_load_factor(), the bucket table is doubled 
+ * but the elements are not redistributed right away.  Instead, every insertion migrates a few of
+ * the old buckets until none are left, so no single insertion pays for rehashing every element.
+ * Allocating the larger table still takes time proportional to bucket_count(), but that is one
+ * sequential copy rather than a walk over every element.
+ * 
+ * While a migration is in progress:
+ * - bucket_count() is the size of the new table.  A bucket @p n that has not been migrated yet 
+ *   holds every element that will end up in buckets @p n and @p n + bucket_count() / 2, and the
+ *   latter bucket is empty.  bucket() and the local iterators reflect where elements are now.
+ * - Insertions may move elements around in the same way that rehash() does: references and 
+ *   pointers to elements remain valid, but iterators and local iterators may refer to different 
+ *   elements afterwards.  Lookups and erasure never migrate buckets.
+ * - rehash(), reserve(), and any operation that grows or shrinks the table all at once finish 
+ *   the migration first.
+ * 
+ * @see AnySet
+ * @see ChainedBuckets
+ */
+struct IncrementalRehash {};
+
+/// @}
+
 /**
  * @brief 
  * AnySet is an associative container that contains a set of unique objects of any constructible type.
@@ -84,13 +170,19 @@ inline constexpr const bool is_iterator_v = is_iterator<T>::value;
  *         is made to copy construct or assign (or similar) from an AnySet instance that contains instances of 
  *         non-copy-constructible types, an exception is thrown.  
  * 
- * @tparam HashFn    - The type of the function object to use when computing the hash codes of elements.
- * @tparam KeyEqual  - The type of the function object to use when comparing elements for equality.
- * @tparam Allocator - The type of the allocator to use when allocating the internal bucket table.
+ * @tparam HashFn      - The type of the function object to use when computing the hash codes of elements.
+ *                       Hash codes are mixed before being mapped to buckets unless 
+ *                       te::hash_is_avalanching_v<HashFn> is true.
+ * @tparam KeyEqual    - The type of the function object to use when comparing elements for equality.
+ * @tparam Allocator   - The type of the allocator to use when allocating the internal bucket table and nodes.
+ * @tparam TablePolicy - The layout of the internal bucket table.  One of te::ChainedBuckets (the default),
+ *                       te::OpenAddressing, or te::IncrementalRehash.
  * 
- * @remark The STL's allocator model is too rigid for AnySet to sanely support customized allocation of its internal
- *         nodes.  Thus its internal elements/nodes are simply allocated using std::make_unique() (effectively using
- *         the keyword 'new').  Allocator support is only provided for the internal bucket table.
+ * @remark Nodes are allocated from a copy of the set's allocator, rebound to an internal block type.  Each node 
+ *         stores the allocator it came from, so node_handles remain plain std::unique_ptrs that may be moved between
+ *         sets with different allocators, and are always freed by the allocator that created them.  When 
+ *         @p Allocator is a std::allocator, nodes are simply allocated with std::make_unique().  Types whose 
+ *         alignment exceeds alignof(std::max_align_t) are always allocated with std::make_unique().
  *
  * @see AnyValue - User-visible @p value_type for AnySet instances.
  * @see AnyHash  - The default value of HashFn.  It %is intended to be sufficiently extensible such that users 
@@ -99,13 +191,23 @@ inline constexpr const bool is_iterator_v = is_iterator<T>::value;
 template <
 	class HashFn = AnyHash,
 	class KeyEqual = std::equal_to<>,
-	class Allocator = std::allocator<AnyValue<HashFn, KeyEqual>>
+	class Allocator = std::allocator<AnyValue<HashFn, KeyEqual>>,
+	class TablePolicy = ChainedBuckets
 >
 struct AnySet:
 	private CompressedPair<HashFn, KeyEqual>
 {
 private:
-	using self_type = AnySet<HashFn, KeyEqual, Allocator>;
+	static_assert(
+		std::is_same_v<TablePolicy, ChainedBuckets> 
+		or std::is_same_v<TablePolicy, OpenAddressing>
+		or std::is_same_v<TablePolicy, IncrementalRehash>,
+		"TablePolicy must be te::ChainedBuckets, te::OpenAddressing, or te::IncrementalRehash."
+	);
+	static constexpr const bool open_addressing = std::is_same_v<TablePolicy, OpenAddressing>;
+	static constexpr const bool incremental_rehash = std::is_same_v<TablePolicy, IncrementalRehash>;
+
+	using self_type = AnySet<HashFn, KeyEqual, Allocator, TablePolicy>;
 	using list_type = detail::AnyList<HashFn, KeyEqual>;
 	using list_iterator = typename list_type::iterator;
 	using const_list_iterator = typename list_type::const_iterator;
@@ -201,8 +303,13 @@ public:
 	};
 
 private:
-	using table_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<iterator>;
+	using alloc_traits = std::allocator_traits<Allocator>;
+	using table_allocator = typename alloc_traits::template rebind_alloc<iterator>;
 	using vector_type = std::vector<iterator, table_allocator>;
+	using hash_mixer = detail::BucketHashMixer<HashFn>;
+	using open_table_type = detail::OpenTable<AnyValue<HashFn, KeyEqual>, iterator, Allocator, hash_mixer>;
+	using table_type = std::conditional_t<open_addressing, open_table_type, vector_type>;
+	using filter_type = detail::BlockedBloomFilter<Allocator>;
 	using pair_type = CompressedPair<HashFn, KeyEqual>;
 	using vector_iterator = typename vector_type::iterator;
 	using const_vector_iterator = typename vector_type::const_iterator;
@@ -260,6 +367,55 @@ private:
 		);
 	}
 
+	// Nodes are allocated with the set's allocator unless it is just std::allocator, in which 
+	// case plain operator new is equivalent and cheaper.
+	static constexpr const bool allocated_nodes = not detail::is_std_allocator_v<allocator_type>;
+
+	template <class T, class HashArg, class ... Args>
+	static node_handle make_node(const allocator_type& alloc, HashArg&& hash_arg, Args&& ... args)
+	{
+		if constexpr(allocated_nodes)
+		{
+			return make_any_value<T, HashFn, KeyEqual>(
+				std::allocator_arg, alloc, std::forward<HashArg>(hash_arg), std::forward<Args>(args)...
+			);
+		}
+		else
+		{
+			(void)alloc;
+			return make_any_value<T, HashFn, KeyEqual>(
+				std::forward<HashArg>(hash_arg), std::forward<Args>(args)...
+			);
+		}
+	}
+
+	static node_handle clone_node(const value_type& value, const allocator_type& alloc)
+	{
+		if constexpr(allocated_nodes)
+			return value.clone(detail::NodeAllocator<allocator_type>(alloc));
+		else
+			return value.clone();
+	}
+
+	static auto node_cloner(const allocator_type& alloc)
+	{ return [&alloc](const value_type& value) { return clone_node(value, alloc); }; }
+
+	// Take the contents of 'other', including its nodes.  Only valid if the nodes may be 
+	// freed with the allocator that this set has afterwards.
+	AnySet& steal(AnySet&& other) noexcept(std::is_nothrow_move_assignable_v<table_type>)
+	{
+		as_pair() = std::move(other.as_pair());
+		list_ = std::move(other.list_);
+		table_ = std::move(other.table_);
+		max_load_factor_ = std::move(other.max_load_factor_);
+		migration_ = other.migration_;
+		filter_ = std::move(other.filter_);
+		fix_table_after_move();
+		assert(other.empty());
+		other.reinitialize_moved_from_table();
+		return *this;
+	}
+
 	template <bool IsConst>	
 	struct BucketIterator:
 		private std::conditional_t<IsConst, const_iterator, iterator>
@@ -324,7 +480,7 @@ private:
 			assert(not get_pos().is_null());
 			// Returns true if 'pos_' is past-the-end for the whole list or the element pointed to by
 			// 'pos_' has a hash in a different bucket (past-the-end for this bucket).
-			return get_pos().is_end() or ((get_pos()->hash & mask_) != bucket_);
+			return get_pos().is_end() or ((hash_mixer{}(get_pos()->hash) & mask_) != bucket_);
 		}
 
 		BucketIterator<false> to_non_const() const
@@ -342,15 +498,188 @@ private:
 
 		std::size_t bucket_{0};
 		std::size_t mask_{0};
-		template <class, class, class>
+		template <class, class, class, class>
+		friend struct AnySet;
+	};
+
+	// Local iterator for OpenAddressing sets.  Each slot holds at most one element,
+	// so incrementing a SlotIterator always makes it past-the-end.
+	template <bool IsConst>
+	struct SlotIterator:
+		private std::conditional_t<IsConst, const_iterator, iterator>
+	{
+	private:
+		using self_type = SlotIterator<IsConst>;
+		using base_type = std::conditional_t<IsConst, const_iterator, iterator>;
+	public:
+		using value_type        = typename base_type::value_type;
+		using reference         = typename base_type::reference;
+		using pointer           = typename base_type::pointer;
+		using difference_type   = typename base_type::difference_type;
+		using iterator_category = typename base_type::iterator_category;
+
+		SlotIterator() = default;
+
+		friend bool operator==(const SlotIterator<IsConst>& left, const SlotIterator<IsConst>& right)
+		{ return left.get_pos() == right.get_pos(); }
+
+		friend bool operator!=(const SlotIterator<IsConst>& left, const SlotIterator<IsConst>& right)
+		{ return not (left == right); }
+
+		self_type& operator++()
+		{
+			assert(not get_pos().is_null());
+			get_pos() = base_type();
+			return *this;
+		}
+
+		self_type operator++(int)
+		{
+			auto cpy = *this;
+			++*this;
+			return cpy;
+		}
+
+		using base_type::operator->;
+		using base_type::operator*;
+
+	private:
+		SlotIterator(base_type pos):
+			base_type(pos)
+		{
+			
+		}
+
+		SlotIterator<false> to_non_const() const
+		{
+			if(get_pos().is_null())
+				return SlotIterator<false>();
+			return SlotIterator<false>(get_pos().to_non_const());
+		}
+
+		const base_type& get_pos() const
+		{ return static_cast<const base_type&>(*this); }
+
+		base_type& get_pos()
+		{ return static_cast<base_type&>(*this); }
+
+		template <class, class, class, class>
 		friend struct AnySet;
 	};
 	
 public:
 	/// Iterator type suitable for traversal through an individual bucket.
-	using local_iterator = BucketIterator<false>;
+	using local_iterator = std::conditional_t<open_addressing, SlotIterator<false>, BucketIterator<false>>;
 	/// Const iterator type suitable for traversal through an individual bucket.
-	using const_local_iterator = BucketIterator<true>;
+	using const_local_iterator = std::conditional_t<open_addressing, SlotIterator<true>, BucketIterator<true>>;
+
+	/**
+	 * @brief Const iterator over the elements of a Partition.  Visits the buckets of the
+	 *        partition in index order.
+	 */
+	struct PartitionIterator
+	{
+		using value_type        = const typename AnySet::value_type;
+		using reference         = const typename AnySet::value_type&;
+		using pointer           = const typename AnySet::value_type*;
+		using difference_type   = std::ptrdiff_t;
+		using iterator_category = std::forward_iterator_tag;
+
+		PartitionIterator() = default;
+
+		reference operator*() const
+		{ return *pos_; }
+
+		pointer operator->() const
+		{ return std::addressof(*pos_); }
+
+		PartitionIterator& operator++()
+		{
+			++pos_;
+			skip_empty_buckets();
+			return *this;
+		}
+
+		PartitionIterator operator++(int)
+		{
+			auto cpy = *this;
+			++*this;
+			return cpy;
+		}
+
+		friend bool operator==(const PartitionIterator& left, const PartitionIterator& right)
+		{ return (left.bucket_ == right.bucket_) and (left.pos_ == right.pos_); }
+
+		friend bool operator!=(const PartitionIterator& left, const PartitionIterator& right)
+		{ return not (left == right); }
+
+	private:
+		PartitionIterator(const AnySet& set, size_type bucket, size_type last):
+			set_(std::addressof(set)), bucket_(bucket), last_(last)
+		{
+			if(bucket_ < last_)
+			{
+				pos_ = set_->cbegin(bucket_);
+				skip_empty_buckets();
+			}
+		}
+
+		void skip_empty_buckets()
+		{
+			while(pos_ == set_->cend(bucket_))
+			{
+				if(++bucket_ == last_)
+				{
+					pos_ = const_local_iterator();
+					return;
+				}
+				pos_ = set_->cbegin(bucket_);
+			}
+		}
+
+		const AnySet* set_ = nullptr;
+		size_type bucket_ = 0;
+		size_type last_ = 0;
+		const_local_iterator pos_;
+		friend struct AnySet;
+	};
+
+	/// Const iterator over the elements of a Partition.
+	using const_partition_iterator = PartitionIterator;
+
+	/**
+	 * @brief A range of consecutive buckets, as returned by partitions().
+	 */
+	struct Partition
+	{
+		/// Get an iterator to the first element of the partition.
+		const_partition_iterator begin() const
+		{ return const_partition_iterator(*set_, first_, last_); }
+
+		/// Get the past-the-end iterator of the partition.
+		const_partition_iterator end() const
+		{ return const_partition_iterator(*set_, last_, last_); }
+
+		/// Get the index of the first bucket in the partition.
+		size_type first_bucket() const noexcept
+		{ return first_; }
+
+		/// Get the index one past the last bucket in the partition.
+		size_type last_bucket() const noexcept
+		{ return last_; }
+
+	private:
+		Partition(const AnySet& set, size_type first, size_type last):
+			set_(std::addressof(set)), first_(first), last_(last)
+		{
+
+		}
+
+		const AnySet* set_;
+		size_type first_;
+		size_type last_;
+		friend struct AnySet;
+	};
 
 	void _assert_invariants(bool check_load_factor = false) const
 	{
@@ -361,17 +690,49 @@ public:
 		auto iter_dist = std::distance(cbegin(), cend());
 		assert(iter_dist >= 0);
 		assert(static_cast<size_type>(iter_dist) == size());
-		assert(std::all_of(table_.begin(), table_.end(), [](const auto& v){ return v.is_null() or not v.is_end();}));
-		for(size_type i = 0; i < bucket_count(); ++i)
+		if constexpr(open_addressing)
+		{
+			assert(table_.size() == size());
+			assert(table_.size() + table_.tombstones() < table_size());
+			for(auto pos = cbegin(); pos != cend(); ++pos)
+			{
+				// every element is indexed, along with its current position in the list
+				auto idx = table_.find_node(std::addressof(*pos));
+				assert(const_iterator(table_.slot(idx).pos) == pos);
+			}
+		}
+		else
 		{
-			// each bucket is sorted WRT hash values of the nodes in the bucket
-			assert(std::is_sorted(
-				this->begin(i),
-				this->end(i),
-				[](const auto& l, const auto& r){ return l.hash < r.hash; }
-			));
-			assert(std::all_of(begin(i), end(i), [&](const auto& v){ return bucket_index(v.hash) == i; }));
+			assert(std::all_of(table_.begin(), table_.end(), [](const auto& v){ return v.is_null() or not v.is_end();}));
+			size_type bucketed = 0;
+			for(size_type i = 0; i < bucket_count(); ++i)
+			{
+				// each bucket is sorted WRT hash values of the nodes in the bucket
+				assert(std::is_sorted(
+					this->begin(i),
+					this->end(i),
+					[](const auto& l, const auto& r){ return l.hash < r.hash; }
+				));
+				assert(std::all_of(begin(i), end(i), [&](const auto& v){ return bucket_index(v.hash) == i; }));
+				bucketed += bucket_size(i);
+			}
+			// each element is in exactly one bucket
+			assert(bucketed == size());
+			(void)bucketed;
+			if constexpr(incremental_rehash)
+			{
+				if(rehashing())
+				{
+					assert(2 * migration_.old_bucket_count == table_size());
+					assert(migration_.migrated < migration_.old_bucket_count);
+					// the upper halves of unmigrated buckets are empty
+					for(size_type i = migration_.migrated; i < migration_.old_bucket_count; ++i)
+						assert(table_[i + migration_.old_bucket_count].is_null());
+				}
+			}
 		}
+		// every element is in the lookup filter
+		assert(std::all_of(begin(), end(), [&](const auto& v){ return filter_.may_contain(v.hash); }));
 		// the load factor is allowed to be not satisfied if the user changed the max_load_factor().
 		// we only do this assertion when asked to
 		if(check_load_factor)
@@ -402,7 +763,18 @@ public:
 		const Allocator& alloc = Allocator()
 	):
 		pair_type(hash, equal),
-		table_(next_highest_pow2(bucket_count), iterator(), allocator_type(alloc))
+		table_(make_table(bucket_count, allocator_type(alloc))),
+		filter_(allocator_type(alloc))
+	{
+		
+	}
+
+	/**
+	 * @brief Construct an empty AnySet instance with 1 bucket.  Sets max_load_factor() to 1.0.
+	 * @param alloc - Allocator to initialize the set with.
+	 */
+	explicit AnySet(const Allocator& alloc):
+		AnySet(size_type(0), HashFn(), KeyEqual(), alloc) 
 	{
 		
 	}
@@ -508,75 +880,106 @@ public:
 		
 	}
 
+	/**
+	 * @brief Construct an AnySet instance from the range [first, last), hashing, copying, and
+	 *        bucketing the elements on the threads of @p policy.  Sets max_load_factor() to 1.0.
+	 *        If multiple elements in the range compare equivalent, only the first encountered
+	 *        is inserted.
+	 *
+	 * @tparam ForwardIt - Forward iterator type.
+	 *
+	 * @param policy       - Execution policy (see Parallel.h) to run the work with.
+	 * @param first        - Iterator to the first element in the range.
+	 * @param last         - Iterator one position past the last element in the range.
+	 * @param bucket_count - Minimum number of buckets to initialize the set with.
+	 * @param hash         - %Hash function to initialize the set with.
+	 * @param equal        - Equality comparison function to initialize the set with
+	 * @param alloc        - Allocator to initialize the set with.
+	 *
+	 * @see insert(const Policy&, ForwardIt, ForwardIt)
+	 */
+	template <
+		class Policy,
+		class ForwardIt,
+		class = std::enable_if_t<detail::is_execution_policy_v<Policy>>
+	>
+	AnySet(
+		const Policy& policy,
+		ForwardIt first,
+		ForwardIt last,
+		size_type bucket_count = 0,
+		const HashFn& hash = HashFn(),
+		const KeyEqual& equal = KeyEqual(),
+		const Allocator& alloc = Allocator()
+	):
+		AnySet(bucket_count, hash, equal, alloc)
+	{
+		this->insert(policy, first, last);
+	}
+
 	/**
 	 * @brief Copy constructs an AnySet instance from other.
 	 *        Constructs the set with the copy of the contents of other.  
 	 *        Copies the load factor, the predicate, and the hash function as well.
+	 *        The copy has the same bucket count and element order as @p other.
 	 * @param other - The set whose contents will be copied.
 	 * @param alloc - Allocator to initialize the set with.
 	 */
 	AnySet(const AnySet& other, const Allocator& alloc):
 		pair_type(other.as_pair()),
-		list_(other.list_),
-		table_(0, alloc),
-		max_load_factor_(other.max_load_factor_)
+		list_(other.list_, list_type::make_copy, node_cloner(alloc)),
+		table_(make_table_of_size(other.table_size(), allocator_type(alloc))),
+		max_load_factor_(other.max_load_factor_),
+		migration_(other.migration_),
+		filter_(other.filter_, allocator_type(alloc))
 	{
-		table_.assign(other.table_.size(), iterator());
-		list_type tmp(std::move(list_));
-		assert(size() == 0u);
-		node_handle node{nullptr};
-		while(not tmp.empty())
-		{
-			node = std::move(tmp.pop(tmp.begin()).first);
-			node = std::move(push(std::move(node)));
-			assert(not static_cast<bool>(node));
-		}
-		assert(tmp.empty());
+		index_copied_list();
 	}
 
 	/**
 	 * @brief Copy constructs an AnySet instance from other.
 	 *        Constructs the set with the copy of the contents of other.  
 	 *        Copies the load factor, the predicate, and the hash function as well.
+	 *        The copy has the same bucket count and element order as @p other.
 	 *        
 	 * @param other - The set whose contents will be copied.
 	 */
 	AnySet(const AnySet& other):
 		pair_type(other.as_pair()),
-		list_(other.list_, list_type::make_copy),
-		table_(0, other.alloc_socca()),
-		max_load_factor_(other.max_load_factor_)
+		list_(other.list_, list_type::make_copy, node_cloner(other.alloc_socca())),
+		table_(make_table_of_size(other.table_size(), other.alloc_socca())),
+		max_load_factor_(other.max_load_factor_),
+		migration_(other.migration_),
+		filter_(other.filter_, other.alloc_socca())
 	{
-		table_.resize(other.table_.size());
-		list_type tmp(std::move(list_));
-		assert(size() == 0u);
-		node_handle node{nullptr};
-		while(not tmp.empty())
-		{
-			node = std::move(tmp.pop(tmp.begin()).first);
-			node = std::move(push(std::move(node)).second);
-			assert(not static_cast<bool>(node));
-		}
-		assert(tmp.empty());
+		index_copied_list();
 	}
 
 	/**
 	 * @brief Move constructs an AnySet instance from other.
-	 *        Constructs the set with the copy of the contents of other.  
-	 *        Copies the load factor, the predicate, and the hash function as well.
-	 * @param other - The set whose contents will be copied.
+	 *        Constructs the set with the contents of other.  
+	 *        Moves the load factor, the predicate, and the hash function as well.
+	 *        If @p alloc compares unequal to other.get_allocator(), the elements of @p other
+	 *        are copied with @p alloc instead of being moved, and @p other is cleared.
+	 * @param other - The set whose contents will be moved.
 	 * @param alloc - Allocator to initialize the set with.
+	 *
+	 * @throws te::NoCopyConstructorError if the elements of @p other must be copied and one of 
+	 *         them is of non-copy-constructible type.
 	 */
 	AnySet(AnySet&& other, const Allocator& alloc):
-		pair_type(std::move(other.as_pair())),
-		list_(std::move(other.list_)),
-		table_(std::move(other.table_), alloc),
-		max_load_factor_(other.max_load_factor_)
+		AnySet(size_type(0), other.hash_function(), other.key_eq(), alloc)
 	{
-		fix_table_after_move();
-		assert(other.empty());
-		if(other.table_.size() == 0u)
-			other.table_.assign(1u, iterator());
+		if(alloc_traits::is_always_equal::value or get_allocator() == other.get_allocator())
+		{
+			steal(std::move(other));
+		}
+		else
+		{
+			// The nodes of 'other' belong to its allocator, so they can't be taken.
+			steal(self_type(other, get_allocator()));
+			other.clear();
+		}
 	}
 
 	/**
@@ -590,12 +993,13 @@ public:
 		pair_type(std::move(other.as_pair())),
 		list_(std::move(other.list_)),
 		table_(std::move(other.table_)),
-		max_load_factor_(other.max_load_factor_)
+		max_load_factor_(other.max_load_factor_),
+		migration_(other.migration_),
+		filter_(std::move(other.filter_))
 	{
 		fix_table_after_move();
 		assert(other.empty());
-		if(other.table_.size() == 0u)
-			other.table_.assign(1u, iterator());
+		other.reinitialize_moved_from_table();
 	}
 
 	/**
@@ -758,7 +1162,9 @@ public:
 
 	/**
 	 * @brief Copy assigns the contents of this AnySet instance from the contents of other.
-	 *        Copies the load factor, the predicate, the hash function, and allocator as well.
+	 *        Copies the load factor, the predicate, and the hash function as well.  The 
+	 *        allocator is copied only if it propagates on copy assignment; otherwise the new
+	 *        elements are allocated with get_allocator().
 	 *        
 	 * @param other - The set whose contents will be copied.
 	 *
@@ -768,27 +1174,49 @@ public:
 	 * @return *this;
 	 */
 	AnySet& operator=(const AnySet& other)
-	{ return *this = std::move(self_type(other)); }
+	{
+		if constexpr(alloc_traits::propagate_on_container_copy_assignment::value)
+			return steal(self_type(other, other.get_allocator()));
+		else
+			return steal(self_type(other, get_allocator()));
+	}
 
 	/**
 	 * @brief Move assigns the contents of this AnySet instance from the contents of other.
-	 *        Moves the load factor, the predicate, the hash function, and allocator as well.
+	 *        Moves the load factor, the predicate, and the hash function as well.  The 
+	 *        allocator is moved only if it propagates on move assignment.  If it doesn't and
+	 *        compares unequal to get_allocator(), the elements of @p other are copied with 
+	 *        get_allocator() instead of being moved, and @p other is cleared.
 	 *        
 	 * @param other - The set whose contents will be moved.
 	 *
+	 * @throws te::NoCopyConstructorError if the elements of @p other must be copied and one of 
+	 *         them is of non-copy-constructible type.  @p other is unmodified in that case.
+	 *
 	 * @return *this;
 	 */
-	AnySet& operator=(AnySet&& other) noexcept(std::is_nothrow_move_assignable_v<vector_type>)
+	AnySet& operator=(AnySet&& other) noexcept(
+		std::is_nothrow_move_assignable_v<table_type>
+		and (
+			alloc_traits::propagate_on_container_move_assignment::value
+			or alloc_traits::is_always_equal::value
+		)
+	)
 	{
-		as_pair() = std::move(other.as_pair());
-		list_ = std::move(other.list_);
-		table_ = std::move(other.table_);
-		max_load_factor_ = std::move(other.max_load_factor_);
-		fix_table_after_move();
-		assert(other.empty());
-		if(other.table_.size() == 0u)
-			other.table_.assign(1u, iterator());
-		return *this;
+		if constexpr(
+			not alloc_traits::propagate_on_container_move_assignment::value
+			and not alloc_traits::is_always_equal::value
+		)
+		{
+			// The nodes of 'other' belong to its allocator, so they can't be taken.
+			if(get_allocator() != other.get_allocator())
+			{
+				self_type tmp(other, get_allocator());
+				other.clear();
+				return steal(std::move(tmp));
+			}
+		}
+		return steal(std::move(other));
 	}
 
 	/**
@@ -899,7 +1327,13 @@ public:
 	void clear() noexcept
 	{
 		list_.clear();
-		std::fill(table_.begin(), table_.end(), iterator());
+		if constexpr(open_addressing)
+			table_.clear();
+		else
+			std::fill(table_.begin(), table_.end(), iterator());
+		// An empty table has nothing left to migrate.
+		migration_ = decltype(migration_){};
+		filter_.clear();
 	}
 	
 	/**
@@ -921,6 +1355,9 @@ public:
 	 *         
 	 *         Emplacement is the only way of inserting objects of non-movable, non-copyable types into
 	 *         an AnySet instance.
+	 *         
+	 *         Emplacing a T from a single Hashed<T> is the same as inserting it: the element is
+	 *         copy-constructed only if it isn't already in the set.
 	 * 
 	 * @note References, pointers, and iterators remain valid after emplacement, however the values 
 	 *       pointed to by iterators may change.
@@ -932,10 +1369,18 @@ public:
 			std::is_same_v<T, std::decay_t<T>>,
 			"Cannot emplace references, arrays, or functions into an AnySet."
 		);
-		auto node(make_any_value<T, HashFn, KeyEqual>(get_hasher(), std::forward<Args>(args)...));
-		auto hash_v = node->hash;
-		KeyInfo<T> ki{unsafe_cast<const T&>(*node), hash_v, bucket_index(hash_v)};
-		return insert_impl<true>(ki.value, ki, std::move(node));
+		if constexpr(sizeof...(Args) == 1u and (std::is_same_v<std::decay_t<Args>, Hashed<T>> and ...))
+		{
+			// The hash is known, so look before allocating.
+			return insert(std::forward<Args>(args)...);
+		}
+		else
+		{
+			auto node(make_node<T>(get_allocator(), get_hasher(), std::forward<Args>(args)...));
+			auto hash_v = node->hash;
+			KeyInfo<T> ki{unsafe_cast<const T&>(*node), hash_v, bucket_index(hash_v)};
+			return insert_impl<true>(ki.value, ki, std::move(node));
+		}
 	}
 	
 	/**
@@ -971,29 +1416,113 @@ public:
 	{ return emplace<T>(std::forward<Args>(args)...); }
 
 	/**
-	 * @brief Inserts an element into the set, if the set doesn't already contain an element 
-	 *        with an equivalent value and type.
+	 * @brief Inserts a new element constructed with the given args if there is no element with
+	 *        the same type and value in the container.  Unlike emplace(), no node is allocated 
+	 *        if the element already exists.
 	 * 
-	 * @param value - element value to insert.
-	 *
-	 * @return Returns a pair consisting of an iterator to the inserted element, or the 
-	 *         already-existing element if no insertion happened, and a bool denoting whether 
-	 *         the insertion took place. true for insertion, false for no insertion.
+	 * The element is first constructed on the stack and looked up.  It is moved into a newly
+	 * allocated node only if it isn't found.
 	 * 
-	 * @note References, pointers, and iterators remain valid after insertion, however the values 
-	 *       pointed to by iterators may change.
-	 */
-	template <class T>
-	std::pair<iterator, bool> insert(T&& value)
-	{
-		return insert_impl<true>(std::forward<T>(value), make_key_info(value));
-	}
-
-	/**
-	 * @brief Inserts an element into the set, if the set doesn't already contain an element 
-	 *        with an equivalent value and type.
+	 * @param args - Arguments to forward to the constructor of the element.
 	 * 
-	 * @param value - element value to insert.
+	 * @tparam T - Type of the element to emplace.  Must be a constructible non-reference type.
+	 * 
+	 * @return Returns a pair consisting of an iterator to the inserted element, or the 
+	 *         already-existing element if no insertion happened, and a bool denoting whether 
+	 *         the insertion took place. true for insertion, false for no insertion.
+	 * 
+	 * @remark If @p T is not move-constructible this is the same as emplace().  If the first 
+	 *         of @p args is a Hashed<T>, this is the same as try_emplace(const Hashed<T>&, Args&&...).
+	 * 
+	 * @note References, pointers, and iterators remain valid after emplacement, however the values 
+	 *       pointed to by iterators may change.
+	 */
+	template <class T, class ... Args>
+	std::pair<iterator, bool> try_emplace(Args&& ... args)
+	{
+		static_assert(
+			std::is_same_v<T, std::decay_t<T>>,
+			"Cannot emplace references, arrays, or functions into an AnySet."
+		);
+		if constexpr(detail::leads_with_hashed_key_v<T, Args...>)
+		{
+			return try_emplace(std::forward<Args>(args)...);
+		}
+		else if constexpr(std::is_move_constructible_v<T>)
+		{
+			T tmp(std::forward<Args>(args)...);
+			return insert(std::move(tmp));
+		}
+		else
+		{
+			return emplace<T>(std::forward<Args>(args)...);
+		}
+	}
+
+	/**
+	 * @brief Inserts a new element constructed with the given args if there is no element with
+	 *        the same type and value as @p key in the container.  Nothing is constructed or 
+	 *        allocated, and nothing is hashed, if the element already exists.
+	 * 
+	 * @param key  - The key to look up, with its hash code.  Use hashed() to get one.
+	 * @param args - Arguments to forward to the constructor of the element.  If empty, the
+	 *               element is copy-constructed from @p key.
+	 * 
+	 * @tparam T - Type of the element to emplace.
+	 * 
+	 * @return Returns a pair consisting of an iterator to the inserted element, or the 
+	 *         already-existing element if no insertion happened, and a bool denoting whether 
+	 *         the insertion took place. true for insertion, false for no insertion.
+	 * 
+	 * @note The element constructed from @p args must compare equal to @p key and have the 
+	 *       same hash code.  The element is not hashed or compared to check this.
+	 * 
+	 * @note References, pointers, and iterators remain valid after emplacement, however the values 
+	 *       pointed to by iterators may change.
+	 */
+	template <class T, class ... Args>
+	std::pair<iterator, bool> try_emplace(const Hashed<T>& key, Args&& ... args)
+	{
+		static_assert(
+			std::is_same_v<T, std::decay_t<T>>,
+			"Cannot emplace references, arrays, or functions into an AnySet."
+		);
+		auto ki = make_key_info(key);
+		auto [pos, found] = find_position(ki);
+		if(found)
+			return std::make_pair(pos.to_non_const(), false);
+		node_handle node;
+		if constexpr(sizeof...(Args) == 0u)
+			node = make_node<T>(get_allocator(), ki.hash, key.value);
+		else
+			node = make_node<T>(get_allocator(), ki.hash, std::forward<Args>(args)...);
+		return std::make_pair(safely_splice_at(pos, ki, std::move(node)), true);
+	}
+
+	/**
+	 * @brief Inserts an element into the set, if the set doesn't already contain an element 
+	 *        with an equivalent value and type.
+	 * 
+	 * @param value - element value to insert.
+	 *
+	 * @return Returns a pair consisting of an iterator to the inserted element, or the 
+	 *         already-existing element if no insertion happened, and a bool denoting whether 
+	 *         the insertion took place. true for insertion, false for no insertion.
+	 * 
+	 * @note References, pointers, and iterators remain valid after insertion, however the values 
+	 *       pointed to by iterators may change.
+	 */
+	template <class T>
+	std::pair<iterator, bool> insert(T&& value)
+	{
+		return insert_impl<true>(std::forward<T>(value));
+	}
+
+	/**
+	 * @brief Inserts an element into the set, if the set doesn't already contain an element 
+	 *        with an equivalent value and type.
+	 * 
+	 * @param value - element value to insert.
 	 * 
 	 * @return Returns a pair consisting of an iterator to the inserted element, or the 
 	 *         already-existing element if no insertion happened, and a bool denoting whether 
@@ -1037,6 +1566,49 @@ public:
 		return range_insert(first, last, iter_cat{});
 	}
 
+	/**
+	 * @brief Inserts elements from the range [first, last) that do not already exist in the set,
+	 *        doing most of the work on the threads of @p policy.  If multiple elements in the range
+	 *        have values that compare equivalent, and there is no such element already in the set,
+	 *        only the first encountered is inserted.
+	 *
+	 * The values are hashed and copied into new nodes in parallel.  For ChainedBuckets and
+	 * IncrementalRehash sets the new nodes and the set's current elements are then grouped by
+	 * bucket in parallel, duplicates are dropped bucket by bucket, and the list and bucket table
+	 * are rebuilt from the groups in one pass; the table grows at most once.  For OpenAddressing
+	 * sets the nodes are linked in one at a time by the calling thread.
+	 *
+	 * The hash function, the equality comparison function, and the allocator must be safe to
+	 * use from several threads at once, and so must dereferencing and copying @p first.
+	 *
+	 * @param policy - Execution policy (see Parallel.h) to run the work with.
+	 * @param first  - Iterator to first element in the range.
+	 * @param last   - Iterator one position past the last element in the range.
+	 *
+	 * @return The number of elements inserted.
+	 *
+	 * @remark Like insert(It, It), this assumes that all elements in the range are new when
+	 *         choosing the new bucket count.
+	 *
+	 * @note References and pointers remain valid after insertion.  Iterators are invalidated.
+	 *
+	 * @note If an exception is thrown, the set is unchanged, except that OpenAddressing sets
+	 *       keep the elements linked in before a comparison threw.
+	 */
+	template <
+		class Policy,
+		class ForwardIt,
+		class = std::enable_if_t<
+			detail::is_execution_policy_v<Policy>
+			and std::is_base_of_v<
+				std::forward_iterator_tag,
+				typename std::iterator_traits<ForwardIt>::iterator_category
+			>
+		>
+	>
+	size_type insert(const Policy& policy, ForwardIt first, ForwardIt last)
+	{ return parallel_range_insert(policy, first, last); }
+
 	/**
 	 * @brief Inserts @p args if they do not already exist in the set.  If multiple values in @p args 
 	 *        have the same type and have values that compare equivalent, and there is no such element 
@@ -1061,6 +1633,7 @@ public:
 		class ... V,
 		class = std::enable_if_t<
 			(not (std::is_same_v<std::decay_t<T>, std::decay_t<U>> and detail::is_iterator_v<std::decay_t<T>>))
+			and (not detail::is_execution_policy_v<T>)
 			and (not std::is_same_v<std::decay_t<T>, const_iterator>)
 			and (not std::is_same_v<std::decay_t<T>, iterator>)
 		>
@@ -1175,13 +1748,15 @@ public:
 	 *       change their allegiance.
 	 */
 	void swap(AnySet& other) 
-		noexcept(std::is_nothrow_swappable_v<vector_type> and std::is_nothrow_swappable_v<pair_type>)
+		noexcept(std::is_nothrow_swappable_v<table_type> and std::is_nothrow_swappable_v<pair_type>)
 	{
 		using std::swap;
 		swap(as_pair(), other.as_pair());
 		swap(list_, other.list_);
 		swap(table_, other.table_);
 		swap(max_load_factor_, other.max_load_factor_);
+		swap(migration_, other.migration_);
+		swap(filter_, other.filter_);
 		this->fix_table_after_move();
 		other.fix_table_after_move();
 	}
@@ -1202,16 +1777,18 @@ public:
 	AnySet& update(const AnySet& other)
 	{
 		preemptive_reserve(other.size());
-		for(const auto& any_v: other)
+		bool found[lookup_batch_size];
+		for(auto pos = other.begin(); pos != other.end();)
 		{
-			auto [pos, found] = find_position(make_key_info(any_v));
-			if(found)
+			// Look up a batch at a time so that the cache misses overlap.  The elements of 
+			// 'other' are distinct, so inserting one cannot change whether another is found.
+			const size_type count = batch_membership(pos, other.end(), found);
+			for(size_type i = 0; i < count; ++i, ++pos)
 			{
-				continue;
-			}
-			else
-			{
-				unsafe_splice_at(pos, any_v.clone());
+				if(found[i])
+					continue;
+				auto ins_pos = find_position(make_key_info(*pos)).first;
+				unsafe_splice_at(ins_pos, clone_node(*pos, get_allocator()));
 			}
 		}
 		assert(load_factor_satisfied());
@@ -1227,7 +1804,10 @@ public:
 	 *
 	 * @note No element copy or move constructors are invoked by this function.
 	 *       Elements are moved by splicing internal node objects from @p other 
-	 *       into @p this.
+	 *       into @p this.  The exception is when the allocators of @p this and @p other
+	 *       compare unequal; the elements are then copied with get_allocator() and erased
+	 *       from @p other, and te::NoCopyConstructorError is thrown for elements of 
+	 *       non-copy-constructible type.
 	 * 
 	 * @note If an exception is thrown while this function is executing, @p this 
 	 *       will be only partially updated and @p other will be missing any elements
@@ -1243,19 +1823,35 @@ public:
 	 */
 	AnySet& update(AnySet&& other)
 	{
+		// The nodes of 'other' can only be taken if they may be freed with our allocator.
+		const bool take_nodes = alloc_traits::is_always_equal::value
+			or get_allocator() == other.get_allocator();
 		preemptive_reserve(other.size());
+		bool found[lookup_batch_size];
 		for(auto pos = other.begin(); pos != other.end(); )
 		{
-			auto [ins_pos, found] = find_position(make_key_info(*pos));
-			if(found)
-			{
-				++pos;
-			}
-			else
+			// Popping an element invalidates the iterator to the one after it, so the batch
+			// is walked by count.
+			const size_type count = batch_membership(pos, other.end(), found);
+			for(size_type i = 0; i < count; ++i)
 			{
-				node_handle node;
-				std::tie(node, pos) = other.pop(pos);
-				unsafe_splice_at(ins_pos, std::move(node));
+				if(found[i])
+				{
+					++pos;
+				}
+				else if(take_nodes)
+				{
+					auto ins_pos = find_position(make_key_info(*pos)).first;
+					node_handle node;
+					std::tie(node, pos) = other.pop(pos);
+					unsafe_splice_at(ins_pos, std::move(node));
+				}
+				else
+				{
+					auto ins_pos = find_position(make_key_info(*pos)).first;
+					unsafe_splice_at(ins_pos, dup(*pos));
+					pos = other.erase(pos);
+				}
 			}
 		}
 		return *this;
@@ -1278,9 +1874,10 @@ public:
 	template <class T>
 	size_type count(const T& value) const
 	{
-		return static_cast<size_type>(
-			find_position(make_key_info(value)).second
-		);
+		auto ki = make_key_info(value);
+		if(not filter_.may_contain(ki.hash))
+			return 0u;
+		return static_cast<size_type>(find_position(ki).second);
 	}
 
 	/**
@@ -1294,7 +1891,10 @@ public:
 	template <class T>
 	const_iterator find(const T& value) const
 	{
-		auto [pos, found] = find_position(make_key_info(value));
+		auto ki = make_key_info(value);
+		if(not filter_.may_contain(ki.hash))
+			return cend();
+		auto [pos, found] = find_position(ki);
 		if(found)
 			return pos;
 		else
@@ -1407,6 +2007,90 @@ public:
 	template <class T>
 	bool contains_eq(const T& value) const
 	{ return find_matching_value(value) != cend(); }
+
+	/**
+	 * @brief Look up every value in the range [@p first, @p last) and write a const_iterator
+	 *        to each one's matching element, or cend() if there is none, to @p out.  
+	 *        
+	 * Equivalent to calling find() on each value in order, but faster for large sets.  Values
+	 * are looked up in batches: the whole batch is hashed first, then the bucket table entries 
+	 * and the first element of each bucket are prefetched, and only then are the values 
+	 * compared.  This overlaps the cache misses of different lookups instead of taking them 
+	 * one after another.
+	 * 
+	 * @tparam ForwardIt - Forward iterator type.  Its value type may be any type that can be 
+	 *                     looked up with find(), including AnyValue (e.g. to look up the elements
+	 *                     of another set) and std::reference_wrapper of either.
+	 * @tparam OutputIt  - Output iterator type that const_iterator is assignable to.
+	 * 
+	 * @param first - Iterator to the first value to look up.
+	 * @param last  - Iterator one past the last value to look up.
+	 * @param out   - Output iterator to write the results to.
+	 * 
+	 * @return Output iterator one past the last result written.
+	 */
+	template <class ForwardIt, class OutputIt>
+	OutputIt find_many(ForwardIt first, ForwardIt last, OutputIt out) const
+	{
+		batch_lookup(first, last, [&](const_iterator pos, bool found) {
+			*out++ = found ? pos : cend();
+		});
+		return out;
+	}
+
+	/**
+	 * @brief Same as find_many(), but writes iterators instead of const_iterators.
+	 */
+	template <class ForwardIt, class OutputIt>
+	OutputIt find_many(ForwardIt first, ForwardIt last, OutputIt out)
+	{
+		batch_lookup(first, last, [&](const_iterator pos, bool found) {
+			*out++ = found ? pos.to_non_const() : end();
+		});
+		return out;
+	}
+
+	/**
+	 * @brief Check whether each value in the range [@p first, @p last) is in the set, and write 
+	 *        the results, as bools, to @p out.
+	 *
+	 * Equivalent to calling contains() on each value in order, but faster for large sets.  
+	 * See find_many() for details.
+	 * 
+	 * @param first - Iterator to the first value to look up.
+	 * @param last  - Iterator one past the last value to look up.
+	 * @param out   - Output iterator to write the results to.
+	 * 
+	 * @return Output iterator one past the last result written.
+	 */
+	template <class ForwardIt, class OutputIt>
+	OutputIt contains_many(ForwardIt first, ForwardIt last, OutputIt out) const
+	{
+		batch_lookup(first, last, [&](const_iterator, bool found) {
+			*out++ = found;
+		});
+		return out;
+	}
+
+	/**
+	 * @brief Check whether each value in the range [@p first, @p first + @p N) is in the set.
+	 * 
+	 * @tparam N - The number of values to look up.
+	 * 
+	 * @param first - Iterator to the first value to look up.
+	 * 
+	 * @return A bitset where the ith bit is set to `true` iff the ith value is in the set.
+	 */
+	template <std::size_t N, class ForwardIt>
+	std::bitset<N> contains_many(ForwardIt first) const
+	{
+		std::bitset<N> bs;
+		std::size_t i = 0;
+		batch_lookup(first, std::next(first, N), [&](const_iterator, bool found) {
+			bs.set(i++, found);
+		});
+		return bs;
+	}
 	
 	/// @} Lookup
 
@@ -1423,7 +2107,16 @@ public:
 	const_local_iterator cbegin(size_type buck) const
 	{
 		assert(buck < bucket_count());
-		return const_local_iterator(table_[buck], buck, table_size());
+		if constexpr(open_addressing)
+		{
+			if(not table_.is_full(buck))
+				return const_local_iterator();
+			return const_local_iterator(const_iterator(table_.slot(buck).pos));
+		}
+		else
+		{
+			return const_local_iterator(table_[buck], buck, local_table_size(buck));
+		}
 	}
 
 	/**
@@ -1458,7 +2151,10 @@ public:
 	const_local_iterator cend(size_type buck) const
 	{
 		assert(buck < bucket_count());
-		return const_local_iterator(const_iterator(), buck, table_size());
+		if constexpr(open_addressing)
+			return const_local_iterator();
+		else
+			return const_local_iterator(const_iterator(), buck, local_table_size(buck));
 	}
 
 	/**
@@ -1527,13 +2223,85 @@ public:
 	 * @param value - Value whose bucket is to be returned.
 	 * 
 	 * @return Index of the bucket in which @p value belongs.
+	 *
+	 * @remark For OpenAddressing sets this is the slot that holds @p value, or the slot
+	 *         that @p value would be inserted into if the set does not contain it.
 	 */
 	template <class T>
 	size_type bucket(const T& value) const
-	{ return bucket_index(get_hasher()(value)); }
+	{
+		if constexpr(open_addressing)
+		{
+			auto ki = make_key_info(value);
+			auto idx = find_slot(ki, get_key_equal());
+			return (idx == table_type::npos) ? table_.insert_position(ki.hash) : idx;
+		}
+		else
+		{
+			return bucket_index(get_hash_value(value));
+		}
+	}
 
 	/// @} Bucket Interface
 
+	/// @name Parallel Traversal
+	/// @{
+
+	/**
+	 * @brief Split the set into @p count non-overlapping ranges of consecutive buckets
+	 *        that together hold every element.
+	 *
+	 * Each partition has about the same number of buckets, so with a reasonable hash
+	 * function each has about the same number of elements.  Computing the partitions
+	 * takes O(@p count) time; nothing is counted.  Different threads may traverse
+	 * different partitions (or the same one) at once, as long as no thread modifies the set.
+	 *
+	 * @param count - Number of partitions to return.  At most bucket_count() partitions
+	 *                are returned, and at least one.
+	 *
+	 * @return The partitions, in bucket order.
+	 *
+	 * @note Partitions and their iterators are invalidated by operations that invalidate
+	 *       local_iterators.
+	 *
+	 * @remark While an IncrementalRehash set is rehashing, the buckets that have not
+	 *         been migrated yet hold the elements of their upper halves too, so partitions
+	 *         of low buckets may hold up to twice as many elements as others.
+	 */
+	std::vector<Partition> partitions(size_type count) const
+	{
+		const size_type buckets = bucket_count();
+		count = std::clamp<size_type>(count, 1u, buckets);
+		auto partition_begin = [&](size_type i) {
+			return (buckets / count) * i + std::min(i, buckets % count);
+		};
+		std::vector<Partition> parts;
+		parts.reserve(count);
+		for(size_type i = 0; i < count; ++i)
+			parts.push_back(Partition(*this, partition_begin(i), partition_begin(i + 1)));
+		return parts;
+	}
+
+	/**
+	 * @brief Call @p func with each element of the set, running the calls on the threads
+	 *        of @p policy.
+	 *
+	 * @param policy - Execution policy (see Parallel.h) to run the traversal with.
+	 * @param func   - Function object to call with a `const value_type&`.  Called
+	 *                 concurrently from several threads.
+	 */
+	template <class Policy, class Func, class = std::enable_if_t<detail::is_execution_policy_v<Policy>>>
+	void for_each(const Policy& policy, Func func) const
+	{
+		const auto parts = partitions(4u * std::max<size_type>(policy.concurrency(), 1u));
+		policy.run(parts.size(), [&](std::size_t i) {
+			for(const auto& value: parts[i])
+				func(value);
+		});
+	}
+
+	/// @} Parallel Traversal
+
 	/// @name Hash Policy
 	/// @{
 
@@ -1576,13 +2344,17 @@ public:
 	 * @param nbuckets - The new number of buckets in the container after rehashing.
 	 *
 	 * @remark The current implementation uses only powers-of-two for the bucket count.
+	 * @remark For IncrementalRehash sets, this finishes any migration in progress, even if the
+	 *         bucket count does not change.
 	 */
 	void rehash(size_type nbuckets)
 	{
+		if constexpr(incremental_rehash)
+			finish_rehash();
 		size_type bcount = bucket_count();
 		assert(bcount > 0u);
 		auto load_factor_good = [&]() {
-			return (static_cast<double>(size()) / bcount) <= max_load_factor_;
+			return (static_cast<double>(size()) / bcount) <= effective_max_load_factor();
 		};
 		if(nbuckets < bcount)
 		{
@@ -1605,6 +2377,8 @@ public:
 		}
 		while(not load_factor_good())
 			bcount *= 2;
+		if constexpr(open_addressing)
+			bcount = std::max(bcount, min_slot_count);
 		if(bcount > bucket_count())
 			grow_table(bcount);
 		else if(bcount < bucket_count())
@@ -1624,11 +2398,60 @@ public:
 	 */
 	void reserve(size_type count)
 	{
-		rehash(static_cast<size_type>(std::ceil(count / max_load_factor())));
+		rehash(static_cast<size_type>(std::ceil(count / effective_max_load_factor())));
 	}
 
 	/// @} Hash Policy
 
+	/// @name Lookup Filter
+	/// @{
+
+	/**
+	 * @brief Give the set a blocked Bloom filter over the hash codes of its elements, or rebuild
+	 *        its filter with new @p options.
+	 *
+	 * Lookups of values that aren't in the set (find(), count(), contains(), contains_value(),
+	 * find_many(), contains_many() and so on) are then usually answered by reading one cache line 
+	 * of the filter, without touching the bucket table or the elements.  Lookups of values that 
+	 * are in the set pay for the extra check, so the filter only helps when most lookups miss.
+	 *
+	 * The filter is kept up to date as elements are inserted and grows with the set.  Erased 
+	 * elements stay in the filter until it is rebuilt, which happens on insertion once the filter 
+	 * is full or once erased elements outnumber the rest.  Copies of the set get a copy of the 
+	 * filter.
+	 *
+	 * @param options - The false-positive rate and memory bound of the filter.
+	 *
+	 * @note If growing the filter during an insertion fails to allocate, the filter is disabled
+	 *       rather than failing the insertion.
+	 */
+	void enable_lookup_filter(const LookupFilterOptions& options = LookupFilterOptions())
+	{
+		filter_type filter = make_lookup_filter(options, size());
+		using std::swap;
+		swap(filter_, filter);
+	}
+
+	/**
+	 * @brief Remove the set's lookup filter, if it has one, and free its memory.
+	 */
+	void disable_lookup_filter() noexcept
+	{ filter_.disable(); }
+
+	/**
+	 * @brief Check whether the set has a lookup filter.
+	 */
+	bool has_lookup_filter() const noexcept
+	{ return filter_.enabled(); }
+
+	/**
+	 * @brief Get the memory use, capacity and expected false-positive rate of the set's lookup filter.
+	 */
+	LookupFilterStats lookup_filter_stats() const noexcept
+	{ return filter_.stats(); }
+
+	/// @} Lookup Filter
+
 	/// @name Observers
 	/// @{
 
@@ -1648,6 +2471,38 @@ public:
 	key_equal key_eq() const
 	{ return get_key_equal(); }
 
+	/**
+	 * @brief Get the order-independent digest of the hash codes of the set's elements.
+	 *
+	 * The digest is kept up to date as elements are added and removed, so this is O(1).  Sets
+	 * that compare equal have equal digests; operator==() uses this to reject most unequal
+	 * sets of the same size without looking at their elements, and te::Hash<AnySet> hashes 
+	 * sets with it.
+	 *
+	 * @return The set's ContentDigest.
+	 */
+	const ContentDigest& content_digest() const noexcept
+	{ return list_.digest(); }
+
+	/**
+	 * @brief Hash @p key with this set's hash function and pair it with the result.
+	 * 
+	 * The returned Hashed<T> can be passed to the lookup, insertion, and erasure member 
+	 * functions of any AnySet whose hash function computes the same hash codes, and is not 
+	 * hashed again.
+	 * 
+	 * @param key - The key to hash.  Must outlive the returned object.
+	 * 
+	 * @return A Hashed<T> referring to @p key.  If @p key is an AnyValue, its stored hash 
+	 *         code is used.
+	 */
+	template <class T>
+	Hashed<T> hashed(const T& key) const
+	{ return Hashed<T>(key, get_hash_value(key)); }
+
+	template <class T>
+	Hashed<T> hashed(const T&& key) const = delete;
+
 	/**
 	 * @brief Get a copy of the allocator.
 	 * 
@@ -1687,6 +2542,8 @@ public:
 	{
 		if(left.size() != right.size())
 			return false;
+		if(left.content_digest() != right.content_digest())
+			return false;
 		// iterate over the set with the smaller table.
 		const auto& iter_set = (left.table_size() > right.table_size()) ? right : left;
 		// search through the set with the larger table
@@ -1745,70 +2602,79 @@ public:
 		assert(not pos_.is_end());
 		assert(not pos_.is_null());
 
+		filter_.note_removal();
 		iterator pos = pos_.to_non_const();
-		size_type buck_idx = iter_bucket_index(pos);
-		iterator bucket_head = table_[buck_idx];
-
-		assert(not bucket_head.is_null());
-		assert(not bucket_head.is_end());
-
-		if(bucket_head == pos)
+		if constexpr(open_addressing)
 		{
-			// 'pos' is the first item in its bucket.
+			table_.erase(table_.find_node(std::addressof(*pos)));
 			auto [node, next] = std::move(list_.pop(pos));
 			if(next.is_end())
-			{
-				// 'pos' was the last item in 'list_'.  The bucket is now empty.
-				table_[buck_idx] = iterator();
 				return std::make_pair(std::move(node), end());
-			}
-
-			if(size_type next_idx = iter_bucket_index(next); next_idx != buck_idx)
-			{
-				// The const_iterator after 'bucket_head' is in a different bucket.
-				// 'pos' was the last item in its bucket and the bucket is now empty.
-				// Since we just invalidated all iterators to the element following
-				// 'pos', we need to fix iterator in the bucket whose first element
-				// was pointed to by next(pos).
-				table_[buck_idx] = iterator();
-				// Fix the iterator we invalidated.
-				table_[next_idx] = next;
-			}
-			else
-			{
-				// 'pos' was *not* the last element in its bucket.  The iterator
-				// stored in the bucket should automagically point to the next
-				// item.  Nothing to fix.
-				assert(table_[buck_idx] == next);
-			}
-			return std::make_pair(std::move(node), next); 
+			// The element after 'pos' has a new predecessor; update its slot.
+			table_.slot(table_.find_node(std::addressof(*next))).pos = next;
+			return std::make_pair(std::move(node), next);
 		}
 		else
 		{
-			// 'pos' is *not* the first item in its bucket.
-			auto [node, next] = std::move(list_.pop(pos));
-			if(next.is_end())
-			{
-				// 'pos' was the last item in the whole list.  Nothing to fix.
-				return std::make_pair(std::move(node), end());
-			}
+			size_type buck_idx = iter_bucket_index(pos);
+			iterator bucket_head = table_[buck_idx];
 
-			if(size_type next_idx = iter_bucket_index(next); next_idx != buck_idx)
+			assert(not bucket_head.is_null());
+			assert(not bucket_head.is_end());
+
+			if(bucket_head == pos)
 			{
-				// 'pos' was the last item in its bucket.  
-				// Since we just invalidated all iterators to the element following
-				// 'pos', we need to fix iterator in the bucket whose first element
-				// was pointed to by next(pos).
-				table_[next_idx] = next;
+				// 'pos' is the first item in its bucket.
+				auto [node, next] = std::move(list_.pop(pos));
+				if(next.is_end())
+				{
+					// 'pos' was the last item in 'list_'.  The bucket is now empty.
+					table_[buck_idx] = iterator();
+					return std::make_pair(std::move(node), end());
+				}
+
+				if(size_type next_idx = iter_bucket_index(next); next_idx != buck_idx)
+				{
+					// The const_iterator after 'bucket_head' is in a different bucket.
+					// 'pos' was the last item in its bucket and the bucket is now empty.
+					// Since we just invalidated all iterators to the element following
+					// 'pos', we need to fix iterator in the bucket whose first element
+					// was pointed to by next(pos).
+					table_[buck_idx] = iterator();
+					// Fix the iterator we invalidated.
+					table_[next_idx] = next;
+				}
+				else
+				{
+					// 'pos' was *not* the last element in its bucket.  The iterator
+					// stored in the bucket should automagically point to the next
+					// item.  Nothing to fix.
+					assert(table_[buck_idx] == next);
+				}
+				return std::make_pair(std::move(node), next); 
 			}
 			else
 			{
-				// 'pos' was *not* the last element in its bucket.  The iterator
-				// stored in the bucket should automagically point to the next
-				// item.  Nothing to fix.
-				assert(table_[buck_idx] == next);
+				// 'pos' is *not* the first item in its bucket.
+				auto [node, next] = std::move(list_.pop(pos));
+				if(next.is_end())
+				{
+					// 'pos' was the last item in the whole list.  Nothing to fix.
+					return std::make_pair(std::move(node), end());
+				}
+
+				if(size_type next_idx = iter_bucket_index(next); next_idx != buck_idx)
+				{
+					// 'pos' was the last item in its bucket.  
+					// Since we just invalidated all iterators to the element following
+					// 'pos', we need to fix iterator in the bucket whose first element
+					// was pointed to by next(pos).
+					table_[next_idx] = next;
+				}
+				// Otherwise 'pos' was *not* the last element in its bucket, and it wasn't the
+				// first either.  The bucket's head is untouched.  Nothing to fix.
+				return std::make_pair(std::move(node), next); 
 			}
-			return std::make_pair(std::move(node), next); 
 		}
 	}
 
@@ -1824,7 +2690,34 @@ public:
 	 *       CopyConstructible, this function throws a te::NoCopyConstructorError.
 	 */
 	node_handle dup(const_iterator pos) const
-	{ return pos->clone(); }
+	{ return clone_node(*pos, get_allocator()); }
+
+	/**
+	 * @brief Copy and return the element at the position pointed to by the local iterator @p pos.
+	 *
+	 * @param pos - Local iterator to the element to copy.
+	 *
+	 * @return A node_handle that points to the copied element.
+	 *
+	 * @note If the value at @p pos is an instance of a type that does not satisfy
+	 *       CopyConstructible, this function throws a te::NoCopyConstructorError.
+	 */
+	node_handle dup(const_local_iterator pos) const
+	{ return clone_node(*pos, get_allocator()); }
+
+	/**
+	 * @brief Copy @p value, which may belong to any set with the same value_type, into a node
+	 *        allocated with this set's allocator.
+	 *
+	 * @param value - The element to copy.
+	 *
+	 * @return A node_handle that points to the copied element.
+	 *
+	 * @note If @p value is an instance of a type that does not satisfy CopyConstructible,
+	 *       this function throws a te::NoCopyConstructorError.
+	 */
+	node_handle dup(const value_type& value) const
+	{ return clone_node(value, get_allocator()); }
 
 	/**
 	 * @brief Insert the value pointed to by @p node to @p this.
@@ -1998,7 +2891,7 @@ public:
 		{
 			assert(load_factor_satisfied());
 			return tuple_t(
-				safely_splice_at(ins_pos, ki, other.dup(pos)), 
+				safely_splice_at(ins_pos, ki, dup(*pos)), 
 				std::next(pos).to_non_const(), 
 				true
 			);
@@ -2009,21 +2902,107 @@ public:
 
 private:
 
-	void fix_table_after_move()
+	static constexpr const size_type min_slot_count = open_table_type::group_width;
+	// Number of buckets that each insertion migrates during an incremental rehash.  Each 
+	// rehash doubles the table, so this finishes well before the next one is needed.
+	static constexpr const size_type rehash_batch_size = 4;
+	// Number of lookups that find_many() and contains_many() overlap.
+	static constexpr const size_type lookup_batch_size = 16;
+
+	static table_type make_table(size_type bucket_count, const allocator_type& alloc)
 	{
-		if(size() > 0u)
-			table_[iter_bucket_index(begin())] = begin();
+		if constexpr(open_addressing)
+			return make_table_of_size(std::max(next_highest_pow2(bucket_count), min_slot_count), alloc);
+		else
+			return make_table_of_size(next_highest_pow2(bucket_count), alloc);
 	}
 
-	float load_factor(size_type extra) const noexcept
-	{ return static_cast<double>(size() + extra) / table_size(); }
-	
-	bool load_factor_satisfied(size_type extra = 0) const
-	{ return load_factor(extra) <= max_load_factor(); }
-
-	iterator safely_splice_at(const_iterator pos, node_handle&& node)
+	static table_type make_table_of_size(size_type table_size, const allocator_type& alloc)
 	{
-		return safely_splice_at(pos, make_key_info(*node), std::move(node));
+		assert((table_size & (table_size - 1)) == 0u);
+		if constexpr(open_addressing)
+			return table_type(table_size, alloc);
+		else
+			return table_type(table_size, iterator(), alloc);
+	}
+
+	/**
+	 * @brief Fill in the (empty) table for a list that was just copied, in list order, from a set 
+	 *        with the same table size.  
+	 *
+	 * The copied nodes keep their hashes, so the copy's buckets are exactly the source's buckets:
+	 * each bucket starts wherever the bucket index changes from one node to the next.  No hashing,
+	 * bucket searches, or comparisons required.
+	 */
+	void index_copied_list() noexcept
+	{
+		if constexpr(open_addressing)
+		{
+			for(auto pos = begin(); pos != end(); ++pos)
+				table_.insert(pos->hash, std::addressof(*pos), pos);
+		}
+		else
+		{
+			size_type prev_idx = table_size();
+			for(auto pos = begin(); pos != end(); ++pos)
+			{
+				if(size_type idx = iter_bucket_index(pos); idx != prev_idx)
+				{
+					assert(table_[idx].is_null());
+					table_[idx] = pos;
+					prev_idx = idx;
+				}
+			}
+		}
+	}
+
+	void reinitialize_moved_from_table()
+	{
+		if constexpr(open_addressing)
+		{
+			if(table_.capacity() == 0u)
+				table_.reset(min_slot_count);
+		}
+		else
+		{
+			if(table_.size() == 0u)
+				table_.assign(1u, iterator());
+		}
+		migration_ = decltype(migration_){};
+	}
+
+	void fix_table_after_move()
+	{
+		if(size() == 0u)
+			return;
+		if constexpr(open_addressing)
+			table_.slot(table_.find_node(std::addressof(*begin()))).pos = begin();
+		else
+			table_[iter_bucket_index(begin())] = begin();
+	}
+
+	float load_factor(size_type extra) const noexcept
+	{
+		// Deleted slots lengthen probe sequences just like full ones do.
+		if constexpr(open_addressing)
+			extra += table_.tombstones();
+		return static_cast<double>(size() + extra) / table_size(); 
+	}
+	
+	bool load_factor_satisfied(size_type extra = 0) const
+	{ return load_factor(extra) <= effective_max_load_factor(); }
+
+	float effective_max_load_factor() const noexcept
+	{
+		if constexpr(open_addressing)
+			return std::min(max_load_factor_, open_table_type::max_load);
+		else
+			return max_load_factor_;
+	}
+
+	iterator safely_splice_at(const_iterator pos, node_handle&& node)
+	{
+		return safely_splice_at(pos, make_key_info(*node), std::move(node));
 	}
 
 	template <class Value>
@@ -2056,34 +3035,163 @@ private:
 				}
 			} guard{*this, pos, false};
 
-			// Before we grow the table, save the address of the inserted node, we'll need it
-			// to find the node again after rehashing.
-			const value_type* addr_save = std::addressof(*ins_pos);
+			if constexpr(open_addressing)
+			{
+				// Rebuilding the index leaves the list alone, so 'ins_pos' is still good.
+				// Only grow if the table is actually full of live elements, otherwise
+				// just clear out the deleted slots.
+				if(4.0 * load_factor() <= 3.0 * effective_max_load_factor())
+					rebuild_table(table_size());
+				else
+					rebuild_table(2 * table_size());
+				guard.good = true;
+				return ins_pos;
+			}
+			else
+			{
+				// Before we grow the table, save the address of the inserted node, we'll need it
+				// to find the node again after rehashing.
+				const value_type* addr_save = std::addressof(*ins_pos);
+
+				if constexpr(incremental_rehash)
+					start_rehash(2 * table_size());
+				else
+					grow_table(2 * table_size());
 
-			grow_table(2 * table_size());
+				// No exceptions thrown.
+				guard.good = true;
 
-			// No exceptions thrown.
-			guard.good = true;
+				if constexpr(incremental_rehash)
+					rehash_step();
 
-			// the key landed somewhere else now, go find it to give the caller their iterator.
-			auto buck_idx = bucket_index(ki.hash);
-			auto buck_pos = table_[buck_idx];
-			assert(not buck_pos.is_null());
-			assert(not buck_pos.is_end());
-			while(std::addressof(*buck_pos) != addr_save)
-			{
-				++buck_pos;
-				assert(iter_bucket_index(buck_pos) == buck_idx);
+				// the key landed somewhere else now, go find it to give the caller their iterator.
+				return locate_node(addr_save, ki.hash);
 			}
-			return buck_pos.to_non_const();
 		}
 		else
 		{
+			if constexpr(incremental_rehash)
+			{
+				if(rehashing())
+				{
+					const value_type* addr_save = std::addressof(*ins_pos);
+					rehash_step();
+					return locate_node(addr_save, ki.hash);
+				}
+			}
 			// No rehash, just return ins_pos.
 			return ins_pos;
 		}
 	}
 
+	// Find the position of the element at 'addr', whose hash is 'hash', after rehashing moved it.
+	iterator locate_node(const value_type* addr, std::size_t hash)
+	{
+		static_assert(not open_addressing);
+		auto buck_idx = bucket_index(hash);
+		auto buck_pos = table_[buck_idx];
+		assert(not buck_pos.is_null());
+		assert(not buck_pos.is_end());
+		while(std::addressof(*buck_pos) != addr)
+		{
+			++buck_pos;
+			assert(iter_bucket_index(buck_pos) == buck_idx);
+		}
+		return buck_pos.to_non_const();
+	}
+
+	/**
+	 * @brief Check whether an incremental rehash is in progress.
+	 */
+	bool rehashing() const noexcept
+	{
+		if constexpr(incremental_rehash)
+			return migration_.old_bucket_count != 0u;
+		else
+			return false;
+	}
+
+	/**
+	 * @brief Begin an incremental rehash into a table of @p new_size buckets (twice the current 
+	 *        size).  Finishes any rehash that is already in progress.
+	 */
+	void start_rehash(size_type new_size)
+	{
+		static_assert(incremental_rehash);
+		assert(new_size == 2 * table_size());
+		// Allocate first, so that nothing has changed if this throws.
+		table_.reserve(new_size);
+		finish_rehash();
+		migration_.old_bucket_count = table_size();
+		migration_.migrated = 0u;
+		// Doesn't allocate.  The unmigrated buckets stay where they are, in the lower half.
+		table_.resize(new_size, iterator());
+	}
+
+	/**
+	 * @brief Migrate the next few unmigrated buckets, if an incremental rehash is in progress.
+	 */
+	void rehash_step() noexcept
+	{
+		for(size_type i = 0; i < rehash_batch_size and rehashing(); ++i)
+			migrate_bucket();
+	}
+
+	/**
+	 * @brief Migrate every remaining bucket, if an incremental rehash is in progress.
+	 */
+	void finish_rehash() noexcept
+	{
+		while(rehashing())
+			migrate_bucket();
+	}
+
+	/**
+	 * @brief Split the next unmigrated bucket into its lower and upper halves in the new table.
+	 * 
+	 * The bucket's elements are contiguous and sorted by hash.  Elements that belong in the upper
+	 * bucket are moved, in order, to just after the elements that stay, so both halves end up
+	 * contiguous and sorted without comparing anything but bucket indices.
+	 */
+	void migrate_bucket() noexcept
+	{
+		static_assert(incremental_rehash);
+		assert(rehashing());
+		size_type lower_idx = migration_.migrated++;
+		size_type upper_idx = lower_idx + migration_.old_bucket_count;
+		assert(table_[upper_idx].is_null());
+		if(const iterator start = table_[lower_idx]; not start.is_null())
+		{
+			list_type upper;
+			iterator pos = start;
+			while(not pos.is_end())
+			{
+				size_type idx = iter_bucket_index(pos);
+				if(idx == upper_idx)
+					upper.push_back(std::move(list_.pop(pos).first));
+				else if(idx == lower_idx)
+					++pos;
+				else
+					break;
+			}
+			// 'pos' is now the end of the lower bucket.
+			if(size_type count = upper.size(); count > 0u)
+			{
+				if(pos == start)
+					// Everything moved to the upper bucket.
+					table_[lower_idx] = iterator();
+				iterator first = list_.splice(pos, std::move(upper));
+				table_[upper_idx] = first;
+				// The bucket after the upper bucket has a new predecessor.
+				auto after = std::next(first, count);
+				if(not after.is_end())
+					table_[iter_bucket_index(after)] = after;
+			}
+		}
+		if(migration_.migrated == migration_.old_bucket_count)
+			migration_ = MigrationState{};
+	}
+
 	template <class Value>
 	iterator initialize_bucket(const KeyInfo<Value>& ki, node_handle&& node)
 	{
@@ -2091,6 +3199,41 @@ private:
 		return table_[ki.bucket] = list_.push_back(std::move(node));
 	}
 
+	// Make a lookup filter with room for twice 'expected' elements that holds the set's elements.
+	filter_type make_lookup_filter(const LookupFilterOptions& options, size_type expected) const
+	{
+		filter_type filter(options, 2u * expected, get_allocator());
+		for(const auto& v: list_)
+			filter.insert(v.hash);
+		return filter;
+	}
+
+	// The filter only speeds up lookups, so if rebuilding it fails, disable it instead of
+	// failing the insertion that needed the rebuild.
+	void rebuild_lookup_filter(size_type expected) noexcept
+	{
+		try
+		{
+			filter_type filter = make_lookup_filter(filter_.options(), expected);
+			using std::swap;
+			swap(filter_, filter);
+		}
+		catch(...)
+		{
+			filter_.disable();
+		}
+	}
+
+	void remember_in_lookup_filter(std::size_t hash) noexcept
+	{
+		if(not filter_.enabled())
+			return;
+		if(filter_.needs_rebuild())
+			rebuild_lookup_filter(size() + 1u);
+		if(filter_.enabled())
+			filter_.insert(hash);
+	}
+
 	iterator unsafe_splice_at(const_iterator pos, node_handle&& node)
 	{
 		return unsafe_splice_at(pos, make_key_info(*node), std::move(node));
@@ -2099,23 +3242,36 @@ private:
 	template <class Value>
 	iterator unsafe_splice_at(const_iterator pos, const KeyInfo<Value>& ki, node_handle&& node)
 	{
-		if(pos.is_null())
-			return initialize_bucket(ki, std::move(node));
-		else if(pos.is_end())
-			return list_.splice(pos, std::move(node));
-
-		size_type buck_idx = iter_bucket_index(pos);
-		iterator ins_pos = list_.splice(pos, std::move(node));
-		if(buck_idx != ki.bucket)
+		remember_in_lookup_filter(ki.hash);
+		if constexpr(open_addressing)
+		{
+			iterator ins_pos = list_.splice(pos, std::move(node));
+			table_.insert(ki.hash, std::addressof(*ins_pos), ins_pos);
+			// The element after the new node has a new predecessor; update its slot.
+			if(auto next_pos = std::next(ins_pos); not next_pos.is_end())
+				table_.slot(table_.find_node(std::addressof(*next_pos))).pos = next_pos;
+			return ins_pos;
+		}
+		else
 		{
-			// The iterator that we just inserted changed the value of an iterator 
-			// in another bucket.  The iterator whose value changed should now point 
-			// to the 'next' of the node we just inserted.  Make it so.
-			auto next_pos = std::next(ins_pos);
-			assert(iter_bucket_index(next_pos) == buck_idx);
-			table_[buck_idx] = next_pos;
+			if(pos.is_null())
+				return initialize_bucket(ki, std::move(node));
+			else if(pos.is_end())
+				return list_.splice(pos, std::move(node));
+
+			size_type buck_idx = iter_bucket_index(pos);
+			iterator ins_pos = list_.splice(pos, std::move(node));
+			if(buck_idx != ki.bucket)
+			{
+				// The iterator that we just inserted changed the value of an iterator 
+				// in another bucket.  The iterator whose value changed should now point 
+				// to the 'next' of the node we just inserted.  Make it so.
+				auto next_pos = std::next(ins_pos);
+				assert(iter_bucket_index(next_pos) == buck_idx);
+				table_[buck_idx] = next_pos;
+			}
+			return ins_pos;
 		}
-		return ins_pos;
 	}
 
 	template <class Value>
@@ -2129,7 +3285,7 @@ private:
 	template <class Value>
 	std::size_t get_hash_value(const Value& value) const
 	{
-		if constexpr(std::is_same_v<Value, value_type>)
+		if constexpr(std::is_same_v<Value, value_type> or detail::is_hashed_v<Value>)
 			return value.hash;
 		else
 			return get_hasher()(value);
@@ -2154,20 +3310,155 @@ private:
 	}
 
 	template <class Value>
-	const_iterator find_matching_value(const Value& value) const
+	KeyInfo<Value> make_key_info(const Hashed<Value>& key) const
 	{
-		auto ki = make_key_info(value);
-		auto [pos, last] = get_bucket_start(ki);
-		if(pos.is_null() or (not last.is_null()))
-			return cend();
+		return make_key_info(key.value, key.hash);
+	}
 
-		while((not pos.is_end()) and (pos->hash == ki.hash))
+	template <class T>
+	static const T& unwrap_key(const T& value)
+	{ return value; }
+
+	template <class T>
+	static const T& unwrap_key(std::reference_wrapper<T> value)
+	{ return value.get(); }
+
+	template <class T>
+	static const T& unwrap_key(const Hashed<T>& key)
+	{ return key.value; }
+
+	/**
+	 * @brief Look up the values in [@p first, @p last) in batches, calling @p visit with the
+	 *        result of find_position() for each one, in order.  Values that the lookup filter 
+	 *        rules out are visited with (cend(), false).
+	 */
+	template <class ForwardIt, class Visit>
+	void batch_lookup(ForwardIt first, ForwardIt last, Visit visit) const
+	{
+		static_assert(
+			std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<ForwardIt>::iterator_category>,
+			"Batched lookups require forward iterators."
+		);
+		using key_type = std::decay_t<decltype(unwrap_key(*first))>;
+		const key_type* keys[lookup_batch_size];
+		std::size_t hashes[lookup_batch_size];
+		size_type buckets[lookup_batch_size];
+		bool maybe[lookup_batch_size];
+		while(first != last)
 		{
-			if(*pos == value)
-				return const_iterator(pos);
-			++pos;
+			// Stage 1: hash the batch, check the lookup filter, and prefetch the bucket table 
+			// entries of the values that might be in the set.
+			size_type count = 0;
+			for(; count < lookup_batch_size and first != last; ++count, ++first)
+			{
+				const auto& key = *first;
+				keys[count] = std::addressof(unwrap_key(key));
+				if constexpr(detail::is_hashed_v<std::decay_t<decltype(key)>>)
+					hashes[count] = key.hash;
+				else
+					hashes[count] = get_hash_value(*keys[count]);
+				buckets[count] = 0u;
+				maybe[count] = filter_.may_contain(hashes[count]);
+				if(not maybe[count])
+					continue;
+				if constexpr(open_addressing)
+					table_.prefetch_group(hashes[count]);
+				else
+				{
+					buckets[count] = bucket_index(hashes[count]);
+					detail::prefetch(std::addressof(table_[buckets[count]]));
+				}
+			}
+			if constexpr(open_addressing)
+			{
+				// Stage 2: prefetch the first candidate node in each home group.
+				for(size_type i = 0; i < count; ++i)
+				{
+					if(maybe[i])
+						table_.prefetch_node(hashes[i]);
+				}
+			}
+			else
+			{
+				// Stage 2: prefetch the pointers to the first node of each bucket, which live 
+				// in the node before the bucket.
+				for(size_type i = 0; i < count; ++i)
+				{
+					if(not maybe[i])
+						continue;
+					if(auto head = table_[buckets[i]]; not head.is_null())
+						detail::prefetch(head.pos_);
+				}
+				// Stage 3: prefetch the first node of each bucket.
+				for(size_type i = 0; i < count; ++i)
+				{
+					if(not maybe[i])
+						continue;
+					if(auto head = table_[buckets[i]]; not head.is_null())
+						detail::prefetch(*head.pos_);
+				}
+			}
+			// Stage 4: compare.
+			for(size_type i = 0; i < count; ++i)
+			{
+				if(not maybe[i])
+				{
+					visit(cend(), false);
+					continue;
+				}
+				auto [pos, found] = find_position(KeyInfo<key_type>{*keys[i], hashes[i], buckets[i]});
+				visit(pos, found);
+			}
+		}
+	}
+
+	/**
+	 * Look up at most lookup_batch_size elements of another set, starting at @p first, with 
+	 * batch_lookup() and store whether each one is in the set in @p found.  Returns the number
+	 * of elements looked up.
+	 */
+	template <class InputIt>
+	size_type batch_membership(InputIt first, InputIt last, bool (&found)[lookup_batch_size]) const
+	{
+		auto stop = first;
+		size_type count = 0;
+		for(; count < lookup_batch_size and stop != last; ++count)
+			++stop;
+		size_type i = 0;
+		batch_lookup(first, stop, [&](const_iterator, bool in_set) { found[i++] = in_set; });
+		return count;
+	}
+
+	template <class Value>
+	const_iterator find_matching_value(const Value& key) const
+	{
+		auto ki = make_key_info(key);
+		const auto& value = ki.value;
+		if(not filter_.may_contain(ki.hash))
+			return cend();
+		if constexpr(open_addressing)
+		{
+			auto idx = table_.find(ki.hash, [&](const auto& slot) {
+				return (slot.node->hash == ki.hash) and (*slot.node == value);
+			});
+			if(idx == table_type::npos)
+				return cend();
+			return const_iterator(table_.slot(idx).pos);
+		}
+		else
+		{
+			auto [pos, last] = get_bucket_start(ki);
+			if(pos.is_null() or (not last.is_null()))
+				return cend();
+
+			while((not pos.is_end()) and (pos->hash == ki.hash))
+			{
+				if(*pos == value)
+					return const_iterator(pos);
+				++pos;
+			}
+			return cend();
 		}
-		return cend();
 	}
 
 	template <class ... T>
@@ -2204,6 +3495,226 @@ private:
 		return count;
 	}
 
+	template <class Policy, class ForwardIt>
+	size_type parallel_range_insert(const Policy& policy, ForwardIt first, ForwardIt last)
+	{
+		using value_t = typename std::iterator_traits<ForwardIt>::value_type;
+		const std::size_t count = static_cast<std::size_t>(std::distance(first, last));
+		if(count == 0u)
+			return 0u;
+		const std::size_t task_count = 4u * std::max<std::size_t>(policy.concurrency(), 1u);
+		auto chunk_begin = [task_count](std::size_t size, std::size_t chunk) {
+			return (size / task_count) * chunk + std::min(chunk, size % task_count);
+		};
+
+		// Hash the values and make their nodes.
+		std::vector<node_handle> nodes(count);
+		{
+			std::vector<ForwardIt> starts;
+			starts.reserve(task_count);
+			for(std::size_t c = 0, idx = 0; c < task_count; ++c)
+			{
+				std::advance(first, chunk_begin(count, c) - idx);
+				idx = chunk_begin(count, c);
+				starts.push_back(first);
+			}
+			policy.run(task_count, [&](std::size_t c) {
+				const allocator_type alloc = get_allocator();
+				auto pos = starts[c];
+				for(std::size_t i = chunk_begin(count, c), stop = chunk_begin(count, c + 1); i < stop; ++i, ++pos)
+				{
+					auto&& value = *pos;
+					std::size_t hash_v = get_hasher()(value);
+					nodes[i] = make_node<value_t>(alloc, hash_v, std::forward<decltype(value)>(value));
+				}
+			});
+		}
+
+		if constexpr(open_addressing)
+		{
+			preemptive_reserve(count);
+			size_type inserted = 0;
+			for(auto& node: nodes)
+			{
+				auto ki = make_key_info(*node);
+				if(auto [pos, found] = find_position(ki); not found)
+				{
+					unsafe_splice_at(pos, ki, std::move(node));
+					++inserted;
+				}
+			}
+			return inserted;
+		}
+		else
+		{
+			if constexpr(incremental_rehash)
+				finish_rehash();
+			// Grow the same way that range insertion does, but build the new table on the side.
+			size_type new_size = table_size();
+			while(static_cast<double>(size() + count) / new_size > effective_max_load_factor())
+				new_size *= 2;
+			table_type table = make_table_of_size(new_size, get_allocator());
+			const size_type mask = new_size - 1u;
+
+			// Index the current elements first so that they win over equal new ones.
+			const std::size_t old_count = size();
+			std::vector<value_type*> old_nodes;
+			old_nodes.reserve(old_count);
+			for(auto& v: *this)
+				old_nodes.push_back(std::addressof(v));
+			const std::size_t total = old_count + count;
+			auto node_at = [&](std::size_t i) {
+				return (i < old_count) ? old_nodes[i] : nodes[i - old_count].get();
+			};
+
+			// Group the nodes into ranges of consecutive buckets (a stable counting sort).
+			struct Entry
+			{
+				size_type bucket;
+				std::size_t hash;
+				std::size_t index;
+			};
+			const size_type range_count = std::min<size_type>(new_size, next_highest_pow2(task_count));
+			const size_type range_width = new_size / range_count;
+			std::vector<Entry> entries(total);
+			std::vector<Entry> grouped(total);
+			std::vector<std::size_t> offsets(task_count * range_count, 0u);
+			policy.run(task_count, [&](std::size_t c) {
+				std::size_t* counts = offsets.data() + c * range_count;
+				for(std::size_t i = chunk_begin(total, c), stop = chunk_begin(total, c + 1); i < stop; ++i)
+				{
+					std::size_t hash_v = node_at(i)->hash;
+					entries[i] = Entry{hash_mixer{}(hash_v) & mask, hash_v, i};
+					++counts[entries[i].bucket / range_width];
+				}
+			});
+			std::vector<std::size_t> range_begin(range_count + 1u);
+			for(std::size_t r = 0, sum = 0; r <= range_count; ++r)
+			{
+				range_begin[r] = sum;
+				for(std::size_t c = 0; r < range_count and c < task_count; ++c)
+					sum += std::exchange(offsets[c * range_count + r], sum);
+			}
+			policy.run(task_count, [&](std::size_t c) {
+				std::size_t* next = offsets.data() + c * range_count;
+				for(std::size_t i = chunk_begin(total, c), stop = chunk_begin(total, c + 1); i < stop; ++i)
+					grouped[next[entries[i].bucket / range_width]++] = entries[i];
+			});
+			// Reuse the first buffer for the sorted ranges.
+			std::vector<Entry>& sorted = entries;
+
+			// Sort each range by bucket, then hash, then position in the input, drop the
+			// duplicates, and link what's left.  This writes the 'next' pointers of the current
+			// elements, so put them back in their original order if anything throws.
+			std::vector<std::pair<value_type*, value_type*>> range_ends(range_count);
+			std::vector<std::vector<node_handle>> dropped(range_count);
+			try
+			{
+				policy.run(range_count, [&](std::size_t r) {
+					auto range_first = sorted.begin() + range_begin[r];
+					auto range_last = sorted.begin() + range_begin[r + 1u];
+					{
+						// Counting sort by bucket, which keeps the input order within each bucket, ...
+						const size_type first_bucket = r * range_width;
+						std::vector<std::size_t> bucket_begin(range_width + 1u, 0u);
+						for(auto pos = grouped.begin() + range_begin[r]; pos != grouped.begin() + range_begin[r + 1u]; ++pos)
+							++bucket_begin[pos->bucket - first_bucket + 1u];
+						std::partial_sum(bucket_begin.begin(), bucket_begin.end(), bucket_begin.begin());
+						for(auto pos = grouped.begin() + range_begin[r]; pos != grouped.begin() + range_begin[r + 1u]; ++pos)
+							range_first[bucket_begin[pos->bucket - first_bucket]++] = *pos;
+						// ... then a stable insertion sort by hash within each (small) bucket.
+						for(auto pos = range_first; pos != range_last; ++pos)
+						{
+							Entry e = *pos;
+							auto hole = pos;
+							for(; hole != range_first and std::prev(hole)->bucket == e.bucket and std::prev(hole)->hash > e.hash; --hole)
+								*hole = *std::prev(hole);
+							*hole = e;
+						}
+					}
+					auto out = range_first;
+					for(auto pos = range_first; pos != range_last; ++pos)
+					{
+						const value_type& node = *node_at(pos->index);
+						bool duplicate = false;
+						// Any equal element kept so far has the same bucket and hash, so it's at the end.
+						for(auto prev = out; prev != range_first;)
+						{
+							--prev;
+							if(prev->bucket != pos->bucket or prev->hash != pos->hash)
+								break;
+							if(compare(*node_at(prev->index), node, get_key_equal()))
+							{
+								duplicate = true;
+								break;
+							}
+						}
+						if(not duplicate)
+						{
+							*out++ = *pos;
+						}
+						else
+						{
+							assert(pos->index >= old_count);
+							dropped[r].push_back(std::move(nodes[pos->index - old_count]));
+						}
+					}
+					if(out == range_first)
+						return;
+					value_type* prev = node_at(range_first->index);
+					for(auto pos = std::next(range_first); pos != out; ++pos)
+					{
+						value_type* node = node_at(pos->index);
+						prev->next = node;
+						if(pos->bucket != std::prev(pos)->bucket)
+							table[pos->bucket].pos_ = std::addressof(prev->next);
+						prev = node;
+					}
+					prev->next = nullptr;
+					range_ends[r] = std::make_pair(node_at(range_first->index), prev);
+				});
+			}
+			catch(...)
+			{
+				for(std::size_t i = 0; i < old_count; ++i)
+					old_nodes[i]->next = (i + 1u < old_count) ? old_nodes[i + 1u] : nullptr;
+				throw;
+			}
+
+			// Nothing below throws.  Chain the ranges together and take ownership of the new nodes.
+			value_type* head = nullptr;
+			value_type** tail = std::addressof(head);
+			size_type new_count = 0;
+			for(std::size_t r = 0; r < range_count; ++r)
+			{
+				auto [range_head, range_tail] = range_ends[r];
+				if(not range_head)
+					continue;
+				*tail = range_head;
+				table[hash_mixer{}(range_head->hash) & mask].pos_ = tail;
+				tail = std::addressof(range_tail->next);
+				new_count += (range_begin[r + 1u] - range_begin[r]) - dropped[r].size();
+			}
+			// The dropped nodes were moved out of 'nodes'; the rest are now in the list.
+			ContentDigest digest = list_.digest();
+			for(auto& node: nodes)
+			{
+				if(node)
+					digest.add(node.release()->hash);
+			}
+			list_.release_nodes();
+			list_.adopt_nodes(head, tail, new_count, digest);
+			table_.swap(table);
+			if(not empty())
+				table_[iter_bucket_index(begin())] = begin();
+			// The new nodes went straight into the list, so rebuild the filter to cover them.
+			if(filter_.enabled())
+				rebuild_lookup_filter(size());
+			assert(load_factor() <= max_load_factor());
+			return new_count - old_count;
+		}
+	}
+
 	void preemptive_reserve(std::size_t ins_count)
 	{
 		auto new_count = size() + ins_count;
@@ -2212,18 +3723,34 @@ private:
 		auto compute_new_load_factor = [&](){
 			return (static_cast<double>(new_count) / new_table_size);
 		};
-		while(compute_new_load_factor() > max_load_factor())
+		while(compute_new_load_factor() > effective_max_load_factor())
 			new_table_size *= 2;
 		if(new_table_size > table_size())
 			grow_table(new_table_size);
+		else if constexpr(open_addressing)
+		{
+			// Callers insert without checking the load factor after this, so make 
+			// sure deleted slots won't eat up the free slots that we need.
+			if(not load_factor_satisfied(ins_count))
+				rebuild_table(table_size());
+		}
 	}
 
 	template <bool CheckLoadFactor, class T>
 	std::pair<iterator, bool> insert_impl(T&& value)
 	{
-		return insert_impl<CheckLoadFactor>(
-			std::forward<T>(value), make_key_info(value), nullptr
-		);
+		if constexpr(detail::is_hashed_v<std::decay_t<T>>)
+		{
+			return insert_impl<CheckLoadFactor>(
+				value.value, make_key_info(value), nullptr
+			);
+		}
+		else
+		{
+			return insert_impl<CheckLoadFactor>(
+				std::forward<T>(value), make_key_info(value), nullptr
+			);
+		}
 	}
 	
 	template <bool CheckLoadFactor, class T>
@@ -2244,8 +3771,8 @@ private:
 			{
 				if(not existing)
 				{
-					existing = make_any_value<std::decay_t<T>, HashFn, KeyEqual>(
-						ki.hash, std::forward<T>(value)
+					existing = make_node<std::decay_t<T>>(
+						get_allocator(), ki.hash, std::forward<T>(value)
 					);
 				}
 			}
@@ -2268,24 +3795,23 @@ private:
 		return std::make_pair(ins_pos, not found);
 	}
 
-	void shrink_table(size_type new_size) noexcept
+	void shrink_table(size_type new_size) noexcept(not open_addressing)
 	{
 		assert(new_size < table_size());
 		// new size must always be a power of two
 		assert((new_size & (new_size - 1)) == 0u);
-
-		table_.assign(new_size, iterator());
-
-		list_type tmp = std::move(list_);
-		assert(size() == 0u);
-		node_handle node{nullptr};
-		while(not tmp.empty())
+		if constexpr(open_addressing)
+		{
+			rebuild_table(new_size);
+		}
+		else
 		{
-			node = std::move(tmp.pop(tmp.begin()).first);
-			node = std::move(push(std::move(node)).second);
-			assert(not static_cast<bool>(node));
+			if constexpr(incremental_rehash)
+				finish_rehash();
+			// Doesn't allocate; the table only gets smaller.
+			table_.assign(new_size, iterator());
+			relink_buckets();
 		}
-		assert(tmp.empty());
 	}
 
 	void grow_table(size_type new_size)
@@ -2293,17 +3819,91 @@ private:
 		assert(new_size > table_size());
 		// new size must always be a power of two
 		assert((new_size & (new_size - 1)) == 0u);
-		table_.assign(new_size, iterator());
-		list_type tmp = std::move(list_);
-		assert(size() == 0u);
-		node_handle node{nullptr};
-		while(not tmp.empty())
+		if constexpr(open_addressing)
+		{
+			rebuild_table(new_size);
+		}
+		else
+		{
+			if constexpr(incremental_rehash)
+			{
+				// Allocate first, so that nothing has changed if this throws.
+				table_.reserve(new_size);
+				finish_rehash();
+			}
+			table_.assign(new_size, iterator());
+			relink_buckets();
+		}
+	}
+
+	/**
+	 * @brief Regroup the list into the buckets of a freshly-assigned (all null) table in a single
+	 *        pass, without searching for keys or calling the comparator.
+	 * 
+	 * Nodes are taken off the old list in order and appended to the new one.  A node whose bucket
+	 * is already started goes right after the last node in that bucket with a hash no greater than 
+	 * its own.  When growing, each old bucket splits into runs that are already sorted, so this 
+	 * is always the end of a bucket that was started a few nodes ago.
+	 */
+	void relink_buckets() noexcept
+	{
+		static_assert(not open_addressing);
+		assert(std::all_of(table_.begin(), table_.end(), [](auto pos) { return pos.is_null(); }));
+		size_type count = size();
+		ContentDigest digest = list_.digest();
+		value_type* node = list_.release_nodes();
+		value_type* head = nullptr;
+		value_type** tail = std::addressof(head);
+		while(node)
 		{
-			node = std::move(tmp.pop(tmp.begin()).first);
-			node = std::move(push(std::move(node)).second);
-			assert(not static_cast<bool>(node));
+			value_type* next = node->next;
+			size_type buck_idx = bucket_index(node->hash);
+			value_type**& first = table_[buck_idx].pos_;
+			if(not first)
+			{
+				// Start a new bucket at the end of the list.
+				node->next = nullptr;
+				*tail = node;
+				first = tail;
+				tail = std::addressof(node->next);
+			}
+			else
+			{
+				value_type** pos = first;
+				while(*pos and (*pos)->hash <= node->hash and bucket_index((*pos)->hash) == buck_idx)
+					pos = std::addressof((*pos)->next);
+				node->next = *pos;
+				*pos = node;
+				if(not node->next)
+					tail = std::addressof(node->next);
+				else if(size_type next_idx = bucket_index(node->next->hash); next_idx != buck_idx)
+					// 'node' is now the predecessor of the first node in the next bucket.
+					table_[next_idx].pos_ = std::addressof(node->next);
+			}
+			node = next;
 		}
-		assert(tmp.empty());
+		list_.adopt_nodes(head, tail, count, digest);
+		if(not empty())
+			table_[iter_bucket_index(begin())] = begin();
+	}
+
+	// Reindex every element into a fresh table of 'new_size' slots.  Unlike grow_table() 
+	// and shrink_table() for chained sets, this doesn't touch the list at all.  
+	void rebuild_table(size_type new_size)
+	{
+		static_assert(open_addressing);
+		table_.reset(new_size);
+		for(auto pos = begin(); pos != end(); ++pos)
+			table_.insert(pos->hash, std::addressof(*pos), pos);
+	}
+
+	template <class Value, class Comp>
+	size_type find_slot(const KeyInfo<Value>& ki, Comp comp) const
+	{
+		static_assert(open_addressing);
+		return table_.find(ki.hash, [&](const auto& slot) {
+			return (slot.node->hash == ki.hash) and compare(ki.value, *slot.node, comp);
+		});
 	}
 
 	/**
@@ -2327,11 +3927,18 @@ private:
 	 *         and the value 'true'.  Otherwise returns an iterator to the position
 	 *         that a value matching @p ki could be inserted at and the value 'false'.
 	 *         If the bucket that @p ki belongs in is empty, returns a 'null' iterator.
+	 *         For OpenAddressing sets, new elements are always inserted at the end.
 	 */
 	template <class Value, class Comp>
 	std::pair<const_iterator, bool> find_position(const KeyInfo<Value>& ki, Comp comp) const
 	{
-		if(auto [pos, last] = get_bucket_start(ki); pos.is_null() and last.is_null())
+		if constexpr(open_addressing)
+		{
+			if(auto idx = find_slot(ki, comp); idx != table_type::npos)
+				return std::make_pair(const_iterator(table_.slot(idx).pos), true);
+			return std::make_pair(cend(), false);
+		}
+		else if(auto [pos, last] = get_bucket_start(ki); pos.is_null() and last.is_null())
 		{
 			// Bucket is empty, return null iterator.
 			return std::make_pair(const_iterator(), false);
@@ -2393,13 +4000,41 @@ private:
 	}
 
 	size_type table_size() const
-	{ return table_.size(); }
+	{
+		if constexpr(open_addressing)
+			return table_.capacity();
+		else
+			return table_.size();
+	}
 
 	size_type get_mask() const
 	{ return table_size() - 1; }
 
 	size_type bucket_index(std::size_t hash) const
-	{ return hash & get_mask(); }
+	{
+		std::size_t mixed = hash_mixer{}(hash);
+		if constexpr(incremental_rehash)
+		{
+			// Buckets that haven't been migrated yet still use the old table's mask.
+			if(rehashing())
+			{
+				if(size_type old_idx = mixed & (migration_.old_bucket_count - 1); old_idx >= migration_.migrated)
+					return old_idx;
+			}
+		}
+		return mixed & get_mask();
+	}
+
+	// The table size that the elements of bucket 'buck' are currently distributed by.
+	size_type local_table_size(size_type buck) const
+	{
+		if constexpr(incremental_rehash)
+		{
+			if(rehashing() and buck < migration_.old_bucket_count and buck >= migration_.migrated)
+				return migration_.old_bucket_count;
+		}
+		return table_size();
+	}
 
 	bool equal_values(const value_type& left, const value_type& right) const
 	{ return left.compare_to(right, get_key_equal()); }
@@ -2441,9 +4076,20 @@ private:
 	const KeyEqual&& get_key_equal() const &&
 	{ return std::move(std::move(as_pair()).second()); }
 
+	// Progress of an incremental rehash.  Buckets [0, migrated) of the old table have been
+	// split into the new one; the rest are still stored in the lower half of 'table_'.
+	struct MigrationState
+	{
+		size_type old_bucket_count{0};
+		size_type migrated{0};
+	};
+	struct NoMigrationState {};
+
 	list_type list_;
-	vector_type table_;
+	table_type table_;
 	float max_load_factor_{1.0};
+	std::conditional_t<incremental_rehash, MigrationState, NoMigrationState> migration_;
+	filter_type filter_;
 };
 
 /**
@@ -2453,6 +4099,7 @@ private:
  * @tparam HashFn    - The type of the function object for the AnySet instance created. (optional)
  * @tparam KeyEqual  - The type of the function object for the AnySet instance created. (optional)
  * @tparam Allocator - The type of the allocator for the AnySet instance created. (optional)
+ * @tparam TablePolicy - The bucket table policy for the AnySet instance created. (optional)
  * 
  * @param elements - Parameter pack of values to initialize the set's contents with.
  *
@@ -2464,15 +4111,51 @@ template <
 	class HashFn = te::AnyHash,
 	class KeyEqual = std::equal_to<>,
 	class Allocator = std::allocator<te::AnyValue<HashFn, KeyEqual>>,
+	class TablePolicy = te::ChainedBuckets,
 	class ... Elements
 >
-te::AnySet<HashFn, KeyEqual, Allocator> make_anyset(Elements&& ... elements)
+te::AnySet<HashFn, KeyEqual, Allocator, TablePolicy> make_anyset(Elements&& ... elements)
 {
-	return te::AnySet<HashFn, KeyEqual, Allocator>(
+	return te::AnySet<HashFn, KeyEqual, Allocator, TablePolicy>(
 		std::forward_as_tuple(std::forward<Elements>(elements)...)
 	);
 }
 
+/**
+ * @brief Specialize te::Hash for AnySet, so that sets can be elements of other sets.  O(1);
+ *        uses AnySet::content_digest().
+ *
+ * @relates AnySet
+ */
+template <class HashFn, class KeyEqual, class Allocator, class TablePolicy>
+struct Hash<AnySet<HashFn, KeyEqual, Allocator, TablePolicy>>
+{
+	std::size_t operator()(const AnySet<HashFn, KeyEqual, Allocator, TablePolicy>& set) const noexcept
+	{ return set.content_digest().value(); }
+};
+
+#if __has_include(<memory_resource>)
+namespace pmr {
+
+/**
+ * @brief AnySet whose bucket table and nodes are allocated from a std::pmr::memory_resource.
+ * 
+ * @relates te::AnySet
+ */
+template <
+	class HashFn = te::AnyHash,
+	class KeyEqual = std::equal_to<>,
+	class TablePolicy = te::ChainedBuckets
+>
+using AnySet = te::AnySet<
+	HashFn, 
+	KeyEqual, 
+	std::pmr::polymorphic_allocator<te::AnyValue<HashFn, KeyEqual>>, 
+	TablePolicy
+>;
+
+} /* namespace pmr */
+#endif 
 
 } /* namespace te */	
 
@@ -0,0 +1,904 @@
+#ifndef CONCURRENT_ANY_SET_H
+#define CONCURRENT_ANY_SET_H
+
+#ifdef _MSC_VER
+# include <iso646.h>
+# include <intrin.h>
+#endif
+
+#include "AnySet.h"
+#include <atomic>
+#include <climits>
+
+/// @internal
+namespace te::detail {
+
+/// Index of the highest set bit in @p value.  @p value must be nonzero.
+inline unsigned highest_set_bit(std::size_t value) noexcept
+{
+	assert(value != 0u);
+#if defined(__GNUC__) || defined(__clang__)
+	if constexpr(sizeof(std::size_t) == sizeof(unsigned long long))
+		return static_cast<unsigned>(sizeof(unsigned long long) * CHAR_BIT - 1u - __builtin_clzll(value));
+	else
+		return static_cast<unsigned>(sizeof(unsigned long) * CHAR_BIT - 1u - __builtin_clzl(value));
+#elif defined(_MSC_VER) && defined(_WIN64)
+	unsigned long idx = 0;
+	_BitScanReverse64(&idx, value);
+	return static_cast<unsigned>(idx);
+#else
+	unsigned idx = 0;
+	while(value >>= 1)
+		++idx;
+	return idx;
+#endif
+}
+
+/// Reverse the order of the bits in @p value.
+inline std::size_t reverse_bits(std::size_t value) noexcept
+{
+	static_assert(sizeof(std::size_t) == 8u or sizeof(std::size_t) == 4u);
+	if constexpr(sizeof(std::size_t) == 8u)
+	{
+		std::uint64_t v = value;
+		v = ((v >> 1) & 0x5555555555555555ull) | ((v & 0x5555555555555555ull) << 1);
+		v = ((v >> 2) & 0x3333333333333333ull) | ((v & 0x3333333333333333ull) << 2);
+		v = ((v >> 4) & 0x0f0f0f0f0f0f0f0full) | ((v & 0x0f0f0f0f0f0f0f0full) << 4);
+		v = ((v >> 8) & 0x00ff00ff00ff00ffull) | ((v & 0x00ff00ff00ff00ffull) << 8);
+		v = ((v >> 16) & 0x0000ffff0000ffffull) | ((v & 0x0000ffff0000ffffull) << 16);
+		v = (v >> 32) | (v << 32);
+		return static_cast<std::size_t>(v);
+	}
+	else
+	{
+		std::uint32_t v = static_cast<std::uint32_t>(value);
+		v = ((v >> 1) & 0x55555555u) | ((v & 0x55555555u) << 1);
+		v = ((v >> 2) & 0x33333333u) | ((v & 0x33333333u) << 2);
+		v = ((v >> 4) & 0x0f0f0f0fu) | ((v & 0x0f0f0f0fu) << 4);
+		v = ((v >> 8) & 0x00ff00ffu) | ((v & 0x00ff00ffu) << 8);
+		v = (v >> 16) | (v << 16);
+		return static_cast<std::size_t>(v);
+	}
+}
+
+} /* namespace te::detail */
+/// @endinternal
+
+namespace te {
+
+/**
+ * @brief A type-erased hash set that supports lock-free insertion and lookup from any number of
+ *        threads at once.
+ *
+ * ConcurrentAnySet is a split-ordered list (Shalev and Shavit, "Split-Ordered Lists: Lock-Free
+ * Extensible Hash Tables").  Like AnySet, all elements live in a single linked list.  The list
+ * is sorted by the bit-reversed (mixed) hash codes of its elements, so that every bucket, at
+ * every bucket count, is a contiguous run of the list.  Each bucket begins with a dummy node
+ * that the bucket table points to.  Buckets are initialized lazily, the first time they are
+ * used, by splicing their dummy node into the run of their parent bucket.
+ *
+ * Elements are linked in with a single compare-and-swap.  Growing the table is a single
+ * compare-and-swap of the bucket count; nothing is rehashed or moved, and the bucket table is
+ * made of segments that are allocated as needed and never reallocated.  No operation takes a
+ * lock, and readers never wait for writers.
+ *
+ * The following member functions may be called concurrently with each other from any number of
+ * threads: insert(), emplace(), try_emplace(), find(), count(), contains(), size(), empty(),
+ * load_factor(), bucket_count(), reserve(), max_load_factor(), and iteration.  clear(), swap(),
+ * and destruction require exclusive access.
+ *
+ * Elements can not be erased, and they never move, so iterators and references to elements
+ * stay valid until the set is cleared or destroyed.  Iterating while other threads insert is
+ * safe; an iteration sees every element that was inserted before it began and may or may not
+ * see elements inserted while it runs.
+ *
+ * @tparam HashFn    - The type of the function object to use when computing the hash codes of elements.
+ * @tparam KeyEqual  - The type of the function object to use when comparing elements for equality.
+ * @tparam Allocator - The type of the allocator to use when allocating elements, list nodes, and the
+ *                     bucket table.
+ *
+ * @remark size() is kept in a number of separate counters, chosen by hash code, so that inserting
+ *         threads don't all write to the same cache line.  size() and load_factor() add them up,
+ *         and are exact only when no insertions are in progress.
+ *
+ * @see AnySet - The single-threaded container with the same element type.
+ */
+template <
+	class HashFn = AnyHash,
+	class KeyEqual = std::equal_to<>,
+	class Allocator = std::allocator<AnyValue<HashFn, KeyEqual>>
+>
+struct ConcurrentAnySet:
+	private CompressedPair<HashFn, KeyEqual>
+{
+private:
+	using self_type = ConcurrentAnySet<HashFn, KeyEqual, Allocator>;
+	using pair_type = CompressedPair<HashFn, KeyEqual>;
+	using hash_mixer = detail::BucketHashMixer<HashFn>;
+
+public:
+	/// AnyValue.
+	using value_type = AnyValue<HashFn, KeyEqual>;
+	/// Size type.
+	using size_type = std::size_t;
+	/// Difference type.
+	using difference_type = std::ptrdiff_t;
+	/// Key equality comparator type.
+	using key_equal = KeyEqual;
+	/// %Hash function type.
+	using hasher = HashFn;
+	/// Allocator type.
+	using allocator_type = Allocator;
+	/// AnyValue.  Here for consistency with std::unordered_set.
+	using key_type = value_type;
+	/// Reference to const AnyValue.
+	using const_reference = const value_type&;
+	/// Reference to const AnyValue.  Elements of a ConcurrentAnySet are never modifiable.
+	using reference = const_reference;
+	/// Pointer to const AnyValue.
+	using const_pointer = const value_type*;
+	/// Pointer to const AnyValue.  Elements of a ConcurrentAnySet are never modifiable.
+	using pointer = const_pointer;
+	/// Type of the nodes that hold elements.  See AnySet::node_handle.
+	using node_handle = std::unique_ptr<value_type>;
+
+private:
+	struct ListNode
+	{
+		ListNode(std::size_t key, value_type* val) noexcept:
+			next(nullptr), order_key(key), value(val)
+		{
+
+		}
+
+		std::atomic<ListNode*> next;
+		// Bit-reversed mixed hash.  Odd for elements, even for bucket dummies.
+		const std::size_t order_key;
+		// Null for bucket dummies.
+		value_type* const value;
+	};
+
+	using bucket_type = std::atomic<ListNode*>;
+	using node_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<ListNode>;
+	using segment_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<bucket_type>;
+
+public:
+	/**
+	 * @brief Forward iterator over the elements of a ConcurrentAnySet.  Skips over the
+	 *        dummy nodes that begin each bucket.
+	 */
+	struct const_iterator
+	{
+		using value_type        = typename ConcurrentAnySet::value_type;
+		using reference         = typename ConcurrentAnySet::const_reference;
+		using pointer           = typename ConcurrentAnySet::const_pointer;
+		using difference_type   = typename ConcurrentAnySet::difference_type;
+		using iterator_category = std::forward_iterator_tag;
+
+		const_iterator() = default;
+
+		reference operator*() const
+		{
+			assert(node_);
+			return *node_->value;
+		}
+
+		pointer operator->() const
+		{ return std::addressof(**this); }
+
+		const_iterator& operator++()
+		{
+			node_ = skip_dummies(node_->next.load(std::memory_order_acquire));
+			return *this;
+		}
+
+		const_iterator operator++(int)
+		{
+			auto cpy = *this;
+			++*this;
+			return cpy;
+		}
+
+		friend bool operator==(const const_iterator& left, const const_iterator& right)
+		{ return left.node_ == right.node_; }
+
+		friend bool operator!=(const const_iterator& left, const const_iterator& right)
+		{ return left.node_ != right.node_; }
+
+	private:
+		explicit const_iterator(const ListNode* node):
+			node_(node)
+		{
+
+		}
+
+		static const ListNode* skip_dummies(const ListNode* node)
+		{
+			while(node and not node->value)
+				node = node->next.load(std::memory_order_acquire);
+			return node;
+		}
+
+		const ListNode* node_ = nullptr;
+		friend struct ConcurrentAnySet;
+	};
+
+	/// Same as const_iterator.  Elements of a ConcurrentAnySet are never modifiable.
+	using iterator = const_iterator;
+
+	/// @name Constructors
+	/// @{
+
+	/**
+	 * @brief Constructs an empty set with 2 buckets.
+	 */
+	ConcurrentAnySet(): ConcurrentAnySet(size_type(0)) { }
+
+	/**
+	 * @brief Construct an empty ConcurrentAnySet instance.
+	 * @param bucket_count - Minimum number of buckets to initialize the set with.
+	 * @param hash         - %Hash function to initialize the set with.
+	 * @param equal        - Equality comparison function to initialize the set with.
+	 * @param alloc        - Allocator to initialize the set with.
+	 */
+	explicit ConcurrentAnySet(
+		size_type bucket_count,
+		const HashFn& hash = HashFn(),
+		const KeyEqual& equal = KeyEqual(),
+		const Allocator& alloc = Allocator()
+	):
+		pair_type(hash, equal),
+		alloc_(alloc)
+	{
+		initialize(bucket_count);
+	}
+
+	/**
+	 * @brief Construct an empty ConcurrentAnySet instance with 2 buckets.
+	 * @param alloc - Allocator to initialize the set with.
+	 */
+	explicit ConcurrentAnySet(const Allocator& alloc):
+		ConcurrentAnySet(size_type(0), HashFn(), KeyEqual(), alloc)
+	{
+
+	}
+
+	/**
+	 * @brief Construct a ConcurrentAnySet instance from an initializer list.
+	 * @param ilist        - Values to insert.
+	 * @param bucket_count - Minimum number of buckets to initialize the set with.
+	 * @param hash         - %Hash function to initialize the set with.
+	 * @param equal        - Equality comparison function to initialize the set with.
+	 * @param alloc        - Allocator to initialize the set with.
+	 */
+	template <class T>
+	ConcurrentAnySet(
+		std::initializer_list<T> ilist,
+		size_type bucket_count = 0,
+		const HashFn& hash = HashFn(),
+		const KeyEqual& equal = KeyEqual(),
+		const Allocator& alloc = Allocator()
+	):
+		ConcurrentAnySet(bucket_count, hash, equal, alloc)
+	{
+		for(const auto& v: ilist)
+			insert(v);
+	}
+
+	ConcurrentAnySet(const ConcurrentAnySet&) = delete;
+	ConcurrentAnySet& operator=(const ConcurrentAnySet&) = delete;
+
+	/// @} Constructors
+
+	~ConcurrentAnySet()
+	{ destroy(); }
+
+	/// @name Iterators
+	/// @{
+
+	/// Get an iterator to the first element of the set.
+	const_iterator begin() const
+	{ return const_iterator(const_iterator::skip_dummies(head())); }
+
+	/// Get an iterator to the first element of the set.
+	const_iterator cbegin() const
+	{ return begin(); }
+
+	/// Get the past-the-end iterator of the set.
+	const_iterator end() const
+	{ return const_iterator(); }
+
+	/// Get the past-the-end iterator of the set.
+	const_iterator cend() const
+	{ return end(); }
+
+	/// @} Iterators
+
+	/// @name Capacity
+	/// @{
+
+	/// Check if the set has no elements.
+	bool empty() const noexcept
+	{ return size() == 0u; }
+
+	/**
+	 * @brief Get the number of elements in the set.  Exact only when no insertions are in progress.
+	 */
+	size_type size() const noexcept
+	{
+		size_type total = 0;
+		for(const auto& c: counters_)
+			total += c.value.load(std::memory_order_relaxed);
+		return total;
+	}
+
+	/// @} Capacity
+
+	/// @name Modifiers
+	/// @{
+
+	/**
+	 * @brief Inserts an element into the set, if the set doesn't already contain an element
+	 *        with an equivalent value and type.  Lock-free.
+	 *
+	 * @param value - Element value to insert, or a Hashed<T> referring to it.
+	 *
+	 * @return Returns a pair consisting of an iterator to the inserted element, or the
+	 *         already-existing element if no insertion happened, and a bool denoting whether
+	 *         the insertion took place.
+	 */
+	template <class T>
+	std::pair<const_iterator, bool> insert(T&& value)
+	{
+		if constexpr(detail::is_hashed_v<std::decay_t<T>>)
+		{
+			using key_type = std::decay_t<decltype(value.value)>;
+			return insert_impl(value.value, value.hash, [&](std::size_t h) {
+				return make_node<key_type>(h, value.value);
+			});
+		}
+		else
+		{
+			std::size_t hash_v = get_hasher()(value);
+			return insert_impl(value, hash_v, [&](std::size_t h) {
+				return make_node<std::decay_t<T>>(h, std::forward<T>(value));
+			});
+		}
+	}
+
+	/**
+	 * @brief Inserts a new element into the container constructed in-place with the given args
+	 *        if there is no element with the same type and value in the container.  Lock-free.
+	 *
+	 * Like AnySet::emplace(), this constructs the node before looking for an existing element,
+	 * and destroys it again if one is found.  try_emplace() avoids that.
+	 *
+	 * @param args - Arguments to forward to the constructor of the element.
+	 *
+	 * @tparam T - Type of the element to emplace.  Must be a constructible non-reference type.
+	 *
+	 * @return Returns a pair consisting of an iterator to the inserted element, or the
+	 *         already-existing element if no insertion happened, and a bool denoting whether
+	 *         the insertion took place.
+	 */
+	template <class T, class ... Args>
+	std::pair<const_iterator, bool> emplace(Args&& ... args)
+	{
+		static_assert(
+			std::is_same_v<T, std::decay_t<T>>,
+			"Cannot emplace references, arrays, or functions into a ConcurrentAnySet."
+		);
+		auto node = make_node<T>(get_hasher(), std::forward<Args>(args)...);
+		const auto& value = unsafe_cast<const T&>(*node);
+		return insert_impl(value, node->hash, [&](std::size_t) { return std::move(node); });
+	}
+
+	/**
+	 * @brief Inserts a new element constructed with the given args if there is no element with
+	 *        the same type and value in the container.  Lock-free.  See AnySet::try_emplace().
+	 *
+	 * @param args - Arguments to forward to the constructor of the element.
+	 *
+	 * @tparam T - Type of the element to emplace.  Must be a move-constructible non-reference type.
+	 *
+	 * @return Returns a pair consisting of an iterator to the inserted element, or the
+	 *         already-existing element if no insertion happened, and a bool denoting whether
+	 *         the insertion took place.
+	 */
+	template <class T, class ... Args>
+	std::pair<const_iterator, bool> try_emplace(Args&& ... args)
+	{
+		static_assert(
+			std::is_same_v<T, std::decay_t<T>>,
+			"Cannot emplace references, arrays, or functions into a ConcurrentAnySet."
+		);
+		T tmp(std::forward<Args>(args)...);
+		return insert(std::move(tmp));
+	}
+
+	/**
+	 * @brief Remove all elements from the set.  Not thread-safe.
+	 *
+	 * @note Invalidates all iterators and references.
+	 */
+	void clear() noexcept
+	{
+		destroy();
+		initialize(0u);
+	}
+
+	/**
+	 * @brief Exchanges the contents, hash functions, and comparison functions of the two sets.
+	 *        Not thread-safe.
+	 *
+	 * @note Iterators and references remain valid.
+	 */
+	void swap(ConcurrentAnySet& other) noexcept
+	{
+		using std::swap;
+		swap(as_pair(), other.as_pair());
+		if constexpr(std::allocator_traits<Allocator>::propagate_on_container_swap::value)
+			swap(alloc_, other.alloc_);
+		else
+			assert(alloc_ == other.alloc_);
+		for(std::size_t i = 0; i < segment_count; ++i)
+			swap_atomics(segments_[i], other.segments_[i]);
+		swap_atomics(bucket_count_, other.bucket_count_);
+		swap_atomics(max_load_factor_, other.max_load_factor_);
+		for(std::size_t i = 0; i < counter_count; ++i)
+			swap_atomics(counters_[i].value, other.counters_[i].value);
+	}
+
+	/// @} Modifiers
+
+	/// @name Lookup
+	/// @{
+
+	/**
+	 * @brief Obtain an iterator to the element that has the same type as, and compares equal
+	 *        to @p value.  Lock-free.
+	 *
+	 * Lookups don't write to the set.  If the value's bucket hasn't been initialized yet, the 
+	 * search starts from the nearest ancestor bucket that has been, instead of initializing it.
+	 *
+	 * @param value - The value to find, or a Hashed<T> referring to it.
+	 *
+	 * @return Iterator to the element found, or end() if no such element exists.
+	 */
+	template <class T>
+	const_iterator find(const T& value) const
+	{
+		if constexpr(detail::is_hashed_v<T>)
+			return const_iterator(find_node(value.value, value.hash));
+		else
+			return const_iterator(find_node(value, get_hasher()(value)));
+	}
+
+	/**
+	 * @brief Returns the number of elements with a value that have the same type as,
+	 *        and compare equal to the @p value, which is either 1 or 0.
+	 */
+	template <class T>
+	size_type count(const T& value) const
+	{ return static_cast<size_type>(find(value) != end()); }
+
+	/**
+	 * @brief Check if @p this contains @p value.
+	 */
+	template <class T>
+	bool contains(const T& value) const
+	{ return find(value) != end(); }
+
+	/**
+	 * @brief Hash @p key with this set's hash function and pair it with the result.  See AnySet::hashed().
+	 */
+	template <class T>
+	Hashed<T> hashed(const T& key) const
+	{
+		if constexpr(std::is_same_v<T, value_type>)
+			return Hashed<T>(key, key.hash);
+		else
+			return Hashed<T>(key, get_hasher()(key));
+	}
+
+	template <class T>
+	Hashed<T> hashed(const T&& key) const = delete;
+
+	/// @} Lookup
+
+	/// @name Hash Policy
+	/// @{
+
+	/**
+	 * @brief Get the number of buckets in the set.  Buckets are only initialized when they
+	 *        are first used.
+	 */
+	size_type bucket_count() const noexcept
+	{ return bucket_count_.load(std::memory_order_acquire); }
+
+	/// Get the largest possible number of buckets.
+	size_type max_bucket_count() const noexcept
+	{ return max_bucket_count_; }
+
+	/// Get the average number of elements per bucket.
+	float load_factor() const noexcept
+	{ return static_cast<float>(size()) / bucket_count(); }
+
+	/**
+	 * @brief Get the load factor above which the bucket count doubles.  Defaults to 2.0, since
+	 *        split-ordered lists are cheap to walk and growing doesn't rehash anything.
+	 */
+	float max_load_factor() const noexcept
+	{ return max_load_factor_.load(std::memory_order_relaxed); }
+
+	/**
+	 * @brief Set the load factor above which the bucket count doubles.  Must be positive.
+	 */
+	void max_load_factor(float f)
+	{
+		assert(f > 0.0);
+		max_load_factor_.store(f, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Make sure there are enough buckets for @p count elements.  This only changes
+	 *        the bucket count; the new buckets are still initialized lazily.
+	 */
+	void reserve(size_type count)
+	{
+		auto needed = static_cast<size_type>(std::ceil(count / max_load_factor()));
+		grow_to(needed);
+	}
+
+	/// @} Hash Policy
+
+	/// @name Observers
+	/// @{
+
+	/// Get a copy of the hash function.
+	hasher hash_function() const
+	{ return get_hasher(); }
+
+	/// Get a copy of the equality comparison function.
+	key_equal key_eq() const
+	{ return get_key_equal(); }
+
+	/// Get a copy of the allocator.
+	allocator_type get_allocator() const
+	{ return alloc_; }
+
+	/// @} Observers
+
+	/// Calls left.swap(right).
+	friend void swap(ConcurrentAnySet& left, ConcurrentAnySet& right) noexcept
+	{ left.swap(right); }
+
+	/**
+	 * @brief Check that the list is sorted by order key, that the initialized buckets' dummies
+	 *        are exactly the dummies in the list, and that the element count is right.  For
+	 *        tests; not thread-safe.
+	 */
+	void _assert_invariants() const
+	{
+		size_type count = 0;
+		size_type dummies = 0;
+		const ListNode* prev = nullptr;
+		for(const ListNode* node = head(); node; node = node->next.load())
+		{
+			if(prev)
+				assert(prev->order_key <= node->order_key);
+			assert(static_cast<bool>(node->value) == static_cast<bool>(node->order_key & 1u));
+			if(node->value)
+			{
+				assert(regular_key(hash_mixer{}(node->value->hash)) == node->order_key);
+				++count;
+			}
+			else
+			{
+				assert(peek_bucket(detail::reverse_bits(node->order_key)) == node);
+				++dummies;
+			}
+			prev = node;
+		}
+		assert(count == size());
+		size_type initialized = 0;
+		for(size_type b = 0; b < bucket_count(); ++b)
+			initialized += static_cast<bool>(peek_bucket(b));
+		assert(initialized == dummies);
+		(void)count;
+		(void)dummies;
+		(void)initialized;
+	}
+
+private:
+	static constexpr const std::size_t segment_count = sizeof(std::size_t) * CHAR_BIT;
+	static constexpr const std::size_t max_bucket_count_ = std::size_t(1) << (segment_count - 1);
+	static constexpr const std::size_t counter_count = 64;
+
+	struct alignas(64) Counter
+	{
+		std::atomic<size_type> value{0};
+	};
+
+	// Split-order keys.  Elements' keys have the lowest bit set, so that a bucket's dummy
+	// comes before every element in the bucket.
+	static std::size_t regular_key(std::size_t mixed) noexcept
+	{ return detail::reverse_bits(mixed) | 1u; }
+
+	static std::size_t dummy_key(std::size_t bucket) noexcept
+	{ return detail::reverse_bits(bucket); }
+
+	// Bucket 'b' lives in segment highest_set_bit(b) + 1, except for bucket 0 which lives
+	// in segment 0.  Segment 's' > 0 holds buckets [2^(s-1), 2^s).
+	static std::size_t segment_index(std::size_t bucket) noexcept
+	{ return bucket == 0u ? 0u : detail::highest_set_bit(bucket) + 1u; }
+
+	static std::size_t segment_size(std::size_t seg) noexcept
+	{ return seg == 0u ? 1u : (std::size_t(1) << (seg - 1u)); }
+
+	static std::size_t segment_offset(std::size_t bucket, std::size_t seg) noexcept
+	{ return seg == 0u ? 0u : bucket - segment_size(seg); }
+
+	// The parent of bucket 'b' is 'b' without its highest set bit.  All elements of 'b' come
+	// from its parent's run of the list when the bucket count is doubled.
+	static std::size_t parent_bucket(std::size_t bucket) noexcept
+	{ return bucket & ~(std::size_t(1) << detail::highest_set_bit(bucket)); }
+
+	template <class T>
+	static void swap_atomics(std::atomic<T>& left, std::atomic<T>& right) noexcept
+	{ left.store(right.exchange(left.load(std::memory_order_relaxed), std::memory_order_relaxed), std::memory_order_relaxed); }
+
+	const HashFn& get_hasher() const
+	{ return this->first(); }
+
+	const KeyEqual& get_key_equal() const
+	{ return this->second(); }
+
+	pair_type& as_pair()
+	{ return static_cast<pair_type&>(*this); }
+
+	template <class T, class HashArg, class ... Args>
+	node_handle make_node(HashArg&& hash_arg, Args&& ... args) const
+	{
+		if constexpr(detail::is_std_allocator_v<allocator_type>)
+		{
+			return make_any_value<T, HashFn, KeyEqual>(
+				std::forward<HashArg>(hash_arg), std::forward<Args>(args)...
+			);
+		}
+		else
+		{
+			return make_any_value<T, HashFn, KeyEqual>(
+				std::allocator_arg, alloc_, std::forward<HashArg>(hash_arg), std::forward<Args>(args)...
+			);
+		}
+	}
+
+	ListNode* make_list_node(std::size_t key, value_type* value) const
+	{
+		node_allocator alloc(alloc_);
+		ListNode* node = std::allocator_traits<node_allocator>::allocate(alloc, 1);
+		::new (static_cast<void*>(node)) ListNode(key, value);
+		return node;
+	}
+
+	void destroy_list_node(ListNode* node) const noexcept
+	{
+		node_allocator alloc(alloc_);
+		node->~ListNode();
+		std::allocator_traits<node_allocator>::deallocate(alloc, node, 1);
+	}
+
+	void initialize(size_type min_bucket_count)
+	{
+		size_type count = 2;
+		while(count < min_bucket_count and count < max_bucket_count_)
+			count *= 2;
+		bucket_count_.store(count, std::memory_order_relaxed);
+		for(auto& c: counters_)
+			c.value.store(0u, std::memory_order_relaxed);
+		ListNode* head = make_list_node(dummy_key(0u), nullptr);
+		bucket_slot(0u).store(head, std::memory_order_release);
+	}
+
+	void destroy() noexcept
+	{
+		ListNode* node = head();
+		while(node)
+		{
+			ListNode* next = node->next.load(std::memory_order_relaxed);
+			delete node->value;
+			destroy_list_node(node);
+			node = next;
+		}
+		segment_allocator alloc(alloc_);
+		for(std::size_t s = 0; s < segment_count; ++s)
+		{
+			if(bucket_type* seg = segments_[s].load(std::memory_order_relaxed))
+				std::allocator_traits<segment_allocator>::deallocate(alloc, seg, segment_size(s));
+			segments_[s].store(nullptr, std::memory_order_relaxed);
+		}
+	}
+
+	ListNode* head() const noexcept
+	{ return segments_[0].load(std::memory_order_acquire)[0].load(std::memory_order_acquire); }
+
+	// Get the table entry for 'bucket', allocating its segment if this is the first bucket in it.
+	bucket_type& bucket_slot(std::size_t bucket) const
+	{
+		const std::size_t seg = segment_index(bucket);
+		bucket_type* segment = segments_[seg].load(std::memory_order_acquire);
+		if(not segment)
+		{
+			segment_allocator alloc(alloc_);
+			const std::size_t n = segment_size(seg);
+			bucket_type* fresh = std::allocator_traits<segment_allocator>::allocate(alloc, n);
+			for(std::size_t i = 0; i < n; ++i)
+				::new (static_cast<void*>(fresh + i)) bucket_type(nullptr);
+			if(segments_[seg].compare_exchange_strong(segment, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+				segment = fresh;
+			else
+				std::allocator_traits<segment_allocator>::deallocate(alloc, fresh, n);
+		}
+		return segment[segment_offset(bucket, seg)];
+	}
+
+	// Get the dummy node of 'bucket' if it has been initialized, without initializing it.
+	const ListNode* peek_bucket(std::size_t bucket) const noexcept
+	{
+		const std::size_t seg = segment_index(bucket);
+		const bucket_type* segment = segments_[seg].load(std::memory_order_acquire);
+		if(not segment)
+			return nullptr;
+		return segment[segment_offset(bucket, seg)].load(std::memory_order_acquire);
+	}
+
+	// Get the dummy node of 'bucket', initializing the bucket (and its ancestors) if needed.
+	ListNode* get_bucket(std::size_t bucket) const
+	{
+		bucket_type& slot = bucket_slot(bucket);
+		if(ListNode* dummy = slot.load(std::memory_order_acquire))
+			return dummy;
+		ListNode* dummy = insert_dummy(get_bucket(parent_bucket(bucket)), dummy_key(bucket));
+		slot.store(dummy, std::memory_order_release);
+		return dummy;
+	}
+
+	// Link a dummy node with 'key' into the list after 'start', or return the one that's
+	// already there.
+	ListNode* insert_dummy(ListNode* start, std::size_t key) const
+	{
+		ListNode* node = nullptr;
+		ListNode* prev = start;
+		for(;;)
+		{
+			ListNode* cur = prev->next.load(std::memory_order_acquire);
+			while(cur and cur->order_key < key)
+			{
+				prev = cur;
+				cur = prev->next.load(std::memory_order_acquire);
+			}
+			if(cur and cur->order_key == key)
+			{
+				if(node)
+					destroy_list_node(node);
+				return cur;
+			}
+			if(not node)
+				node = make_list_node(key, nullptr);
+			node->next.store(cur, std::memory_order_relaxed);
+			if(prev->next.compare_exchange_weak(cur, node, std::memory_order_release, std::memory_order_relaxed))
+				return node;
+			// Something was linked in after 'prev'.  Keep looking from there.
+		}
+	}
+
+	template <class Value>
+	bool matches(const ListNode* node, const Value& value, std::size_t hash_v) const
+	{
+		return (node->value->hash == hash_v) and compare(*node->value, value, get_key_equal());
+	}
+
+	// Get the dummy node of 'bucket', or of its nearest initialized ancestor.  The list is sorted,
+	// so searching for an element of 'bucket' from an ancestor's dummy finds the same elements;
+	// it just walks past the elements of the ancestor first.  Never initializes anything.
+	const ListNode* nearest_bucket(std::size_t bucket) const noexcept
+	{
+		const ListNode* dummy = peek_bucket(bucket);
+		while(not dummy)
+		{
+			// Bucket 0 is always initialized.
+			assert(bucket != 0u);
+			bucket = parent_bucket(bucket);
+			dummy = peek_bucket(bucket);
+		}
+		return dummy;
+	}
+
+	template <class Value>
+	const ListNode* find_node(const Value& value, std::size_t hash_v) const
+	{
+		const std::size_t mixed = hash_mixer{}(hash_v);
+		const std::size_t key = regular_key(mixed);
+		const ListNode* node = nearest_bucket(mixed & (bucket_count() - 1u))->next.load(std::memory_order_acquire);
+		while(node and node->order_key < key)
+			node = node->next.load(std::memory_order_acquire);
+		for(; node and node->order_key == key; node = node->next.load(std::memory_order_acquire))
+		{
+			if(matches(node, value, hash_v))
+				return node;
+		}
+		return nullptr;
+	}
+
+	template <class Value, class MakeNode>
+	std::pair<const_iterator, bool> insert_impl(const Value& value, std::size_t hash_v, MakeNode make)
+	{
+		const std::size_t mixed = hash_mixer{}(hash_v);
+		const std::size_t key = regular_key(mixed);
+		ListNode* prev = get_bucket(mixed & (bucket_count() - 1u));
+		ListNode* node = nullptr;
+		// 'make' may move from 'value', so once the node exists, compare against its copy instead.
+		const Value* key_value = std::addressof(value);
+		for(;;)
+		{
+			// Elements with the same key go after the ones already there, so look at all of them.
+			ListNode* cur = prev->next.load(std::memory_order_acquire);
+			while(cur and cur->order_key <= key)
+			{
+				if(cur->order_key == key and matches(cur, *key_value, hash_v))
+				{
+					if(node)
+					{
+						delete node->value;
+						destroy_list_node(node);
+					}
+					return std::make_pair(const_iterator(cur), false);
+				}
+				prev = cur;
+				cur = prev->next.load(std::memory_order_acquire);
+			}
+			if(not node)
+			{
+				node_handle value_node = make(hash_v);
+				node = make_list_node(key, value_node.get());
+				value_node.release();
+				key_value = std::addressof(unsafe_cast<const Value&>(*node->value));
+			}
+			node->next.store(cur, std::memory_order_relaxed);
+			if(prev->next.compare_exchange_weak(cur, node, std::memory_order_release, std::memory_order_relaxed))
+				break;
+			// Something was linked in after 'prev'; it might be equal to 'value'.  Keep looking
+			// from there.
+		}
+		auto& counter = counters_[mixed % counter_count].value;
+		auto n = counter.fetch_add(1u, std::memory_order_relaxed) + 1u;
+		// Estimate the size from this counter alone; elements are spread over the counters by hash.
+		auto bcount = bucket_count();
+		if(n * counter_count > bcount * max_load_factor())
+			grow_to(bcount * 2u);
+		return std::make_pair(const_iterator(node), true);
+	}
+
+	void grow_to(size_type new_count) noexcept
+	{
+		auto count = bucket_count_.load(std::memory_order_relaxed);
+		new_count = std::min(new_count, max_bucket_count_);
+		while(count < new_count)
+		{
+			size_type next = count * 2u;
+			if(bucket_count_.compare_exchange_weak(count, next, std::memory_order_release, std::memory_order_relaxed))
+				count = next;
+		}
+	}
+
+	Allocator alloc_;
+	mutable std::atomic<bucket_type*> segments_[segment_count] = {};
+	std::atomic<size_type> bucket_count_{0};
+	std::atomic<float> max_load_factor_{2.0f};
+	Counter counters_[counter_count];
+};
+
+} /* namespace te */
+
+#endif /* CONCURRENT_ANY_SET_H */
@@ -0,0 +1,451 @@
+#ifndef COW_ANY_SET_H
+#define COW_ANY_SET_H
+
+#ifdef _MSC_VER
+# include <iso646.h>
+#endif
+
+#include "AnySet.h"
+#include <atomic>
+#include <memory>
+
+namespace te {
+
+/**
+ * @brief A copy-on-write wrapper around AnySet.  Copies share one AnySet until one of them is
+ *        changed.
+ *
+ * Copying a CowAnySet (including passing it by value) copies a pointer and bumps a reference
+ * count; no elements or buckets are copied.  The shared AnySet is cloned the first time a copy
+ * that shares it is changed, and only then.  Changes that turn out to have no effect (inserting
+ * an element that is already there, erasing one that isn't) don't clone it.
+ *
+ * Reading goes straight to the shared AnySet (see get()), so lookups and iteration cost the
+ * same as they do on an AnySet.  Arbitrary changes can be made through mutate(), which returns
+ * the AnySet after making sure that this copy is its only owner.
+ *
+ * The set operations in SetOperations.h accept CowAnySet instances.  Where the result is equal
+ * to one of the arguments (e.g. the union of a set and one of its subsets), the result shares
+ * that argument's AnySet instead of copying it.
+ *
+ * @code
+ * te::CowAnySet<> config(std::move(any_set));
+ * auto snapshot = config;        // O(1)
+ * config.insert(std::string("new-option")); // clones here; snapshot is unchanged
+ * @endcode
+ *
+ * Like std::shared_ptr, distinct copies that share an AnySet may be read, copied, changed, and
+ * destroyed by different threads at once.  A single CowAnySet object is, like an AnySet, safe to
+ * read from any number of threads but not to change while it is read.
+ *
+ * @tparam HashFn      - The type of the function object to use when computing the hash codes of elements.
+ * @tparam KeyEqual    - The type of the function object to use when comparing elements for equality.
+ * @tparam Allocator   - The allocator of the shared AnySet.  Also allocates its reference count.
+ * @tparam TablePolicy - The table policy of the shared AnySet.  See AnySet.
+ *
+ * @see AnySet - The type of the shared set.
+ */
+template <
+	class HashFn = AnyHash,
+	class KeyEqual = std::equal_to<>,
+	class Allocator = std::allocator<AnyValue<HashFn, KeyEqual>>,
+	class TablePolicy = ChainedBuckets
+>
+struct CowAnySet
+{
+	/// Type of the shared set.
+	using set_type = AnySet<HashFn, KeyEqual, Allocator, TablePolicy>;
+	/// AnyValue.
+	using value_type = typename set_type::value_type;
+	/// Size type.
+	using size_type = typename set_type::size_type;
+	/// Difference type.
+	using difference_type = typename set_type::difference_type;
+	/// %Hash function type.
+	using hasher = HashFn;
+	/// Key equality comparator type.
+	using key_equal = KeyEqual;
+	/// Allocator type.
+	using allocator_type = Allocator;
+	/// Reference type.
+	using reference = const value_type&;
+	/// Const reference type.
+	using const_reference = const value_type&;
+	/// Iterator type.  Elements are only reachable through const iterators; use mutate() to get
+	/// mutable access to the set.
+	using iterator = typename set_type::const_iterator;
+	/// Const iterator type.
+	using const_iterator = typename set_type::const_iterator;
+	/// Type of the nodes that hold elements.  See AnySet::node_handle.
+	using node_handle = typename set_type::node_handle;
+
+	/// @name Constructors
+	/// @{
+
+	/**
+	 * @brief Construct an empty set.  Doesn't allocate.
+	 */
+	CowAnySet() noexcept = default;
+
+	/**
+	 * @brief Construct a CowAnySet that owns @p set.  Pass an rvalue to avoid copying @p set.
+	 */
+	explicit CowAnySet(set_type set):
+		set_(make_shared_set(std::move(set)))
+	{
+
+	}
+
+	/**
+	 * @brief Share @p other's set.  O(1).
+	 */
+	CowAnySet(const CowAnySet& other) noexcept = default;
+
+	/**
+	 * @brief Take @p other's set.  @p other is left empty.
+	 */
+	CowAnySet(CowAnySet&& other) noexcept = default;
+
+	/// @} Constructors
+
+	/// @name Assignment
+	/// @{
+
+	/// Share @p other's set.  O(1).
+	CowAnySet& operator=(const CowAnySet& other) noexcept = default;
+
+	/// Take @p other's set.  @p other is left empty.
+	CowAnySet& operator=(CowAnySet&& other) noexcept = default;
+
+	/// @} Assignment
+
+	/// @name Sharing
+	/// @{
+
+	/**
+	 * @brief Get the (possibly shared) set.
+	 *
+	 * @note The reference is invalidated by any change to this CowAnySet, including assignment.
+	 */
+	const set_type& get() const noexcept
+	{ return set_ ? *set_ : empty_set(); }
+
+	/// Get the (possibly shared) set.  Same as get().
+	const set_type& operator*() const noexcept
+	{ return get(); }
+
+	/// Get the (possibly shared) set.  Same as get().
+	const set_type* operator->() const noexcept
+	{ return std::addressof(get()); }
+
+	/**
+	 * @brief Get a mutable reference to the set, cloning it first if it is shared.
+	 *
+	 * @note The reference must not be used after this CowAnySet is copied or assigned to, since
+	 *       the set may be shared again from then on.
+	 *
+	 * @note Invalidates all iterators to the set, and all references obtained with get().
+	 */
+	set_type& mutate()
+	{
+		if(not set_)
+			set_ = make_shared_set(set_type());
+		else if(set_.use_count() > 1)
+			set_ = make_shared_set(*set_);
+		else
+		{
+			// use_count() is a relaxed load.  A copy on another thread may have read the set 
+			// just before it was destroyed; the fence orders those reads before our writes.
+			std::atomic_thread_fence(std::memory_order_acquire);
+		}
+		return *set_;
+	}
+
+	/**
+	 * @brief Check if this CowAnySet currently shares its set with another CowAnySet.  If so,
+	 *        the next change to either of them clones the set.
+	 */
+	bool is_shared() const noexcept
+	{ return set_.use_count() > 1; }
+
+	/**
+	 * @brief Check if this CowAnySet shares its set with @p other.
+	 */
+	bool shares_with(const CowAnySet& other) const noexcept
+	{ return std::addressof(get()) == std::addressof(other.get()); }
+
+	/**
+	 * @brief Get a copy of the set that this CowAnySet doesn't share.
+	 */
+	set_type to_any_set() const
+	{ return get(); }
+
+	/**
+	 * @brief Move the set out of this CowAnySet, cloning it only if it is shared.  Leaves this
+	 *        CowAnySet empty.
+	 */
+	set_type release()
+	{
+		set_type result(std::move(mutate()));
+		set_.reset();
+		return result;
+	}
+
+	/// @} Sharing
+
+	/// @name Iterators
+	/// @{
+
+	/// Get an iterator to the first element of the set.
+	const_iterator begin() const
+	{ return get().begin(); }
+
+	/// Get an iterator to the first element of the set.
+	const_iterator cbegin() const
+	{ return get().cbegin(); }
+
+	/// Get an iterator to the end of the set.
+	const_iterator end() const
+	{ return get().end(); }
+
+	/// Get an iterator to the end of the set.
+	const_iterator cend() const
+	{ return get().cend(); }
+
+	/// @} Iterators
+
+	/// @name Capacity
+	/// @{
+
+	/// Get the number of elements in the set.
+	size_type size() const noexcept
+	{ return get().size(); }
+
+	/// Check if the set is empty.
+	bool empty() const noexcept
+	{ return get().empty(); }
+
+	/// Get the number of buckets of the set.
+	size_type bucket_count() const noexcept
+	{ return get().bucket_count(); }
+
+	/// @} Capacity
+
+	/// @name Modifiers
+	/// @{
+
+	/**
+	 * @brief Insert @p value if the set doesn't already contain it.  Doesn't clone a shared set
+	 *        if it already contains @p value.
+	 *
+	 * @see AnySet::insert(T&&)
+	 */
+	template <class T>
+	std::pair<const_iterator, bool> insert(T&& value)
+	{
+		if(is_shared())
+		{
+			auto pos = get().find(value);
+			if(pos != get().end())
+				return std::make_pair(pos, false);
+		}
+		return mutate().insert(std::forward<T>(value));
+	}
+
+	/**
+	 * @brief Insert each of @p args that the set doesn't already contain.
+	 *
+	 * @return The number of elements inserted.
+	 */
+	template <class T, class U, class ... V>
+	size_type insert(T&& first, U&& second, V&& ... args)
+	{
+		auto ins = [this](auto&& v) -> size_type {
+			return insert(std::forward<decltype(v)>(v)).second;
+		};
+		size_type count = ins(std::forward<T>(first));
+		count += ins(std::forward<U>(second));
+		return (count + ... + ins(std::forward<V>(args)));
+	}
+
+	/**
+	 * @brief Insert an element constructed from @p args if the set doesn't already contain it.
+	 *        Doesn't clone a shared set if it already contains the element.
+	 *
+	 * @see AnySet::emplace()
+	 */
+	template <class T, class ... Args>
+	std::pair<const_iterator, bool> emplace(Args&& ... args)
+	{
+		static_assert(
+			std::is_same_v<T, std::decay_t<T>>,
+			"Cannot emplace references, arrays, or functions into a CowAnySet."
+		);
+		if(not is_shared())
+			return mutate().template emplace<T>(std::forward<Args>(args)...);
+		// Build the element before deciding whether to clone.
+		node_handle node = make_node<T>(std::forward<Args>(args)...);
+		auto pos = get().find(unsafe_cast<const T&>(*node));
+		if(pos != get().end())
+			return std::make_pair(pos, false);
+		[[maybe_unused]] auto [ins_pos, leftover] = mutate().push(std::move(node));
+		assert(not leftover);
+		return std::make_pair(const_iterator(ins_pos), true);
+	}
+
+	/**
+	 * @brief Erase the element equal to @p value, if there is one.  Doesn't clone a shared set
+	 *        if it doesn't contain @p value.
+	 *
+	 * @return The number of elements erased (zero or one).
+	 */
+	template <class T>
+	size_type erase(const T& value)
+	{
+		if(is_shared() and not get().contains(value))
+			return 0u;
+		return mutate().erase(value);
+	}
+
+	/**
+	 * @brief Add copies of the elements of @p other that the set doesn't already contain.
+	 *        Doesn't clone a shared set if it already contains all of them.  If this set is
+	 *        empty, it shares @p other's set instead.
+	 */
+	CowAnySet& update(const CowAnySet& other)
+	{
+		if(empty())
+			return *this = other;
+		set_type* target = nullptr;
+		for(auto pos = other.begin(); pos != other.end(); ++pos)
+		{
+			if(not target)
+			{
+				if(get().contains_value(*pos))
+					continue;
+				target = std::addressof(mutate());
+				target->reserve(target->size() + other.size());
+			}
+			target->push(target->dup(*pos));
+		}
+		return *this;
+	}
+
+	/// Remove all elements.  Doesn't clone a shared set.
+	void clear()
+	{
+		if(is_shared())
+			set_ = make_shared_set(set_type(0u, hash_function(), key_eq(), get_allocator()));
+		else if(set_)
+			set_->clear();
+	}
+
+	/// Exchange the contents of this set and @p other.  O(1).
+	void swap(CowAnySet& other) noexcept
+	{ set_.swap(other.set_); }
+
+	/// Exchange the contents of @p left and @p right.  O(1).
+	friend void swap(CowAnySet& left, CowAnySet& right) noexcept
+	{ left.swap(right); }
+
+	/// @} Modifiers
+
+	/// @name Lookup
+	/// @{
+
+	/// Get an iterator to the element equal to @p value, or end() if there is none.
+	template <class T>
+	const_iterator find(const T& value) const
+	{ return get().find(value); }
+
+	/// Check if the set contains @p value.
+	template <class T>
+	bool contains(const T& value) const
+	{ return get().contains(value); }
+
+	/// Count the elements equal to @p value (0 or 1).
+	template <class T>
+	size_type count(const T& value) const
+	{ return get().count(value); }
+
+	/// Check if the set contains an element equal to @p any_v.
+	bool contains_value(const value_type& any_v) const
+	{ return get().contains_value(any_v); }
+
+	/// Pair @p key with its hash code.  See AnySet::hashed().
+	template <class T>
+	Hashed<T> hashed(const T& key) const
+	{ return get().hashed(key); }
+
+	template <class T>
+	Hashed<T> hashed(const T&& key) const = delete;
+
+	/// @} Lookup
+
+	/// @name Observers
+	/// @{
+
+	/// Get the hash function of the set.
+	hasher hash_function() const
+	{ return get().hash_function(); }
+
+	/// Get the key equality comparator of the set.
+	key_equal key_eq() const
+	{ return get().key_eq(); }
+
+	/// Get the allocator of the set.
+	allocator_type get_allocator() const
+	{ return get().get_allocator(); }
+
+	/// @} Observers
+
+	/// Check that the shared set's invariants hold.
+	void _assert_invariants() const
+	{ get()._assert_invariants(); }
+
+	/// Check if @p left and @p right contain the same elements.  O(1) if they share a set.
+	friend bool operator==(const CowAnySet& left, const CowAnySet& right)
+	{ return left.shares_with(right) or left.get() == right.get(); }
+
+	/// Check if @p left and @p right contain different elements.
+	friend bool operator!=(const CowAnySet& left, const CowAnySet& right)
+	{ return not (left == right); }
+
+private:
+	static std::shared_ptr<set_type> make_shared_set(set_type&& set)
+	{
+		const allocator_type alloc = set.get_allocator();
+		return std::allocate_shared<set_type>(alloc, std::move(set));
+	}
+
+	static std::shared_ptr<set_type> make_shared_set(const set_type& set)
+	{ return std::allocate_shared<set_type>(set.get_allocator(), set); }
+
+	// Default-constructed and cleared sets share this instead of allocating.
+	static const set_type& empty_set()
+	{
+		static const set_type empty;
+		return empty;
+	}
+
+	template <class T, class ... Args>
+	node_handle make_node(Args&& ... args) const
+	{
+		if constexpr(detail::is_std_allocator_v<Allocator>)
+		{
+			return make_any_value<T, HashFn, KeyEqual>(get().hash_function(), std::forward<Args>(args)...);
+		}
+		else
+		{
+			return make_any_value<T, HashFn, KeyEqual>(
+				std::allocator_arg, get_allocator(), get().hash_function(), std::forward<Args>(args)...
+			);
+		}
+	}
+
+	std::shared_ptr<set_type> set_;
+};
+
+} /* namespace te */
+
+#endif /* COW_ANY_SET_H */
@@ -0,0 +1,635 @@
+#ifndef FROZEN_ANY_SET_H
+#define FROZEN_ANY_SET_H
+
+#ifdef _MSC_VER
+# include <iso646.h>
+#endif
+
+#include "AnySet.h"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace te {
+
+/// @internal
+namespace detail {
+
+/**
+ * @brief Node allocator that carves nodes out of a few large blocks, which are freed together.
+ *
+ * Nodes allocated here are destroyed in place and never deallocated one at a time, except by
+ * allocate_typed_value() when a constructor throws; the deallocator stored before each node
+ * does nothing for that reason.
+ */
+template <class Alloc>
+struct ArenaNodeAllocator final:
+	public NodeAllocatorBase
+{
+	using block_allocator = typename std::allocator_traits<Alloc>::template rebind_alloc<NodeBlock>;
+	using block_traits = std::allocator_traits<block_allocator>;
+
+	ArenaNodeAllocator(const Alloc& alloc, std::size_t first_block_size):
+		alloc_(alloc), next_block_size_(std::max<std::size_t>(first_block_size / sizeof(NodeBlock), 4u))
+	{
+
+	}
+
+	ArenaNodeAllocator(const ArenaNodeAllocator&) = delete;
+	ArenaNodeAllocator& operator=(const ArenaNodeAllocator&) = delete;
+
+	ArenaNodeAllocator(ArenaNodeAllocator&& other) noexcept:
+		alloc_(other.alloc_),
+		blocks_(std::move(other.blocks_)),
+		free_(std::exchange(other.free_, nullptr)),
+		free_count_(std::exchange(other.free_count_, 0u)),
+		next_block_size_(other.next_block_size_),
+		last_node_(std::exchange(other.last_node_, nullptr))
+	{
+
+	}
+
+	~ArenaNodeAllocator()
+	{
+		for(auto [block, count]: blocks_)
+			block_traits::deallocate(alloc_, block, count);
+	}
+
+	void* allocate_node(std::size_t node_size) const final override
+	{
+		const std::size_t count = 1u + (node_size + sizeof(NodeBlock) - 1u) / sizeof(NodeBlock);
+		if(count > free_count_)
+		{
+			const std::size_t block_count = std::max(count, next_block_size_);
+			blocks_.reserve(blocks_.size() + 1u);
+			free_ = block_traits::allocate(alloc_, block_count);
+			free_count_ = block_count;
+			blocks_.emplace_back(free_, block_count);
+			next_block_size_ = block_count;
+		}
+		// The first block of each node holds the (no-op) deallocator; the node starts after it.
+		auto* base = reinterpret_cast<unsigned char*>(free_ + 1);
+		NodeDeallocator dealloc = &deallocate;
+		std::memcpy(base - sizeof(NodeDeallocator), &dealloc, sizeof(dealloc));
+		free_ += count;
+		free_count_ -= count;
+		last_node_ = base;
+		return base;
+	}
+
+	// Check whether 'node' is the last node allocated here.  Over-aligned nodes come from
+	// operator new instead.
+	bool allocated_last(const void* node) const noexcept
+	{ return node == last_node_; }
+
+private:
+	static void deallocate(void*, std::size_t) noexcept
+	{
+
+	}
+
+	mutable block_allocator alloc_;
+	mutable std::vector<std::pair<NodeBlock*, std::size_t>> blocks_;
+	mutable NodeBlock* free_ = nullptr;
+	mutable std::size_t free_count_ = 0;
+	mutable std::size_t next_block_size_;
+	mutable const void* last_node_ = nullptr;
+};
+
+// Map the high 32 bits of 'hash' onto [0, range) without a division.
+inline std::size_t reduce_hash(std::size_t hash, std::size_t range) noexcept
+{
+	auto high = static_cast<std::uint32_t>(hash >> (std::numeric_limits<std::size_t>::digits - 32));
+	return static_cast<std::size_t>((static_cast<std::uint64_t>(high) * range) >> 32);
+}
+
+} /* namespace detail */
+/// @endinternal
+
+/**
+ * @brief An immutable copy of an AnySet, indexed by a minimal perfect hash function.
+ *
+ * A FrozenAnySet is built once from an AnySet and cannot be modified afterwards.  The elements
+ * are copied into a few large blocks of memory (usually one), in the order of their slots.  The
+ * index is a minimal perfect hash function over the distinct hash codes of the elements, built
+ * in the "hash and displace" style: each hash code falls into a small group, and each group has
+ * a stored displacement that sends its hash codes to distinct slots.  Each slot stores a hash
+ * code and a pointer to the first element with that hash code, so a lookup reads the group's
+ * displacement and the slot, and only reads an element if the hash codes match.  Elements with
+ * equal hash codes share a slot.
+ *
+ * The element types must be copy constructible.  Elements of over-aligned types are allocated
+ * individually, as AnySet allocates them.
+ *
+ * All member functions are const, so a FrozenAnySet can be shared by any number of threads
+ * without synchronization.
+ *
+ * @code
+ * te::AnySet<> allow_list{1, 2, std::string("admin")};
+ * const te::FrozenAnySet<> frozen(allow_list);
+ * bool ok = frozen.contains(std::string("admin"));
+ * @endcode
+ *
+ * @tparam HashFn    - The hash function type of the sets it is built from.
+ * @tparam KeyEqual  - The key equality type of the sets it is built from.
+ * @tparam Allocator - Allocator for the element storage and the index.
+ */
+template <
+	class HashFn = AnyHash,
+	class KeyEqual = std::equal_to<>,
+	class Allocator = std::allocator<AnyValue<HashFn, KeyEqual>>
+>
+struct FrozenAnySet
+{
+	/// AnyValue.
+	using value_type = AnyValue<HashFn, KeyEqual>;
+	/// Size type.
+	using size_type = std::size_t;
+	/// Difference type.
+	using difference_type = std::ptrdiff_t;
+	/// %Hash function type.
+	using hasher = HashFn;
+	/// Key equality comparator type.
+	using key_equal = KeyEqual;
+	/// Allocator type.
+	using allocator_type = Allocator;
+	/// Reference type.
+	using reference = const value_type&;
+	/// Const reference type.
+	using const_reference = const value_type&;
+	/// Pointer type.
+	using pointer = const value_type*;
+	/// Const pointer type.
+	using const_pointer = const value_type*;
+
+	/**
+	 * @brief Forward iterator over the elements of a FrozenAnySet, in slot order.
+	 */
+	struct Iterator
+	{
+		using value_type        = const typename FrozenAnySet::value_type;
+		using reference         = const typename FrozenAnySet::value_type&;
+		using pointer           = const typename FrozenAnySet::value_type*;
+		using difference_type   = std::ptrdiff_t;
+		using iterator_category = std::forward_iterator_tag;
+
+		Iterator() = default;
+
+		reference operator*() const
+		{ return *node_; }
+
+		pointer operator->() const
+		{ return node_; }
+
+		Iterator& operator++()
+		{
+			node_ = node_->next;
+			if(not node_)
+				node_ = set_->first_node(++slot_);
+			return *this;
+		}
+
+		Iterator operator++(int)
+		{
+			auto cpy = *this;
+			++*this;
+			return cpy;
+		}
+
+		friend bool operator==(const Iterator& left, const Iterator& right)
+		{ return left.node_ == right.node_; }
+
+		friend bool operator!=(const Iterator& left, const Iterator& right)
+		{ return not (left == right); }
+
+	private:
+		Iterator(const FrozenAnySet& set, size_type slot, const typename FrozenAnySet::value_type* node):
+			set_(std::addressof(set)), slot_(slot), node_(node)
+		{
+
+		}
+
+		const FrozenAnySet* set_ = nullptr;
+		size_type slot_ = 0;
+		const typename FrozenAnySet::value_type* node_ = nullptr;
+		friend struct FrozenAnySet;
+	};
+
+	/// Iterator type.  Frozen sets have no mutable iterators.
+	using iterator = Iterator;
+	/// Const iterator type.
+	using const_iterator = Iterator;
+
+	/// @name Constructors
+	/// @{
+
+	/**
+	 * @brief Build a frozen copy of @p set.  Copies every element once.
+	 *
+	 * @param set   - The set to copy.
+	 * @param alloc - Allocator for the element storage and the index.
+	 *
+	 * @note Throws te::NoCopyConstructorError if @p set contains an element whose type is not
+	 *       copy constructible.
+	 */
+	template <class A, class P>
+	explicit FrozenAnySet(const AnySet<HashFn, KeyEqual, A, P>& set, const Allocator& alloc = Allocator()):
+		hasher_(set.hash_function()),
+		key_eq_(set.key_eq()),
+		pilots_(pilot_allocator(alloc)),
+		slots_(slot_allocator(alloc)),
+		remap_(size_vector_allocator(alloc)),
+		arena_(alloc, set.size() * estimated_node_size)
+	{
+		try
+		{
+			build(set);
+		}
+		catch(...)
+		{
+			destroy_nodes();
+			throw;
+		}
+	}
+
+	/// Move constructor.  @p other is left empty.
+	FrozenAnySet(FrozenAnySet&& other):
+		hasher_(other.hasher_),
+		key_eq_(other.key_eq_),
+		seed_(other.seed_),
+		slot_count_(std::exchange(other.slot_count_, 0u)),
+		table_size_(std::exchange(other.table_size_, 0u)),
+		size_(std::exchange(other.size_, 0u)),
+		pilots_(std::move(other.pilots_)),
+		slots_(std::move(other.slots_)),
+		remap_(std::move(other.remap_)),
+		heap_nodes_(std::move(other.heap_nodes_)),
+		arena_(std::move(other.arena_))
+	{
+		other.slots_.clear();
+	}
+
+	FrozenAnySet(const FrozenAnySet&) = delete;
+	FrozenAnySet& operator=(const FrozenAnySet&) = delete;
+	FrozenAnySet& operator=(FrozenAnySet&&) = delete;
+
+	/// @} Constructors
+
+	~FrozenAnySet()
+	{ destroy_nodes(); }
+
+	/// @name Iterators
+	/// @{
+
+	/// Get an iterator to the first element.
+	const_iterator begin() const noexcept
+	{ return const_iterator(*this, 0u, first_node(0u)); }
+
+	/// Get an iterator to the first element.
+	const_iterator cbegin() const noexcept
+	{ return begin(); }
+
+	/// Get the past-the-end iterator.
+	const_iterator end() const noexcept
+	{ return const_iterator(*this, slots_.size(), nullptr); }
+
+	/// Get the past-the-end iterator.
+	const_iterator cend() const noexcept
+	{ return end(); }
+
+	/// @} Iterators
+
+	/// @name Capacity
+	/// @{
+
+	/// Get the number of elements.
+	size_type size() const noexcept
+	{ return size_; }
+
+	/// Check whether the set is empty.
+	bool empty() const noexcept
+	{ return size_ == 0u; }
+
+	/// @} Capacity
+
+	/// @name Lookup
+	/// @{
+
+	/**
+	 * @brief Find the element equal to @p value.
+	 *
+	 * @param value - Value to search for.  May also be a value_type or a Hashed<T>.
+	 *
+	 * @return An iterator to the element, or end() if there is none.
+	 */
+	template <class T>
+	const_iterator find(const T& value) const
+	{
+		if(empty())
+			return end();
+		const std::size_t hash_v = get_hash_value(value);
+		const size_type slot = slot_of(hash_v);
+		// Every element in a slot has the slot's hash code.
+		if(slots_[slot].hash != hash_v)
+			return end();
+		for(const value_type* node = slots_[slot].node; node; node = node->next)
+		{
+			if(compare(unwrap_key(value), *node, key_eq_))
+				return const_iterator(*this, slot, node);
+		}
+		return end();
+	}
+
+	/// Check whether the set contains an element equal to @p value.
+	template <class T>
+	bool contains(const T& value) const
+	{ return find(value) != end(); }
+
+	/// Count the elements equal to @p value (0 or 1).
+	template <class T>
+	size_type count(const T& value) const
+	{ return static_cast<size_type>(contains(value)); }
+
+	/// Check whether the set contains an element equal to @p any_v.
+	bool contains_value(const value_type& any_v) const
+	{ return contains(any_v); }
+
+	/// @} Lookup
+
+	/// @name Observers
+	/// @{
+
+	/// Get a copy of the hash function.
+	hasher hash_function() const
+	{ return hasher_; }
+
+	/// Get a copy of the equality comparison function.
+	key_equal key_eq() const
+	{ return key_eq_; }
+
+	/// Hash @p key with this set's hash function and pair it with the result.  See AnySet::hashed().
+	template <class T>
+	Hashed<T> hashed(const T& key) const
+	{ return Hashed<T>(key, hasher_(key)); }
+
+	template <class T>
+	Hashed<T> hashed(const T&& key) const = delete;
+
+	/// @} Observers
+
+	void _assert_invariants() const
+	{
+		assert(slots_.size() == slot_count_);
+		size_type count = 0;
+		for(size_type s = 0; s < slot_count_; ++s)
+		{
+			// Every slot holds the elements with one distinct hash code.
+			assert(slots_[s].node);
+			assert(slot_of(slots_[s].hash) == s);
+			for(const value_type* node = slots_[s].node; node; node = node->next)
+			{
+				assert(node->hash == slots_[s].hash);
+				++count;
+			}
+		}
+		assert(count == size_);
+	}
+
+	friend bool operator==(const FrozenAnySet& left, const FrozenAnySet& right)
+	{
+		if(left.size() != right.size())
+			return false;
+		return std::all_of(left.begin(), left.end(), [&](const auto& v) { return right.contains_value(v); });
+	}
+
+	friend bool operator!=(const FrozenAnySet& left, const FrozenAnySet& right)
+	{ return not (left == right); }
+
+private:
+	// The hash code is stored next to the node pointer so that most misses never touch a node.
+	struct Slot
+	{
+		std::size_t hash;
+		value_type* node;
+	};
+
+	using slot_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+	using size_vector_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<size_type>;
+	using pilot_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<std::uint32_t>;
+
+	// Average number of hash codes per displacement group.
+	static constexpr const size_type group_size = 2;
+	// Guess at the size of a node, for sizing the first block of the arena.
+	static constexpr const size_type estimated_node_size = 64;
+	// Give up on a seed after this many displacements for one group.
+	static constexpr const std::uint32_t max_pilot = 1u << 20;
+
+	template <class T>
+	std::size_t get_hash_value(const T& value) const
+	{
+		if constexpr(std::is_same_v<T, value_type> or detail::is_hashed_v<T>)
+			return value.hash;
+		else
+			return hasher_(value);
+	}
+
+	template <class T>
+	static const T& unwrap_key(const T& value)
+	{ return value; }
+
+	template <class T>
+	static const T& unwrap_key(const Hashed<T>& key)
+	{ return key.value; }
+
+	size_type group_of(std::size_t hash_v) const noexcept
+	{ return detail::reduce_hash(detail::finalize_hash(hash_v ^ seed_), pilots_.size()); }
+
+	size_type position_of(std::size_t hash_v, std::uint32_t pilot) const noexcept
+	{
+		std::size_t displaced = hash_v ^ detail::finalize_hash(seed_ + pilot + 1u);
+		return detail::reduce_hash(detail::finalize_hash(displaced), table_size_);
+	}
+
+	const value_type* first_node(size_type slot) const noexcept
+	{ return (slot < slots_.size()) ? slots_[slot].node : nullptr; }
+
+	size_type slot_of(std::size_t hash_v) const noexcept
+	{
+		size_type pos = position_of(hash_v, pilots_[group_of(hash_v)]);
+		return (pos < slot_count_) ? pos : remap_[pos - slot_count_];
+	}
+
+	template <class A, class P>
+	void build(const AnySet<HashFn, KeyEqual, A, P>& set)
+	{
+		assert(set.size() < (std::size_t(1) << 32));
+		if(set.empty())
+			return;
+		// Sort the elements by hash code so that equal hash codes are adjacent.
+		std::vector<std::pair<std::size_t, const value_type*>> sorted;
+		sorted.reserve(set.size());
+		for(const auto& v: set)
+			sorted.emplace_back(v.hash, std::addressof(v));
+		std::sort(sorted.begin(), sorted.end(), [](const auto& l, const auto& r) { return l.first < r.first; });
+		std::vector<std::size_t> keys;
+		keys.reserve(sorted.size());
+		for(const auto& v: sorted)
+		{
+			if(keys.empty() or keys.back() != v.first)
+				keys.push_back(v.first);
+		}
+		slot_count_ = keys.size();
+		// A little slack makes placing the last groups cheap; positions past the end are remapped.
+		table_size_ = slot_count_ + slot_count_ / 16u + 1u;
+		pilots_.assign((slot_count_ + group_size - 1u) / group_size, 0u);
+		std::vector<size_type> key_slot(keys.size());
+		while(not place_keys(keys, key_slot))
+			seed_ = detail::finalize_hash(seed_ + 0x9e3779b97f4a7c15ull);
+
+		// Copy the elements into the arena in slot order.
+		std::vector<size_type> slot_key(slot_count_);
+		for(size_type k = 0; k < keys.size(); ++k)
+			slot_key[key_slot[k]] = k;
+		std::vector<size_type> key_first(keys.size() + 1u);
+		for(size_type i = 0, k = 0; i < sorted.size(); ++i)
+		{
+			if(i == 0u or sorted[i].first != sorted[i - 1u].first)
+				key_first[k++] = i;
+		}
+		key_first.back() = sorted.size();
+		slots_.assign(slot_count_, Slot{0u, nullptr});
+		for(size_type s = 0; s < slot_count_; ++s)
+		{
+			const size_type k = slot_key[s];
+			slots_[s].hash = keys[k];
+			value_type** link = &slots_[s].node;
+			for(size_type i = key_first[k]; i < key_first[k + 1u]; ++i)
+			{
+				*link = copy_node(*sorted[i].second);
+				link = &(*link)->next;
+				++size_;
+			}
+		}
+	}
+
+	// Find a displacement for each group so that every key lands in its own position.
+	// Returns false if some group couldn't be placed with this seed.
+	bool place_keys(const std::vector<std::size_t>& keys, std::vector<size_type>& key_slot)
+	{
+		const size_type group_count = pilots_.size();
+		std::vector<size_type> group_begin(group_count + 1u, 0u);
+		for(auto k: keys)
+			++group_begin[group_of(k) + 1u];
+		std::partial_sum(group_begin.begin(), group_begin.end(), group_begin.begin());
+		std::vector<size_type> grouped(keys.size());
+		{
+			auto next = group_begin;
+			for(size_type k = 0; k < keys.size(); ++k)
+				grouped[next[group_of(keys[k])]++] = k;
+		}
+		// Place the largest groups first, while the table is still mostly empty.
+		std::vector<size_type> order(group_count);
+		std::iota(order.begin(), order.end(), size_type(0));
+		std::stable_sort(order.begin(), order.end(), [&](size_type l, size_type r) {
+			return (group_begin[l + 1u] - group_begin[l]) > (group_begin[r + 1u] - group_begin[r]);
+		});
+		std::vector<char> taken(table_size_, false);
+		std::vector<size_type> positions;
+		for(size_type g: order)
+		{
+			const size_type first = group_begin[g];
+			const size_type last = group_begin[g + 1u];
+			if(first == last)
+				break;
+			std::uint32_t pilot = 0;
+			for(;; ++pilot)
+			{
+				if(pilot == max_pilot)
+					return false;
+				positions.clear();
+				bool ok = true;
+				for(size_type i = first; ok and i < last; ++i)
+				{
+					size_type pos = position_of(keys[grouped[i]], pilot);
+					ok = not taken[pos] and std::find(positions.begin(), positions.end(), pos) == positions.end();
+					positions.push_back(pos);
+				}
+				if(ok)
+					break;
+			}
+			pilots_[g] = pilot;
+			for(size_type i = first; i < last; ++i)
+			{
+				taken[positions[i - first]] = true;
+				key_slot[grouped[i]] = positions[i - first];
+			}
+		}
+		// Send the positions past the end to the free slots before it.
+		remap_.assign(table_size_ - slot_count_, 0u);
+		size_type free_slot = 0;
+		for(size_type pos = slot_count_; pos < table_size_; ++pos)
+		{
+			if(not taken[pos])
+				continue;
+			while(taken[free_slot])
+				++free_slot;
+			remap_[pos - slot_count_] = free_slot;
+			taken[free_slot] = true;
+		}
+		for(auto& s: key_slot)
+		{
+			if(s >= slot_count_)
+				s = remap_[s - slot_count_];
+		}
+		return true;
+	}
+
+	void destroy_nodes() noexcept
+	{
+		for(auto& slot: slots_)
+		{
+			for(value_type* node = std::exchange(slot.node, nullptr); node;)
+			{
+				value_type* next = node->next;
+				if(std::binary_search(heap_nodes_.begin(), heap_nodes_.end(), node))
+					delete node;
+				else
+					node->~value_type();
+				node = next;
+			}
+		}
+		heap_nodes_.clear();
+		size_ = 0;
+	}
+
+	value_type* copy_node(const value_type& value)
+	{
+		heap_nodes_.reserve(heap_nodes_.size() + 1u);
+		value_type* node = value.clone(arena_).release();
+		if(not arena_.allocated_last(node))
+		{
+			// Over-aligned types don't go through the node allocator.
+			heap_nodes_.insert(std::upper_bound(heap_nodes_.begin(), heap_nodes_.end(), node), node);
+		}
+		return node;
+	}
+
+	HashFn hasher_;
+	KeyEqual key_eq_;
+	std::size_t seed_ = 0;
+	size_type slot_count_ = 0;
+	size_type table_size_ = 0;
+	size_type size_ = 0;
+	std::vector<std::uint32_t, pilot_allocator> pilots_;
+	// Each slot's elements are linked through AnyValue::next.
+	std::vector<Slot, slot_allocator> slots_;
+	std::vector<size_type, size_vector_allocator> remap_;
+	// Sorted.
+	std::vector<value_type*> heap_nodes_;
+	detail::ArenaNodeAllocator<Allocator> arena_;
+};
+
+} /* namespace te */
+
+#endif /* FROZEN_ANY_SET_H */
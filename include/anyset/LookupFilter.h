@@ -0,0 +1,334 @@
+#ifndef LOOKUP_FILTER_H
+#define LOOKUP_FILTER_H
+
+#ifdef _MSC_VER
+# include <iso646.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <cassert>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+/// @file LookupFilter.h
+/// The optional lookup filter of AnySet.
+///
+/// AnySet::enable_lookup_filter() gives a set a blocked Bloom filter over the hash codes of
+/// its elements.  Lookups of values that aren't in the set are then usually answered by the
+/// filter alone.  LookupFilterOptions configures the filter, and AnySet::lookup_filter_stats()
+/// describes it with a LookupFilterStats.
+
+namespace te {
+
+/**
+ * @brief Options for AnySet::enable_lookup_filter().
+ */
+struct LookupFilterOptions
+{
+	/// False-positive rate that the filter is sized for.  Must be in (0, 1).
+	double false_positive_rate = 0.01;
+	/// Upper bound on the memory used by the filter, in bytes, or 0 for no bound.  A filter that
+	/// would be larger is made as large as allowed and has a higher false-positive rate.
+	std::size_t max_bytes = 0;
+};
+
+/**
+ * @brief Description of the lookup filter of an AnySet, as returned by
+ *        AnySet::lookup_filter_stats().
+ */
+struct LookupFilterStats
+{
+	/// Whether the set has a lookup filter.  If not, the other members are all zero.
+	bool enabled = false;
+	/// Bytes of memory used by the filter's bit array.
+	std::size_t memory_bytes = 0;
+	/// Number of elements the filter can hold before it is rebuilt larger.
+	std::size_t capacity = 0;
+	/// Number of bits set for each element.
+	std::size_t hash_count = 0;
+	/// Number of erased elements whose bits are still set.  Cleared when the filter is rebuilt.
+	std::size_t stale_count = 0;
+	/// LookupFilterOptions::false_positive_rate.
+	double target_false_positive_rate = 0.0;
+	/// Expected false-positive rate of the filter as it is now, counting stale elements.
+	double expected_false_positive_rate = 0.0;
+};
+
+} /* namespace te */
+
+/// @internal
+namespace te::detail {
+
+/**
+ * @brief Blocked Bloom filter over the hash codes of the elements of an AnySet.
+ *
+ * The bit array is split into 512-bit blocks, one cache line each.  A hash code picks one block
+ * and sets (or tests) all of its bits within that block, so a lookup reads a single cache line
+ * no matter how many bits are used per element.  Elements can't be removed; erasures are only
+ * counted, and the owning set rebuilds the filter from its elements when they pile up.
+ *
+ * @tparam Allocator - Allocator type; rebound for the block array.
+ */
+template <class Allocator>
+struct BlockedBloomFilter
+{
+	using size_type = std::size_t;
+
+	static constexpr const size_type block_bits = 512;
+	/// Smallest capacity the filter is built with.
+	static constexpr const size_type min_capacity = 64;
+	static constexpr const unsigned max_hash_count = 16;
+
+private:
+	struct alignas(64) Block {
+		std::uint64_t words[block_bits / 64];
+	};
+
+	using alloc_traits = std::allocator_traits<Allocator>;
+	using block_allocator = typename alloc_traits::template rebind_alloc<Block>;
+	using block_vector = std::vector<Block, block_allocator>;
+
+public:
+	explicit BlockedBloomFilter(const Allocator& alloc):
+		blocks_(block_allocator(alloc))
+	{
+
+	}
+
+	/**
+	 * @brief Make an empty filter, configured with @p options, that can hold @p expected elements.
+	 */
+	BlockedBloomFilter(const LookupFilterOptions& options, size_type expected, const Allocator& alloc):
+		blocks_(block_allocator(alloc)),
+		options_(options)
+	{
+		assert(options.false_positive_rate > 0.0 and options.false_positive_rate < 1.0);
+		capacity_ = std::max(expected, min_capacity);
+		// Start from the size and hash count of a classic Bloom filter with the target rate.
+		// Blocks are unevenly loaded, which costs some accuracy, so add blocks until the 
+		// expected rate at capacity meets the target.
+		const double ln2 = std::log(2.0);
+		const double bits_per_element = -std::log(options.false_positive_rate) / (ln2 * ln2);
+		hash_count_ = static_cast<unsigned>(std::lround(bits_per_element * ln2));
+		hash_count_ = std::clamp(hash_count_, 1u, max_hash_count);
+		const double capacity = static_cast<double>(capacity_);
+		double block_count = std::ceil(bits_per_element * capacity / block_bits);
+		while(false_positive_rate(capacity / block_count, hash_count_) > options.false_positive_rate)
+			block_count = std::ceil(block_count * 1.0625);
+		if(options.max_bytes != 0u)
+			block_count = std::min(block_count, static_cast<double>(options.max_bytes / sizeof(Block)));
+		blocks_.assign(std::max(static_cast<size_type>(block_count), size_type(1)), Block{});
+	}
+
+	BlockedBloomFilter(const BlockedBloomFilter& other, const Allocator& alloc):
+		blocks_(other.blocks_, block_allocator(alloc)),
+		options_(other.options_),
+		capacity_(other.capacity_),
+		count_(other.count_),
+		stale_(other.stale_),
+		hash_count_(other.hash_count_)
+	{
+
+	}
+
+	BlockedBloomFilter(BlockedBloomFilter&& other) noexcept:
+		blocks_(std::move(other.blocks_)),
+		options_(other.options_),
+		capacity_(std::exchange(other.capacity_, 0u)),
+		count_(std::exchange(other.count_, 0u)),
+		stale_(std::exchange(other.stale_, 0u)),
+		hash_count_(std::exchange(other.hash_count_, 0u))
+	{
+		other.blocks_.clear();
+	}
+
+	BlockedBloomFilter(BlockedBloomFilter&& other, const Allocator& alloc):
+		blocks_(std::move(other.blocks_), block_allocator(alloc)),
+		options_(other.options_),
+		capacity_(std::exchange(other.capacity_, 0u)),
+		count_(std::exchange(other.count_, 0u)),
+		stale_(std::exchange(other.stale_, 0u)),
+		hash_count_(std::exchange(other.hash_count_, 0u))
+	{
+		other.blocks_.clear();
+	}
+
+	BlockedBloomFilter& operator=(BlockedBloomFilter&& other) noexcept(
+		std::is_nothrow_move_assignable_v<block_vector>
+	)
+	{
+		blocks_ = std::move(other.blocks_);
+		options_ = other.options_;
+		capacity_ = std::exchange(other.capacity_, 0u);
+		count_ = std::exchange(other.count_, 0u);
+		stale_ = std::exchange(other.stale_, 0u);
+		hash_count_ = std::exchange(other.hash_count_, 0u);
+		other.blocks_.clear();
+		return *this;
+	}
+
+	friend void swap(BlockedBloomFilter& left, BlockedBloomFilter& right) noexcept
+	{
+		using std::swap;
+		left.blocks_.swap(right.blocks_);
+		swap(left.options_, right.options_);
+		swap(left.capacity_, right.capacity_);
+		swap(left.count_, right.count_);
+		swap(left.stale_, right.stale_);
+		swap(left.hash_count_, right.hash_count_);
+	}
+
+	bool enabled() const noexcept
+	{ return not blocks_.empty(); }
+
+	const LookupFilterOptions& options() const noexcept
+	{ return options_; }
+
+	/// Free the bit array.  may_contain() returns true for everything afterwards.
+	void disable() noexcept
+	{
+		blocks_.clear();
+		blocks_.shrink_to_fit();
+		capacity_ = count_ = stale_ = 0u;
+		hash_count_ = 0u;
+	}
+
+	/// Clear every bit without reallocating.
+	void clear() noexcept
+	{
+		std::fill(blocks_.begin(), blocks_.end(), Block{});
+		count_ = stale_ = 0u;
+	}
+
+	/// Set the bits of @p hash.  The filter must be enabled.
+	void insert(std::size_t hash) noexcept
+	{
+		assert(enabled());
+		const std::uint64_t mixed = mix(hash);
+		Block& block = blocks_[block_index(mixed)];
+		for_each_bit(mixed, [&](unsigned bit) {
+			block.words[bit / 64u] |= std::uint64_t(1) << (bit % 64u);
+			return true;
+		});
+		++count_;
+	}
+
+	/// Returns false if no element with hash code @p hash was inserted.  Always true when disabled.
+	bool may_contain(std::size_t hash) const noexcept
+	{
+		if(not enabled())
+			return true;
+		const std::uint64_t mixed = mix(hash);
+		const Block& block = blocks_[block_index(mixed)];
+		return for_each_bit(mixed, [&](unsigned bit) {
+			return ((block.words[bit / 64u] >> (bit % 64u)) & 1u) != 0u;
+		});
+	}
+
+	/// Note that an inserted element was erased.  Its bits stay set.
+	void note_removal() noexcept
+	{
+		if(enabled())
+			++stale_;
+	}
+
+	/// True if the filter is full, or if more of its elements were erased than remain.
+	bool needs_rebuild() const noexcept
+	{ return count_ >= capacity_ or stale_ > count_ - stale_; }
+
+	LookupFilterStats stats() const noexcept
+	{
+		LookupFilterStats s;
+		if(not enabled())
+			return s;
+		s.enabled = true;
+		s.memory_bytes = blocks_.size() * sizeof(Block);
+		s.capacity = capacity_;
+		s.hash_count = hash_count_;
+		s.stale_count = stale_;
+		s.target_false_positive_rate = options_.false_positive_rate;
+		s.expected_false_positive_rate = expected_false_positive_rate();
+		return s;
+	}
+
+private:
+
+	static std::uint64_t mix(std::uint64_t h) noexcept
+	{
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ull;
+		h ^= h >> 33;
+		return h;
+	}
+
+	size_type block_index(std::uint64_t mixed) const noexcept
+	{
+		// Map the high half of the hash onto [0, block count) without a division.
+		return static_cast<size_type>(((mixed >> 32) * static_cast<std::uint64_t>(blocks_.size())) >> 32);
+	}
+
+	// Call 'f' with each of the hash_count_ bit positions of 'mixed' within its block until it
+	// returns false.  Each position is the top bits of the low half of the hash times a 
+	// different odd constant.
+	template <class F>
+	bool for_each_bit(std::uint64_t mixed, F f) const noexcept
+	{
+		static constexpr const std::uint32_t salts[max_hash_count] = {
+			0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+			0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u,
+			0x9e3779b1u, 0x85ebca77u, 0xc2b2ae3du, 0x27d4eb2fu,
+			0x165667b1u, 0xd3a2646du, 0xfd7046c5u, 0xb55a4f09u
+		};
+		const auto lo = static_cast<std::uint32_t>(mixed);
+		for(unsigned i = 0; i < hash_count_; ++i)
+		{
+			if(not f(static_cast<unsigned>(static_cast<std::uint32_t>(lo * salts[i]) >> 23)))
+				return false;
+		}
+		return true;
+	}
+
+	double expected_false_positive_rate() const noexcept
+	{
+		return false_positive_rate(
+			static_cast<double>(count_) / static_cast<double>(blocks_.size()), hash_count_
+		);
+	}
+
+	// Average false-positive rate over blocks that hold 'lambda' elements on average.  Block
+	// loads are roughly Poisson distributed.
+	static double false_positive_rate(double lambda, unsigned hash_count) noexcept
+	{
+		if(lambda <= 0.0)
+			return 0.0;
+		const double k = hash_count;
+		const double miss = 1.0 - 1.0 / block_bits;
+		const double spread = 10.0 * std::sqrt(lambda) + 10.0;
+		double rate = 0.0;
+		for(double j = std::max(std::floor(lambda - spread), 0.0); j <= lambda + spread; j += 1.0)
+		{
+			const double p = std::exp(j * std::log(lambda) - lambda - std::lgamma(j + 1.0));
+			rate += p * std::pow(1.0 - std::pow(miss, k * j), k);
+		}
+		return std::min(rate, 1.0);
+	}
+
+	block_vector blocks_;
+	LookupFilterOptions options_;
+	size_type capacity_{0};
+	size_type count_{0};
+	size_type stale_{0};
+	unsigned hash_count_{0};
+};
+
+} /* namespace te::detail */
+/// @endinternal
+
+#endif /* LOOKUP_FILTER_H */
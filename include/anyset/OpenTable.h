@@ -0,0 +1,440 @@
+#ifndef OPEN_TABLE_H
+#define OPEN_TABLE_H
+
+#ifdef _MSC_VER
+# include <iso646.h>
+# include <intrin.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+# include <emmintrin.h>
+# define ANYSET_OPEN_TABLE_SSE2 1
+#endif
+
+/// @internal
+namespace te::detail {
+
+/// Index of the lowest set bit in @p mask.  @p mask must be nonzero.
+inline unsigned lowest_set_bit(std::uint32_t mask) noexcept
+{
+	assert(mask != 0u);
+#if defined(__GNUC__) || defined(__clang__)
+	return static_cast<unsigned>(__builtin_ctz(mask));
+#elif defined(_MSC_VER)
+	unsigned long idx = 0;
+	_BitScanForward(&idx, mask);
+	return static_cast<unsigned>(idx);
+#else
+	unsigned idx = 0;
+	while(not (mask & 1u))
+	{
+		mask >>= 1;
+		++idx;
+	}
+	return idx;
+#endif
+}
+
+/// Hint that the memory at @p addr is about to be read.  Never faults.
+inline void prefetch(const void* addr) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+	__builtin_prefetch(addr);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	_mm_prefetch(static_cast<const char*>(addr), _MM_HINT_T0);
+#else
+	(void)addr;
+#endif
+}
+
+/**
+ * @brief A group of 16 control bytes from an OpenTable.
+ *
+ * Each query returns a bitmask whose ith bit is set if the ith control byte matches.
+ * Uses SSE2 when it is available, and a portable SWAR (SIMD-within-a-register)
+ * implementation over two 64-bit words otherwise.
+ */
+struct ControlGroup
+{
+	static constexpr const std::size_t width = 16;
+	/// Control byte of a slot that has never held an element.
+	static constexpr const std::uint8_t empty = 0x80u;
+	/// Control byte of a slot whose element was erased (tombstone).
+	static constexpr const std::uint8_t deleted = 0xFEu;
+
+	explicit ControlGroup(const std::uint8_t* ctrl) noexcept
+	{
+#ifdef ANYSET_OPEN_TABLE_SSE2
+		ctrl_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+		std::memcpy(&lo_, ctrl, sizeof(lo_));
+		std::memcpy(&hi_, ctrl + sizeof(lo_), sizeof(hi_));
+#endif
+	}
+
+	/// Match full slots whose 7-bit fingerprint is @p h2.
+	std::uint32_t match(std::uint8_t h2) const noexcept
+	{ return match_byte(h2); }
+
+	/// Match slots that have never been occupied.
+	std::uint32_t match_empty() const noexcept
+	{ return match_byte(empty); }
+
+	/// Match slots that are either empty or deleted (high bit set).
+	std::uint32_t match_empty_or_deleted() const noexcept
+	{
+#ifdef ANYSET_OPEN_TABLE_SSE2
+		return static_cast<std::uint32_t>(_mm_movemask_epi8(ctrl_));
+#else
+		return msbs_to_mask(lo_ & msbs) | (msbs_to_mask(hi_ & msbs) << 8);
+#endif
+	}
+
+private:
+
+	std::uint32_t match_byte(std::uint8_t b) const noexcept
+	{
+#ifdef ANYSET_OPEN_TABLE_SSE2
+		auto needle = _mm_set1_epi8(static_cast<char>(b));
+		return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(needle, ctrl_)));
+#else
+		return msbs_to_mask(zero_bytes(lo_ ^ (lsbs * b)))
+			| (msbs_to_mask(zero_bytes(hi_ ^ (lsbs * b))) << 8);
+#endif
+	}
+
+#ifdef ANYSET_OPEN_TABLE_SSE2
+	__m128i ctrl_;
+#else
+	static constexpr const std::uint64_t lsbs = 0x0101010101010101ull;
+	static constexpr const std::uint64_t msbs = 0x8080808080808080ull;
+	static constexpr const std::uint64_t lows = 0x7f7f7f7f7f7f7f7full;
+
+	// Set the high bit of every byte in 'x' that is zero.  Exact (no false positives).
+	static std::uint64_t zero_bytes(std::uint64_t x) noexcept
+	{ return ~(((x & lows) + lows) | x | lows); }
+
+	// Gather the high bit of each byte of 'x' into the low 8 bits of the result.
+	static std::uint32_t msbs_to_mask(std::uint64_t x) noexcept
+	{ return static_cast<std::uint32_t>((((x >> 7) & lsbs) * 0x0102040810204080ull) >> 56); }
+
+	std::uint64_t lo_;
+	std::uint64_t hi_;
+#endif
+};
+
+/**
+ * @brief Swiss-table style open-addressed index over the nodes of an AnySet.
+ *
+ * Slots are split into groups of ControlGroup::width.  Each slot has a control byte that is
+ * either ControlGroup::empty, ControlGroup::deleted, or the low 7 bits of the element's mixed
+ * hash code.  Lookups compare a whole group's control bytes at once and only touch the slots
+ * (and the nodes that they point to) whose fingerprints match.  Groups are probed
+ * triangularly, which visits every group when the group count is a power of two.
+ *
+ * The table stores, along with each node pointer, the position of the node in the owning
+ * set's linked list so that iterators can be produced without walking the list.  Keeping
+ * those positions up to date is the owning set's job.
+ *
+ * @tparam Node      - Type of the indexed nodes.  Must have a 'hash' member.
+ * @tparam Position  - Type of the list position stored with each node.
+ * @tparam Allocator - Allocator type; rebound for the control byte and slot arrays.
+ * @tparam Mixer     - Stateless function object applied to hash codes before they are split 
+ *                     into a group index and a fingerprint.  Every bit of its result should 
+ *                     depend on every bit of the key.
+ */
+template <class Node, class Position, class Allocator, class Mixer>
+struct OpenTable
+{
+	struct Slot {
+		Node* node;
+		Position pos;
+	};
+
+	using size_type = std::size_t;
+	using allocator_type = Allocator;
+
+	static constexpr const size_type npos = ~size_type(0);
+	static constexpr const size_type group_width = ControlGroup::width;
+	/// Open addressing needs free slots to terminate probes; this is the hard upper bound on the load.
+	static constexpr const float max_load = 0.875f;
+
+private:
+	using alloc_traits = std::allocator_traits<Allocator>;
+	using ctrl_allocator = typename alloc_traits::template rebind_alloc<std::uint8_t>;
+	using slot_allocator = typename alloc_traits::template rebind_alloc<Slot>;
+	using ctrl_vector = std::vector<std::uint8_t, ctrl_allocator>;
+	using slot_vector = std::vector<Slot, slot_allocator>;
+
+public:
+	OpenTable(size_type capacity, const Allocator& alloc):
+		ctrl_(ctrl_allocator(alloc)),
+		slots_(slot_allocator(alloc))
+	{
+		reset(capacity);
+	}
+
+	OpenTable(OpenTable&& other) noexcept:
+		ctrl_(std::move(other.ctrl_)),
+		slots_(std::move(other.slots_)),
+		size_(std::exchange(other.size_, 0u)),
+		tombstones_(std::exchange(other.tombstones_, 0u))
+	{
+
+	}
+
+	OpenTable(OpenTable&& other, const Allocator& alloc):
+		ctrl_(std::move(other.ctrl_), ctrl_allocator(alloc)),
+		slots_(std::move(other.slots_), slot_allocator(alloc)),
+		size_(std::exchange(other.size_, 0u)),
+		tombstones_(std::exchange(other.tombstones_, 0u))
+	{
+		other.ctrl_.clear();
+		other.slots_.clear();
+	}
+
+	OpenTable& operator=(OpenTable&& other) noexcept(
+		std::is_nothrow_move_assignable_v<ctrl_vector> and std::is_nothrow_move_assignable_v<slot_vector>
+	)
+	{
+		ctrl_ = std::move(other.ctrl_);
+		slots_ = std::move(other.slots_);
+		size_ = std::exchange(other.size_, 0u);
+		tombstones_ = std::exchange(other.tombstones_, 0u);
+		other.ctrl_.clear();
+		other.slots_.clear();
+		return *this;
+	}
+
+	/**
+	 * @brief Discard the contents of the table and reallocate it with @p capacity slots.
+	 *        @p capacity must be zero or a power of two that is at least group_width.
+	 *        If allocation fails, the table is unmodified.
+	 */
+	void reset(size_type capacity)
+	{
+		assert((capacity == 0u) or (capacity >= group_width));
+		assert((capacity & (capacity - 1u)) == 0u);
+		ctrl_vector ctrl(capacity, ControlGroup::empty, ctrl_.get_allocator());
+		slot_vector slots(capacity, Slot{nullptr, Position()}, slots_.get_allocator());
+		ctrl_.swap(ctrl);
+		slots_.swap(slots);
+		size_ = 0u;
+		tombstones_ = 0u;
+	}
+
+	/// Mark every slot empty without reallocating.
+	void clear() noexcept
+	{
+		std::fill(ctrl_.begin(), ctrl_.end(), ControlGroup::empty);
+		size_ = 0u;
+		tombstones_ = 0u;
+	}
+
+	/**
+	 * @brief Find the slot whose node satisfies @p pred.
+	 * @param hash - Hash code of the key being searched for.
+	 * @param pred - Predicate invoked on slots whose fingerprint matches @p hash.
+	 * @return Index of the matching slot, or npos.
+	 */
+	template <class Pred>
+	size_type find(std::size_t hash, Pred pred) const
+	{
+		if(capacity() == 0u)
+			return npos;
+		const std::size_t mixed = Mixer{}(hash);
+		const auto h2 = fingerprint(mixed);
+		const size_type gmask = group_count() - 1u;
+		size_type group = home_group(mixed);
+		for(size_type step = 0; step < group_count(); )
+		{
+			const size_type base = group * group_width;
+			ControlGroup g(ctrl_.data() + base);
+			for(std::uint32_t bits = g.match(h2); bits != 0u; bits &= (bits - 1u))
+			{
+				size_type idx = base + lowest_set_bit(bits);
+				if(pred(slots_[idx]))
+					return idx;
+			}
+			if(g.match_empty() != 0u)
+				return npos;
+			++step;
+			group = (group + step) & gmask;
+		}
+		return npos;
+	}
+
+	/**
+	 * @brief Prefetch the control bytes and slots that a find() for @p hash probes first.
+	 */
+	void prefetch_group(std::size_t hash) const noexcept
+	{
+		if(capacity() == 0u)
+			return;
+		const size_type base = home_group(Mixer{}(hash)) * group_width;
+		detail::prefetch(ctrl_.data() + base);
+		detail::prefetch(slots_.data() + base);
+	}
+
+	/**
+	 * @brief Prefetch the node in the first slot of @p hash's home group whose fingerprint matches.
+	 *        Call after prefetch_group().
+	 */
+	void prefetch_node(std::size_t hash) const noexcept
+	{
+		if(capacity() == 0u)
+			return;
+		const std::size_t mixed = Mixer{}(hash);
+		const size_type base = home_group(mixed) * group_width;
+		if(std::uint32_t bits = ControlGroup(ctrl_.data() + base).match(fingerprint(mixed)); bits != 0u)
+			detail::prefetch(slots_[base + lowest_set_bit(bits)].node);
+	}
+
+	/// Find the slot that holds @p node.  @p node must be in the table.
+	size_type find_node(const Node* node) const
+	{
+		auto idx = find(node->hash, [node](const Slot& s) { return s.node == node; });
+		assert(idx != npos);
+		return idx;
+	}
+
+	/**
+	 * @brief Get the index of the slot that insert() would place an element with
+	 *        hash code @p hash into.  There must be at least one free slot.
+	 */
+	size_type insert_position(std::size_t hash) const
+	{
+		assert(capacity() > size_ + tombstones_);
+		const std::size_t mixed = Mixer{}(hash);
+		const size_type gmask = group_count() - 1u;
+		size_type group = home_group(mixed);
+		for(size_type step = 0; ; )
+		{
+			const size_type base = group * group_width;
+			ControlGroup g(ctrl_.data() + base);
+			if(auto bits = g.match_empty_or_deleted(); bits != 0u)
+				return base + lowest_set_bit(bits);
+			++step;
+			assert(step < group_count());
+			group = (group + step) & gmask;
+		}
+	}
+
+	/**
+	 * @brief Insert @p node at list position @p pos.  The caller is responsible for ensuring that
+	 *        no equivalent node is already present and that a free slot exists.
+	 * @return The index of the slot used.
+	 */
+	size_type insert(std::size_t hash, Node* node, Position pos) noexcept
+	{
+		size_type idx = insert_position(hash);
+		if(ctrl_[idx] == ControlGroup::deleted)
+			--tombstones_;
+		ctrl_[idx] = fingerprint(Mixer{}(hash));
+		slots_[idx] = Slot{node, pos};
+		++size_;
+		return idx;
+	}
+
+	/**
+	 * @brief Remove the node in slot @p idx.
+	 *
+	 * Groups are probed as a unit, so a probe only ever passes over a group that had no empty
+	 * slots at the time.  If the slot's group still has an empty slot, then no probe sequence
+	 * relies on this slot being occupied and it can be marked empty instead of deleted.
+	 */
+	void erase(size_type idx) noexcept
+	{
+		assert(is_full(idx));
+		const size_type base = idx - (idx % group_width);
+		if(ControlGroup(ctrl_.data() + base).match_empty() != 0u)
+		{
+			ctrl_[idx] = ControlGroup::empty;
+		}
+		else
+		{
+			ctrl_[idx] = ControlGroup::deleted;
+			++tombstones_;
+		}
+		--size_;
+	}
+
+	bool is_full(size_type idx) const noexcept
+	{
+		assert(idx < capacity());
+		return not (ctrl_[idx] & 0x80u);
+	}
+
+	Slot& slot(size_type idx) noexcept
+	{
+		assert(is_full(idx));
+		return slots_[idx];
+	}
+
+	const Slot& slot(size_type idx) const noexcept
+	{
+		assert(is_full(idx));
+		return slots_[idx];
+	}
+
+	/// Number of slots.
+	size_type capacity() const noexcept
+	{ return ctrl_.size(); }
+
+	/// Number of full slots.
+	size_type size() const noexcept
+	{ return size_; }
+
+	/// Number of deleted slots.
+	size_type tombstones() const noexcept
+	{ return tombstones_; }
+
+	size_type max_size() const noexcept
+	{ return std::min(ctrl_.max_size(), slots_.max_size()); }
+
+	allocator_type get_allocator() const
+	{ return allocator_type(ctrl_.get_allocator()); }
+
+	void swap(OpenTable& other) noexcept
+	{
+		using std::swap;
+		ctrl_.swap(other.ctrl_);
+		slots_.swap(other.slots_);
+		swap(size_, other.size_);
+		swap(tombstones_, other.tombstones_);
+	}
+
+	friend void swap(OpenTable& left, OpenTable& right) noexcept
+	{ left.swap(right); }
+
+private:
+	static std::uint8_t fingerprint(std::size_t mixed) noexcept
+	{ return static_cast<std::uint8_t>(mixed & 0x7fu); }
+
+	size_type group_count() const noexcept
+	{ return capacity() / group_width; }
+
+	/// The first group that probes for a key with mixed hash code @p mixed visit.
+	size_type home_group(std::size_t mixed) const noexcept
+	{ return (mixed >> 7) & (group_count() - 1u); }
+
+	ctrl_vector ctrl_;
+	slot_vector slots_;
+	size_type size_{0u};
+	size_type tombstones_{0u};
+};
+
+} /* namespace te::detail */
+/// @endinternal
+
+#endif /* OPEN_TABLE_H */
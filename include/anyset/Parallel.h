@@ -0,0 +1,143 @@
+#ifndef ANY_SET_PARALLEL_H
+#define ANY_SET_PARALLEL_H
+
+#ifdef _MSC_VER
+# include <iso646.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/// @file Parallel.h
+/// Execution policies for the parallel overloads of AnySet operations.
+///
+/// An execution policy is any object with the two const member functions
+/// * `std::size_t concurrency()` - the number of tasks worth running at once, and
+/// * `void run(std::size_t task_count, Task&& task)` - call `task(i)` for every
+///   `i` in `[0, task_count)`, possibly concurrently, and return when all calls
+///   have returned.  If any call throws, rethrow one of the exceptions.
+///
+/// te::par runs tasks on std::threads that it starts for each call.  To use an
+/// existing thread pool instead, pass an object that submits the tasks to the
+/// pool from run().
+///
+/// @note These are not the standard execution policies.  With libstdc++, including
+///       `<execution>` requires linking against TBB, which AnySet does not otherwise need.
+
+namespace te {
+
+/**
+ * @brief Execution policy that runs tasks on std::threads started for each call to run().
+ */
+struct ParallelPolicy
+{
+	/// Use std::thread::hardware_concurrency() threads.
+	constexpr ParallelPolicy() noexcept = default;
+
+	/// Use @p thread_count threads, including the calling thread.  0 means
+	/// std::thread::hardware_concurrency().
+	explicit constexpr ParallelPolicy(std::size_t thread_count) noexcept:
+		thread_count_(thread_count)
+	{
+
+	}
+
+	/// Get the number of threads that run() uses, including the calling thread.
+	std::size_t concurrency() const noexcept
+	{
+		if(thread_count_ > 0u)
+			return thread_count_;
+		return std::max<std::size_t>(std::thread::hardware_concurrency(), 1u);
+	}
+
+	/**
+	 * @brief Call @p task with every index in [0, @p task_count).  The calling thread
+	 *        takes part; tasks are handed out to threads one at a time.
+	 *
+	 * If a task throws, no further tasks are started and the first exception is
+	 * rethrown once every thread has finished.
+	 */
+	template <class Task>
+	void run(std::size_t task_count, Task&& task) const
+	{
+		const std::size_t thread_count = std::min(concurrency(), task_count);
+		if(thread_count <= 1u)
+		{
+			for(std::size_t i = 0; i < task_count; ++i)
+				task(i);
+			return;
+		}
+		std::atomic<std::size_t> next{0};
+		std::exception_ptr error;
+		std::mutex error_mutex;
+		auto work = [&]() {
+			try
+			{
+				for(std::size_t i; (i = next.fetch_add(1u, std::memory_order_relaxed)) < task_count;)
+					task(i);
+			}
+			catch(...)
+			{
+				std::lock_guard<std::mutex> lock(error_mutex);
+				if(not error)
+					error = std::current_exception();
+				next.store(task_count, std::memory_order_relaxed);
+			}
+		};
+		std::vector<std::thread> threads;
+		threads.reserve(thread_count - 1u);
+		try
+		{
+			for(std::size_t i = 1; i < thread_count; ++i)
+				threads.emplace_back(work);
+		}
+		catch(...)
+		{
+			// Couldn't start a thread.  Let the ones already running finish.
+			next.store(task_count, std::memory_order_relaxed);
+			for(auto& t: threads)
+				t.join();
+			throw;
+		}
+		work();
+		for(auto& t: threads)
+			t.join();
+		if(error)
+			std::rethrow_exception(error);
+	}
+
+private:
+	std::size_t thread_count_ = 0;
+};
+
+/// Default parallel execution policy.
+inline constexpr const ParallelPolicy par{};
+
+namespace detail {
+
+template <class T, class = void>
+struct is_execution_policy: public std::false_type {};
+
+template <class T>
+struct is_execution_policy<
+	T,
+	std::void_t<
+		decltype(std::size_t(std::declval<const T&>().concurrency())),
+		decltype(std::declval<const T&>().run(std::size_t(0), std::declval<void(&)(std::size_t)>()))
+	>
+>: public std::true_type {};
+
+template <class T>
+inline constexpr const bool is_execution_policy_v = is_execution_policy<std::decay_t<T>>::value;
+
+} /* namespace detail */
+
+} /* namespace te */
+
+#endif /* ANY_SET_PARALLEL_H */
@@ -0,0 +1,1268 @@
+#ifndef PERSISTENT_ANY_SET_H
+#define PERSISTENT_ANY_SET_H
+
+#ifdef _MSC_VER
+# include <iso646.h>
+#endif
+
+#include "AnySet.h"
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+/// @internal
+namespace te::detail {
+
+/// Number of set bits in @p value.
+inline unsigned popcount32(std::uint32_t value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return static_cast<unsigned>(__builtin_popcount(value));
+#else
+	return static_cast<unsigned>(std::bitset<32>(value).count());
+#endif
+}
+
+} /* namespace te::detail */
+/// @endinternal
+
+namespace te {
+
+/**
+ * @brief An immutable, type-erased hash set whose copies share structure.
+ *
+ * PersistentAnySet is a hash array mapped trie (Bagwell, "Ideal Hash Trees") over the cached hash
+ * codes of its elements.  Each level of the trie consumes five bits of the (mixed) hash code and
+ * stores only the children that exist, so that the trie is about log32(size()) levels deep.
+ * Elements whose hash codes are equal share a collision node at the bottom.
+ *
+ * The trie's nodes are reference counted and never modified after they are built.  insert(),
+ * emplace(), and erase() leave the set unchanged and return a new version that shares every
+ * node except those on the path to the change, so a change allocates O(log(size())) memory and
+ * copies no elements.  Copying a PersistentAnySet (taking a snapshot) is O(1).
+ *
+ * Elements are copied only when converting from and to AnySet (see
+ * PersistentAnySet(const AnySet&) and to_any_set()).  The set operations in SetOperations.h
+ * accept PersistentAnySet instances and share the elements of their arguments.
+ *
+ * Reference counts are atomic, so versions that share nodes can be read, copied, and destroyed
+ * by different threads at once.  A single PersistentAnySet object is, like a const AnySet, safe to
+ * read from any number of threads.
+ *
+ * @code
+ * te::PersistentAnySet<> v1;
+ * auto v2 = v1.insert(1).insert(std::string("two"));
+ * auto v3 = v2.erase(1);
+ * // v1 is still empty and v2 still contains 1.
+ * @endcode
+ *
+ * @tparam HashFn    - Hash function, as for AnySet.
+ * @tparam KeyEqual  - Key equality comparator, as for AnySet.
+ * @tparam Allocator - Allocator for the trie's nodes and the elements.
+ */
+template <
+	class HashFn = AnyHash,
+	class KeyEqual = std::equal_to<>,
+	class Allocator = std::allocator<AnyValue<HashFn, KeyEqual>>
+>
+struct PersistentAnySet
+{
+	/// AnyValue.
+	using value_type = AnyValue<HashFn, KeyEqual>;
+	/// Size type.
+	using size_type = std::size_t;
+	/// Difference type.
+	using difference_type = std::ptrdiff_t;
+	/// %Hash function type.
+	using hasher = HashFn;
+	/// Key equality comparator type.
+	using key_equal = KeyEqual;
+	/// Allocator type.
+	using allocator_type = Allocator;
+	/// Reference type.
+	using reference = const value_type&;
+	/// Const reference type.
+	using const_reference = const value_type&;
+	/// Pointer type.
+	using pointer = const value_type*;
+	/// Const pointer type.
+	using const_pointer = const value_type*;
+	/// Node handle type.
+	using node_handle = std::unique_ptr<value_type>;
+
+private:
+	enum class NodeKind: unsigned char { Leaf, Branch, Collision };
+
+	struct Node
+	{
+		explicit Node(NodeKind k) noexcept:
+			kind(k)
+		{
+
+		}
+
+		mutable std::atomic<std::size_t> refs{1};
+		const NodeKind kind;
+	};
+
+	// Owns one element.
+	struct Leaf: Node
+	{
+		explicit Leaf(value_type* v) noexcept:
+			Node(NodeKind::Leaf), value(v)
+		{
+
+		}
+
+		value_type* const value;
+	};
+
+	// The children follow the header, one for each bit set in 'bitmap', ordered by bit.
+	struct Branch: Node
+	{
+		explicit Branch(std::uint32_t b) noexcept:
+			Node(NodeKind::Branch), bitmap(b)
+		{
+
+		}
+
+		Node** children() noexcept
+		{ return reinterpret_cast<Node**>(this + 1); }
+
+		Node* const* children() const noexcept
+		{ return reinterpret_cast<Node* const*>(this + 1); }
+
+		unsigned size() const noexcept
+		{ return detail::popcount32(bitmap); }
+
+		const std::uint32_t bitmap;
+	};
+
+	// Two or more leaves whose elements have the same hash code.  The leaves follow the header.
+	struct Collision: Node
+	{
+		explicit Collision(std::uint32_t c) noexcept:
+			Node(NodeKind::Collision), count(c)
+		{
+
+		}
+
+		Leaf** leaves() noexcept
+		{ return reinterpret_cast<Leaf**>(this + 1); }
+
+		Leaf* const* leaves() const noexcept
+		{ return reinterpret_cast<Leaf* const*>(this + 1); }
+
+		unsigned size() const noexcept
+		{ return count; }
+
+		const std::uint32_t count;
+	};
+
+	static_assert(sizeof(Branch) % sizeof(Node*) == 0u and alignof(Branch) <= alignof(Node*));
+	static_assert(sizeof(Collision) % sizeof(Node*) == 0u and alignof(Collision) <= alignof(Node*));
+
+	static constexpr const unsigned bits_per_level = 5;
+	static constexpr const std::size_t level_mask = (std::size_t(1) << bits_per_level) - 1u;
+	static constexpr const unsigned hash_digits = std::numeric_limits<std::size_t>::digits;
+	// Branch levels, plus one for a collision node.
+	static constexpr const unsigned max_depth = (hash_digits + bits_per_level - 1u) / bits_per_level + 1u;
+
+	using hash_mixer = detail::BucketHashMixer<HashFn>;
+
+public:
+	/**
+	 * @brief Forward iterator over the elements of a PersistentAnySet.
+	 *
+	 * Iterators remain valid as long as the set (or any version sharing the node they refer to)
+	 * exists.  They hold a path through the trie, so they are larger than AnySet's iterators.
+	 */
+	struct Iterator
+	{
+		using value_type        = const typename PersistentAnySet::value_type;
+		using reference         = const typename PersistentAnySet::value_type&;
+		using pointer           = const typename PersistentAnySet::value_type*;
+		using difference_type   = std::ptrdiff_t;
+		using iterator_category = std::forward_iterator_tag;
+
+		Iterator() = default;
+
+		reference operator*() const
+		{ return *leaf_->value; }
+
+		pointer operator->() const
+		{ return leaf_->value; }
+
+		Iterator& operator++()
+		{
+			while(depth_ > 0u)
+			{
+				auto& frame = path_[depth_ - 1u];
+				if(++frame.pos < child_count(frame.node))
+				{
+					descend(child_at(frame.node, frame.pos));
+					return *this;
+				}
+				--depth_;
+			}
+			leaf_ = nullptr;
+			return *this;
+		}
+
+		Iterator operator++(int)
+		{
+			auto cpy = *this;
+			++*this;
+			return cpy;
+		}
+
+		friend bool operator==(const Iterator& left, const Iterator& right)
+		{ return left.leaf_ == right.leaf_; }
+
+		friend bool operator!=(const Iterator& left, const Iterator& right)
+		{ return not (left == right); }
+
+	private:
+		struct Frame
+		{
+			const Node* node;
+			unsigned pos;
+		};
+
+		static unsigned child_count(const Node* node) noexcept
+		{
+			if(node->kind == NodeKind::Branch)
+				return static_cast<const Branch*>(node)->size();
+			return static_cast<const Collision*>(node)->size();
+		}
+
+		static const Node* child_at(const Node* node, unsigned pos) noexcept
+		{
+			if(node->kind == NodeKind::Branch)
+				return static_cast<const Branch*>(node)->children()[pos];
+			return static_cast<const Collision*>(node)->leaves()[pos];
+		}
+
+		void push(const Node* node, unsigned pos) noexcept
+		{
+			assert(depth_ < max_depth);
+			path_[depth_++] = Frame{node, pos};
+		}
+
+		// Go to the first leaf under 'node'.
+		void descend(const Node* node) noexcept
+		{
+			while(node->kind != NodeKind::Leaf)
+			{
+				push(node, 0u);
+				node = child_at(node, 0u);
+			}
+			leaf_ = static_cast<const Leaf*>(node);
+		}
+
+		std::array<Frame, max_depth> path_;
+		unsigned depth_ = 0;
+		const Leaf* leaf_ = nullptr;
+		friend struct PersistentAnySet;
+	};
+
+	/// Iterator type.  Persistent sets have no mutable iterators.
+	using iterator = Iterator;
+	/// Const iterator type.
+	using const_iterator = Iterator;
+
+	/// @name Constructors
+	/// @{
+
+	/// Construct an empty set.
+	PersistentAnySet() = default;
+
+	/**
+	 * @brief Construct an empty set.
+	 *
+	 * @param hash  - Hash function for the set.
+	 * @param equal - Key equality comparator for the set.
+	 * @param alloc - Allocator for the set.
+	 */
+	explicit PersistentAnySet(const HashFn& hash, const KeyEqual& equal = KeyEqual(), const Allocator& alloc = Allocator()):
+		hasher_(hash), key_eq_(equal), alloc_(alloc)
+	{
+
+	}
+
+	/**
+	 * @brief Construct a set containing copies of the elements of @p set.
+	 *
+	 * The trie is built bottom-up in one pass, rather than by inserting the elements one at a
+	 * time.
+	 *
+	 * @param set   - The set to copy.
+	 * @param alloc - Allocator for the set.
+	 *
+	 * @note Throws te::NoCopyConstructorError if @p set contains an element whose type is not
+	 *       copy constructible.
+	 */
+	template <class A, class P>
+	explicit PersistentAnySet(const AnySet<HashFn, KeyEqual, A, P>& set, const Allocator& alloc = Allocator()):
+		hasher_(set.hash_function()), key_eq_(set.key_eq()), alloc_(alloc)
+	{
+		build_from(set);
+	}
+
+	/// Take a snapshot of @p other.  O(1).
+	PersistentAnySet(const PersistentAnySet& other):
+		hasher_(other.hasher_),
+		key_eq_(other.key_eq_),
+		alloc_(other.alloc_),
+		root_(retain(other.root_)),
+		size_(other.size_)
+	{
+
+	}
+
+	/// Move constructor.  @p other is left empty.
+	PersistentAnySet(PersistentAnySet&& other) noexcept:
+		hasher_(other.hasher_),
+		key_eq_(other.key_eq_),
+		alloc_(other.alloc_),
+		root_(std::exchange(other.root_, nullptr)),
+		size_(std::exchange(other.size_, 0u))
+	{
+
+	}
+
+	/**
+	 * @brief Take a snapshot of @p other that uses @p alloc.  O(1) if @p alloc compares equal to
+	 *        other.get_allocator(); otherwise the elements of @p other are copied.
+	 *
+	 * @note Throws te::NoCopyConstructorError if the elements must be copied and @p other 
+	 *       contains an element whose type is not copy constructible.
+	 */
+	PersistentAnySet(const PersistentAnySet& other, const Allocator& alloc):
+		hasher_(other.hasher_), key_eq_(other.key_eq_), alloc_(alloc)
+	{
+		if(alloc_ == other.alloc_)
+		{
+			root_ = retain(other.root_);
+			size_ = other.size_;
+		}
+		else
+		{
+			build_from(other);
+		}
+	}
+
+	/**
+	 * @brief Move constructor that uses @p alloc.  @p other is left empty if @p alloc compares
+	 *        equal to other.get_allocator(); otherwise its elements are copied.
+	 *
+	 * @note Throws te::NoCopyConstructorError if the elements must be copied and @p other 
+	 *       contains an element whose type is not copy constructible.
+	 */
+	PersistentAnySet(PersistentAnySet&& other, const Allocator& alloc):
+		hasher_(other.hasher_), key_eq_(other.key_eq_), alloc_(alloc)
+	{
+		if(alloc_ == other.alloc_)
+		{
+			root_ = std::exchange(other.root_, nullptr);
+			size_ = std::exchange(other.size_, 0u);
+		}
+		else
+		{
+			build_from(other);
+		}
+	}
+
+	/// @} Constructors
+
+	~PersistentAnySet()
+	{ release(root_); }
+
+	/// @name Assignment
+	/// @{
+
+	/**
+	 * @brief Make this set a snapshot of @p other.  O(1), unless the allocator doesn't propagate
+	 *        on copy assignment and compares unequal to that of @p other, in which case the 
+	 *        elements of @p other are copied.
+	 */
+	PersistentAnySet& operator=(const PersistentAnySet& other)
+	{
+		if constexpr(alloc_traits::propagate_on_container_copy_assignment::value)
+		{
+			PersistentAnySet tmp(other);
+			swap_contents<true>(tmp);
+		}
+		else
+		{
+			PersistentAnySet tmp(other, alloc_);
+			swap_contents<false>(tmp);
+		}
+		return *this;
+	}
+
+	/**
+	 * @brief Move assignment operator.  Copies the elements of @p other if the allocator 
+	 *        doesn't propagate on move assignment and compares unequal to that of @p other.
+	 */
+	PersistentAnySet& operator=(PersistentAnySet&& other) noexcept(
+		alloc_traits::propagate_on_container_move_assignment::value
+		or alloc_traits::is_always_equal::value
+	)
+	{
+		if constexpr(alloc_traits::propagate_on_container_move_assignment::value)
+		{
+			PersistentAnySet tmp(std::move(other));
+			swap_contents<true>(tmp);
+		}
+		else
+		{
+			PersistentAnySet tmp(std::move(other), alloc_);
+			swap_contents<false>(tmp);
+		}
+		return *this;
+	}
+
+	/// @} Assignment
+
+	/// @name Iterators
+	/// @{
+
+	/// Get an iterator to the first element.
+	const_iterator begin() const noexcept
+	{
+		const_iterator pos;
+		if(root_)
+			pos.descend(root_);
+		return pos;
+	}
+
+	/// Get an iterator to the first element.
+	const_iterator cbegin() const noexcept
+	{ return begin(); }
+
+	/// Get the past-the-end iterator.
+	const_iterator end() const noexcept
+	{ return const_iterator(); }
+
+	/// Get the past-the-end iterator.
+	const_iterator cend() const noexcept
+	{ return end(); }
+
+	/// @} Iterators
+
+	/// @name Capacity
+	/// @{
+
+	/// Get the number of elements.
+	size_type size() const noexcept
+	{ return size_; }
+
+	/// Check whether the set is empty.
+	bool empty() const noexcept
+	{ return size_ == 0u; }
+
+	/// @} Capacity
+
+	/// @name Modifiers
+	/// Each modifier leaves the set unchanged and returns the new version.
+	/// @{
+
+	/**
+	 * @brief Get a version of the set that also contains @p value.
+	 *
+	 * @param value - The value to insert.  If it is a value_type, the element is copied.
+	 *
+	 * @return A copy of this set if it already contains an element with an equivalent value and
+	 *         type, otherwise a new version that also contains @p value.
+	 */
+	template <class T>
+	[[nodiscard]] PersistentAnySet insert(T&& value) const
+	{
+		if constexpr(std::is_same_v<std::decay_t<T>, value_type>)
+		{
+			if(contains_value(value))
+				return *this;
+			return with_node(clone_node(value));
+		}
+		else
+		{
+			const std::size_t hash_v = hasher_(value);
+			if(find_leaf(Hashed<std::decay_t<T>>(value, hash_v)))
+				return *this;
+			return with_node(make_node<std::decay_t<T>>(hash_v, std::forward<T>(value)));
+		}
+	}
+
+	/**
+	 * @brief Get a version of the set that also contains a @p T constructed from @p args.
+	 *
+	 * The element is constructed before checking whether the set already contains it.
+	 *
+	 * @tparam T - Type of the element to emplace.  Must be a constructible non-reference type.
+	 */
+	template <class T, class ... Args>
+	[[nodiscard]] PersistentAnySet emplace(Args&& ... args) const
+	{
+		static_assert(
+			std::is_same_v<T, std::decay_t<T>>,
+			"Cannot emplace references, arrays, or functions into a PersistentAnySet."
+		);
+		node_handle node = make_node<T>(hasher_, std::forward<Args>(args)...);
+		if(contains_value(*node))
+			return *this;
+		return with_node(std::move(node));
+	}
+
+	/**
+	 * @brief Get a version of the set without the element equal to @p value.
+	 *
+	 * @param value - Value of the element to erase, or a Hashed<T> referring to it.
+	 *
+	 * @return A copy of this set if it doesn't contain such an element, otherwise a new version
+	 *         without it.
+	 */
+	template <class T>
+	[[nodiscard]] PersistentAnySet erase(const T& value) const
+	{
+		const std::size_t hash_v = get_hash_value(value);
+		bool found = false;
+		Node* root = erase_node(root_, 0u, hash_mixer{}(hash_v), hash_v, value, found);
+		if(not found)
+			return *this;
+		return PersistentAnySet(*this, root, size_ - 1u);
+	}
+
+	/**
+	 * @brief Get a version of the set without the elements for which @p pred returns true.
+	 *
+	 * @param pred - Unary predicate taking a const value_type&.
+	 */
+	template <class Pred>
+	[[nodiscard]] PersistentAnySet erase_if(Pred pred) const
+	{
+		std::vector<const value_type*> doomed;
+		for(const auto& v: *this)
+		{
+			if(pred(v))
+				doomed.push_back(std::addressof(v));
+		}
+		PersistentAnySet result(*this);
+		for(const value_type* v: doomed)
+			result = result.erase(*v);
+		return result;
+	}
+
+	/**
+	 * @brief Get the union of this set and @p other.  The elements of @p other are shared, not
+	 *        copied, if the allocators of the two sets compare equal.  Where both sets contain 
+	 *        equivalent elements, this set's is kept.
+	 */
+	[[nodiscard]] PersistentAnySet update(const PersistentAnySet& other) const
+	{
+		// Nodes are released with the allocator of the set that holds them, so they can only
+		// be shared between sets whose allocators compare equal.
+		const bool share = alloc_ == other.alloc_;
+		if(empty() and share)
+			return PersistentAnySet(*this, retain(other.root_), other.size_);
+		PersistentAnySet result(*this);
+		for(auto pos = other.begin(); pos != other.end(); ++pos)
+		{
+			if(result.contains_value(*pos))
+				continue;
+			if(share)
+				result = result.with_leaf(const_cast<Leaf*>(retain(pos.leaf_)));
+			else
+				result = result.with_node(clone_node(*pos));
+		}
+		return result;
+	}
+
+	/**
+	 * @brief Swap the contents of this set with @p other.  The allocators are swapped only if 
+	 *        they propagate on swap; otherwise they must compare equal.
+	 */
+	void swap(PersistentAnySet& other) noexcept
+	{
+		if constexpr(not alloc_traits::propagate_on_container_swap::value)
+			assert(alloc_ == other.alloc_);
+		swap_contents<alloc_traits::propagate_on_container_swap::value>(other);
+	}
+
+	/// Swap the contents of @p left and @p right.
+	friend void swap(PersistentAnySet& left, PersistentAnySet& right) noexcept
+	{ left.swap(right); }
+
+	/// @} Modifiers
+
+	/// @name Lookup
+	/// @{
+
+	/**
+	 * @brief Find the element equal to @p value.
+	 *
+	 * @param value - Value to search for.  May also be a value_type or a Hashed<T>.
+	 *
+	 * @return An iterator to the element, or end() if there is none.
+	 */
+	template <class T>
+	const_iterator find(const T& value) const
+	{
+		const_iterator pos;
+		pos.leaf_ = find_leaf(value, &pos);
+		return pos;
+	}
+
+	/// Check whether the set contains an element equal to @p value.
+	template <class T>
+	bool contains(const T& value) const
+	{ return find_leaf(value) != nullptr; }
+
+	/// Count the elements equal to @p value (0 or 1).
+	template <class T>
+	size_type count(const T& value) const
+	{ return static_cast<size_type>(contains(value)); }
+
+	/// Check whether the set contains an element equal to @p any_v.
+	bool contains_value(const value_type& any_v) const
+	{ return contains(any_v); }
+
+	/// @} Lookup
+
+	/// @name Conversion
+	/// @{
+
+	/**
+	 * @brief Copy the elements into a new AnySet.
+	 *
+	 * @tparam TablePolicy - Table policy of the AnySet to create.
+	 */
+	template <class TablePolicy = ChainedBuckets>
+	AnySet<HashFn, KeyEqual, Allocator, TablePolicy> to_any_set() const
+	{
+		AnySet<HashFn, KeyEqual, Allocator, TablePolicy> result(size_, hasher_, key_eq_, alloc_);
+		for(const auto& v: *this)
+			result.push(clone_node(v));
+		return result;
+	}
+
+	/// @} Conversion
+
+	/// @name Observers
+	/// @{
+
+	/// Get a copy of the hash function.
+	hasher hash_function() const
+	{ return hasher_; }
+
+	/// Get a copy of the equality comparison function.
+	key_equal key_eq() const
+	{ return key_eq_; }
+
+	/// Get a copy of the allocator.
+	allocator_type get_allocator() const
+	{ return alloc_; }
+
+	/// Hash @p key with this set's hash function and pair it with the result.  See AnySet::hashed().
+	template <class T>
+	Hashed<T> hashed(const T& key) const
+	{ return Hashed<T>(key, hasher_(key)); }
+
+	template <class T>
+	Hashed<T> hashed(const T&& key) const = delete;
+
+	/// @} Observers
+
+	void _assert_invariants() const
+	{
+		assert((root_ == nullptr) == (size_ == 0u));
+		if(root_)
+			assert(assert_node_invariants(root_, 0u, 0u) == size_);
+	}
+
+	friend bool operator==(const PersistentAnySet& left, const PersistentAnySet& right)
+	{
+		if(left.size() != right.size())
+			return false;
+		if(left.root_ == right.root_)
+			return true;
+		return std::all_of(left.begin(), left.end(), [&](const auto& v) { return right.contains_value(v); });
+	}
+
+	friend bool operator!=(const PersistentAnySet& left, const PersistentAnySet& right)
+	{ return not (left == right); }
+
+private:
+	using alloc_traits = std::allocator_traits<Allocator>;
+	using leaf_allocator = typename alloc_traits::template rebind_alloc<Leaf>;
+	using leaf_traits = std::allocator_traits<leaf_allocator>;
+	using word_allocator = typename alloc_traits::template rebind_alloc<Node*>;
+	using word_traits = std::allocator_traits<word_allocator>;
+
+	static_assert(
+		std::is_same_v<typename leaf_traits::pointer, Leaf*>
+		and std::is_same_v<typename word_traits::pointer, Node**>,
+		"PersistentAnySet does not support fancy pointers."
+	);
+
+	// Nodes are allocated with the set's allocator unless it is just std::allocator, as in AnySet.
+	static constexpr const bool allocated_nodes = not detail::is_std_allocator_v<allocator_type>;
+
+	// Adopt 'root' (already retained) as the root of a version with the same functors as 'other'.
+	PersistentAnySet(const PersistentAnySet& other, Node* root, size_type count) noexcept:
+		hasher_(other.hasher_), key_eq_(other.key_eq_), alloc_(other.alloc_), root_(root), size_(count)
+	{
+
+	}
+
+	template <class T, class HashArg, class ... Args>
+	node_handle make_node(HashArg&& hash_arg, Args&& ... args) const
+	{
+		if constexpr(allocated_nodes)
+		{
+			return make_any_value<T, HashFn, KeyEqual>(
+				std::allocator_arg, alloc_, std::forward<HashArg>(hash_arg), std::forward<Args>(args)...
+			);
+		}
+		else
+		{
+			return make_any_value<T, HashFn, KeyEqual>(
+				std::forward<HashArg>(hash_arg), std::forward<Args>(args)...
+			);
+		}
+	}
+
+	node_handle clone_node(const value_type& value) const
+	{
+		if constexpr(allocated_nodes)
+			return value.clone(detail::NodeAllocator<allocator_type>(alloc_));
+		else
+			return value.clone();
+	}
+
+	template <class T>
+	std::size_t get_hash_value(const T& value) const
+	{
+		if constexpr(std::is_same_v<T, value_type> or detail::is_hashed_v<T>)
+			return value.hash;
+		else
+			return hasher_(value);
+	}
+
+	template <class T>
+	static const T& unwrap_key(const T& value)
+	{ return value; }
+
+	template <class T>
+	static const T& unwrap_key(const Hashed<T>& key)
+	{ return key.value; }
+
+	static std::uint32_t level_bit(std::size_t mixed, unsigned shift) noexcept
+	{ return std::uint32_t(1) << ((mixed >> shift) & level_mask); }
+
+	static std::size_t hash_of(const Node* node) noexcept
+	{
+		if(node->kind == NodeKind::Leaf)
+			return static_cast<const Leaf*>(node)->value->hash;
+		assert(node->kind == NodeKind::Collision);
+		return static_cast<const Collision*>(node)->leaves()[0]->value->hash;
+	}
+
+	template <class T>
+	bool matches(const Leaf* leaf, std::size_t hash_v, const T& key) const
+	{ return leaf->value->hash == hash_v and compare(unwrap_key(key), *leaf->value, key_eq_); }
+
+	// Find the leaf holding the element equal to 'key'.  Records the path in 'pos' if given.
+	template <class T>
+	const Leaf* find_leaf(const T& key, const_iterator* pos = nullptr) const
+	{
+		const std::size_t hash_v = get_hash_value(key);
+		const std::size_t mixed = hash_mixer{}(hash_v);
+		const Node* node = root_;
+		for(unsigned shift = 0; node; shift += bits_per_level)
+		{
+			if(node->kind == NodeKind::Leaf)
+			{
+				const Leaf* leaf = static_cast<const Leaf*>(node);
+				return matches(leaf, hash_v, key) ? leaf : nullptr;
+			}
+			else if(node->kind == NodeKind::Collision)
+			{
+				const Collision* coll = static_cast<const Collision*>(node);
+				if(hash_of(coll) != hash_v)
+					return nullptr;
+				for(unsigned i = 0; i < coll->size(); ++i)
+				{
+					if(matches(coll->leaves()[i], hash_v, key))
+					{
+						if(pos)
+							pos->push(coll, i);
+						return coll->leaves()[i];
+					}
+				}
+				return nullptr;
+			}
+			const Branch* branch = static_cast<const Branch*>(node);
+			const std::uint32_t bit = level_bit(mixed, shift);
+			if(not (branch->bitmap & bit))
+				return nullptr;
+			const unsigned idx = detail::popcount32(branch->bitmap & (bit - 1u));
+			if(pos)
+				pos->push(branch, idx);
+			node = branch->children()[idx];
+		}
+		return nullptr;
+	}
+
+	/// @name Node Management
+	/// @{
+
+	template <class N>
+	static N* retain(N* node) noexcept
+	{
+		if(node)
+			node->refs.fetch_add(1u, std::memory_order_relaxed);
+		return node;
+	}
+
+	void release(const Node* node) const noexcept
+	{
+		if(not node or node->refs.fetch_sub(1u, std::memory_order_acq_rel) != 1u)
+			return;
+		Node* n = const_cast<Node*>(node);
+		switch(n->kind)
+		{
+		case NodeKind::Leaf: {
+			Leaf* leaf = static_cast<Leaf*>(n);
+			delete leaf->value;
+			leaf->~Leaf();
+			leaf_allocator alloc(alloc_);
+			leaf_traits::deallocate(alloc, leaf, 1u);
+			break;
+		}
+		case NodeKind::Branch: {
+			Branch* branch = static_cast<Branch*>(n);
+			const unsigned count = branch->size();
+			for(unsigned i = 0; i < count; ++i)
+				release(branch->children()[i]);
+			branch->~Branch();
+			deallocate_words(branch, sizeof(Branch), count);
+			break;
+		}
+		case NodeKind::Collision: {
+			Collision* coll = static_cast<Collision*>(n);
+			const unsigned count = coll->size();
+			for(unsigned i = 0; i < count; ++i)
+				release(coll->leaves()[i]);
+			coll->~Collision();
+			deallocate_words(coll, sizeof(Collision), count);
+			break;
+		}
+		}
+	}
+
+	void* allocate_words(std::size_t header_size, unsigned count) const
+	{
+		word_allocator alloc(alloc_);
+		return word_traits::allocate(alloc, header_size / sizeof(Node*) + count);
+	}
+
+	void deallocate_words(void* p, std::size_t header_size, unsigned count) const noexcept
+	{
+		word_allocator alloc(alloc_);
+		word_traits::deallocate(alloc, static_cast<Node**>(p), header_size / sizeof(Node*) + count);
+	}
+
+	// Takes ownership of 'node' even if allocation fails.
+	Leaf* make_leaf(node_handle node) const
+	{
+		leaf_allocator alloc(alloc_);
+		Leaf* leaf = leaf_traits::allocate(alloc, 1u);
+		return ::new(static_cast<void*>(leaf)) Leaf(node.release());
+	}
+
+	// The caller fills in the children.
+	Branch* make_branch(std::uint32_t bitmap) const
+	{ return ::new(allocate_words(sizeof(Branch), detail::popcount32(bitmap))) Branch(bitmap); }
+
+	// The caller fills in the leaves.
+	Collision* make_collision(unsigned count) const
+	{ return ::new(allocate_words(sizeof(Collision), count)) Collision(count); }
+
+	/// @} Node Management
+
+	/// @name Path Copying
+	/// Each of these returns a new reference to the node that replaces 'node', retains what it
+	/// shares with 'node', and leaves 'node' itself alone.  Nodes passed by owning reference
+	/// ('leaf', 'child') are released if the function throws.
+	/// @{
+
+	// Insert 'leaf', whose element is not in the trie rooted at 'node'.
+	Node* insert_leaf(Node* node, unsigned shift, std::size_t mixed, Leaf* leaf) const
+	{
+		if(not node)
+			return leaf;
+		if(node->kind == NodeKind::Branch)
+		{
+			Branch* branch = static_cast<Branch*>(node);
+			const std::uint32_t bit = level_bit(mixed, shift);
+			const unsigned idx = detail::popcount32(branch->bitmap & (bit - 1u));
+			if(branch->bitmap & bit)
+			{
+				Node* child = insert_leaf(branch->children()[idx], shift + bits_per_level, mixed, leaf);
+				return replace_child(branch, idx, child);
+			}
+			return add_child(branch, bit, idx, leaf);
+		}
+		const std::size_t other_hash = hash_of(node);
+		if(other_hash == leaf->value->hash)
+			return add_collision(node, leaf);
+		return split(node, hash_mixer{}(other_hash), leaf, mixed, shift);
+	}
+
+	// Make a subtrie that holds both 'existing' and 'leaf', which have different hash codes.
+	Node* split(Node* existing, std::size_t existing_mixed, Leaf* leaf, std::size_t mixed, unsigned shift) const
+	{
+		assert(shift < hash_digits);
+		const std::uint32_t existing_bit = level_bit(existing_mixed, shift);
+		const std::uint32_t bit = level_bit(mixed, shift);
+		if(existing_bit != bit)
+		{
+			Branch* branch;
+			try
+			{
+				branch = make_branch(existing_bit | bit);
+			}
+			catch(...)
+			{
+				release(leaf);
+				throw;
+			}
+			const bool leaf_first = bit < existing_bit;
+			branch->children()[leaf_first ? 0 : 1] = leaf;
+			branch->children()[leaf_first ? 1 : 0] = retain(existing);
+			return branch;
+		}
+		Node* child = split(existing, existing_mixed, leaf, mixed, shift + bits_per_level);
+		Branch* branch;
+		try
+		{
+			branch = make_branch(bit);
+		}
+		catch(...)
+		{
+			release(child);
+			throw;
+		}
+		branch->children()[0] = child;
+		return branch;
+	}
+
+	Node* add_collision(Node* existing, Leaf* leaf) const
+	{
+		const unsigned count = (existing->kind == NodeKind::Leaf) ? 1u : static_cast<Collision*>(existing)->size();
+		Collision* coll;
+		try
+		{
+			coll = make_collision(count + 1u);
+		}
+		catch(...)
+		{
+			release(leaf);
+			throw;
+		}
+		if(existing->kind == NodeKind::Leaf)
+			coll->leaves()[0] = static_cast<Leaf*>(retain(existing));
+		else
+			std::transform(
+				static_cast<Collision*>(existing)->leaves(),
+				static_cast<Collision*>(existing)->leaves() + count,
+				coll->leaves(),
+				[](Leaf* l) { return retain(l); }
+			);
+		coll->leaves()[count] = leaf;
+		return coll;
+	}
+
+	Node* replace_child(Branch* branch, unsigned idx, Node* child) const
+	{
+		Branch* result;
+		try
+		{
+			result = make_branch(branch->bitmap);
+		}
+		catch(...)
+		{
+			release(child);
+			throw;
+		}
+		const unsigned count = branch->size();
+		for(unsigned i = 0; i < count; ++i)
+			result->children()[i] = (i == idx) ? child : retain(branch->children()[i]);
+		return result;
+	}
+
+	Node* add_child(Branch* branch, std::uint32_t bit, unsigned idx, Node* child) const
+	{
+		Branch* result;
+		try
+		{
+			result = make_branch(branch->bitmap | bit);
+		}
+		catch(...)
+		{
+			release(child);
+			throw;
+		}
+		const unsigned count = branch->size();
+		Node** out = result->children();
+		for(unsigned i = 0; i < count; ++i)
+		{
+			if(i == idx)
+				*out++ = child;
+			*out++ = retain(branch->children()[i]);
+		}
+		if(idx == count)
+			*out = child;
+		return result;
+	}
+
+	Node* remove_child(Branch* branch, std::uint32_t bit, unsigned idx) const
+	{
+		Branch* result = make_branch(branch->bitmap & ~bit);
+		const unsigned count = branch->size();
+		Node** out = result->children();
+		for(unsigned i = 0; i < count; ++i)
+		{
+			if(i != idx)
+				*out++ = retain(branch->children()[i]);
+		}
+		return result;
+	}
+
+	// Remove the element equal to 'key'.  Sets 'found' if there is one; otherwise returns null.
+	// Keys are compared before anything is allocated.  A branch left with a single leaf or
+	// collision node is replaced by that node, so the trie stays as shallow as it would be if the
+	// element had never been inserted.
+	template <class T>
+	Node* erase_node(Node* node, unsigned shift, std::size_t mixed, std::size_t hash_v, const T& key, bool& found) const
+	{
+		if(not node)
+			return nullptr;
+		if(node->kind == NodeKind::Leaf)
+		{
+			found = matches(static_cast<Leaf*>(node), hash_v, key);
+			return nullptr;
+		}
+		if(node->kind == NodeKind::Collision)
+		{
+			Collision* coll = static_cast<Collision*>(node);
+			if(hash_of(coll) != hash_v)
+				return nullptr;
+			const unsigned count = coll->size();
+			unsigned idx = 0;
+			while(idx < count and not matches(coll->leaves()[idx], hash_v, key))
+				++idx;
+			if(idx == count)
+				return nullptr;
+			found = true;
+			if(count == 2u)
+				return retain(coll->leaves()[1u - idx]);
+			Collision* result = make_collision(count - 1u);
+			Leaf** out = result->leaves();
+			for(unsigned i = 0; i < count; ++i)
+			{
+				if(i != idx)
+					*out++ = retain(coll->leaves()[i]);
+			}
+			return result;
+		}
+		Branch* branch = static_cast<Branch*>(node);
+		const std::uint32_t bit = level_bit(mixed, shift);
+		if(not (branch->bitmap & bit))
+			return nullptr;
+		const unsigned idx = detail::popcount32(branch->bitmap & (bit - 1u));
+		const unsigned count = branch->size();
+		Node* child = erase_node(branch->children()[idx], shift + bits_per_level, mixed, hash_v, key, found);
+		if(not found)
+			return nullptr;
+		if(child)
+		{
+			if(count == 1u and child->kind != NodeKind::Branch)
+				return child;
+			return replace_child(branch, idx, child);
+		}
+		if(count == 1u)
+			return nullptr;
+		if(count == 2u)
+		{
+			Node* other = branch->children()[1u - idx];
+			if(other->kind != NodeKind::Branch)
+				return retain(other);
+		}
+		return remove_child(branch, bit, idx);
+	}
+
+	/// @} Path Copying
+
+	// Return a new version with 'node' inserted.  The set must not contain an equivalent element.
+	PersistentAnySet with_node(node_handle node) const
+	{ return with_leaf(make_leaf(std::move(node))); }
+
+	// Return a new version with 'leaf' (an owning reference) inserted.
+	PersistentAnySet with_leaf(Leaf* leaf) const
+	{
+		Node* root = insert_leaf(root_, 0u, hash_mixer{}(leaf->value->hash), leaf);
+		return PersistentAnySet(*this, root, size_ + 1u);
+	}
+
+	// Swap everything but, unless 'WithAllocator', the allocators.  Nodes are released with 
+	// the allocator of the set that holds them, so that must not change unless they do.
+	template <bool WithAllocator>
+	void swap_contents(PersistentAnySet& other) noexcept
+	{
+		using std::swap;
+		swap(hasher_, other.hasher_);
+		swap(key_eq_, other.key_eq_);
+		if constexpr(WithAllocator)
+			swap(alloc_, other.alloc_);
+		swap(root_, other.root_);
+		swap(size_, other.size_);
+	}
+
+	// 'set' is an AnySet or PersistentAnySet with the same HashFn and KeyEqual.
+	template <class Set>
+	void build_from(const Set& set)
+	{
+		struct Entry
+		{
+			std::size_t mixed;
+			Leaf* leaf;
+		};
+		std::vector<Entry> entries;
+		entries.reserve(set.size());
+		// 'entries' holds a reference to each leaf until the trie is built.
+		auto release_entries = [&]() {
+			for(const auto& e: entries)
+				release(e.leaf);
+		};
+		try
+		{
+			for(const auto& v: set)
+				entries.push_back(Entry{hash_mixer{}(v.hash), make_leaf(clone_node(v))});
+			std::vector<Entry> buffer(entries.size());
+			root_ = build_level(entries.data(), entries.data() + entries.size(), buffer.data(), 0u);
+		}
+		catch(...)
+		{
+			release_entries();
+			throw;
+		}
+		release_entries();
+		size_ = set.size();
+	}
+
+	// Build the subtrie holding [first, last), all of whose mixed hash codes agree below 'shift'.
+	// 'buffer' is scratch space as large as the range.
+	template <class Entry>
+	Node* build_level(Entry* first, Entry* last, Entry* buffer, unsigned shift) const
+	{
+		const std::size_t count = last - first;
+		if(count == 1u)
+			return retain(first->leaf);
+		if(std::all_of(first + 1, last, [&](const Entry& e) { return e.mixed == first->mixed; }))
+		{
+			Collision* coll = make_collision(static_cast<unsigned>(count));
+			for(std::size_t i = 0; i < count; ++i)
+				coll->leaves()[i] = retain(first[i].leaf);
+			return coll;
+		}
+		// Counting sort on this level's bits.
+		std::array<std::size_t, level_mask + 2u> starts{};
+		for(auto p = first; p != last; ++p)
+			++starts[((p->mixed >> shift) & level_mask) + 1u];
+		std::partial_sum(starts.begin(), starts.end(), starts.begin());
+		{
+			auto next = starts;
+			for(auto p = first; p != last; ++p)
+				buffer[next[(p->mixed >> shift) & level_mask]++] = *p;
+			std::copy(buffer, buffer + count, first);
+		}
+		std::uint32_t bitmap = 0;
+		std::array<Node*, level_mask + 1u> children;
+		unsigned child_count = 0;
+		try
+		{
+			for(std::size_t idx = 0; idx <= level_mask; ++idx)
+			{
+				if(starts[idx] == starts[idx + 1u])
+					continue;
+				bitmap |= std::uint32_t(1) << idx;
+				children[child_count] = build_level(
+					first + starts[idx], first + starts[idx + 1u], buffer + starts[idx], shift + bits_per_level
+				);
+				++child_count;
+			}
+			Branch* branch = make_branch(bitmap);
+			std::copy(children.begin(), children.begin() + child_count, branch->children());
+			return branch;
+		}
+		catch(...)
+		{
+			for(unsigned i = 0; i < child_count; ++i)
+				release(children[i]);
+			throw;
+		}
+	}
+
+	// Check the subtrie at 'node', whose mixed hash codes all have 'prefix' below 'shift'.
+	// Returns the number of elements in it.
+	size_type assert_node_invariants(const Node* node, unsigned shift, std::size_t prefix) const
+	{
+		assert(node->refs.load() > 0u);
+		const std::size_t prefix_mask = (shift >= hash_digits) ? ~std::size_t(0) : ((std::size_t(1) << shift) - 1u);
+		if(node->kind == NodeKind::Leaf)
+		{
+			assert((hash_mixer{}(hash_of(node)) & prefix_mask) == prefix);
+			return 1u;
+		}
+		if(node->kind == NodeKind::Collision)
+		{
+			const Collision* coll = static_cast<const Collision*>(node);
+			assert(coll->size() >= 2u);
+			assert((hash_mixer{}(hash_of(coll)) & prefix_mask) == prefix);
+			for(unsigned i = 0; i < coll->size(); ++i)
+				assert(coll->leaves()[i]->value->hash == hash_of(coll));
+			return coll->size();
+		}
+		const Branch* branch = static_cast<const Branch*>(node);
+		assert(branch->bitmap != 0u);
+		assert(shift < hash_digits);
+		// A leaf or collision node is never the only child of a branch.
+		assert(branch->size() > 1u or branch->children()[0]->kind == NodeKind::Branch);
+		size_type total = 0;
+		for(unsigned i = 0, idx = 0; idx <= level_mask; ++idx)
+		{
+			if(not (branch->bitmap & (std::uint32_t(1) << idx)))
+				continue;
+			total += assert_node_invariants(
+				branch->children()[i++], shift + bits_per_level, prefix | (std::size_t(idx) << shift)
+			);
+		}
+		return total;
+	}
+
+	HashFn hasher_;
+	KeyEqual key_eq_;
+	Allocator alloc_;
+	Node* root_ = nullptr;
+	size_type size_ = 0;
+};
+
+} /* namespace te */
+
+#endif /* PERSISTENT_ANY_SET_H */
@@ -0,0 +1,453 @@
+#ifndef RCU_ANY_SET_H
+#define RCU_ANY_SET_H
+
+#ifdef _MSC_VER
+# include <iso646.h>
+#endif
+
+#include "AnySet.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <thread>
+
+namespace te {
+
+/**
+ * @brief A read-mostly wrapper around AnySet whose readers never wait and never write to memory
+ *        that other threads write to.
+ *
+ * RcuAnySet keeps two copies of the set.  Readers read whichever copy is currently published.
+ * A writer collects changes in a Batch, applies the batch to the unpublished copy, publishes
+ * that copy with a single atomic store, and waits for the readers of the old copy to finish (as
+ * in epoch-based reclamation).  Instead of freeing the old copy, it then applies the same batch
+ * to it, so that the two copies are equal again.  Publishing a batch therefore costs time
+ * proportional to the size of the batch, not the size of the set, and no element that the batch
+ * doesn't change is ever copied.  Each inserted element is constructed once for each copy.
+ *
+ * Each reader thread registers once with make_reader() and gets a Reader, which owns a slot
+ * (on its own cache line) where it announces the epoch it entered at.  Entering and leaving a
+ * read-side critical section (Reader::read()) are a few loads and two stores to that slot.
+ *
+ * @code
+ * te::RcuAnySet<> set;
+ * // Reader threads:
+ * auto reader = set.make_reader();
+ * bool seen = reader.contains(key);
+ * {
+ *     auto view = reader.read();
+ *     for(const auto& v: *view) { ... }
+ * }
+ * // Writer thread:
+ * auto batch = set.make_batch();
+ * batch.insert(1);
+ * batch.erase("abc"s);
+ * set.publish(std::move(batch));
+ * @endcode
+ *
+ * Writers are serialized with a mutex.  Readers must not be used from more than one thread at a
+ * time, must not nest read() sections, and must not outlive the set.
+ *
+ * @tparam HashFn      - The type of the function object to use when computing the hash codes of elements.
+ * @tparam KeyEqual    - The type of the function object to use when comparing elements for equality.
+ * @tparam Allocator   - The type of the allocator of each copy.  See AnySet.
+ * @tparam TablePolicy - The table policy of each copy.  See AnySet.
+ *
+ * @see AnySet - The type of each copy.
+ */
+template <
+	class HashFn = AnyHash,
+	class KeyEqual = std::equal_to<>,
+	class Allocator = std::allocator<AnyValue<HashFn, KeyEqual>>,
+	class TablePolicy = ChainedBuckets
+>
+struct RcuAnySet
+{
+	/// Type of each copy of the set.
+	using set_type = AnySet<HashFn, KeyEqual, Allocator, TablePolicy>;
+	/// AnyValue.
+	using value_type = typename set_type::value_type;
+	/// Size type.
+	using size_type = typename set_type::size_type;
+	/// %Hash function type.
+	using hasher = HashFn;
+	/// Key equality comparator type.
+	using key_equal = KeyEqual;
+	/// Allocator type.
+	using allocator_type = Allocator;
+	/// Type of the nodes that hold elements.  See AnySet::node_handle.
+	using node_handle = typename set_type::node_handle;
+
+private:
+	struct alignas(64) ReaderSlot
+	{
+		// 0 while not reading, otherwise the epoch the reader entered at.
+		std::atomic<std::uint64_t> epoch{0};
+		bool in_use = false;
+	};
+
+public:
+	struct Reader;
+
+	/**
+	 * @brief RAII read-side critical section.  The published copy of the set that it refers to
+	 *        will not be modified until it is destroyed.
+	 */
+	struct ReadGuard
+	{
+		ReadGuard(const ReadGuard&) = delete;
+		ReadGuard& operator=(const ReadGuard&) = delete;
+
+		~ReadGuard()
+		{ slot_->epoch.store(0u, std::memory_order_release); }
+
+		/// Get the published copy of the set.
+		const set_type& operator*() const noexcept
+		{ return *set_; }
+
+		/// Get the published copy of the set.
+		const set_type* operator->() const noexcept
+		{ return set_; }
+
+	private:
+		ReadGuard(const RcuAnySet& owner, ReaderSlot* slot) noexcept:
+			slot_(slot)
+		{
+			assert(slot_->epoch.load(std::memory_order_relaxed) == 0u);
+			// Announce the epoch before looking at which copy is published.  If the writer has
+			// already moved on to the next epoch, it has also already published the new copy.
+			slot_->epoch.store(owner.epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+			set_ = std::addressof(owner.copies_[owner.published_.load(std::memory_order_seq_cst)]);
+		}
+
+		ReaderSlot* slot_;
+		const set_type* set_;
+		friend struct Reader;
+	};
+
+	/**
+	 * @brief A registered reader.  Use one per thread.
+	 */
+	struct Reader
+	{
+		Reader(Reader&& other) noexcept:
+			owner_(std::exchange(other.owner_, nullptr)), slot_(std::exchange(other.slot_, nullptr))
+		{
+
+		}
+
+		Reader& operator=(Reader&& other) noexcept
+		{
+			Reader tmp(std::move(other));
+			std::swap(owner_, tmp.owner_);
+			std::swap(slot_, tmp.slot_);
+			return *this;
+		}
+
+		~Reader()
+		{
+			if(owner_)
+				owner_->release_slot(slot_);
+		}
+
+		/// Enter a read-side critical section.  Wait-free.
+		ReadGuard read() const noexcept
+		{ return ReadGuard(*owner_, slot_); }
+
+		/// Check if the published copy contains @p value.  Wait-free, apart from the lookup itself.
+		template <class T>
+		bool contains(const T& value) const
+		{ return read()->contains(value); }
+
+		/// Count the elements of the published copy that are equal to @p value (0 or 1).
+		template <class T>
+		size_type count(const T& value) const
+		{ return read()->count(value); }
+
+	private:
+		Reader(RcuAnySet& owner, ReaderSlot* slot) noexcept:
+			owner_(std::addressof(owner)), slot_(slot)
+		{
+
+		}
+
+		RcuAnySet* owner_;
+		ReaderSlot* slot_;
+		friend struct RcuAnySet;
+	};
+
+	/**
+	 * @brief A list of changes to publish together.  Operations are applied in the order they
+	 *        were added.
+	 *
+	 * Since the batch is applied to each copy of the set, every inserted element is constructed
+	 * twice up front: once by copying and once by moving the given value.  Inserted types must
+	 * therefore be copy constructible.
+	 */
+	struct Batch
+	{
+		/// Insert @p value.
+		template <class T>
+		void insert(T&& value)
+		{
+			using type = std::decay_t<T>;
+			auto first = make_node<type>(get_hasher(), value);
+			std::size_t hash_v = first->hash;
+			auto second = make_node<type>(hash_v, std::forward<T>(value));
+			ops_.push_back(Op{true, std::move(first), std::move(second)});
+		}
+
+		/// Insert an element constructed from @p args.
+		template <class T, class ... Args>
+		void emplace(Args&& ... args)
+		{
+			static_assert(
+				std::is_same_v<T, std::decay_t<T>>,
+				"Cannot emplace references, arrays, or functions into an RcuAnySet."
+			);
+			auto first = make_node<T>(get_hasher(), std::forward<Args>(args)...);
+			auto second = make_node<T>(first->hash, unsafe_cast<const T&>(*first));
+			ops_.push_back(Op{true, std::move(first), std::move(second)});
+		}
+
+		/// Erase the element equal to @p value, if there is one.
+		template <class T>
+		void erase(const T& value)
+		{ ops_.push_back(Op{false, make_node<T>(get_hasher(), value), nullptr}); }
+
+		/// Insert copies of the elements of @p other.
+		void update(const set_type& other)
+		{
+			// Copy with the set's allocator, not with that of 'other'.
+			set_type copy(other, alloc_);
+			while(not copy.empty())
+			{
+				auto second = copy.dup(copy.cbegin());
+				ops_.push_back(Op{true, std::move(copy.pop(copy.cbegin()).first), std::move(second)});
+			}
+		}
+
+		/// Get the number of operations in the batch.
+		size_type size() const noexcept
+		{ return ops_.size(); }
+
+		/// Check if the batch has no operations.
+		bool empty() const noexcept
+		{ return ops_.empty(); }
+
+	private:
+		struct Op
+		{
+			bool insert;
+			// Inserted into the first and second copy, respectively.  For erasures 'first' is
+			// the key and 'second' is null.
+			node_handle first;
+			node_handle second;
+		};
+
+		Batch(const HashFn& hash, const Allocator& alloc):
+			hasher_(hash), alloc_(alloc)
+		{
+
+		}
+
+		const HashFn& get_hasher() const
+		{ return hasher_; }
+
+		template <class T, class HashArg, class ... Args>
+		node_handle make_node(HashArg&& hash_arg, Args&& ... args) const
+		{
+			if constexpr(detail::is_std_allocator_v<Allocator>)
+			{
+				return make_any_value<T, HashFn, KeyEqual>(
+					std::forward<HashArg>(hash_arg), std::forward<Args>(args)...
+				);
+			}
+			else
+			{
+				return make_any_value<T, HashFn, KeyEqual>(
+					std::allocator_arg, alloc_, std::forward<HashArg>(hash_arg), std::forward<Args>(args)...
+				);
+			}
+		}
+
+		std::vector<Op> ops_;
+		HashFn hasher_;
+		Allocator alloc_;
+		friend struct RcuAnySet;
+	};
+
+	/// @name Constructors
+	/// @{
+
+	/**
+	 * @brief Construct an RcuAnySet whose contents are a copy of @p initial.
+	 */
+	explicit RcuAnySet(set_type initial = set_type()):
+		copies_{initial, std::move(initial)}
+	{
+
+	}
+
+	RcuAnySet(const RcuAnySet&) = delete;
+	RcuAnySet& operator=(const RcuAnySet&) = delete;
+
+	/// @} Constructors
+
+	~RcuAnySet()
+	{
+		assert(std::none_of(slots_.begin(), slots_.end(), [](const auto& s) { return s.in_use; }));
+	}
+
+	/// @name Readers
+	/// @{
+
+	/**
+	 * @brief Register a reader.  Takes a lock; do this once per thread, not once per read.
+	 */
+	Reader make_reader()
+	{
+		std::lock_guard<std::mutex> lock(slots_mutex_);
+		auto pos = std::find_if(slots_.begin(), slots_.end(), [](const auto& s) { return not s.in_use; });
+		if(pos == slots_.end())
+			pos = slots_.emplace(slots_.end());
+		pos->in_use = true;
+		return Reader(*this, std::addressof(*pos));
+	}
+
+	/// @} Readers
+
+	/// @name Writers
+	/// @{
+
+	/// Get an empty batch of changes for this set.
+	Batch make_batch() const
+	{
+		// assign() may be replacing the copies on another thread.
+		std::lock_guard<std::mutex> lock(writer_mutex_);
+		return Batch(copies_[0].hash_function(), copies_[0].get_allocator());
+	}
+
+	/**
+	 * @brief Apply @p batch to the set and publish the result.  Blocks until every reader that
+	 *        started before the result was published has finished.
+	 *
+	 * @note If applying the batch throws, the set is left unchanged or with the batch applied,
+	 *       and both copies are equal.
+	 */
+	void publish(Batch&& batch)
+	{
+		std::lock_guard<std::mutex> lock(writer_mutex_);
+		const int current = published_.load(std::memory_order_relaxed);
+		const int next = 1 - current;
+		apply_or_restore(batch, &Op::first, copies_[next], copies_[current]);
+		swap_published(next);
+		apply_or_restore(batch, &Op::second, copies_[current], copies_[next]);
+	}
+
+	/**
+	 * @brief Replace the contents of the set with @p contents.  Blocks until every reader that
+	 *        started before the new contents were published has finished.
+	 *
+	 * @note Unlike publish(), this copies every element of @p contents once.
+	 */
+	void assign(set_type contents)
+	{
+		std::lock_guard<std::mutex> lock(writer_mutex_);
+		const int current = published_.load(std::memory_order_relaxed);
+		const int next = 1 - current;
+		copies_[next] = std::move(contents);
+		swap_published(next);
+		copies_[current] = copies_[next];
+	}
+
+	/// Insert @p value and publish the result.  Same as publishing a one-element batch.
+	template <class T>
+	void insert(T&& value)
+	{
+		auto batch = make_batch();
+		batch.insert(std::forward<T>(value));
+		publish(std::move(batch));
+	}
+
+	/// Erase @p value and publish the result.  Same as publishing a one-element batch.
+	template <class T>
+	void erase(const T& value)
+	{
+		auto batch = make_batch();
+		batch.erase(value);
+		publish(std::move(batch));
+	}
+
+	/// Insert copies of the elements of @p other and publish the result.
+	void update(const set_type& other)
+	{
+		auto batch = make_batch();
+		batch.update(other);
+		publish(std::move(batch));
+	}
+
+	/// @} Writers
+
+private:
+	using Op = typename Batch::Op;
+
+	// Apply the batch's 'which' nodes to 'target'.  If that throws, make 'target' equal to
+	// 'source' again; readers may be looking at 'source', so it is only read.
+	static void apply_or_restore(Batch& batch, node_handle Op::* which, set_type& target, const set_type& source)
+	{
+		try
+		{
+			for(auto& op: batch.ops_)
+			{
+				if(op.insert)
+					target.push(std::move(op.*which));
+				else
+					target.erase(*op.first);
+			}
+		}
+		catch(...)
+		{
+			target = source;
+			throw;
+		}
+	}
+
+	// Publish copies_[next], then wait until no reader can still be reading the other copy.
+	void swap_published(int next)
+	{
+		published_.store(next, std::memory_order_seq_cst);
+		const std::uint64_t epoch = epoch_.fetch_add(1u, std::memory_order_seq_cst) + 1u;
+		std::lock_guard<std::mutex> lock(slots_mutex_);
+		for(const auto& slot: slots_)
+		{
+			for(;;)
+			{
+				std::uint64_t e = slot.epoch.load(std::memory_order_seq_cst);
+				if(e == 0u or e >= epoch)
+					break;
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void release_slot(ReaderSlot* slot)
+	{
+		std::lock_guard<std::mutex> lock(slots_mutex_);
+		assert(slot->epoch.load() == 0u);
+		slot->in_use = false;
+	}
+
+	set_type copies_[2];
+	std::atomic<int> published_{0};
+	std::atomic<std::uint64_t> epoch_{1};
+	mutable std::mutex writer_mutex_;
+	std::mutex slots_mutex_;
+	std::list<ReaderSlot> slots_;
+};
+
+} /* namespace te */
+
+#endif /* RCU_ANY_SET_H */
@@ -6,6 +6,12 @@
 #endif 
 
 #include "AnySet.h"
+#include "FrozenAnySet.h"
+#include "PersistentAnySet.h"
+#include "CowAnySet.h"
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
 #include <type_traits>
 
 /// @file SetOperations.h
@@ -17,6 +23,25 @@
 /// * symmetric_difference_of()
 /// * is_subset_of()
 /// * is_superset_of()
+///
+/// The first four also have overloads that take an execution policy (see Parallel.h)
+/// as their first argument.
+///
+/// A FrozenAnySet or PersistentAnySet may be used wherever a set is only read: as the sets
+/// subtracted by difference_of(), and as either argument of is_subset_of() and is_superset_of().
+/// The first four also have overloads for groups of PersistentAnySet instances, which return a
+/// PersistentAnySet that shares the elements of its arguments, and for groups of CowAnySet
+/// instances, which return a CowAnySet that shares an argument's set when the result equals it.
+/// A CowAnySet may also be read wherever a FrozenAnySet may.
+///
+/// SetViews.h has lazily evaluated versions of the first four, which don't copy any elements.
+///
+/// Functions that count the elements of a set operation's result without computing it:
+/// * intersection_size()
+/// * union_size()
+/// * difference_size()
+/// * is_disjoint()
+/// * jaccard_index()
 
 namespace te {
 
@@ -25,12 +50,136 @@ namespace detail {
 template <class T>
 struct is_any_set: public std::false_type {};
 
-template <class H, class E, class A>
-struct is_any_set<AnySet<H, E, A>>: public std::true_type {};
+template <class H, class E, class A, class P>
+struct is_any_set<AnySet<H, E, A, P>>: public std::true_type {};
 
 template <class T>
 inline constexpr const bool is_any_set_v = is_any_set<T>::value;
 
+template <class T>
+struct is_frozen_any_set: public std::false_type {};
+
+template <class H, class E, class A>
+struct is_frozen_any_set<FrozenAnySet<H, E, A>>: public std::true_type {};
+
+template <class T>
+struct is_persistent_any_set: public std::false_type {};
+
+template <class H, class E, class A>
+struct is_persistent_any_set<PersistentAnySet<H, E, A>>: public std::true_type {};
+
+template <class T>
+inline constexpr const bool is_persistent_any_set_v = is_persistent_any_set<T>::value;
+
+template <class T>
+struct is_cow_any_set: public std::false_type {};
+
+template <class H, class E, class A, class P>
+struct is_cow_any_set<CowAnySet<H, E, A, P>>: public std::true_type {};
+
+template <class T>
+inline constexpr const bool is_cow_any_set_v = is_cow_any_set<T>::value;
+
+template <class T>
+struct is_readable_set:
+	public std::disjunction<is_any_set<T>, is_frozen_any_set<T>, is_persistent_any_set<T>, is_cow_any_set<T>>
+{};
+
+template <class T, class U>
+struct has_same_value_type: public std::is_same<typename T::value_type, typename U::value_type> {};
+
+// Check whether 'U' is a set that can be read alongside the set 'T': either the same type
+// or another kind of set with the same value_type.
+template <class T, class U>
+struct is_readable_set_for:
+	public std::disjunction<
+		std::is_same<T, U>,
+		std::conjunction<is_readable_set<T>, is_readable_set<U>, has_same_value_type<T, U>>
+	>
+{};
+
+template <class T, class U>
+inline constexpr const bool is_readable_set_for_v = is_readable_set_for<T, U>::value;
+
+template <class T>
+inline constexpr const bool is_readable_set_v = is_readable_set<T>::value;
+
+// Number of elements whose membership the set operations look up at a time.
+inline constexpr const std::size_t membership_batch_size = 16;
+
+// Store whether each of the 'count' elements starting at 'first' is in 'set' in 'found'.
+// AnySets look the whole batch up with contains_many(), which overlaps the cache misses.
+template <class Set, class It>
+void batch_contains(const Set& set, It first, std::size_t count, bool* found)
+{
+	if constexpr(is_any_set_v<Set>)
+	{
+		set.contains_many(first, std::next(first, count), found);
+	}
+	else
+	{
+		for(std::size_t i = 0; i < count; ++i, ++first)
+			found[i] = set.contains_value(*first);
+	}
+}
+
+// Store whether each of the 'count' elements starting at 'first' is in any of 'sets' in 'found'.
+template <class It, class ... Sets>
+void difference_batch(It first, std::size_t count, bool* found, const Sets& ... sets)
+{
+	bool in_set[membership_batch_size];
+	std::fill_n(found, count, false);
+	auto unite = [&](const auto& s) {
+		batch_contains(s, first, count, in_set);
+		for(std::size_t i = 0; i < count; ++i)
+			found[i] = found[i] or in_set[i];
+	};
+	(unite(sets) , ...);
+}
+
+// Call 'visit(first, count)' on consecutive batches of at most membership_batch_size elements
+// of 'set', which 'visit' may erase.  'visit' must return an iterator one past the batch.
+template <class Set, class Visit>
+void for_each_batch(Set& set, Visit visit)
+{
+	auto pos = set.begin();
+	for(std::size_t left = set.size(); left > 0;)
+	{
+		const std::size_t count = std::min(left, membership_batch_size);
+		pos = visit(pos, count);
+		left -= count;
+	}
+}
+
+// Count the elements of 'small' that are also in 'large', a batch of lookups at a time.  Stops
+// after the first batch that brings the count to 'limit' or more.
+template <class Small, class Large>
+std::size_t count_common(const Small& small, const Large& large, std::size_t limit)
+{
+	bool found[membership_batch_size];
+	std::size_t common = 0;
+	auto pos = small.begin();
+	for(std::size_t left = small.size(); left > 0 and common < limit;)
+	{
+		const std::size_t count = std::min(left, membership_batch_size);
+		batch_contains(large, pos, count, found);
+		common += static_cast<std::size_t>(std::count(found, found + count, true));
+		std::advance(pos, count);
+		left -= count;
+	}
+	return common;
+}
+
+// Same as count_common(), but looks up the elements of whichever set is smaller.
+template <class A, class B>
+std::size_t count_common_either(const A& a, const B& b, std::size_t limit)
+{
+	if(b.size() < a.size())
+		return count_common(b, a, limit);
+	else
+		return count_common(a, b, limit);
+}
+
 template <class Op, class Pred, class T, class ... U>
 decltype(auto) select_and_invoke(Op&& op, [[maybe_unused]] Pred pred, T&& first)
 {
@@ -71,6 +220,94 @@ decltype(auto) select_and_invoke(Op&& op, Pred pred, T&& first, U&& second, Args
 	}
 }
 
+// Split 'set' into 'chunk_count' partitions and call 'visit(chunk, pos)' with a
+// const_local_iterator to each element, running each partition as one of 'policy's tasks.
+template <class Policy, class Set, class Visit>
+void parallel_visit(const Policy& policy, const Set& set, std::size_t chunk_count, Visit visit)
+{
+	const auto parts = set.partitions(chunk_count);
+	assert(parts.size() == chunk_count);
+	policy.run(chunk_count, [&](std::size_t chunk) {
+		for(auto b = parts[chunk].first_bucket(), stop = parts[chunk].last_bucket(); b < stop; ++b)
+		{
+			for(auto pos = set.begin(b), last = set.end(b); pos != last; ++pos)
+				visit(chunk, pos);
+		}
+	});
+}
+
+template <class Policy, class Set>
+std::size_t parallel_chunk_count(const Policy& policy, const Set& set)
+{
+	// More chunks than threads so that threads that finish early can take more work.
+	return std::min<std::size_t>(set.bucket_count(), 4u * std::max<std::size_t>(policy.concurrency(), 1u));
+}
+
+// Copy the elements of 'set' that satisfy 'pred'.  Returns the copies made by each chunk.
+template <class Policy, class Set, class Pred>
+std::vector<std::vector<typename Set::node_handle>>
+parallel_copy_if(const Policy& policy, const Set& set, Pred pred)
+{
+	std::vector<std::vector<typename Set::node_handle>> parts(parallel_chunk_count(policy, set));
+	parallel_visit(policy, set, parts.size(), [&](std::size_t chunk, auto pos) {
+		if(pred(*pos))
+			parts[chunk].push_back(set.dup(pos));
+	});
+	return parts;
+}
+
+// Find the elements of 'set' that satisfy 'pred'.  Returns the elements found by each chunk.
+template <class Policy, class Set, class Pred>
+std::vector<std::vector<const typename Set::value_type*>>
+parallel_find_if(const Policy& policy, const Set& set, Pred pred)
+{
+	std::vector<std::vector<const typename Set::value_type*>> parts(parallel_chunk_count(policy, set));
+	parallel_visit(policy, set, parts.size(), [&](std::size_t chunk, auto pos) {
+		if(pred(*pos))
+			parts[chunk].push_back(std::addressof(*pos));
+	});
+	return parts;
+}
+
+// Add nodes that are not already in 'set' to 'set'.  Only links the nodes.
+template <class Set>
+void push_all(Set& set, std::vector<std::vector<typename Set::node_handle>>&& parts)
+{
+	std::size_t count = 0;
+	for(const auto& part: parts)
+		count += part.size();
+	set.reserve(set.size() + count);
+	for(auto& part: parts)
+	{
+		for(auto& node: part)
+		{
+			[[maybe_unused]] auto [pos, leftover] = set.push(std::move(node));
+			assert(not leftover);
+		}
+	}
+}
+
+// Erase the elements equal to each of 'values' from 'set'.
+template <class Set>
+void erase_all(Set& set, const std::vector<std::vector<const typename Set::value_type*>>& values)
+{
+	for(const auto& part: values)
+	{
+		for(auto v: part)
+			set.erase(*v);
+	}
+}
+
+// Make a copy of 'set', copying the elements in parallel.
+template <class Policy, class Set>
+Set parallel_copy(const Policy& policy, const Set& set)
+{
+	Set result(0u, set.hash_function(), set.key_eq(), set.get_allocator());
+	result.max_load_factor(1.0);
+	push_all(result, parallel_copy_if(policy, set, [](const auto&) { return true; }));
+	return result;
+}
+
 } /* namespace detail */
 
 /// @name Set Operation Free-Functions
@@ -170,20 +407,20 @@ std::decay_t<T> intersection_of(T&& first, U&& ... args)
 	auto intersection_of_impl = [](auto&& f, const auto& ... set) -> std::decay_t<T> {
 		std::decay_t<T> result(std::forward<decltype(f)>(f));
 		result.max_load_factor(1.0);
-		auto pos = result.begin();
-		while(pos != result.end())
-		{
-			const auto& any_v = *pos;
-			auto has_value = [&](const auto& s) { return s.contains_value(any_v); };
-			if(not static_cast<bool>((has_value(set) and ...)))
-			{
-				pos = result.erase(pos);
-			}
-			else
-			{
-				++pos;
-			}
-		}
+		detail::for_each_batch(result, [&](auto pos, std::size_t count) {
+			bool keep[detail::membership_batch_size];
+			bool found[detail::membership_batch_size];
+			std::fill_n(keep, count, true);
+			auto intersect = [&](const auto& s) {
+				detail::batch_contains(s, pos, count, found);
+				for(std::size_t i = 0; i < count; ++i)
+					keep[i] = keep[i] and found[i];
+			};
+			(intersect(set) , ...);
+			for(std::size_t i = 0; i < count; ++i)
+				pos = keep[i] ? std::next(pos) : result.erase(pos);
+			return pos;
+		});
 		return result;
 	};
 	return detail::select_and_invoke(
@@ -246,7 +483,9 @@ std::decay_t<T> symmetric_difference_of(T&& first, U&& ... args)
  * @brief Get the (asymmetric) difference of a group of AnySet instances.
  * 
  * All arguments (@p first and @p args...) must be AnySet instances 
- * with the same @p HashFn and @p KeyEqual values.
+ * with the same @p HashFn and @p KeyEqual values.  The sets in @p args... may
+ * also be FrozenAnySet, PersistentAnySet, or CowAnySet instances with the same
+ * @p HashFn and @p KeyEqual.
  *
  * @note Set membership is determined using the shared @p KeyEqual function, not 
  *       necessarily operator==.
@@ -264,7 +503,7 @@ template <
 	class ... U,
 	class = std::enable_if_t<
 		detail::is_any_set_v<std::decay_t<T>>
-		and (std::is_same_v<std::decay_t<T>, std::decay_t<U>> and ...)
+		and (detail::is_readable_set_for_v<std::decay_t<T>, std::decay_t<U>> and ...)
 	>
 >
 std::decay_t<T> difference_of(T&& left, const U& ... right)
@@ -274,28 +513,29 @@ std::decay_t<T> difference_of(T&& left, const U& ... right)
 		std::decay_t<T> result(std::move(left));
 		result.max_load_factor(1.0);
 		
-		for(auto pos = result.begin(); pos != result.end();)
-		{
-			if(((right.contains_value(*pos)) or ...))
-			{
-				pos = result.erase(pos);
-			}
-			else
-			{
-				++pos;
-			}
-		}
+		detail::for_each_batch(result, [&](auto pos, std::size_t count) {
+			bool drop[detail::membership_batch_size];
+			detail::difference_batch(pos, count, drop, right...);
+			for(std::size_t i = 0; i < count; ++i)
+				pos = drop[i] ? result.erase(pos) : std::next(pos);
+			return pos;
+		});
 		return result;
 	}
 	else
 	{
 		std::decay_t<T> result(left.bucket_count());
 		
-		for(auto pos = left.begin(); pos != left.end(); ++pos)
-		{
-			if(not ((right.contains_value(*pos)) or ...))
-				result.push(left.dup(pos));
-		}
+		detail::for_each_batch(left, [&](auto pos, std::size_t count) {
+			bool drop[detail::membership_batch_size];
+			detail::difference_batch(pos, count, drop, right...);
+			for(std::size_t i = 0; i < count; ++i, ++pos)
+			{
+				if(not drop[i])
+					result.push(left.dup(pos));
+			}
+			return pos;
+		});
 		return result;
 	}
 }
@@ -311,11 +551,24 @@ std::decay_t<T> difference_of(T&& left, const U& ... right)
  * 
  * @return true if @p sub is a subset of @p super.
  */
-template <class H, class E, class A>
-bool is_subset_of(const AnySet<H, E, A>& sub, const AnySet<H, E, A>& super)
+template <
+	class Sub,
+	class Super,
+	class = std::enable_if_t<
+		detail::is_readable_set_v<Sub> and detail::is_readable_set_v<Super>
+		and std::is_same_v<typename Sub::value_type, typename Super::value_type>
+	>
+>
+bool is_subset_of(const Sub& sub, const Super& super)
 {
 	if(sub.size() > super.size())
 		return false;
+	if constexpr(std::is_same_v<Sub, Super> and detail::is_any_set_v<Sub>)
+	{
+		// Sets of the same size are subsets of each other only if they are equal.
+		if(sub.size() == super.size() and sub.content_digest() != super.content_digest())
+			return false;
+	}
 	for(const auto& v: sub)
 	{
 		if(not super.contains_value(v))
@@ -335,13 +588,596 @@ bool is_subset_of(const AnySet<H, E, A>& sub, const AnySet<H, E, A>& super)
  * 
  * @return true if @p super is a superset of @p sub.
  */
-template <class H, class E, class A>
-bool is_superset_of(const AnySet<H, E, A>& super, const AnySet<H, E, A>& sub)
+template <
+	class Super,
+	class Sub,
+	class = std::enable_if_t<
+		detail::is_readable_set_v<Super> and detail::is_readable_set_v<Sub>
+		and std::is_same_v<typename Super::value_type, typename Sub::value_type>
+	>
+>
+bool is_superset_of(const Super& super, const Sub& sub)
 { return is_subset_of(sub, super); }
 
 
 /// @} Set Operation Free-Functions
 
+/// @name Set Cardinality Free-Functions
+/// These compute the size of a set operation's result, or a value derived from it, without
+/// computing the result.  They look up the elements of the smaller set in the larger one, a
+/// batch at a time, and neither allocate memory nor copy elements.  Either argument may be an
+/// AnySet, FrozenAnySet, PersistentAnySet, or CowAnySet; both must have the same value_type.
+/// @{
+
+/**
+ * @brief Get the number of elements in both @p left and @p right.  Same as
+ *        `intersection_of(left, right).size()`.
+ *
+ * @note Set membership is determined using the shared @p KeyEqual function, not 
+ *       necessarily operator==.
+ */
+template <
+	class Left,
+	class Right,
+	class = std::enable_if_t<
+		detail::is_readable_set_v<Left> and detail::is_readable_set_v<Right>
+		and std::is_same_v<typename Left::value_type, typename Right::value_type>
+	>
+>
+std::size_t intersection_size(const Left& left, const Right& right)
+{ return detail::count_common_either(left, right, SIZE_MAX); }
+
+/**
+ * @brief Get the number of elements in either of @p left and @p right.  Same as
+ *        `union_of(left, right).size()`.
+ *
+ * @see intersection_size()
+ */
+template <
+	class Left,
+	class Right,
+	class = std::enable_if_t<
+		detail::is_readable_set_v<Left> and detail::is_readable_set_v<Right>
+		and std::is_same_v<typename Left::value_type, typename Right::value_type>
+	>
+>
+std::size_t union_size(const Left& left, const Right& right)
+{ return left.size() + right.size() - intersection_size(left, right); }
+
+/**
+ * @brief Get the number of elements of @p left that aren't in @p right.  Same as
+ *        `difference_of(left, right).size()`.
+ *
+ * @see intersection_size()
+ */
+template <
+	class Left,
+	class Right,
+	class = std::enable_if_t<
+		detail::is_readable_set_v<Left> and detail::is_readable_set_v<Right>
+		and std::is_same_v<typename Left::value_type, typename Right::value_type>
+	>
+>
+std::size_t difference_size(const Left& left, const Right& right)
+{ return left.size() - intersection_size(left, right); }
+
+/**
+ * @brief Determine whether @p left and @p right have no elements in common.  Stops looking 
+ *        at the first batch of lookups that finds a common element.
+ *
+ * @see intersection_size()
+ */
+template <
+	class Left,
+	class Right,
+	class = std::enable_if_t<
+		detail::is_readable_set_v<Left> and detail::is_readable_set_v<Right>
+		and std::is_same_v<typename Left::value_type, typename Right::value_type>
+	>
+>
+bool is_disjoint(const Left& left, const Right& right)
+{ return detail::count_common_either(left, right, 1u) == 0u; }
+
+/**
+ * @brief Get the Jaccard index of @p left and @p right: the size of their intersection
+ *        divided by the size of their union.
+ *
+ * @return A value in [0, 1].  Two empty sets have a Jaccard index of 1.
+ *
+ * @see intersection_size()
+ */
+template <
+	class Left,
+	class Right,
+	class = std::enable_if_t<
+		detail::is_readable_set_v<Left> and detail::is_readable_set_v<Right>
+		and std::is_same_v<typename Left::value_type, typename Right::value_type>
+	>
+>
+double jaccard_index(const Left& left, const Right& right)
+{
+	const std::size_t common = intersection_size(left, right);
+	const std::size_t total = left.size() + right.size() - common;
+	if(total == 0u)
+		return 1.0;
+	return static_cast<double>(common) / static_cast<double>(total);
+}
+
+/// @} Set Cardinality Free-Functions
+
+/// @name Parallel Set Operation Free-Functions
+/// These compute the same sets as their sequential counterparts, but do the lookups and
+/// element copies on the threads of an execution policy such as te::par.  Each task scans a
+/// contiguous range of buckets and collects its results separately; the results are then
+/// linked into the output set without copying the elements again.  Only the calling thread
+/// modifies sets.
+///
+/// The allocators of the sets must be safe to use from several threads at once, and so must
+/// the hash functions and key comparators.
+///
+/// @note RValue sets are only reused where the sequential overload would reuse them as the
+///       result; other rvalue arguments are read from like lvalues.
+/// @{
+
+/**
+ * @brief Get the union of a group of AnySet instances, using @p policy to run the work.
+ *
+ * @param policy - Execution policy to run the work with.
+ * @param first  - the first set in the group.
+ * @param args   - the other sets in the group.
+ *
+ * @return the set union of @p first and @p args....
+ *
+ * @see union_of(T&&, U&&...)
+ */
+template <
+	class Policy,
+	class T,
+	class ... U,
+	class = std::enable_if_t<
+		detail::is_execution_policy_v<Policy>
+		and detail::is_any_set_v<std::decay_t<T>>
+		and (std::is_same_v<std::decay_t<T>, std::decay_t<U>> and ...)
+	>
+>
+std::decay_t<T> union_of(const Policy& policy, T&& first, U&& ... args)
+{
+	auto is_better = [](auto&& left, auto&& right) {
+		// return true if 'right' is the better candidate
+		constexpr bool left_is_rvalue = std::is_rvalue_reference_v<decltype(left)>;
+		constexpr bool right_is_rvalue = std::is_rvalue_reference_v<decltype(right)>;
+		if constexpr(left_is_rvalue != right_is_rvalue)
+			return right_is_rvalue;
+		else
+			return left.bucket_count() < right.bucket_count();
+	};
+	const std::size_t max_total_size = (first.size() + ... + args.size());
+	auto union_of_impl = [&](auto&& f, const auto& ... sets) -> std::decay_t<T> {
+		std::decay_t<T> result = [&]() {
+			if constexpr(std::is_rvalue_reference_v<decltype(f)>)
+				return std::decay_t<T>(std::move(f));
+			else
+				return detail::parallel_copy(policy, f);
+		}();
+		result.max_load_factor(1.0);
+		result.reserve(max_total_size);
+		auto add = [&](const auto& s) {
+			detail::push_all(result, detail::parallel_copy_if(policy, s, [&](const auto& v) {
+				return not result.contains_value(v);
+			}));
+		};
+		(add(sets) , ...);
+		return result;
+	};
+	return detail::select_and_invoke(
+		union_of_impl, is_better, std::forward<T>(first), std::forward<U>(args)...
+	);
+}
+
+/**
+ * @brief Get the intersection of a group of AnySet instances, using @p policy to run the work.
+ *
+ * @param policy - Execution policy to run the work with.
+ * @param first  - the first set in the group.
+ * @param args   - the other sets in the group.
+ *
+ * @return the set intersection of @p first and @p args....
+ *
+ * @see intersection_of(T&&, U&&...)
+ */
+template <
+	class Policy,
+	class T,
+	class ... U,
+	class = std::enable_if_t<
+		detail::is_execution_policy_v<Policy>
+		and detail::is_any_set_v<std::decay_t<T>>
+		and (std::is_same_v<std::decay_t<T>, std::decay_t<U>> and ...)
+	>
+>
+std::decay_t<T> intersection_of(const Policy& policy, T&& first, U&& ... args)
+{
+	auto is_better = [](auto&& left, auto&& right) {
+		// return true if 'right' is the better candidate
+		constexpr bool left_is_rvalue = std::is_rvalue_reference_v<decltype(left)>;
+		constexpr bool right_is_rvalue = std::is_rvalue_reference_v<decltype(right)>;
+		if constexpr(left_is_rvalue != right_is_rvalue)
+			return right_is_rvalue;
+		else
+			return left.size() > right.size();
+	};
+	auto intersection_of_impl = [&](auto&& f, const auto& ... set) -> std::decay_t<T> {
+		auto in_all = [&](const auto& any_v) { return static_cast<bool>((set.contains_value(any_v) and ...)); };
+		if constexpr(std::is_rvalue_reference_v<decltype(f)>)
+		{
+			std::decay_t<T> result(std::move(f));
+			result.max_load_factor(1.0);
+			detail::erase_all(result, detail::parallel_find_if(policy, result, [&](const auto& any_v) {
+				return not in_all(any_v);
+			}));
+			return result;
+		}
+		else
+		{
+			std::decay_t<T> result(0u, f.hash_function(), f.key_eq(), f.get_allocator());
+			result.max_load_factor(1.0);
+			detail::push_all(result, detail::parallel_copy_if(policy, f, in_all));
+			return result;
+		}
+	};
+	return detail::select_and_invoke(
+		intersection_of_impl, is_better, std::forward<T>(first), std::forward<U>(args)...
+	);
+}
+
+/**
+ * @brief Get the symmetric difference of a group of AnySet instances, using @p policy to run
+ *        the work.
+ *
+ * @param policy - Execution policy to run the work with.
+ * @param first  - the first set in the group.
+ * @param args   - the other sets in the group.
+ *
+ * @return the set symmetric difference of @p first and @p args....
+ *
+ * @see symmetric_difference_of(T&&, U&&...)
+ */
+template <
+	class Policy,
+	class T,
+	class ... U,
+	class = std::enable_if_t<
+		detail::is_execution_policy_v<Policy>
+		and detail::is_any_set_v<std::decay_t<T>>
+		and (std::is_same_v<std::decay_t<T>, std::decay_t<U>> and ...)
+	>
+>
+std::decay_t<T> symmetric_difference_of(const Policy& policy, T&& first, U&& ... args)
+{
+	auto is_better = [](auto&& left, auto&& right) {
+		// return true if 'right' is the better candidate
+		constexpr bool left_is_rvalue = std::is_rvalue_reference_v<decltype(left)>;
+		constexpr bool right_is_rvalue = std::is_rvalue_reference_v<decltype(right)>;
+		if constexpr(left_is_rvalue != right_is_rvalue)
+			return right_is_rvalue;
+		else
+			return left.bucket_count() < right.bucket_count();
+	};
+	auto symmetric_difference_of_impl = [&](auto&& f, const auto& ... set) -> std::decay_t<T> {
+		using set_type = std::decay_t<T>;
+		set_type result = [&]() {
+			if constexpr(std::is_rvalue_reference_v<decltype(f)>)
+				return set_type(std::move(f));
+			else
+				return detail::parallel_copy(policy, f);
+		}();
+		result.max_load_factor(1.0);
+		auto inplace_symdiff = [&](const set_type& s) {
+			// Find the elements that 's' shares with 'result' and copy the rest in one pass.
+			const std::size_t chunk_count = detail::parallel_chunk_count(policy, s);
+			std::vector<std::vector<const typename set_type::value_type*>> common(chunk_count);
+			std::vector<std::vector<typename set_type::node_handle>> added(chunk_count);
+			detail::parallel_visit(policy, s, chunk_count, [&](std::size_t chunk, auto pos) {
+				if(result.contains_value(*pos))
+					common[chunk].push_back(std::addressof(*pos));
+				else
+					added[chunk].push_back(s.dup(pos));
+			});
+			detail::erase_all(result, common);
+			detail::push_all(result, std::move(added));
+		};
+		(... , inplace_symdiff(set));
+		return result;
+	};
+	return detail::select_and_invoke(
+		symmetric_difference_of_impl, is_better, std::forward<T>(first), std::forward<U>(args)...
+	);
+}
+
+/**
+ * @brief Get the (asymmetric) difference of a group of AnySet instances, using @p policy to
+ *        run the work.
+ *
+ * @param policy - Execution policy to run the work with.
+ * @param left   - the set to subtract from.
+ * @param right  - the sets to subtract.
+ *
+ * @return the set (asymmetric) difference of @p left and @p right....
+ *
+ * @see difference_of(T&&, const U&...)
+ */
+template <
+	class Policy,
+	class T,
+	class ... U,
+	class = std::enable_if_t<
+		detail::is_execution_policy_v<Policy>
+		and detail::is_any_set_v<std::decay_t<T>>
+		and (detail::is_readable_set_for_v<std::decay_t<T>, std::decay_t<U>> and ...)
+	>
+>
+std::decay_t<T> difference_of(const Policy& policy, T&& left, const U& ... right)
+{
+	auto in_any = [&](const auto& any_v) { return static_cast<bool>((right.contains_value(any_v) or ...)); };
+	if constexpr(std::is_rvalue_reference_v<decltype(left)>)
+	{
+		std::decay_t<T> result(std::move(left));
+		result.max_load_factor(1.0);
+		detail::erase_all(result, detail::parallel_find_if(policy, result, in_any));
+		return result;
+	}
+	else
+	{
+		std::decay_t<T> result(left.bucket_count(), left.hash_function(), left.key_eq(), left.get_allocator());
+		detail::push_all(result, detail::parallel_copy_if(policy, left, [&](const auto& any_v) {
+			return not in_any(any_v);
+		}));
+		return result;
+	}
+}
+
+/// @} Parallel Set Operation Free-Functions
+
+/// @name Persistent Set Operation Free-Functions
+/// Overloads for groups of PersistentAnySet instances.  Their results share the elements
+/// (and, where possible, whole subtries) of the arguments instead of copying them.
+/// @{
+
+/**
+ * @brief Get the union of a group of PersistentAnySet instances.  Starts from the largest
+ *        set and inserts the elements of the others.
+ *
+ * @see union_of(T&&, U&&...)
+ */
+template <
+	class T,
+	class ... U,
+	class = std::enable_if_t<
+		detail::is_persistent_any_set_v<std::decay_t<T>>
+		and (std::is_same_v<std::decay_t<T>, std::decay_t<U>> and ...)
+	>
+>
+std::decay_t<T> union_of(const T& first, const U& ... args)
+{
+	const std::decay_t<T>* largest = std::addressof(first);
+	((largest = (args.size() > largest->size()) ? std::addressof(args) : largest) , ...);
+	std::decay_t<T> result(*largest);
+	auto merge = [&](const auto& set) {
+		if(std::addressof(set) != largest)
+			result = result.update(set);
+	};
+	merge(first);
+	(merge(args) , ...);
+	return result;
+}
+
+/**
+ * @brief Get the intersection of a group of PersistentAnySet instances.  Starts from the
+ *        smallest set and erases the elements that the others don't contain.
+ *
+ * @see intersection_of(T&&, U&&...)
+ */
+template <
+	class T,
+	class ... U,
+	class = std::enable_if_t<
+		detail::is_persistent_any_set_v<std::decay_t<T>>
+		and (std::is_same_v<std::decay_t<T>, std::decay_t<U>> and ...)
+	>
+>
+std::decay_t<T> intersection_of(const T& first, const U& ... args)
+{
+	const std::decay_t<T>* smallest = std::addressof(first);
+	((smallest = (args.size() < smallest->size()) ? std::addressof(args) : smallest) , ...);
+	return smallest->erase_if([&](const auto& any_v) {
+		auto has_value = [&](const auto& s) { return s.contains_value(any_v); };
+		return not static_cast<bool>(has_value(first) and (has_value(args) and ...));
+	});
+}
+
+/**
+ * @brief Get the symmetric difference of a group of PersistentAnySet instances.
+ *
+ * @see symmetric_difference_of(T&&, U&&...)
+ */
+template <
+	class T,
+	class ... U,
+	class = std::enable_if_t<
+		detail::is_persistent_any_set_v<std::decay_t<T>>
+		and (std::is_same_v<std::decay_t<T>, std::decay_t<U>> and ...)
+	>
+>
+std::decay_t<T> symmetric_difference_of(const T& first, const U& ... args)
+{
+	std::decay_t<T> result(first);
+	auto symdiff = [&](const auto& set) {
+		auto only_left = result.erase_if([&](const auto& v) { return set.contains_value(v); });
+		auto only_right = set.erase_if([&](const auto& v) { return result.contains_value(v); });
+		result = only_left.update(only_right);
+	};
+	(symdiff(args) , ...);
+	return result;
+}
+
+/**
+ * @brief Get the (asymmetric) difference of a PersistentAnySet and a group of sets.
+ *
+ * The sets in @p right... may be any sets (AnySet, FrozenAnySet, or PersistentAnySet) with the
+ * same @p HashFn and @p KeyEqual as @p left.
+ *
+ * @see difference_of(T&&, const U&...)
+ */
+template <
+	class T,
+	class ... U,
+	class = std::enable_if_t<
+		detail::is_persistent_any_set_v<std::decay_t<T>>
+		and (detail::is_readable_set_for_v<std::decay_t<T>, std::decay_t<U>> and ...)
+	>
+>
+std::decay_t<T> difference_of(const T& left, const U& ... right)
+{
+	return left.erase_if([&](const auto& any_v) {
+		return static_cast<bool>((right.contains_value(any_v) or ...));
+	});
+}
+
+/// @} Persistent Set Operation Free-Functions
+
+/// @name Copy-on-Write Set Operation Free-Functions
+/// Overloads for groups of CowAnySet instances.  The result starts out sharing the set of one
+/// of the arguments, and that set is cloned only if the result turns out to differ from it.
+/// @{
+
+/**
+ * @brief Get the union of a group of CowAnySet instances.  Shares the largest set if it
+ *        contains all of the others.
+ *
+ * @see union_of(T&&, U&&...)
+ */
+template <
+	class H, class E, class A, class P,
+	class ... U,
+	class = std::enable_if_t<(std::is_same_v<CowAnySet<H, E, A, P>, U> and ...)>
+>
+CowAnySet<H, E, A, P> union_of(const CowAnySet<H, E, A, P>& first, const U& ... args)
+{
+	const CowAnySet<H, E, A, P>* largest = std::addressof(first);
+	((largest = (args.size() > largest->size()) ? std::addressof(args) : largest) , ...);
+	CowAnySet<H, E, A, P> result(*largest);
+	auto merge = [&](const auto& set) {
+		if(std::addressof(set) != largest)
+			result.update(set);
+	};
+	merge(first);
+	(merge(args) , ...);
+	return result;
+}
+
+/**
+ * @brief Get the intersection of a group of CowAnySet instances.  Shares the smallest set if
+ *        the others all contain it.
+ *
+ * @see intersection_of(T&&, U&&...)
+ */
+template <
+	class H, class E, class A, class P,
+	class ... U,
+	class = std::enable_if_t<(std::is_same_v<CowAnySet<H, E, A, P>, U> and ...)>
+>
+CowAnySet<H, E, A, P> intersection_of(const CowAnySet<H, E, A, P>& first, const U& ... args)
+{
+	const CowAnySet<H, E, A, P>* smallest = std::addressof(first);
+	((smallest = (args.size() < smallest->size()) ? std::addressof(args) : smallest) , ...);
+	auto in_all = [&](const auto& any_v) {
+		auto has_value = [&](const auto& s) {
+			return std::addressof(s) == smallest or s.contains_value(any_v);
+		};
+		return static_cast<bool>(has_value(first) and (has_value(args) and ...));
+	};
+	const auto& set = smallest->get();
+	auto pos = std::find_if_not(set.begin(), set.end(), in_all);
+	if(pos == set.end())
+		return *smallest;
+	// Copy the elements before the first one that is missing, then the rest that aren't.
+	typename CowAnySet<H, E, A, P>::set_type result(0u, set.hash_function(), set.key_eq(), set.get_allocator());
+	result.max_load_factor(1.0);
+	for(auto it = set.begin(); it != pos; ++it)
+		result.push(set.dup(it));
+	for(++pos; pos != set.end(); ++pos)
+	{
+		if(in_all(*pos))
+			result.push(set.dup(pos));
+	}
+	return CowAnySet<H, E, A, P>(std::move(result));
+}
+
+/**
+ * @brief Get the symmetric difference of a group of CowAnySet instances.
+ *
+ * @see symmetric_difference_of(T&&, U&&...)
+ */
+template <
+	class H, class E, class A, class P,
+	class ... U,
+	class = std::enable_if_t<(std::is_same_v<CowAnySet<H, E, A, P>, U> and ...)>
+>
+CowAnySet<H, E, A, P> symmetric_difference_of(const CowAnySet<H, E, A, P>& first, const U& ... args)
+{
+	CowAnySet<H, E, A, P> result(first);
+	auto symdiff = [&](const auto& set) {
+		if(result.empty())
+		{
+			result = set;
+			return;
+		}
+		if(set.empty())
+			return;
+		auto& target = result.mutate();
+		target.max_load_factor(1.0);
+		target ^= set.get();
+	};
+	(symdiff(args) , ...);
+	return result;
+}
+
+/**
+ * @brief Get the (asymmetric) difference of a CowAnySet and a group of sets.  Shares
+ *        @p left's set if none of @p right... have any of its elements.
+ *
+ * The sets in @p right... may be any sets (AnySet, FrozenAnySet, PersistentAnySet, or
+ * CowAnySet) with the same @p HashFn and @p KeyEqual as @p left.
+ *
+ * @see difference_of(T&&, const U&...)
+ */
+template <
+	class H, class E, class A, class P,
+	class ... U,
+	class = std::enable_if_t<(detail::is_readable_set_for_v<CowAnySet<H, E, A, P>, U> and ...)>
+>
+CowAnySet<H, E, A, P> difference_of(const CowAnySet<H, E, A, P>& left, const U& ... right)
+{
+	auto in_any = [&](const auto& any_v) {
+		return static_cast<bool>((right.contains_value(any_v) or ...));
+	};
+	const auto& set = left.get();
+	auto pos = std::find_if(set.begin(), set.end(), in_any);
+	if(pos == set.end())
+		return left;
+	typename CowAnySet<H, E, A, P>::set_type result(set.bucket_count(), set.hash_function(), set.key_eq(), set.get_allocator());
+	for(auto it = set.begin(); it != pos; ++it)
+		result.push(set.dup(it));
+	for(++pos; pos != set.end(); ++pos)
+	{
+		if(not in_any(*pos))
+			result.push(set.dup(pos));
+	}
+	return CowAnySet<H, E, A, P>(std::move(result));
+}
+
+/// @} Copy-on-Write Set Operation Free-Functions
+
 /// @name Set Operation Operator Overloads
 /// @{
 
@@ -360,13 +1196,13 @@ std::decay_t<T> operator+(T&& left, U&& right)
 { return union_of(std::forward<T>(left), std::forward<U>(right)); }
 
 /// Compute the union of @p left and @p right as if by `left = (left + right);`
-template <class H, class E, class A>
-AnySet<H, E, A>& operator+=(AnySet<H, E, A>& left, AnySet<H, E, A>&& right)
+template <class H, class E, class A, class P>
+AnySet<H, E, A, P>& operator+=(AnySet<H, E, A, P>& left, AnySet<H, E, A, P>&& right)
 { return left.update(std::move(right)); }
 
 /// Compute the union of @p left and @p right as if by `left = (left + right);`
-template <class H, class E, class A>
-AnySet<H, E, A>& operator+=(AnySet<H, E, A>& left, const AnySet<H, E, A>& right)
+template <class H, class E, class A, class P>
+AnySet<H, E, A, P>& operator+=(AnySet<H, E, A, P>& left, const AnySet<H, E, A, P>& right)
 { return left.update(right); }
 
 
@@ -382,13 +1218,13 @@ std::decay_t<T> operator|(T&& left, U&& right)
 { return std::forward<T>(left) + std::forward<U>(right); }
 
 /// Compute the union of @p left and @p right as if by `left = (left + right);`
-template <class H, class E, class A>
-AnySet<H, E, A>& operator|=(AnySet<H, E, A>& left, AnySet<H, E, A>&& right)
+template <class H, class E, class A, class P>
+AnySet<H, E, A, P>& operator|=(AnySet<H, E, A, P>& left, AnySet<H, E, A, P>&& right)
 { return left += std::move(right); }
 
 /// Compute the union of @p left and @p right as if by `left = (left + right);`
-template <class H, class E, class A>
-AnySet<H, E, A>& operator|=(AnySet<H, E, A>& left, const AnySet<H, E, A>& right)
+template <class H, class E, class A, class P>
+AnySet<H, E, A, P>& operator|=(AnySet<H, E, A, P>& left, const AnySet<H, E, A, P>& right)
 { return left += right; }
 
 /// @} Set Union Operators
@@ -409,13 +1245,13 @@ std::decay_t<T> operator&(T&& left, U&& right)
 { return intersection_of(std::forward<T>(left), std::forward<U>(right)); }
 
 /// Compute the intersection of @p left and @p right as if by `left = (left & right);`
-template <class H, class E, class A>
-AnySet<H, E, A>& operator&=(AnySet<H, E, A>& left, AnySet<H, E, A>&& right)
+template <class H, class E, class A, class P>
+AnySet<H, E, A, P>& operator&=(AnySet<H, E, A, P>& left, AnySet<H, E, A, P>&& right)
 { return left = intersection_of(std::move(left), std::move(right)); }
 
 /// Compute the intersection of @p left and @p right as if by `left = (left & right);`
-template <class H, class E, class A>
-AnySet<H, E, A>& operator&=(AnySet<H, E, A>& left, const AnySet<H, E, A>& right)
+template <class H, class E, class A, class P>
+AnySet<H, E, A, P>& operator&=(AnySet<H, E, A, P>& left, const AnySet<H, E, A, P>& right)
 { return left = intersection_of(std::move(left), right); }
 
 /// @} Set Intersection Operators
@@ -436,13 +1272,13 @@ std::decay_t<T> operator-(T&& left, U&& right)
 { return difference_of(std::forward<T>(left), std::forward<U>(right)); }
 
 /// Compute the (asymmetric) difference of @p left and @p right as if by `left = (left - right);`
-template <class H, class E, class A>
-AnySet<H, E, A>& operator-=(AnySet<H, E, A>& left, AnySet<H, E, A>&& right)
+template <class H, class E, class A, class P>
+AnySet<H, E, A, P>& operator-=(AnySet<H, E, A, P>& left, AnySet<H, E, A, P>&& right)
 { return left = difference_of(std::move(left), std::move(right)); }
 
 /// Compute the (asymmetric) difference of @p left and @p right as if by `left = (left - right);`
-template <class H, class E, class A>
-AnySet<H, E, A>& operator-=(AnySet<H, E, A>& left, const AnySet<H, E, A>& right)
+template <class H, class E, class A, class P>
+AnySet<H, E, A, P>& operator-=(AnySet<H, E, A, P>& left, const AnySet<H, E, A, P>& right)
 { return left = difference_of(std::move(left), right); }
 
 
@@ -464,10 +1300,10 @@ std::decay_t<T> operator^(T&& left, U&& right)
 
 /// Compute the symmetric difference of @p left and @p right as if by `left = (left ^ right);`
 template <
-	class H, class E, class A, class U,
-	class = std::enable_if_t<std::is_same_v<AnySet<H, E, A>, std::decay_t<U>>>
+	class H, class E, class A, class P, class U,
+	class = std::enable_if_t<std::is_same_v<AnySet<H, E, A, P>, std::decay_t<U>>>
 >
-AnySet<H, E, A>& operator^=(AnySet<H, E, A>& left, U&& right)
+AnySet<H, E, A, P>& operator^=(AnySet<H, E, A, P>& left, U&& right)
 {
 	for(auto pos = right.begin(); pos != right.end();)
 	{
@@ -487,23 +1323,23 @@ AnySet<H, E, A>& operator^=(AnySet<H, E, A>& left, U&& right)
 /// @{
 
 /// Semantically equivalent to `is_subset_of(left, right);`.
-template <class H, class E, class A>
-bool operator<=(const AnySet<H, E, A>& left, const AnySet<H, E, A>& right)
+template <class H, class E, class A, class P>
+bool operator<=(const AnySet<H, E, A, P>& left, const AnySet<H, E, A, P>& right)
 { return is_subset_of(left, right); }
 
 /// Semantically equivalent to `is_subset_of(left, right) && !(left.size() == right.size());`.
-template <class H, class E, class A>
-bool operator<(const AnySet<H, E, A>& left, const AnySet<H, E, A>& right)
+template <class H, class E, class A, class P>
+bool operator<(const AnySet<H, E, A, P>& left, const AnySet<H, E, A, P>& right)
 { return is_subset_of(left, right) and (left.size() < right.size()); }
 
 /// Semantically equivalent to `is_superset_of(left, right);`.
-template <class H, class E, class A>
-bool operator>=(const AnySet<H, E, A>& left, const AnySet<H, E, A>& right)
+template <class H, class E, class A, class P>
+bool operator>=(const AnySet<H, E, A, P>& left, const AnySet<H, E, A, P>& right)
 { return is_superset_of(left, right); }
 
 /// Semantically equivalent to `is_subset_of(left, right) && !(left.size() == right.size());`.
-template <class H, class E, class A>
-bool operator>(const AnySet<H, E, A>& left, const AnySet<H, E, A>& right)
+template <class H, class E, class A, class P>
+bool operator>(const AnySet<H, E, A, P>& left, const AnySet<H, E, A, P>& right)
 { return is_superset_of(left, right) and (left.size() > right.size()); }
 
 /// @} Subset/Superset Operators
@@ -512,8 +1348,8 @@ bool operator>(const AnySet<H, E, A>& left, const AnySet<H, E, A>& right)
 /// @{
 
 /// Write an AnySet instance to the std::ostream @p os.
-template <class H, class E, class C>
-std::ostream& operator<<(std::ostream& os, const AnySet<H, E, C>& set)
+template <class H, class E, class A, class P>
+std::ostream& operator<<(std::ostream& os, const AnySet<H, E, A, P>& set)
 {
 	os << '{';
 	if(set.size() > 0)
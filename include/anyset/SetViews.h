@@ -0,0 +1,515 @@
+#ifndef SET_VIEWS_H
+#define SET_VIEWS_H
+
+#ifdef _MSC_VER
+# include <iso646.h>
+#endif
+
+#include "SetOperations.h"
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+
+/// @file SetViews.h
+/// Lazily evaluated set expressions:
+/// * views::set_union()
+/// * views::set_intersection()
+/// * views::set_difference()
+/// * views::set_symmetric_difference()
+///
+/// Each returns a SetView that refers to its operands instead of copying them.  Iterating a
+/// view or calling contains() on it reads the operand sets directly; building and using a view
+/// allocates no memory.  Views may be used as the operands of other views, to any depth.  Call
+/// SetView::materialize() to copy the elements of a view into an AnySet.
+
+namespace te {
+
+/// @internal
+namespace detail {
+
+enum class SetViewOp { Union, Intersection, Difference, SymmetricDifference };
+
+} /* namespace detail */
+
+namespace views {
+
+template <detail::SetViewOp Op, class Left, class Right>
+struct SetView;
+
+} /* namespace views */
+
+/// @internal
+namespace detail {
+
+template <class T>
+struct is_set_view: public std::false_type {};
+
+template <SetViewOp Op, class L, class R>
+struct is_set_view<views::SetView<Op, L, R>>: public std::true_type {};
+
+template <class T>
+inline constexpr const bool is_set_view_v = is_set_view<T>::value;
+
+// Check whether 'T' and 'U' may be the operands of one view: sets or views with the same
+// value_type.
+template <class T, class U>
+struct is_view_operand_pair:
+	public std::conjunction<
+		std::disjunction<is_readable_set<T>, is_set_view<T>>,
+		std::disjunction<is_readable_set<U>, is_set_view<U>>,
+		has_same_value_type<T, U>
+	>
+{};
+
+template <class T, class U>
+inline constexpr const bool is_view_operand_pair_v = is_view_operand_pair<T, U>::value;
+
+// The AnySet type that a view over 'T' materializes to by default.
+template <class T>
+struct view_set_type { using type = typename T::set_type; };
+
+template <class H, class E, class A, class P>
+struct view_set_type<AnySet<H, E, A, P>> { using type = AnySet<H, E, A, P>; };
+
+template <class H, class E, class A>
+struct view_set_type<FrozenAnySet<H, E, A>> { using type = AnySet<H, E, A>; };
+
+template <class H, class E, class A>
+struct view_set_type<PersistentAnySet<H, E, A>> { using type = AnySet<H, E, A>; };
+
+// Views hold the views they are built from by value and sets by pointer.
+template <class T>
+using view_operand_t = std::conditional_t<is_set_view_v<T>, T, const T*>;
+
+template <class T>
+const T& view_operand(const T& operand)
+{ return operand; }
+
+template <class T>
+const T& view_operand(const T* operand)
+{ return *operand; }
+
+template <class T>
+view_operand_t<T> store_view_operand(const T& operand)
+{
+	if constexpr(is_set_view_v<T>)
+		return operand;
+	else
+		return std::addressof(operand);
+}
+
+} /* namespace detail */
+
+namespace views {
+
+/**
+ * @brief A lazily evaluated union, intersection, difference, or symmetric difference of two
+ *        sets or views.
+ *
+ * A SetView does not own its operands.  Sets are referred to by address and must outlive the
+ * view and its iterators; views used as operands are copied into the view, which is cheap.
+ * Changing an operand set invalidates the iterators of every view over it, but not the views.
+ *
+ * Iteration yields the elements of the left operand (those that pass the operation's test)
+ * followed, for unions and symmetric differences, by the elements of the right operand that
+ * aren't in the left one.  Each element costs a lookup in the other operand, except for the
+ * left elements of a union.  contains() costs a lookup in one or both operands.
+ *
+ * Build views with set_union(), set_intersection(), set_difference(), and
+ * set_symmetric_difference() rather than directly.
+ *
+ * @code
+ * // Iterates 'a' and 'b' once each; nothing is copied.
+ * for(const auto& v: te::views::set_difference(te::views::set_union(a, b), c))
+ *     std::cout << v << '\n';
+ * @endcode
+ *
+ * @tparam Op    - The set operation.
+ * @tparam Left  - The type of the left operand: an AnySet, FrozenAnySet, PersistentAnySet,
+ *                 CowAnySet, or SetView.
+ * @tparam Right - The type of the right operand.  Must have the same value_type as @p Left.
+ */
+template <detail::SetViewOp Op, class Left, class Right>
+struct SetView
+{
+	/// AnyValue.
+	using value_type = typename Left::value_type;
+	/// Size type.
+	using size_type = std::size_t;
+	/// Difference type.
+	using difference_type = std::ptrdiff_t;
+	/// %Hash function type.
+	using hasher = typename Left::hasher;
+	/// Key equality comparator type.
+	using key_equal = typename Left::key_equal;
+	/// Type of the AnySet that materialize() returns by default.
+	using set_type = typename detail::view_set_type<Left>::type;
+	/// Reference type.
+	using reference = const value_type&;
+	/// Const reference type.
+	using const_reference = const value_type&;
+	/// Pointer type.
+	using pointer = const value_type*;
+	/// Const pointer type.
+	using const_pointer = const value_type*;
+
+	/**
+	 * @brief Forward iterator over the elements of a SetView.
+	 */
+	struct Iterator
+	{
+		using value_type        = const typename SetView::value_type;
+		using reference         = const typename SetView::value_type&;
+		using pointer           = const typename SetView::value_type*;
+		using difference_type   = std::ptrdiff_t;
+		using iterator_category = std::forward_iterator_tag;
+
+		Iterator() = default;
+
+		reference operator*() const
+		{ return in_right_ ? *right_ : *left_; }
+
+		pointer operator->() const
+		{ return std::addressof(**this); }
+
+		Iterator& operator++()
+		{
+			if(in_right_)
+				++right_;
+			else
+				++left_;
+			view_->settle(*this);
+			return *this;
+		}
+
+		Iterator operator++(int)
+		{
+			auto cpy = *this;
+			++*this;
+			return cpy;
+		}
+
+		friend bool operator==(const Iterator& left, const Iterator& right)
+		{ return left.left_ == right.left_ and left.right_ == right.right_; }
+
+		friend bool operator!=(const Iterator& left, const Iterator& right)
+		{ return not (left == right); }
+
+	private:
+		using left_iterator = typename Left::const_iterator;
+		using right_iterator = typename Right::const_iterator;
+
+		Iterator(const SetView& view, left_iterator left, right_iterator right, bool in_right):
+			view_(std::addressof(view)), left_(left), right_(right), in_right_(in_right)
+		{
+
+		}
+
+		const SetView* view_ = nullptr;
+		left_iterator left_{};
+		right_iterator right_{};
+		// Whether the left operand has been exhausted.
+		bool in_right_ = false;
+		friend struct SetView;
+	};
+
+	/// Iterator type.  Views have no mutable iterators.
+	using iterator = Iterator;
+	/// Const iterator type.
+	using const_iterator = Iterator;
+
+	/**
+	 * @brief Construct a view over @p left and @p right.  Prefer set_union() and friends.
+	 */
+	SetView(const Left& left, const Right& right):
+		left_(detail::store_view_operand(left)),
+		right_(detail::store_view_operand(right))
+	{
+
+	}
+
+	/// @name Iterators
+	/// @{
+
+	/// Get an iterator to the first element of the view.
+	const_iterator begin() const
+	{
+		const auto& r = right();
+		Iterator it(*this, left().begin(), iterates_right ? r.begin() : r.end(), false);
+		settle(it);
+		return it;
+	}
+
+	/// Get an iterator past the last element of the view.
+	const_iterator end() const
+	{ return Iterator(*this, left().end(), right().end(), true); }
+
+	/// @} Iterators
+
+	/// @name Capacity
+	/// @{
+
+	/// Determine whether the view has no elements.  Evaluates the view up to its first element.
+	bool empty() const
+	{ return begin() == end(); }
+
+	/**
+	 * @brief Get an upper bound on the number of elements in the view, from the sizes of the
+	 *        operand sets.  O(1) for each set in the expression.
+	 */
+	size_type size_bound() const
+	{
+		const size_type l = operand_size_bound(left());
+		const size_type r = operand_size_bound(right());
+		switch(Op)
+		{
+		case detail::SetViewOp::Intersection:
+			return std::min(l, r);
+		case detail::SetViewOp::Difference:
+			return l;
+		default:
+			return l + r;
+		}
+	}
+
+	/// @} Capacity
+
+	/// @name Lookup
+	/// @{
+
+	/**
+	 * @brief Determine whether @p value is in the view.
+	 *
+	 * @param value - The value to look up.  May be any type that the operands' contains()
+	 *                accepts.
+	 */
+	template <class T>
+	bool contains(const T& value) const
+	{ return evaluate([&](const auto& s) { return s.contains(value); }); }
+
+	/**
+	 * @brief Determine whether an element equal to @p any_v is in the view.
+	 */
+	bool contains_value(const value_type& any_v) const
+	{ return evaluate([&](const auto& s) { return s.contains_value(any_v); }); }
+
+	/// Same as contains(), but returns a count (0 or 1).
+	template <class T>
+	size_type count(const T& value) const
+	{ return static_cast<size_type>(contains(value)); }
+
+	/// @} Lookup
+
+	/// @name Conversion
+	/// @{
+
+	/**
+	 * @brief Copy the elements of the view into a new set.  Each element is copied once.
+	 *
+	 * @tparam Set - The type of the set to return.  Defaults to the AnySet type of the
+	 *               leftmost operand.
+	 *
+	 * @param alloc - The allocator of the new set.
+	 *
+	 * @note Throws te::NoCopyConstructorError if an element's type is not copy constructible.
+	 */
+	template <class Set = set_type>
+	Set materialize(const typename Set::allocator_type& alloc = typename Set::allocator_type()) const
+	{
+		Set result(0u, hash_function(), key_eq(), alloc);
+		result.reserve(size_bound());
+		for(const auto& v: *this)
+			result.push(result.dup(v));
+		return result;
+	}
+
+	/// @} Conversion
+
+	/// @name Observers
+	/// @{
+
+	/// Get a copy of the leftmost operand's hash function.
+	hasher hash_function() const
+	{ return left().hash_function(); }
+
+	/// Get a copy of the leftmost operand's equality comparison function.
+	key_equal key_eq() const
+	{ return left().key_eq(); }
+
+	/// Get the left operand.
+	const Left& left() const noexcept
+	{ return detail::view_operand(left_); }
+
+	/// Get the right operand.
+	const Right& right() const noexcept
+	{ return detail::view_operand(right_); }
+
+	/// @} Observers
+
+private:
+	static constexpr const bool iterates_right =
+		Op == detail::SetViewOp::Union or Op == detail::SetViewOp::SymmetricDifference;
+
+	template <class T>
+	static size_type operand_size_bound(const T& operand)
+	{
+		if constexpr(detail::is_set_view_v<T>)
+			return operand.size_bound();
+		else
+			return operand.size();
+	}
+
+	// Combine 'in(left())' and 'in(right())' according to the operation, evaluating
+	// 'in(right())' only when it matters.
+	template <class In>
+	bool evaluate(In in) const
+	{
+		const bool in_left = in(left());
+		switch(Op)
+		{
+		case detail::SetViewOp::Union:
+			return in_left or in(right());
+		case detail::SetViewOp::Intersection:
+			return in_left and in(right());
+		case detail::SetViewOp::Difference:
+			return in_left and not in(right());
+		default:
+			return in_left != in(right());
+		}
+	}
+
+	// Advance 'it' to the next element of the view, starting at its current position.
+	void settle(Iterator& it) const
+	{
+		if(not it.in_right_)
+		{
+			const auto left_end = left().end();
+			for(; it.left_ != left_end; ++it.left_)
+			{
+				if(keep_left(*it.left_))
+					return;
+			}
+			it.in_right_ = true;
+		}
+		const auto right_end = right().end();
+		while(it.right_ != right_end and left().contains_value(*it.right_))
+			++it.right_;
+	}
+
+	bool keep_left(const value_type& any_v) const
+	{
+		if constexpr(Op == detail::SetViewOp::Union)
+			return true;
+		else if constexpr(Op == detail::SetViewOp::Intersection)
+			return right().contains_value(any_v);
+		else
+			return not right().contains_value(any_v);
+	}
+
+	detail::view_operand_t<Left> left_;
+	detail::view_operand_t<Right> right_;
+
+	template <detail::SetViewOp, class, class>
+	friend struct SetView;
+};
+
+} /* namespace views */
+
+/// @internal
+namespace detail {
+
+template <SetViewOp Op, class Left, class Right>
+views::SetView<Op, std::decay_t<Left>, std::decay_t<Right>> make_set_view(Left&& left, Right&& right)
+{
+	static_assert(
+		is_set_view_v<std::decay_t<Left>> or std::is_lvalue_reference_v<Left>,
+		"Set views don't own the sets they refer to; the left operand must be an lvalue."
+	);
+	static_assert(
+		is_set_view_v<std::decay_t<Right>> or std::is_lvalue_reference_v<Right>,
+		"Set views don't own the sets they refer to; the right operand must be an lvalue."
+	);
+	return views::SetView<Op, std::decay_t<Left>, std::decay_t<Right>>(left, right);
+}
+
+} /* namespace detail */
+
+namespace views {
+
+/// @name Set View Factories
+/// @{
+
+/**
+ * @brief Get a view of the union of @p left and @p right.
+ *
+ * @param left  - A set (AnySet, FrozenAnySet, PersistentAnySet, or CowAnySet) or SetView.
+ *                Sets must be lvalues and must outlive the view.
+ * @param right - A set or SetView with the same value_type as @p left.
+ */
+template <
+	class Left, class Right,
+	class = std::enable_if_t<detail::is_view_operand_pair_v<std::decay_t<Left>, std::decay_t<Right>>>
+>
+auto set_union(Left&& left, Right&& right)
+{
+	return detail::make_set_view<detail::SetViewOp::Union>(
+		std::forward<Left>(left), std::forward<Right>(right)
+	);
+}
+
+/**
+ * @brief Get a view of the intersection of @p left and @p right.  Iteration visits the
+ *        elements of @p left, so it should be the smaller operand.
+ *
+ * @see set_union()
+ */
+template <
+	class Left, class Right,
+	class = std::enable_if_t<detail::is_view_operand_pair_v<std::decay_t<Left>, std::decay_t<Right>>>
+>
+auto set_intersection(Left&& left, Right&& right)
+{
+	return detail::make_set_view<detail::SetViewOp::Intersection>(
+		std::forward<Left>(left), std::forward<Right>(right)
+	);
+}
+
+/**
+ * @brief Get a view of the elements of @p left that aren't in @p right.
+ *
+ * @see set_union()
+ */
+template <
+	class Left, class Right,
+	class = std::enable_if_t<detail::is_view_operand_pair_v<std::decay_t<Left>, std::decay_t<Right>>>
+>
+auto set_difference(Left&& left, Right&& right)
+{
+	return detail::make_set_view<detail::SetViewOp::Difference>(
+		std::forward<Left>(left), std::forward<Right>(right)
+	);
+}
+
+/**
+ * @brief Get a view of the elements that are in exactly one of @p left and @p right.
+ *
+ * @see set_union()
+ */
+template <
+	class Left, class Right,
+	class = std::enable_if_t<detail::is_view_operand_pair_v<std::decay_t<Left>, std::decay_t<Right>>>
+>
+auto set_symmetric_difference(Left&& left, Right&& right)
+{
+	return detail::make_set_view<detail::SetViewOp::SymmetricDifference>(
+		std::forward<Left>(left), std::forward<Right>(right)
+	);
+}
+
+/// @} Set View Factories
+
+} /* namespace views */
+
+} /* namespace te */
+
+#endif /* SET_VIEWS_H */
@@ -0,0 +1,490 @@
+#ifndef SHARDED_ANY_SET_H
+#define SHARDED_ANY_SET_H
+
+#ifdef _MSC_VER
+# include <iso646.h>
+#endif
+
+#include "AnySet.h"
+#include <array>
+#include <climits>
+#include <mutex>
+#include <shared_mutex>
+
+namespace te {
+
+/**
+ * @brief A thread-safe type-erased hash set made of @p N independently locked AnySet shards.
+ *
+ * Each element lives in the shard picked by the high-order bits of its (mixed) hash code.  The
+ * shards pick buckets with the low-order bits, so sharding doesn't disturb the distribution of
+ * elements over each shard's buckets.  Hash codes are computed before any lock is taken and are
+ * passed on to the shard as Hashed<T> keys, so each element is hashed only once.
+ *
+ * Every member function is thread-safe.  Operations on single elements lock only the element's
+ * shard: lookups take a shared lock, and modifications take an exclusive lock.  Whole-set
+ * operations (for_each(), snapshot(), size(), and clear()) lock every shard, always in order of
+ * shard index, and so see a consistent view of the whole set.
+ *
+ * Since the shards may be modified by other threads at any time, no iterators into a
+ * ShardedAnySet are handed out.  Operations that would return an iterator return a bool instead.
+ *
+ * @tparam N           - The number of shards.  Must be positive.
+ * @tparam HashFn      - The type of the function object to use when computing the hash codes of elements.
+ * @tparam KeyEqual    - The type of the function object to use when comparing elements for equality.
+ * @tparam Allocator   - The type of the allocator to use when allocating the shards' bucket tables and nodes.
+ * @tparam TablePolicy - The table policy of each shard.  See AnySet.
+ *
+ * @see AnySet           - The type of each shard.
+ * @see ConcurrentAnySet - A lock-free alternative that supports insertion and lookup, but not erasure.
+ */
+template <
+	std::size_t N,
+	class HashFn = AnyHash,
+	class KeyEqual = std::equal_to<>,
+	class Allocator = std::allocator<AnyValue<HashFn, KeyEqual>>,
+	class TablePolicy = ChainedBuckets
+>
+struct ShardedAnySet
+{
+	static_assert(N > 0u, "ShardedAnySet must have at least one shard.");
+
+	/// Type of each shard.
+	using set_type = AnySet<HashFn, KeyEqual, Allocator, TablePolicy>;
+	/// AnyValue.
+	using value_type = typename set_type::value_type;
+	/// Size type.
+	using size_type = typename set_type::size_type;
+	/// Key equality comparator type.
+	using key_equal = KeyEqual;
+	/// %Hash function type.
+	using hasher = HashFn;
+	/// Allocator type.
+	using allocator_type = Allocator;
+	/// Type of the nodes that hold elements.  See AnySet::node_handle.
+	using node_handle = typename set_type::node_handle;
+
+	/// @name Constructors
+	/// @{
+
+	/**
+	 * @brief Construct an empty set.
+	 */
+	ShardedAnySet(): ShardedAnySet(size_type(0)) { }
+
+	/**
+	 * @brief Construct an empty set.
+	 * @param bucket_count - Minimum total number of buckets, divided evenly over the shards.
+	 * @param hash         - %Hash function to initialize the set with.
+	 * @param equal        - Equality comparison function to initialize the set with.
+	 * @param alloc        - Allocator to initialize every shard with.
+	 */
+	explicit ShardedAnySet(
+		size_type bucket_count,
+		const HashFn& hash = HashFn(),
+		const KeyEqual& equal = KeyEqual(),
+		const Allocator& alloc = Allocator()
+	):
+		shards_(make_shards(std::make_index_sequence<N>{}, (bucket_count + N - 1u) / N, hash, equal, alloc)),
+		hasher_(hash)
+	{
+
+	}
+
+	/**
+	 * @brief Construct an empty set.
+	 * @param alloc - Allocator to initialize every shard with.
+	 */
+	explicit ShardedAnySet(const Allocator& alloc):
+		ShardedAnySet(size_type(0), HashFn(), KeyEqual(), alloc)
+	{
+
+	}
+
+	ShardedAnySet(const ShardedAnySet&) = delete;
+	ShardedAnySet& operator=(const ShardedAnySet&) = delete;
+
+	/// @} Constructors
+
+	/// @name Modifiers
+	/// @{
+
+	/**
+	 * @brief Inserts @p value if the set doesn't already contain an element with an equivalent
+	 *        value and type.  The element is only constructed if it is inserted.
+	 *
+	 * @param value - Element value to insert, or a Hashed<T> referring to it.
+	 *
+	 * @return true if the element was inserted.
+	 */
+	template <class T>
+	bool insert(T&& value)
+	{
+		if constexpr(detail::is_hashed_v<std::decay_t<T>>)
+		{
+			auto& shard = shard_for(value.hash);
+			std::unique_lock<std::shared_mutex> lock(shard.mutex);
+			return shard.set.insert(value).second;
+		}
+		else
+		{
+			Hashed<std::decay_t<T>> key(value, get_hasher()(value));
+			auto& shard = shard_for(key.hash);
+			std::unique_lock<std::shared_mutex> lock(shard.mutex);
+			return shard.set.try_emplace(key, std::forward<T>(value)).second;
+		}
+	}
+
+	/**
+	 * @brief Constructs an element from @p args and inserts it if the set doesn't already contain
+	 *        an element with an equivalent value and type.  The node is allocated and the element
+	 *        hashed before any lock is taken.
+	 *
+	 * @tparam T - Type of the element to emplace.  Must be a constructible non-reference type.
+	 *
+	 * @return true if the element was inserted.
+	 */
+	template <class T, class ... Args>
+	bool emplace(Args&& ... args)
+	{
+		static_assert(
+			std::is_same_v<T, std::decay_t<T>>,
+			"Cannot emplace references, arrays, or functions into a ShardedAnySet."
+		);
+		node_handle node;
+		if constexpr(detail::is_std_allocator_v<Allocator>)
+		{
+			node = make_any_value<T, HashFn, KeyEqual>(get_hasher(), std::forward<Args>(args)...);
+		}
+		else
+		{
+			node = make_any_value<T, HashFn, KeyEqual>(
+				std::allocator_arg, get_allocator(), get_hasher(), std::forward<Args>(args)...
+			);
+		}
+		return not push(std::move(node));
+	}
+
+	/**
+	 * @brief Constructs an element from @p args on the stack, and moves it into a new node only
+	 *        if the set doesn't already contain an element with an equivalent value and type.
+	 *        See AnySet::try_emplace().
+	 *
+	 * @tparam T - Type of the element to emplace.  Must be a move-constructible non-reference type.
+	 *
+	 * @return true if the element was inserted.
+	 */
+	template <class T, class ... Args>
+	bool try_emplace(Args&& ... args)
+	{
+		static_assert(
+			std::is_same_v<T, std::decay_t<T>>,
+			"Cannot emplace references, arrays, or functions into a ShardedAnySet."
+		);
+		return insert(T(std::forward<Args>(args)...));
+	}
+
+	/**
+	 * @brief Erase the element that has the same type as, and compares equal to @p value.
+	 *
+	 * @param value - Value of the element to erase, or a Hashed<T> referring to it.
+	 *
+	 * @return The number of elements erased (zero or one).
+	 */
+	template <class T>
+	size_type erase(const T& value)
+	{
+		auto key = make_key(value);
+		auto& shard = shard_for(key.hash);
+		std::unique_lock<std::shared_mutex> lock(shard.mutex);
+		return shard.set.erase(key);
+	}
+
+	/**
+	 * @brief Remove the element that has the same type as, and compares equal to @p value, and
+	 *        return the node that holds it.
+	 *
+	 * @param value - Value of the element to remove, or a Hashed<T> referring to it.
+	 *
+	 * @return The node that held the element, or a null node_handle if there was no such element.
+	 */
+	template <class T>
+	node_handle pop(const T& value)
+	{
+		auto key = make_key(value);
+		auto& shard = shard_for(key.hash);
+		std::unique_lock<std::shared_mutex> lock(shard.mutex);
+		auto pos = shard.set.find(key);
+		if(pos == shard.set.end())
+			return nullptr;
+		return shard.set.pop(pos).first;
+	}
+
+	/**
+	 * @brief Insert the element held by @p node, if the set doesn't already contain an element
+	 *        with an equivalent value and type.
+	 *
+	 * @param node - node_handle pointing to the element to add.
+	 *
+	 * @return A null node_handle if the insertion was successful, or @p node if it was not.
+	 */
+	node_handle push(node_handle&& node)
+	{
+		assert(node);
+		auto& shard = shard_for(node->hash);
+		std::unique_lock<std::shared_mutex> lock(shard.mutex);
+		return shard.set.push(std::move(node)).second;
+	}
+
+	/**
+	 * @brief Moves the element at position @p pos from @p other into @p this, unless @p this
+	 *        already contains an equivalent element.  See AnySet::splice().
+	 *
+	 * @param other - The set to move the element from.  Must not be modified by other threads
+	 *                during the call.
+	 * @param pos   - Iterator to the element to move.
+	 *
+	 * @return A pair of an iterator to the position in @p other of the element after @p pos, and
+	 *         a bool indicating whether the element was moved.
+	 */
+	std::pair<typename set_type::iterator, bool> splice(set_type& other, typename set_type::const_iterator pos)
+	{
+		auto& shard = shard_for(pos->hash);
+		std::unique_lock<std::shared_mutex> lock(shard.mutex);
+		auto [ins_pos, next, moved] = shard.set.splice(other, pos);
+		(void)ins_pos;
+		return std::make_pair(next, moved);
+	}
+
+	/**
+	 * @brief Moves every element of @p other into @p this, except those that @p this already
+	 *        contains an equivalent element for.  Each element locks only its own shard.
+	 *
+	 * @param other - The set to move elements from.  Must not be modified by other threads
+	 *                during the call.
+	 *
+	 * @return The number of elements moved.
+	 */
+	size_type splice(set_type& other)
+	{
+		size_type count = 0;
+		for(auto pos = other.cbegin(); pos != other.cend();)
+		{
+			auto [next, moved] = splice(other, pos);
+			count += moved;
+			pos = next;
+		}
+		return count;
+	}
+
+	/**
+	 * @brief Remove all elements from every shard.
+	 */
+	void clear()
+	{
+		with_all_locked<std::unique_lock<std::shared_mutex>>([this]() {
+			for(auto& shard: shards_)
+				shard.set.clear();
+		});
+	}
+
+	/// @} Modifiers
+
+	/// @name Lookup
+	/// @{
+
+	/**
+	 * @brief Check if the set contains @p value.
+	 *
+	 * @param value - Value to search for, or a Hashed<T> referring to it.
+	 */
+	template <class T>
+	bool contains(const T& value) const
+	{
+		auto key = make_key(value);
+		const auto& shard = shard_for(key.hash);
+		std::shared_lock<std::shared_mutex> lock(shard.mutex);
+		return shard.set.contains(key);
+	}
+
+	/**
+	 * @brief Returns the number of elements that have the same type as, and compare equal to
+	 *        @p value, which is either 1 or 0.
+	 */
+	template <class T>
+	size_type count(const T& value) const
+	{ return static_cast<size_type>(contains(value)); }
+
+	/**
+	 * @brief Hash @p key with this set's hash function and pair it with the result.  See AnySet::hashed().
+	 */
+	template <class T>
+	Hashed<T> hashed(const T& key) const
+	{ return make_key(key); }
+
+	template <class T>
+	Hashed<T> hashed(const T&& key) const = delete;
+
+	/// @} Lookup
+
+	/// @name Whole-Set Operations
+	/// @{
+
+	/**
+	 * @brief Call @p visit with every element of the set, with every shard locked for reading.
+	 *        Elements are visited in shard order.
+	 *
+	 * @param visit - Function object called as `visit(const value_type&)`.  Must not call
+	 *                member functions of @p this that modify it.
+	 */
+	template <class Visit>
+	void for_each(Visit visit) const
+	{
+		with_all_locked<std::shared_lock<std::shared_mutex>>([&]() {
+			for(const auto& shard: shards_)
+			{
+				for(const auto& value: shard.set)
+					visit(value);
+			}
+		});
+	}
+
+	/**
+	 * @brief Copy every element of the set into a single AnySet, with every shard locked for
+	 *        reading.
+	 *
+	 * @return An AnySet holding copies of the elements, as they were at one point in time.
+	 *
+	 * @note Throws te::NoCopyConstructorError if an element's type is not copy constructible.
+	 */
+	set_type snapshot() const
+	{
+		return with_all_locked<std::shared_lock<std::shared_mutex>>([&]() {
+			size_type total = 0;
+			for(const auto& shard: shards_)
+				total += shard.set.size();
+			set_type result(get_allocator());
+			result.reserve(total);
+			for(const auto& shard: shards_)
+			{
+				for(auto pos = shard.set.cbegin(); pos != shard.set.cend(); ++pos)
+					result.push(shard.set.dup(pos));
+			}
+			return result;
+		});
+	}
+
+	/**
+	 * @brief Get the number of elements in the set, with every shard locked for reading.
+	 */
+	size_type size() const
+	{
+		return with_all_locked<std::shared_lock<std::shared_mutex>>([&]() {
+			size_type total = 0;
+			for(const auto& shard: shards_)
+				total += shard.set.size();
+			return total;
+		});
+	}
+
+	/// Check if the set has no elements.
+	bool empty() const
+	{ return size() == 0u; }
+
+	/// @} Whole-Set Operations
+
+	/// @name Observers
+	/// @{
+
+	/// Get the number of shards.
+	static constexpr size_type shard_count() noexcept
+	{ return N; }
+
+	/// Get the index of the shard that holds elements with hash code @p hash.
+	static size_type shard_index(std::size_t hash) noexcept
+	{
+		// Multiply-shift of the top 32 bits, which works for any N.  The shards use the
+		// low-order bits to pick buckets.
+		constexpr unsigned shift = sizeof(std::size_t) * CHAR_BIT - 32u;
+		std::uint64_t high = static_cast<std::uint64_t>(hash_mixer{}(hash) >> shift);
+		return static_cast<size_type>((high * N) >> 32u);
+	}
+
+	/// Get a copy of the hash function.
+	hasher hash_function() const
+	{ return get_hasher(); }
+
+	/// Get a copy of the equality comparison function.
+	key_equal key_eq() const
+	{ return shards_[0].set.key_eq(); }
+
+	/// Get a copy of the allocator.
+	allocator_type get_allocator() const
+	{ return shards_[0].set.get_allocator(); }
+
+	/// @} Observers
+
+private:
+	using hash_mixer = detail::BucketHashMixer<HashFn>;
+
+	struct alignas(64) Shard
+	{
+		template <class ... Args>
+		Shard(Args&& ... args):
+			set(std::forward<Args>(args)...)
+		{
+
+		}
+
+		mutable std::shared_mutex mutex;
+		set_type set;
+	};
+
+	template <std::size_t ... I>
+	static std::array<Shard, N> make_shards(
+		std::index_sequence<I...>,
+		size_type bucket_count,
+		const HashFn& hash,
+		const KeyEqual& equal,
+		const Allocator& alloc
+	)
+	{ return {{((void)I, Shard(bucket_count, hash, equal, alloc))...}}; }
+
+	// The shards' hash functions are all copies of the same one.
+	const HashFn& get_hasher() const
+	{ return hasher_; }
+
+	template <class T>
+	auto make_key(const T& value) const
+	{
+		if constexpr(detail::is_hashed_v<T>)
+			return value;
+		else if constexpr(std::is_same_v<T, value_type>)
+			return Hashed<T>(value, value.hash);
+		else
+			return Hashed<T>(value, get_hasher()(value));
+	}
+
+	Shard& shard_for(std::size_t hash)
+	{ return shards_[shard_index(hash)]; }
+
+	const Shard& shard_for(std::size_t hash) const
+	{ return shards_[shard_index(hash)]; }
+
+	// Lock every shard in order of index, then call 'f'.
+	template <class Lock, class F>
+	decltype(auto) with_all_locked(F f) const
+	{
+		std::array<Lock, N> locks;
+		for(std::size_t i = 0; i < N; ++i)
+			locks[i] = Lock(shards_[i].mutex);
+		return f();
+	}
+
+	std::array<Shard, N> shards_;
+	HashFn hasher_;
+};
+
+} /* namespace te */
+
+#endif /* SHARDED_ANY_SET_H */
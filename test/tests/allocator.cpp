@@ -0,0 +1,263 @@
+#include "any-set.h"
+#include "anyset/SetOperations.h"
+#include <memory_resource>
+
+namespace {
+
+struct alignas(64) OverAligned
+{
+	int value;
+
+	friend bool operator==(const OverAligned& l, const OverAligned& r)
+	{ return l.value == r.value; }
+};
+
+} /* namespace */
+
+template <>
+struct te::Hash<OverAligned>
+{
+	std::size_t operator()(const OverAligned& v) const
+	{ return std::hash<int>{}(v.value); }
+};
+
+using pmr_set_t = te::pmr::AnySet<>;
+using pmr_oa_set_t = te::pmr::AnySet<te::AnyHash, std::equal_to<>, te::OpenAddressing>;
+
+TEST_CASE("Node Allocation", "[allocator]") {
+
+	using namespace std::literals;
+	using std::pmr::polymorphic_allocator;
+	using value_type = pmr_set_t::value_type;
+
+	SECTION("Nodes are allocated from the set's memory resource") {
+		CountingResource res;
+		{
+			pmr_set_t set(16, polymorphic_allocator<value_type>{&res});
+			std::size_t before = res.allocations;
+			set.emplace<int>(1);
+			set.emplace<std::string>("abc"s);
+			set.insert(2.0);
+			REQUIRE(res.allocations == before + 3u);
+			set.insert(1);
+			REQUIRE(res.allocations == before + 3u);
+			set.erase(1);
+			REQUIRE(res.deallocations == 1u);
+			set._assert_invariants();
+		}
+		REQUIRE(res.allocations == res.deallocations);
+		REQUIRE(res.bytes_in_use == 0u);
+	}
+
+	SECTION("Open addressing sets allocate nodes from the set's memory resource") {
+		CountingResource res;
+		{
+			pmr_oa_set_t set(polymorphic_allocator<value_type>{&res});
+			for(int i = 0; i < 100; ++i)
+				set.insert(i);
+			REQUIRE(res.allocations >= 100u);
+			set._assert_invariants();
+		}
+		REQUIRE(res.allocations == res.deallocations);
+		REQUIRE(res.bytes_in_use == 0u);
+	}
+
+	SECTION("Nodes can move between sets with different memory resources") {
+		CountingResource res_a;
+		CountingResource res_b;
+		{
+			pmr_set_t a(polymorphic_allocator<value_type>{&res_a});
+			pmr_set_t b(polymorphic_allocator<value_type>{&res_b});
+			for(int i = 0; i < 10; ++i)
+				a.insert(i);
+			std::size_t a_allocs = res_a.allocations;
+			std::size_t b_allocs = res_b.allocations;
+
+			auto [node, _] = a.pop(a.find(3));
+			REQUIRE(b.push(std::move(node)).second == nullptr);
+			b.splice(a, a.find(4));
+			REQUIRE(a.size() == 8u);
+			REQUIRE(b.size() == 2u);
+			REQUIRE(b.contains(3));
+			REQUIRE(b.contains(4));
+			// Moving nodes does not allocate nodes.
+			REQUIRE(res_a.allocations == a_allocs);
+			a._assert_invariants();
+			b._assert_invariants();
+
+			// Duplicates come from the resource of the set they were duplicated from.
+			auto copy = b.dup(b.find(3));
+			REQUIRE(res_b.allocations > b_allocs);
+			REQUIRE(a.push(std::move(copy)).second == nullptr);
+			REQUIRE(a.contains(3));
+		}
+		REQUIRE(res_a.allocations == res_a.deallocations);
+		REQUIRE(res_b.allocations == res_b.deallocations);
+		REQUIRE(res_a.bytes_in_use == 0u);
+		REQUIRE(res_b.bytes_in_use == 0u);
+	}
+
+	SECTION("Copies allocate from the provided memory resource") {
+		CountingResource res_a;
+		CountingResource res_b;
+		{
+			pmr_set_t a(polymorphic_allocator<value_type>{&res_a});
+			a.insert(1, 2.0, "three"s);
+			std::size_t a_allocs = res_a.allocations;
+			pmr_set_t b(a, polymorphic_allocator<value_type>{&res_b});
+			REQUIRE(a == b);
+			REQUIRE(res_a.allocations == a_allocs);
+			REQUIRE(res_b.allocations >= 3u);
+			b.update(pmr_set_t(std::make_tuple(4, 5)));
+			REQUIRE(b.size() == 5u);
+			b._assert_invariants();
+		}
+		REQUIRE(res_a.allocations == res_a.deallocations);
+		REQUIRE(res_b.allocations == res_b.deallocations);
+	}
+
+	SECTION("Copy assignment allocates from the destination's memory resource") {
+		CountingResource res_a;
+		CountingResource res_b;
+		{
+			pmr_set_t a(polymorphic_allocator<value_type>{&res_a});
+			pmr_set_t b(polymorphic_allocator<value_type>{&res_b});
+			a.insert(1, 2.0, "three"s);
+			b.insert(4);
+			std::size_t a_allocs = res_a.allocations;
+			std::size_t b_allocs = res_b.allocations;
+			b = a;
+			REQUIRE(a == b);
+			REQUIRE(b.get_allocator().resource() == &res_b);
+			REQUIRE(res_a.allocations == a_allocs);
+			REQUIRE(res_b.allocations >= b_allocs + 3u);
+			b._assert_invariants();
+			a.clear();
+			REQUIRE(res_a.deallocations >= 3u);
+			REQUIRE(b.contains("three"s));
+		}
+		REQUIRE(res_a.allocations == res_a.deallocations);
+		REQUIRE(res_b.allocations == res_b.deallocations);
+	}
+
+	SECTION("Move assignment copies elements between different memory resources") {
+		CountingResource res_b;
+		pmr_set_t b(polymorphic_allocator<value_type>{&res_b});
+		{
+			std::pmr::monotonic_buffer_resource res_a;
+			pmr_set_t a(polymorphic_allocator<value_type>{&res_a});
+			for(int i = 0; i < 100; ++i)
+				a.insert(i);
+			std::size_t b_allocs = res_b.allocations;
+			b = std::move(a);
+			REQUIRE(a.empty());
+			REQUIRE(b.size() == 100u);
+			REQUIRE(b.get_allocator().resource() == &res_b);
+			REQUIRE(res_b.allocations >= b_allocs + 100u);
+			a.insert(1);
+			a._assert_invariants();
+		}
+		// The elements of 'b' outlive the resource of the set they were moved from.
+		for(int i = 0; i < 100; ++i)
+			REQUIRE(b.contains(i));
+		b._assert_invariants();
+
+		// Sets with the same resource still take each other's nodes.
+		pmr_set_t c(polymorphic_allocator<value_type>{&res_b});
+		const auto* node = std::addressof(*b.find(50));
+		c = std::move(b);
+		REQUIRE(c.size() == 100u);
+		REQUIRE(std::addressof(*c.find(50)) == node);
+		c._assert_invariants();
+	}
+
+	SECTION("Moving into a different memory resource copies the elements") {
+		CountingResource res_a;
+		CountingResource res_b;
+		{
+			pmr_set_t a(polymorphic_allocator<value_type>{&res_a});
+			for(int i = 0; i < 100; ++i)
+				a.insert(i);
+			std::size_t b_allocs = res_b.allocations;
+			pmr_set_t b(std::move(a), polymorphic_allocator<value_type>{&res_b});
+			REQUIRE(a.empty());
+			REQUIRE(b.size() == 100u);
+			REQUIRE(b.get_allocator().resource() == &res_b);
+			REQUIRE(res_b.allocations >= b_allocs + 100u);
+			REQUIRE(res_a.deallocations >= 100u);
+			b._assert_invariants();
+			a.insert(1);
+			a._assert_invariants();
+
+			// With the same resource, the nodes are taken.
+			const auto* node = std::addressof(*b.find(50));
+			pmr_set_t c(std::move(b), polymorphic_allocator<value_type>{&res_b});
+			REQUIRE(std::addressof(*c.find(50)) == node);
+			c._assert_invariants();
+		}
+		REQUIRE(res_a.allocations == res_a.deallocations);
+		REQUIRE(res_b.allocations == res_b.deallocations);
+	}
+
+	SECTION("Elements copied or moved from another set use this set's memory resource") {
+		CountingResource res_b;
+		pmr_set_t b(polymorphic_allocator<value_type>{&res_b});
+		{
+			CountingResource res_a;
+			pmr_set_t a(polymorphic_allocator<value_type>{&res_a});
+			for(int i = 0; i < 100; ++i)
+				a.insert(i);
+			std::size_t b_allocs = res_b.allocations;
+			const pmr_set_t& const_a = a;
+			b.splice_or_copy(const_a, const_a.find(1));
+			REQUIRE(res_b.allocations == b_allocs + 1u);
+			b.insert(2);
+			b.update(std::move(a));
+			REQUIRE(b.size() == 100u);
+			// Elements already in 'b' stay in 'a'.
+			REQUIRE(a.size() == 2u);
+			REQUIRE(a.contains(1));
+			REQUIRE(a.contains(2));
+			REQUIRE(res_b.allocations >= b_allocs + 100u);
+			REQUIRE(res_a.deallocations >= 99u);
+		}
+		for(int i = 0; i < 100; ++i)
+			REQUIRE(b.contains(i));
+		b._assert_invariants();
+	}
+
+	SECTION("Nodes can be allocated from a monotonic buffer") {
+		std::pmr::monotonic_buffer_resource res;
+		pmr_set_t set(polymorphic_allocator<value_type>{&res});
+		for(int i = 0; i < 100; ++i)
+			set.insert(i);
+		for(int i = 0; i < 100; i += 2)
+			set.erase(i);
+		REQUIRE(set.size() == 50u);
+		set._assert_invariants();
+	}
+
+	SECTION("Nodes can be created with an explicit allocator") {
+		CountingResource res;
+		{
+			polymorphic_allocator<value_type> alloc{&res};
+			any_set_t set;
+			set.push(te::make_any_value<int, te::AnyHash, std::equal_to<>>(
+				std::allocator_arg, alloc, te::AnyHash{}, 10
+			));
+			REQUIRE(res.allocations == 1u);
+			REQUIRE(set.contains(10));
+			set._assert_invariants();
+		}
+		REQUIRE(res.deallocations == 1u);
+	}
+
+	SECTION("Over-aligned types") {
+		CountingResource res;
+		pmr_set_t set(polymorphic_allocator<value_type>{&res});
+		set.emplace<OverAligned>(OverAligned{5});
+		REQUIRE(set.contains(OverAligned{5}));
+		const auto& v = te::as<OverAligned>(*set.find(OverAligned{5}));
+		REQUIRE(reinterpret_cast<std::uintptr_t>(&v) % alignof(OverAligned) == 0u);
+	}
+}
@@ -7,6 +7,9 @@
 #include <array>
 #include <algorithm>
 #include <iterator>
+#if __has_include(<memory_resource>)
+# include <memory_resource>
+#endif
 #include "catch/catch.hpp"
 
 using any_set_t = te::AnySet<>;
@@ -18,6 +21,10 @@ using const_iterator = typename te::AnySet<>::const_iterator;
 using local_iterator = typename te::AnySet<>::local_iterator;
 using const_local_iterator = typename te::AnySet<>::const_local_iterator;
 
+// any_set_t with the other table policies.
+using oa_set_t = te::AnySet<te::AnyHash, std::equal_to<>, std::allocator<value_type>, te::OpenAddressing>;
+using ir_set_t = te::AnySet<te::AnyHash, std::equal_to<>, std::allocator<value_type>, te::IncrementalRehash>;
+
 using te::as;
 using te::try_as;
 
@@ -78,6 +85,48 @@ struct te::Hash<std::size_t>
 	{ return n; }
 };
 
+// AnyHash without the bucket index mixing step, for tests that need to know which bucket a
+// value lands in.  Combined with the identity hash for size_t below.
+struct IdentityBucketHash: te::AnyHash
+{
+	using is_avalanching = std::true_type;
+};
+
+using identity_bucket_set_t = te::AnySet<
+	IdentityBucketHash, 
+	std::equal_to<>, 
+	std::allocator<te::AnyValue<IdentityBucketHash, std::equal_to<>>>
+>;
+
+#if __has_include(<memory_resource>)
+// Memory resource that counts what is allocated from it, for tests of te::pmr sets.
+struct CountingResource final:
+	public std::pmr::memory_resource
+{
+	std::size_t allocations = 0;
+	std::size_t deallocations = 0;
+	std::size_t bytes_in_use = 0;
+
+private:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override
+	{
+		++allocations;
+		bytes_in_use += bytes;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+	{
+		++deallocations;
+		bytes_in_use -= bytes;
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+	{ return this == &other; }
+};
+#endif
+
 template <class T>
 std::vector<T> to_vector(const any_set_t& set)
 {
@@ -19,8 +19,30 @@ TEST_CASE("Bucket", "[bucket]") {
 		set.rehash(16u);
 		REQUIRE(set.bucket_count() == 16u);
 		for(std::size_t i = 0; i < 32; ++i)
+		{
+			REQUIRE(set.bucket(i) < 16u);
+		}
+	}
+
+	SECTION("Hash codes are used as-is when the hash function is avalanching") {
+		identity_bucket_set_t set;
+		set.rehash(16u);
+		REQUIRE(set.bucket_count() == 16u);
+		for(std::size_t i = 0; i < 32; ++i)
 		{
 			REQUIRE(set.bucket(i) == (i % 16u));
 		}
 	}
+
+	SECTION("Hash codes that differ only in their high bits are spread over the buckets") {
+		any_set_t set;
+		set.rehash(64u);
+		REQUIRE(set.bucket_count() == 64u);
+		std::vector<size_type> buckets;
+		for(std::size_t i = 0; i < 32; ++i)
+			buckets.push_back(set.bucket(i * 64u));
+		std::sort(buckets.begin(), buckets.end());
+		auto distinct = std::distance(buckets.begin(), std::unique(buckets.begin(), buckets.end()));
+		REQUIRE(distinct > 8);
+	}
 }
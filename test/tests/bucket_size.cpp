@@ -5,7 +5,7 @@ TEST_CASE("Bucket Size", "[bucket-size]") {
 
 	using namespace te;
 	{
-		any_set_t set;
+		identity_bucket_set_t set;
 		set.rehash(8);
 		REQUIRE(set.bucket_count() == 8);
 		for(std::size_t i = 0; i < set.bucket_count(); ++i)
@@ -0,0 +1,214 @@
+#include "any-set.h"
+#include "anyset/ConcurrentAnySet.h"
+#include <atomic>
+#include <thread>
+
+using concurrent_set_t = te::ConcurrentAnySet<>;
+
+namespace {
+
+// A string whose move constructor yields, so that other threads get to run while an inserting
+// thread is making its node, even on a single core.  Moved-from keys are empty.
+struct YieldingKey
+{
+	explicit YieldingKey(std::string s): value(std::move(s)) { }
+
+	YieldingKey(const YieldingKey&) = default;
+
+	YieldingKey(YieldingKey&& other) noexcept:
+		value(std::exchange(other.value, std::string()))
+	{
+		std::this_thread::yield();
+	}
+
+	friend bool operator==(const YieldingKey& left, const YieldingKey& right)
+	{ return left.value == right.value; }
+
+	std::string value;
+};
+
+} /* namespace */
+
+template <>
+struct te::Hash<YieldingKey> {
+
+	std::size_t operator()(const YieldingKey& k) const
+	{ return te::hash_value(k.value); }
+};
+
+TEST_CASE("Concurrent AnySet", "[concurrent]") {
+
+	using namespace te;
+	using namespace std::literals;
+
+	SECTION("Single-threaded insertion and lookup") {
+		concurrent_set_t set;
+		REQUIRE(set.empty());
+		REQUIRE(set.begin() == set.end());
+		for(int i = 0; i < 1000; ++i)
+		{
+			auto [pos, inserted] = set.insert(i);
+			REQUIRE(inserted);
+			REQUIRE(as<int>(*pos) == i);
+			REQUIRE(set.insert(std::to_string(i)).second);
+		}
+		set._assert_invariants();
+		REQUIRE(set.size() == 2000u);
+		REQUIRE(set.bucket_count() >= 1000u);
+		REQUIRE(set.load_factor() <= set.max_load_factor());
+		for(int i = 0; i < 1000; ++i)
+		{
+			REQUIRE(set.contains(i));
+			REQUIRE(set.count(std::to_string(i)) == 1u);
+			REQUIRE(not set.contains(long(i)));
+			REQUIRE(not set.insert(i).second);
+			REQUIRE(as<int>(*set.find(i)) == i);
+		}
+		REQUIRE(not set.contains(1000));
+		REQUIRE(set.find(1000) == set.end());
+		REQUIRE(std::distance(set.begin(), set.end()) == 2000);
+		set._assert_invariants();
+	}
+
+	SECTION("Emplacement and precomputed hashes") {
+		concurrent_set_t set{1, 2, 3};
+		REQUIRE(set.emplace<std::string>(3u, 'a').second);
+		REQUIRE(not set.emplace<std::string>("aaa").second);
+		REQUIRE(not set.try_emplace<std::string>(3u, 'a').second);
+		REQUIRE(set.try_emplace<std::string>("bbb").second);
+		auto key = "ccc"s;
+		auto hk = set.hashed(key);
+		REQUIRE(not set.contains(hk));
+		REQUIRE(set.insert(hk).second);
+		REQUIRE(set.find(hk) == set.find(key));
+		REQUIRE(set.size() == 6u);
+		set._assert_invariants();
+	}
+
+	SECTION("Iterators stay valid while the table grows") {
+		concurrent_set_t set;
+		auto pos = set.insert(-1).first;
+		for(int i = 0; i < 10000; ++i)
+			set.insert(i);
+		REQUIRE(as<int>(*pos) == -1);
+		REQUIRE(set.find(-1) == pos);
+		set._assert_invariants();
+	}
+
+	SECTION("Lookups in buckets that haven't been initialized yet") {
+		concurrent_set_t set;
+		for(int i = 0; i < 100; ++i)
+			set.insert(i);
+		// Most of the new buckets stay uninitialized until something is inserted into them.
+		set.reserve(1u << 16);
+		const concurrent_set_t& cset = set;
+		for(int i = 0; i < 100; ++i)
+		{
+			REQUIRE(cset.contains(i));
+			REQUIRE(as<int>(*cset.find(i)) == i);
+			REQUIRE(not cset.contains(i + 100));
+		}
+		set._assert_invariants();
+		for(int i = 100; i < 200; ++i)
+			set.insert(i);
+		for(int i = 0; i < 200; ++i)
+			REQUIRE(cset.contains(i));
+		set._assert_invariants();
+	}
+
+	SECTION("reserve(), clear(), and swap()") {
+		concurrent_set_t set;
+		set.reserve(1000);
+		REQUIRE(set.bucket_count() * set.max_load_factor() >= 1000u);
+		for(int i = 0; i < 100; ++i)
+			set.insert(i);
+		concurrent_set_t other{"a"s, "b"s};
+		swap(set, other);
+		REQUIRE(set.size() == 2u);
+		REQUIRE(other.size() == 100u);
+		REQUIRE(set.contains("a"s));
+		REQUIRE(other.contains(99));
+		other.clear();
+		REQUIRE(other.empty());
+		REQUIRE(not other.contains(99));
+		other.insert(99);
+		REQUIRE(other.contains(99));
+		set._assert_invariants();
+		other._assert_invariants();
+	}
+
+	SECTION("Concurrent insertion and lookup") {
+		concurrent_set_t set;
+		constexpr int thread_count = 8;
+		constexpr int per_thread = 5000;
+		std::atomic<int> inserted{0};
+		std::atomic<bool> lookups_ok{true};
+		std::vector<std::thread> threads;
+		for(int t = 0; t < thread_count; ++t)
+		{
+			threads.emplace_back([&, t]() {
+				// Every value is inserted by two threads; exactly one of them must succeed.
+				int first = (t / 2) * per_thread;
+				int count = 0;
+				for(int i = first; i < first + per_thread; ++i)
+				{
+					count += set.insert(i).second;
+					if(not set.contains(i))
+						lookups_ok = false;
+					if(t % 2 == 0)
+						count += set.insert(std::to_string(i)).second;
+				}
+				inserted += count;
+			});
+		}
+		for(auto& t: threads)
+			t.join();
+		REQUIRE(lookups_ok);
+		const int distinct = (thread_count / 2) * per_thread;
+		REQUIRE(inserted == 2 * distinct);
+		REQUIRE(set.size() == std::size_t(2 * distinct));
+		for(int i = 0; i < distinct; ++i)
+		{
+			REQUIRE(set.contains(i));
+			REQUIRE(set.contains(std::to_string(i)));
+		}
+		REQUIRE(std::distance(set.begin(), set.end()) == 2 * distinct);
+		set._assert_invariants();
+	}
+
+	SECTION("Concurrent insertion of equal rvalues") {
+		constexpr int thread_count = 8;
+		constexpr int key_count = 200;
+		for(int round = 0; round < 20; ++round)
+		{
+			concurrent_set_t set;
+			std::atomic<int> inserted{0};
+			std::atomic<int> ready{0};
+			std::vector<std::thread> threads;
+			for(int t = 0; t < thread_count; ++t)
+			{
+				threads.emplace_back([&, t]() {
+					++ready;
+					while(ready < thread_count)
+						std::this_thread::yield();
+					int count = 0;
+					for(int i = 0; i < key_count; ++i)
+					{
+						YieldingKey key(std::to_string(i));
+						if(t % 2 == 0)
+							count += set.insert(std::move(key)).second;
+						else
+							count += set.try_emplace<YieldingKey>(std::move(key)).second;
+					}
+					inserted += count;
+				});
+			}
+			for(auto& t: threads)
+				t.join();
+			REQUIRE(inserted == key_count);
+			REQUIRE(set.size() == std::size_t(key_count));
+			REQUIRE(std::distance(set.begin(), set.end()) == key_count);
+			set._assert_invariants();
+		}
+	}
+}
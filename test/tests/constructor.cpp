@@ -137,4 +137,46 @@ TEST_CASE("Constructor", "[constructor]") {
 			REQUIRE(set.bucket_count() >= numbers.size());
 		}
 	}
+
+	SECTION("Copies have the same layout as the original") {
+		auto check_layout = [](const auto& set, bool same_buckets) {
+			std::decay_t<decltype(set)> copy(set);
+			copy._assert_invariants();
+			REQUIRE(copy.bucket_count() == set.bucket_count());
+			REQUIRE(std::equal(set.begin(), set.end(), copy.begin(), copy.end()));
+			for(std::size_t i = 0; same_buckets and i < set.bucket_count(); ++i)
+				REQUIRE(copy.bucket_size(i) == set.bucket_size(i));
+			std::decay_t<decltype(set)> assigned;
+			assigned = set;
+			assigned._assert_invariants();
+			REQUIRE(assigned.bucket_count() == set.bucket_count());
+			REQUIRE(std::equal(set.begin(), set.end(), assigned.begin(), assigned.end()));
+		};
+		any_set_t chained;
+		oa_set_t open;
+		ir_set_t incremental;
+		for(int i = 0; i < 1000; ++i)
+		{
+			chained.insert(i, std::to_string(i), static_cast<long>(i));
+			open.insert(i, std::to_string(i), static_cast<long>(i));
+			incremental.insert(i, std::to_string(i), static_cast<long>(i));
+		}
+		for(int i = 0; i < 1000; i += 7)
+		{
+			chained.erase(i);
+			open.erase(i);
+		}
+		check_layout(chained, true);
+		// Open addressing copies don't inherit the original's deleted slots.
+		check_layout(open, false);
+		check_layout(incremental, true);
+		check_layout(any_set_t{}, true);
+	}
+
+	SECTION("Copying a set of non-copyable values throws") {
+		any_set_t set{1, 2, 3};
+		set.emplace<UniqueInt>(std::make_unique<int>(4));
+		set.insert(5, 6, 7);
+		REQUIRE_THROWS_AS(any_set_t(set), const NoCopyConstructorError<UniqueInt>&);
+	}
 }
@@ -0,0 +1,122 @@
+#include "any-set.h"
+#include "anyset/SetOperations.h"
+
+namespace {
+
+template <class Set>
+te::ContentDigest recompute_digest(const Set& set)
+{
+	te::ContentDigest digest;
+	for(const auto& v: set)
+		digest.add(v.hash);
+	return digest;
+}
+
+template <class Set>
+void check_digest_tracks_contents()
+{
+	using namespace std::literals;
+	Set set;
+	REQUIRE(set.content_digest() == te::ContentDigest{});
+
+	for(int i = 0; i < 200; ++i)
+		set.insert(i);
+	set.insert("a"s, "b"s, 1.5);
+	REQUIRE(set.content_digest() == recompute_digest(set));
+
+	// Insertion order doesn't matter.
+	Set reversed;
+	reversed.insert(1.5, "b"s, "a"s);
+	for(int i = 200; i-- > 0;)
+		reversed.insert(i);
+	REQUIRE(reversed.content_digest() == set.content_digest());
+
+	set.erase(7);
+	set.erase("a"s);
+	REQUIRE(set.content_digest() == recompute_digest(set));
+	REQUIRE(set.content_digest() != reversed.content_digest());
+
+	auto [node, next] = set.pop(set.find(8));
+	REQUIRE(set.content_digest() == recompute_digest(set));
+	set.push(std::move(node));
+	REQUIRE(set.content_digest() == recompute_digest(set));
+
+	set.rehash(set.bucket_count() * 8u);
+	set._assert_invariants();
+	REQUIRE(set.content_digest() == recompute_digest(set));
+
+	Set other;
+	for(int i = 150; i < 300; ++i)
+		other.insert(i);
+	set.update(other);
+	REQUIRE(set.content_digest() == recompute_digest(set));
+	set.update(std::move(other));
+	REQUIRE(set.content_digest() == recompute_digest(set));
+	REQUIRE(other.content_digest() == recompute_digest(other));
+
+	Set copy(set);
+	REQUIRE(copy.content_digest() == set.content_digest());
+	Set moved(std::move(copy));
+	REQUIRE(moved.content_digest() == set.content_digest());
+	REQUIRE(copy.content_digest() == te::ContentDigest{});
+
+	swap(moved, other);
+	REQUIRE(other.content_digest() == set.content_digest());
+
+	other.splice(set, set.find(299));
+	REQUIRE(other.content_digest() == recompute_digest(other));
+	REQUIRE(set.content_digest() == recompute_digest(set));
+
+	set.clear();
+	REQUIRE(set.content_digest() == te::ContentDigest{});
+
+	std::vector<int> ints;
+	for(int i = 0; i < 5000; ++i)
+		ints.push_back(i % 3000);
+	set.insert(te::ParallelPolicy(4), ints.begin(), ints.end());
+	set._assert_invariants();
+	REQUIRE(set.content_digest() == recompute_digest(set));
+}
+
+} /* namespace */
+
+TEST_CASE("Content digest", "[content-digest]") {
+
+	using namespace te;
+	using namespace std::literals;
+
+	SECTION("The digest tracks the contents of the set") {
+		check_digest_tracks_contents<any_set_t>();
+		check_digest_tracks_contents<oa_set_t>();
+		check_digest_tracks_contents<ir_set_t>();
+	}
+
+	SECTION("Equal sets have equal digests, and sets with different digests are unequal") {
+		any_set_t a({1, 2, 3});
+		any_set_t b({3, 2, 1});
+		any_set_t c({1, 2, 4});
+		REQUIRE(a.content_digest() == b.content_digest());
+		REQUIRE(a == b);
+		REQUIRE(a.content_digest() != c.content_digest());
+		REQUIRE(a != c);
+		REQUIRE(not is_subset_of(a, c));
+		REQUIRE(is_subset_of(a, b));
+	}
+
+	SECTION("te::Hash<AnySet> hashes sets by their contents") {
+		any_set_t a({1, 2, 3});
+		any_set_t b({3, 2, 1});
+		any_set_t c({"1"s, "2"s});
+		REQUIRE(te::Hash<any_set_t>{}(a) == te::Hash<any_set_t>{}(b));
+		REQUIRE(te::Hash<any_set_t>{}(a) != te::Hash<any_set_t>{}(c));
+		REQUIRE(te::Hash<any_set_t>{}(any_set_t{}) == te::ContentDigest{}.value());
+
+		// Sets can now be elements of other sets.
+		any_set_t sets;
+		REQUIRE(sets.insert(a).second);
+		REQUIRE(not sets.insert(b).second);
+		REQUIRE(sets.insert(c).second);
+		REQUIRE(sets.contains(any_set_t({2, 1, 3})));
+		REQUIRE(not sets.contains(any_set_t({1, 2})));
+	}
+}
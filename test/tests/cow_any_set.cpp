@@ -0,0 +1,212 @@
+#include "any-set.h"
+#include "anyset/CowAnySet.h"
+#include "anyset/SetOperations.h"
+#include <thread>
+
+namespace {
+
+// Counts copies, to check that shared sets are cloned only when they change.
+struct Counted
+{
+	Counted(int v): value(v) {}
+	Counted(const Counted& other): value(other.value) { ++copies; }
+
+	friend bool operator==(const Counted& l, const Counted& r)
+	{ return l.value == r.value; }
+
+	int value;
+	static inline int copies = 0;
+};
+
+} /* namespace */
+
+template <>
+struct std::hash<Counted>
+{
+	std::size_t operator()(const Counted& v) const
+	{ return std::hash<int>{}(v.value); }
+};
+
+namespace {
+
+using cow_set_t = te::CowAnySet<>;
+
+cow_set_t make_counted(int count)
+{
+	any_set_t set;
+	for(int i = 0; i < count; ++i)
+		set.emplace<Counted>(i);
+	return cow_set_t(std::move(set));
+}
+
+} /* namespace */
+
+TEST_CASE("CowAnySet", "[cow]") {
+
+	using namespace std::literals;
+
+	SECTION("Empty set") {
+		cow_set_t set;
+		set._assert_invariants();
+		REQUIRE(set.empty());
+		REQUIRE(set.size() == 0u);
+		REQUIRE(set.begin() == set.end());
+		REQUIRE(not set.contains(1));
+		REQUIRE(set.erase(1) == 0u);
+		REQUIRE(not set.is_shared());
+		cow_set_t other;
+		REQUIRE(set == other);
+	}
+	SECTION("Copies share the set") {
+		Counted::copies = 0;
+		auto a = make_counted(100);
+		auto b = a;
+		REQUIRE(a.is_shared());
+		REQUIRE(b.shares_with(a));
+		REQUIRE(std::addressof(*a) == std::addressof(*b));
+		REQUIRE(Counted::copies == 0);
+		REQUIRE(a == b);
+	}
+	SECTION("The first change clones") {
+		Counted::copies = 0;
+		auto a = make_counted(100);
+		auto b = a;
+		auto c = a;
+		REQUIRE(b.insert(Counted(100)).second);
+		b._assert_invariants();
+		REQUIRE(Counted::copies == 101);
+		REQUIRE(not b.is_shared());
+		REQUIRE(a.shares_with(c));
+		REQUIRE(b.size() == 101u);
+		REQUIRE(a.size() == 100u);
+		REQUIRE(not a.contains(Counted(100)));
+		// 'b' is no longer shared, so this doesn't clone.
+		REQUIRE(b.erase(Counted(0)) == 1u);
+		REQUIRE(Counted::copies == 101);
+		REQUIRE(a.contains(Counted(0)));
+		REQUIRE(c.contains(Counted(0)));
+	}
+	SECTION("Changes without effect don't clone") {
+		Counted::copies = 0;
+		auto a = make_counted(100);
+		auto b = a;
+		REQUIRE(not b.insert(Counted(5)).second);
+		REQUIRE(not b.emplace<Counted>(5).second);
+		REQUIRE(b.erase(Counted(1000)) == 0u);
+		REQUIRE(b.erase(5) == 0u);
+		b.update(a);
+		REQUIRE(b.shares_with(a));
+		REQUIRE(Counted::copies == 0);
+		REQUIRE(b.emplace<Counted>(200).second);
+		REQUIRE(not b.shares_with(a));
+		REQUIRE(b.size() == 101u);
+		REQUIRE(a.size() == 100u);
+	}
+	SECTION("mutate") {
+		cow_set_t a(any_set_t{1, 2, 3});
+		auto b = a;
+		auto& set = b.mutate();
+		REQUIRE(not b.is_shared());
+		set.insert("four"s, 5.0);
+		set.erase(1);
+		REQUIRE(b.size() == 4u);
+		REQUIRE(b.contains("four"s));
+		REQUIRE(a == cow_set_t(any_set_t{1, 2, 3}));
+	}
+	SECTION("clear and release") {
+		cow_set_t a(any_set_t{1, 2, 3});
+		auto b = a;
+		b.clear();
+		REQUIRE(b.empty());
+		REQUIRE(a.size() == 3u);
+		auto c = a;
+		any_set_t released = c.release();
+		REQUIRE(c.empty());
+		REQUIRE(released == any_set_t({1, 2, 3}));
+		REQUIRE(a.size() == 3u);
+		any_set_t moved = a.release();
+		REQUIRE(moved == released);
+		REQUIRE(a.empty());
+	}
+	SECTION("update copies elements with the set's memory resource") {
+		using pmr_cow_set_t = te::CowAnySet<te::AnyHash, std::equal_to<>, te::pmr::AnySet<>::allocator_type>;
+		CountingResource res_a;
+		pmr_cow_set_t a{te::pmr::AnySet<>(&res_a)};
+		a.insert(0);
+		{
+			CountingResource res_b;
+			te::pmr::AnySet<> b_set(&res_b);
+			for(int i = 0; i < 10; ++i)
+				b_set.insert(i);
+			pmr_cow_set_t b(std::move(b_set));
+			std::size_t a_allocs = res_a.allocations;
+			std::size_t b_allocs = res_b.allocations;
+			a.update(b);
+			REQUIRE(res_a.allocations >= a_allocs + 9u);
+			REQUIRE(res_b.allocations == b_allocs);
+		}
+		REQUIRE(a.size() == 10u);
+		for(int i = 0; i < 10; ++i)
+			REQUIRE(a.contains(i));
+		a->_assert_invariants();
+	}
+	SECTION("Concurrent copies") {
+		auto base = make_counted(1000);
+		std::vector<std::thread> threads;
+		std::vector<std::size_t> sizes(4, 0u);
+		for(std::size_t t = 0; t < sizes.size(); ++t)
+		{
+			threads.emplace_back([&, t]() {
+				for(int i = 0; i < 100; ++i)
+				{
+					auto mine = base;
+					mine.erase(Counted(static_cast<int>(t)));
+					sizes[t] = mine.size();
+				}
+			});
+		}
+		for(auto& th: threads)
+			th.join();
+		for(auto n: sizes)
+			REQUIRE(n == 999u);
+		REQUIRE(base.size() == 1000u);
+		REQUIRE(not base.is_shared());
+	}
+	SECTION("Set operations") {
+		any_set_t any_a, any_b, any_c;
+		for(int i = 0; i < 100; ++i)
+		{
+			any_a.insert(i);
+			if(i % 2 == 0)
+				any_b.insert(i);
+			if(i % 3 == 0)
+				any_c.insert(i);
+		}
+		cow_set_t a(any_a), b(any_b), c(any_c);
+
+		auto u = te::union_of(b, c);
+		u._assert_invariants();
+		REQUIRE(*u == te::union_of(any_b, any_c));
+		auto i = te::intersection_of(a, b, c);
+		i._assert_invariants();
+		REQUIRE(*i == te::intersection_of(any_a, any_b, any_c));
+		auto s = te::symmetric_difference_of(a, b, c);
+		s._assert_invariants();
+		REQUIRE(*s == te::symmetric_difference_of(any_a, any_b, any_c));
+		auto d = te::difference_of(a, b, any_c);
+		d._assert_invariants();
+		REQUIRE(*d == te::difference_of(any_a, any_b, any_c));
+		REQUIRE(te::difference_of(any_a, b, c) == te::difference_of(any_a, any_b, any_c));
+
+		REQUIRE(te::is_subset_of(b, a));
+		REQUIRE(te::is_subset_of(any_b, a));
+		REQUIRE(te::is_superset_of(a, any_c));
+		REQUIRE(not te::is_subset_of(a, b));
+
+		// Results that equal an argument share its set.
+		REQUIRE(te::union_of(a, b, c).shares_with(a));
+		REQUIRE(te::intersection_of(a, b).shares_with(b));
+		REQUIRE(te::difference_of(b, cow_set_t(any_set_t{1, 3})).shares_with(b));
+		REQUIRE(te::symmetric_difference_of(a, cow_set_t()).shares_with(a));
+	}
+}
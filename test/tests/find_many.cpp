@@ -0,0 +1,95 @@
+#include "any-set.h"
+#include <functional>
+
+TEST_CASE("Batched Lookup", "[find_many]") {
+
+	using namespace te;
+	using namespace std::literals;
+
+	any_set_t set;
+	for(int i = 0; i < 1000; i += 2)
+	{
+		set.insert(i);
+		set.insert(std::to_string(i));
+	}
+	std::vector<int> keys(1000);
+	std::iota(keys.begin(), keys.end(), 0);
+
+	SECTION("find_many() agrees with find()") {
+		std::vector<any_set_t::const_iterator> found;
+		const auto& cset = set;
+		cset.find_many(keys.begin(), keys.end(), std::back_inserter(found));
+		REQUIRE(found.size() == keys.size());
+		for(std::size_t i = 0; i < keys.size(); ++i)
+			REQUIRE(found[i] == cset.find(keys[i]));
+
+		std::vector<any_set_t::iterator> found_mut;
+		set.find_many(keys.begin(), keys.end(), std::back_inserter(found_mut));
+		for(std::size_t i = 0; i < keys.size(); ++i)
+			REQUIRE(found_mut[i] == set.find(keys[i]));
+	}
+
+	SECTION("contains_many() agrees with contains()") {
+		std::vector<bool> found;
+		set.contains_many(keys.begin(), keys.end(), std::back_inserter(found));
+		REQUIRE(found.size() == keys.size());
+		for(std::size_t i = 0; i < keys.size(); ++i)
+			REQUIRE(found[i] == set.contains(keys[i]));
+
+		// Same values with a different type are not found.
+		std::vector<long> longs(keys.begin(), keys.end());
+		found.clear();
+		set.contains_many(longs.begin(), longs.end(), std::back_inserter(found));
+		REQUIRE(std::none_of(found.begin(), found.end(), [](bool b) { return b; }));
+	}
+
+	SECTION("contains_many() with a bitset") {
+		auto bs = set.contains_many<40>(keys.begin() + 10);
+		for(std::size_t i = 0; i < bs.size(); ++i)
+			REQUIRE(bs[i] == set.contains(keys[10 + i]));
+	}
+
+	SECTION("Ranges of AnyValues") {
+		any_set_t other(std::make_tuple(0, 1, 2, 3, "0"s, "1"s, 2.0));
+		std::vector<bool> found;
+		set.contains_many(other.begin(), other.end(), std::back_inserter(found));
+		auto pos = other.begin();
+		for(bool b: found)
+			REQUIRE(b == set.contains_value(*pos++));
+
+		std::vector<std::reference_wrapper<const any_set_t::value_type>> refs(other.begin(), other.end());
+		std::vector<any_set_t::const_iterator> iters;
+		std::as_const(set).find_many(refs.begin(), refs.end(), std::back_inserter(iters));
+		for(std::size_t i = 0; i < refs.size(); ++i)
+			REQUIRE((iters[i] == set.cend()) != set.contains_value(refs[i].get()));
+	}
+
+	SECTION("Open addressing and incremental rehash sets") {
+		oa_set_t open;
+		ir_set_t incremental;
+		for(int i = 0; i < 1000; i += 2)
+		{
+			open.insert(i, std::to_string(i));
+			incremental.insert(i, std::to_string(i));
+		}
+		std::vector<bool> open_found;
+		std::vector<bool> incremental_found;
+		open.contains_many(keys.begin(), keys.end(), std::back_inserter(open_found));
+		incremental.contains_many(keys.begin(), keys.end(), std::back_inserter(incremental_found));
+		for(std::size_t i = 0; i < keys.size(); ++i)
+		{
+			REQUIRE(open_found[i] == set.contains(keys[i]));
+			REQUIRE(incremental_found[i] == set.contains(keys[i]));
+		}
+	}
+
+	SECTION("Empty ranges and empty sets") {
+		std::vector<bool> found;
+		set.contains_many(keys.begin(), keys.begin(), std::back_inserter(found));
+		REQUIRE(found.empty());
+		any_set_t empty;
+		empty.contains_many(keys.begin(), keys.end(), std::back_inserter(found));
+		REQUIRE(found.size() == keys.size());
+		REQUIRE(std::none_of(found.begin(), found.end(), [](bool b) { return b; }));
+	}
+}
@@ -0,0 +1,233 @@
+#include "any-set.h"
+#include "anyset/FrozenAnySet.h"
+#include "anyset/SetOperations.h"
+#include <set>
+#include <thread>
+
+namespace {
+
+// Every Collider has the same hash code.
+struct Collider
+{
+	int value;
+
+	friend bool operator==(const Collider& l, const Collider& r)
+	{ return l.value == r.value; }
+};
+
+struct alignas(64) OverAligned
+{
+	int value;
+
+	friend bool operator==(const OverAligned& l, const OverAligned& r)
+	{ return l.value == r.value; }
+};
+
+struct CopyThrows
+{
+	CopyThrows(int v): value(v) { }
+	CopyThrows(const CopyThrows&) { throw std::runtime_error("CopyThrows"); }
+	friend bool operator==(const CopyThrows& l, const CopyThrows& r)
+	{ return l.value == r.value; }
+	int value;
+};
+
+} /* namespace */
+
+template <>
+struct std::hash<Collider>
+{
+	std::size_t operator()(const Collider&) const
+	{ return 12345u; }
+};
+
+template <>
+struct std::hash<OverAligned>
+{
+	std::size_t operator()(const OverAligned& v) const
+	{ return std::hash<int>{}(v.value); }
+};
+
+template <>
+struct std::hash<CopyThrows>
+{
+	std::size_t operator()(const CopyThrows& v) const
+	{ return std::hash<int>{}(v.value); }
+};
+
+namespace {
+
+using frozen_set_t = te::FrozenAnySet<>;
+
+template <class Set>
+void check_frozen_copy(const Set& set)
+{
+	frozen_set_t frozen(set);
+	frozen._assert_invariants();
+	REQUIRE(frozen.size() == set.size());
+	REQUIRE(frozen.empty() == set.empty());
+	REQUIRE(static_cast<std::size_t>(std::distance(frozen.begin(), frozen.end())) == set.size());
+	std::set<const value_type*> seen;
+	for(const auto& v: frozen)
+	{
+		REQUIRE(set.contains_value(v));
+		REQUIRE(frozen.contains_value(v));
+		REQUIRE(std::addressof(*frozen.find(v)) == std::addressof(v));
+		REQUIRE(seen.insert(std::addressof(v)).second);
+	}
+	for(const auto& v: set)
+		REQUIRE(frozen.contains_value(v));
+}
+
+} /* namespace */
+
+TEST_CASE("FrozenAnySet", "[frozen]") {
+
+	using namespace std::literals;
+
+	SECTION("Empty set") {
+		any_set_t set;
+		frozen_set_t frozen(set);
+		frozen._assert_invariants();
+		REQUIRE(frozen.empty());
+		REQUIRE(frozen.size() == 0u);
+		REQUIRE(frozen.begin() == frozen.end());
+		REQUIRE(not frozen.contains(1));
+		REQUIRE(frozen.find(1) == frozen.end());
+	}
+	SECTION("Lookup") {
+		any_set_t set;
+		for(int i = 0; i < 10000; ++i)
+			set.insert(i);
+		set.insert("abc"s, 1.5, 'x');
+		check_frozen_copy(set);
+
+		frozen_set_t frozen(set);
+		for(int i = 0; i < 10000; ++i)
+		{
+			REQUIRE(frozen.contains(i));
+			REQUIRE(frozen.count(i) == 1u);
+			REQUIRE(te::as<int>(*frozen.find(i)) == i);
+		}
+		for(int i = 10000; i < 20000; ++i)
+		{
+			REQUIRE(not frozen.contains(i));
+			REQUIRE(frozen.count(i) == 0u);
+			REQUIRE(frozen.find(i) == frozen.end());
+		}
+		REQUIRE(frozen.contains("abc"s));
+		REQUIRE(frozen.contains(1.5));
+		REQUIRE(frozen.contains('x'));
+		// Same value, different type.
+		REQUIRE(not frozen.contains(static_cast<long>(1)));
+		REQUIRE(not frozen.contains("abd"s));
+	}
+	SECTION("Hashed keys") {
+		any_set_t set;
+		for(int i = 0; i < 100; ++i)
+			set.insert(std::to_string(i));
+		frozen_set_t frozen(set);
+		auto key = "42"s;
+		auto missing = "420"s;
+		REQUIRE(frozen.contains(frozen.hashed(key)));
+		REQUIRE(te::as<std::string>(*frozen.find(frozen.hashed(key))) == "42");
+		REQUIRE(not frozen.contains(frozen.hashed(missing)));
+	}
+	SECTION("Equal hash codes") {
+		any_set_t set;
+		for(int i = 0; i < 50; ++i)
+			set.insert(Collider{i}, i);
+		check_frozen_copy(set);
+
+		frozen_set_t frozen(set);
+		for(int i = 0; i < 50; ++i)
+		{
+			REQUIRE(frozen.contains(Collider{i}));
+			REQUIRE(te::as<Collider>(*frozen.find(Collider{i})).value == i);
+		}
+		REQUIRE(not frozen.contains(Collider{50}));
+	}
+	SECTION("Over-aligned elements") {
+		any_set_t set;
+		for(int i = 0; i < 100; ++i)
+			set.insert(OverAligned{i}, i);
+		check_frozen_copy(set);
+
+		frozen_set_t frozen(set);
+		for(int i = 0; i < 100; ++i)
+		{
+			const auto& v = te::as<OverAligned>(*frozen.find(OverAligned{i}));
+			REQUIRE(v.value == i);
+			REQUIRE(reinterpret_cast<std::uintptr_t>(std::addressof(v)) % alignof(OverAligned) == 0u);
+		}
+	}
+	SECTION("Other table policies") {
+		oa_set_t oa_set;
+		ir_set_t ir_set;
+		for(int i = 0; i < 3000; ++i)
+		{
+			oa_set.insert(i, std::to_string(i));
+			ir_set.insert(i, std::to_string(i));
+		}
+		check_frozen_copy(oa_set);
+		check_frozen_copy(ir_set);
+	}
+	SECTION("Copy constructor throws") {
+		any_set_t set;
+		for(int i = 0; i < 100; ++i)
+			set.insert(i, std::to_string(i));
+		set.emplace<CopyThrows>(7);
+		REQUIRE_THROWS_AS(frozen_set_t(set), const std::runtime_error&);
+		set.emplace<UniqueInt>(UniqueInt::make(1));
+		set.erase(CopyThrows(7));
+		REQUIRE_THROWS_AS(frozen_set_t(set), const te::NoCopyConstructorError<UniqueInt>&);
+	}
+	SECTION("Move construction") {
+		any_set_t set{1, 2, 3};
+		frozen_set_t frozen(set);
+		frozen_set_t moved(std::move(frozen));
+		REQUIRE(moved.size() == 3u);
+		REQUIRE(moved.contains(2));
+		REQUIRE(moved == frozen_set_t(set));
+		REQUIRE(frozen.empty());
+		REQUIRE(not frozen.contains(2));
+		REQUIRE(frozen.begin() == frozen.end());
+	}
+	SECTION("Concurrent readers") {
+		any_set_t set;
+		for(int i = 0; i < 20000; ++i)
+			set.insert(i);
+		const frozen_set_t frozen(set);
+		std::vector<std::thread> threads;
+		std::vector<std::size_t> found(4, 0u);
+		for(std::size_t t = 0; t < found.size(); ++t)
+		{
+			threads.emplace_back([&, t]() {
+				for(int i = 0; i < 40000; ++i)
+					found[t] += frozen.contains(i);
+			});
+		}
+		for(auto& th: threads)
+			th.join();
+		for(auto n: found)
+			REQUIRE(n == 20000u);
+	}
+	SECTION("Set operation inputs") {
+		any_set_t left{1, 2, 3, 4, 5};
+		any_set_t right;
+		right.insert(2, 4, 6);
+		frozen_set_t frozen(right);
+		REQUIRE(te::difference_of(left, frozen) == te::difference_of(left, right));
+		REQUIRE(te::difference_of(te::par, left, frozen) == te::difference_of(left, right));
+		REQUIRE((te::difference_of(any_set_t(left), frozen) == any_set_t{1, 3, 5}));
+
+		any_set_t sub{2, 4};
+		frozen_set_t frozen_sub(sub);
+		REQUIRE(te::is_subset_of(sub, frozen));
+		REQUIRE(te::is_subset_of(frozen_sub, frozen));
+		REQUIRE(te::is_subset_of(frozen_sub, right));
+		REQUIRE(te::is_superset_of(frozen, sub));
+		REQUIRE(not te::is_subset_of(frozen, sub));
+		REQUIRE(not te::is_subset_of(left, frozen));
+	}
+}
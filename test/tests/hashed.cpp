@@ -0,0 +1,135 @@
+#include "any-set.h"
+#include "anyset/SetOperations.h"
+
+namespace {
+
+struct CountingHash
+{
+	static inline std::size_t calls = 0;
+
+	template <class T>
+	std::size_t operator()(const T& value) const
+	{
+		++calls;
+		return te::AnyHash{}(value);
+	}
+};
+
+using counting_allocator_t = std::allocator<te::AnyValue<CountingHash, std::equal_to<>>>;
+using counting_set_t = te::AnySet<CountingHash, std::equal_to<>, counting_allocator_t>;
+using counting_oa_set_t = te::AnySet<CountingHash, std::equal_to<>, counting_allocator_t, te::OpenAddressing>;
+using counting_ir_set_t = te::AnySet<CountingHash, std::equal_to<>, counting_allocator_t, te::IncrementalRehash>;
+
+template <class Set>
+void check_hashed_keys()
+{
+	using namespace te;
+	using namespace std::literals;
+
+	Set set;
+	for(int i = 0; i < 100; ++i)
+		set.insert(std::to_string(i));
+	set.insert(1, 2, 3);
+
+	// Lookups with a Hashed<T> don't hash the key
+	{
+		auto present = "42"s;
+		auto absent = "abc"s;
+		auto hp = set.hashed(present);
+		auto ha = set.hashed(absent);
+		REQUIRE(hp.hash == CountingHash{}(present));
+		auto calls = CountingHash::calls;
+		REQUIRE(set.contains(hp));
+		REQUIRE(not set.contains(ha));
+		REQUIRE(set.count(hp) == 1u);
+		REQUIRE(set.find(hp) == set.find(present));
+		REQUIRE(set.find(ha) == set.end());
+		REQUIRE(std::as_const(set).find(hp) == std::as_const(set).find(present));
+		REQUIRE(set.equal_range(hp).first == set.find(present));
+		REQUIRE(set.contains_eq(hp));
+		REQUIRE(not set.contains_eq(ha));
+		REQUIRE(set.bucket(hp) == set.bucket(present));
+		std::vector<Hashed<std::string>> keys{hp, ha};
+		std::vector<bool> found;
+		set.contains_many(keys.begin(), keys.end(), std::back_inserter(found));
+		REQUIRE((found == std::vector<bool>{true, false}));
+		// Only the calls in the REQUIREs above with a plain key hash anything.
+		REQUIRE(CountingHash::calls == calls + 4u);
+	}
+
+	// Insertion and erasure with a Hashed<T> don't hash the key
+	{
+		auto key = "new"s;
+		auto hk = set.hashed(key);
+		auto calls = CountingHash::calls;
+		auto [pos, inserted] = set.insert(hk);
+		REQUIRE(inserted);
+		REQUIRE(as<std::string>(*pos) == key);
+		REQUIRE(pos->hash == hk.hash);
+		REQUIRE(not set.insert(hk).second);
+		REQUIRE(not set.template emplace<std::string>(hk).second);
+		REQUIRE(set.erase(hk) == 1u);
+		REQUIRE(set.template emplace<std::string>(hk).second);
+		REQUIRE(set.erase(hk) == 1u);
+		REQUIRE(set.erase(hk) == 0u);
+		REQUIRE(CountingHash::calls == calls);
+		set._assert_invariants();
+	}
+
+	// One Hashed<T> can be used with several sets
+	{
+		Set other{4, 5, 6};
+		auto key = 5;
+		auto hk = make_hashed(key, CountingHash{});
+		auto calls = CountingHash::calls;
+		REQUIRE(not set.contains(hk));
+		REQUIRE(other.contains(hk));
+		set.insert(hk);
+		REQUIRE(set.contains(hk));
+		REQUIRE(CountingHash::calls == calls);
+		REQUIRE(set.contains(5));
+		set._assert_invariants();
+	}
+
+	// Hashed AnyValues use the stored hash
+	{
+		Set other{1, 2, 7};
+		auto calls = CountingHash::calls;
+		std::size_t found = 0;
+		for(const auto& v: other)
+			found += set.contains(set.hashed(v));
+		REQUIRE(found == 2u);
+		REQUIRE(CountingHash::calls == calls);
+	}
+
+	// Range insertion of Hashed<T>s
+	{
+		std::vector<std::string> strings{"x", "y", "1", "z"};
+		std::vector<Hashed<std::string>> keys;
+		for(const auto& s: strings)
+			keys.push_back(set.hashed(s));
+		auto size = set.size();
+		REQUIRE(set.insert(keys.begin(), keys.end()) == 3u);
+		REQUIRE(set.size() == size + 3u);
+		for(const auto& s: strings)
+			REQUIRE(set.contains(s));
+		set._assert_invariants();
+	}
+}
+
+} /* namespace */
+
+TEST_CASE("Precomputed Hashes", "[hashed]") {
+
+	SECTION("Chained buckets") {
+		check_hashed_keys<counting_set_t>();
+	}
+
+	SECTION("Open addressing") {
+		check_hashed_keys<counting_oa_set_t>();
+	}
+
+	SECTION("Incremental rehash") {
+		check_hashed_keys<counting_ir_set_t>();
+	}
+}
@@ -0,0 +1,164 @@
+#include "any-set.h"
+#include "anyset/SetOperations.h"
+#include <random>
+#include <unordered_set>
+
+namespace {
+
+// Insert integers until the bucket table doubles.  The insertion that triggers the rehash
+// only migrates a few buckets, so a migration is in progress afterwards.
+void insert_until_growth(ir_set_t& set, int& next)
+{
+	auto bcount = set.bucket_count();
+	while(set.bucket_count() == bcount)
+		set.insert(next++);
+}
+
+} /* namespace */
+
+TEST_CASE("Incremental Rehash", "[incremental_rehash]") {
+
+	using namespace te;
+	using namespace std::literals;
+
+	SECTION("Random inserts and erases agree with std::unordered_set") {
+		std::mt19937 gen(0);
+		std::uniform_int_distribution<int> dist(0, 5000);
+		std::unordered_set<int> expect;
+		ir_set_t set;
+		for(int i = 0; i < 30000; ++i)
+		{
+			int v = dist(gen);
+			if(i % 4 == 0)
+			{
+				REQUIRE(set.erase(v) == expect.erase(v));
+				set.erase(std::to_string(v));
+			}
+			else
+			{
+				REQUIRE(set.insert(v).second == expect.insert(v).second);
+				set.insert(std::to_string(v));
+			}
+			if(i % 97 == 0)
+				set._assert_invariants(true);
+		}
+		REQUIRE(set.size() == 2 * expect.size());
+		for(int v: expect)
+		{
+			REQUIRE(set.contains(v));
+			REQUIRE(set.count(std::to_string(v)) == 1u);
+		}
+	}
+
+	SECTION("Growing leaves the upper buckets empty until they are migrated") {
+		ir_set_t set;
+		int next = 0;
+		while(set.bucket_count() < 1024u)
+			insert_until_growth(set, next);
+		set._assert_invariants(true);
+		auto half = set.bucket_count() / 2;
+		// Only the first few buckets have been migrated.
+		for(auto i = half / 2; i < half; ++i)
+			REQUIRE(set.bucket_size(i + half) == 0u);
+		std::size_t total = 0;
+		for(std::size_t i = 0; i < set.bucket_count(); ++i)
+		{
+			total += set.bucket_size(i);
+			for(auto pos = set.begin(i); pos != set.end(i); ++pos)
+				REQUIRE(set.bucket(as<int>(*pos)) == i);
+		}
+		REQUIRE(total == set.size());
+		for(int i = 0; i < next; ++i)
+			REQUIRE(set.contains(i));
+	}
+
+	SECTION("Inserted elements' iterators are correct during a migration") {
+		ir_set_t set;
+		int next = 0;
+		insert_until_growth(set, next);
+		insert_until_growth(set, next);
+		for(int i = 0; i < 200; ++i, ++next)
+		{
+			auto [pos, inserted] = set.insert(next);
+			REQUIRE(inserted);
+			REQUIRE(as<int>(*pos) == next);
+			auto [pos2, inserted2] = set.emplace<std::string>(std::to_string(next));
+			REQUIRE(inserted2);
+			REQUIRE(as<std::string>(*pos2) == std::to_string(next));
+			set._assert_invariants();
+		}
+	}
+
+	SECTION("rehash() finishes the migration") {
+		ir_set_t set;
+		int next = 0;
+		while(set.bucket_count() < 4096u)
+			insert_until_growth(set, next);
+		auto bcount = set.bucket_count();
+		auto half = bcount / 2;
+		set.rehash(0);
+		REQUIRE(set.bucket_count() == bcount);
+		set._assert_invariants(true);
+		std::size_t upper = 0;
+		for(auto i = half; i < bcount; ++i)
+			upper += set.bucket_size(i);
+		REQUIRE(upper > 0u);
+		set.reserve(4 * bcount);
+		REQUIRE(set.bucket_count() > bcount);
+		set._assert_invariants(true);
+		for(int i = 0; i < next; ++i)
+			REQUIRE(set.contains(i));
+	}
+
+	SECTION("Erasing, popping, and pushing during a migration") {
+		ir_set_t set;
+		int next = 0;
+		while(set.bucket_count() < 512u)
+			insert_until_growth(set, next);
+		for(int i = 0; i < next; i += 3)
+		{
+			REQUIRE(set.erase(i) == 1u);
+			set._assert_invariants();
+		}
+		ir_set_t other;
+		for(int i = 1; i < next; i += 3)
+		{
+			auto [node, pos] = set.pop(set.find(i));
+			REQUIRE(other.push(std::move(node)).second == nullptr);
+		}
+		set._assert_invariants();
+		other._assert_invariants();
+		for(int i = 0; i < next; ++i)
+		{
+			REQUIRE(set.contains(i) == (i % 3 == 2));
+			REQUIRE(other.contains(i) == (i % 3 == 1));
+		}
+	}
+
+	SECTION("Copying, moving, swapping, and clearing during a migration") {
+		ir_set_t set;
+		int next = 0;
+		while(set.bucket_count() < 512u)
+			insert_until_growth(set, next);
+		ir_set_t copy(set);
+		copy._assert_invariants();
+		REQUIRE(copy == set);
+		ir_set_t moved(std::move(copy));
+		moved._assert_invariants();
+		REQUIRE(moved == set);
+		ir_set_t other{1.0, 2.0, 3.0};
+		swap(moved, other);
+		moved._assert_invariants();
+		other._assert_invariants();
+		REQUIRE(other == set);
+		other.insert(next);
+		other._assert_invariants();
+		set.clear();
+		set._assert_invariants();
+		REQUIRE(set.empty());
+		for(int i = 0; i < 100; ++i)
+			set.insert(i);
+		set._assert_invariants(true);
+		REQUIRE(set.size() == 100u);
+	}
+}
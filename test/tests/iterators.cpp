@@ -5,7 +5,8 @@ TEST_CASE("Iterators", "[iterators]") {
 
 	using namespace te;
 	SECTION("Iterating over all elements with iterators iterates over each bucket sequentially") {
-		any_set_t set({0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+		// With identity bucket indices, buckets are created in the same order as the list.
+		identity_bucket_set_t set({0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
 		REQUIRE(set.size() == 10);
 		REQUIRE(set.bucket_count() >= 10);
 		auto pos = set.begin();
@@ -20,7 +20,7 @@ TEST_CASE("Local Iterators", "[local-iterators]") {
 	SECTION("Local iterators iterate over all of the elements in their respective buckets.  No more, no less.") {
 		// size_t is specialized to the identity hash (test suite only)
 		std::array<std::size_t, 10> v{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
-		any_set_t set(v.begin(), v.end());
+		identity_bucket_set_t set(v.begin(), v.end());
 		REQUIRE(set.size() == v.size());
 		REQUIRE(set.bucket_count() >= v.size());
 		std::size_t buck_count = set.bucket_count();
@@ -0,0 +1,184 @@
+#include "any-set.h"
+#include <algorithm>
+
+namespace {
+
+template <class Set>
+void check_lookup_filter()
+{
+	using namespace std::literals;
+	Set set;
+	REQUIRE(not set.has_lookup_filter());
+	REQUIRE(not set.lookup_filter_stats().enabled);
+	REQUIRE(set.lookup_filter_stats().memory_bytes == 0u);
+
+	for(int i = 0; i < 100; ++i)
+		set.insert(i);
+	set.enable_lookup_filter();
+	REQUIRE(set.has_lookup_filter());
+	set._assert_invariants();
+
+	// The filter grows with the set and never hides an element.
+	for(int i = 100; i < 20000; ++i)
+		set.insert(i);
+	set.insert("a"s, "b"s, 1.5);
+	set._assert_invariants();
+	auto stats = set.lookup_filter_stats();
+	REQUIRE(stats.enabled);
+	REQUIRE(stats.capacity >= set.size());
+	REQUIRE(stats.memory_bytes > 0u);
+	REQUIRE(stats.hash_count > 0u);
+	REQUIRE(stats.target_false_positive_rate == 0.01);
+	REQUIRE(stats.expected_false_positive_rate > 0.0);
+	REQUIRE(stats.expected_false_positive_rate < 0.01);
+	for(int i = 0; i < 20000; ++i)
+		REQUIRE(set.contains(i));
+	REQUIRE(set.contains("a"s));
+	REQUIRE(set.count(1.5) == 1u);
+	REQUIRE(set.find(19999) != set.end());
+	REQUIRE(not set.contains(20000));
+	REQUIRE(not set.contains("c"s));
+	REQUIRE(set.find(-1) == set.end());
+	REQUIRE(set.contains_value(*set.find(1234)));
+
+	std::vector<int> probes;
+	for(int i = 0; i < 1000; ++i)
+		probes.push_back(i % 2 == 0 ? i : 1000000 + i);
+	std::vector<char> found(probes.size());
+	set.contains_many(probes.begin(), probes.end(), found.begin());
+	for(std::size_t i = 0; i < probes.size(); ++i)
+		REQUIRE(bool(found[i]) == (i % 2 == 0));
+
+	// Erased elements are gone, and the filter is eventually rebuilt without them.
+	for(int i = 0; i < 15000; ++i)
+		set.erase(i);
+	REQUIRE(set.lookup_filter_stats().stale_count == 15000u);
+	for(int i = 0; i < 15000; ++i)
+		REQUIRE(not set.contains(i));
+	set.insert(-1);
+	set._assert_invariants();
+	REQUIRE(set.lookup_filter_stats().stale_count == 0u);
+	for(int i = 15000; i < 20000; ++i)
+		REQUIRE(set.contains(i));
+	REQUIRE(set.contains(-1));
+
+	auto [node, next] = set.pop(set.find(16000));
+	REQUIRE(not set.contains(16000));
+	set.push(std::move(node));
+	REQUIRE(set.contains(16000));
+
+	set.rehash(set.bucket_count() * 4u);
+	set._assert_invariants();
+	REQUIRE(set.contains(16000));
+
+	// Copies and moves carry the filter along.
+	Set copy(set);
+	REQUIRE(copy.has_lookup_filter());
+	copy._assert_invariants();
+	REQUIRE(copy == set);
+	Set moved(std::move(copy));
+	REQUIRE(moved.has_lookup_filter());
+	REQUIRE(not copy.has_lookup_filter());
+	copy.insert(1);
+	REQUIRE(copy.contains(1));
+	moved._assert_invariants();
+
+	Set other;
+	other.insert(1, 2, 3);
+	swap(other, moved);
+	REQUIRE(other.has_lookup_filter());
+	REQUIRE(not moved.has_lookup_filter());
+	REQUIRE(other.contains(16000));
+
+	// Elements that come from other sets go through the filter too.
+	other.splice(moved, moved.find(2));
+	REQUIRE(other.contains(2));
+	Set more;
+	for(int i = 50000; i < 51000; ++i)
+		more.insert(i);
+	other.update(more);
+	other.update(std::move(more));
+	other._assert_invariants();
+	REQUIRE(other.contains(50500));
+
+	std::vector<int> ints;
+	for(int i = 0; i < 60000; ++i)
+		ints.push_back(i % 40000);
+	other.insert(te::ParallelPolicy(4), ints.begin(), ints.end());
+	other._assert_invariants();
+	REQUIRE(other.contains(39999));
+	REQUIRE(not other.contains(40000));
+
+	other.clear();
+	REQUIRE(other.has_lookup_filter());
+	REQUIRE(other.lookup_filter_stats().expected_false_positive_rate == 0.0);
+	REQUIRE(not other.contains(1));
+	other.insert(1);
+	REQUIRE(other.contains(1));
+	other._assert_invariants();
+
+	other.disable_lookup_filter();
+	REQUIRE(not other.has_lookup_filter());
+	REQUIRE(other.lookup_filter_stats().memory_bytes == 0u);
+	REQUIRE(other.contains(1));
+	other.insert(2);
+	REQUIRE(other.contains(2));
+}
+
+} /* namespace */
+
+TEST_CASE("Lookup filter", "[lookup-filter]") {
+
+	using namespace te;
+
+	SECTION("The filter never gives false negatives") {
+		check_lookup_filter<any_set_t>();
+		check_lookup_filter<oa_set_t>();
+		check_lookup_filter<ir_set_t>();
+	}
+
+	SECTION("The false-positive rate and memory are configurable") {
+		auto make_stats = [](double rate, std::size_t max_bytes) {
+			any_set_t set;
+			for(int i = 0; i < 50000; ++i)
+				set.insert(i);
+			LookupFilterOptions options;
+			options.false_positive_rate = rate;
+			options.max_bytes = max_bytes;
+			set.enable_lookup_filter(options);
+			set._assert_invariants();
+			return set.lookup_filter_stats();
+		};
+		auto loose = make_stats(0.05, 0);
+		auto tight = make_stats(0.001, 0);
+		auto small = make_stats(0.001, 4096);
+		REQUIRE(loose.capacity >= 50000u);
+		REQUIRE(tight.memory_bytes > loose.memory_bytes);
+		REQUIRE(tight.hash_count > loose.hash_count);
+		REQUIRE(tight.expected_false_positive_rate < loose.expected_false_positive_rate);
+		REQUIRE(small.memory_bytes <= 4096u);
+		REQUIRE(small.expected_false_positive_rate > tight.expected_false_positive_rate);
+	}
+
+	SECTION("The filter's false-positive rate is close to the target at capacity") {
+		for(double rate: {0.1, 0.01, 0.001})
+		{
+			LookupFilterOptions options;
+			options.false_positive_rate = rate;
+			const std::size_t capacity = 100000;
+			detail::BlockedBloomFilter<std::allocator<value_type>> filter(options, capacity, std::allocator<value_type>());
+			for(std::size_t i = 0; i < capacity; ++i)
+				filter.insert(i);
+			REQUIRE(filter.needs_rebuild());
+			std::size_t false_positives = 0;
+			const std::size_t probe_count = 1000000;
+			for(std::size_t i = 0; i < probe_count; ++i)
+				false_positives += filter.may_contain(capacity + i);
+			const double measured = static_cast<double>(false_positives) / probe_count;
+			const double expected = filter.stats().expected_false_positive_rate;
+			REQUIRE(measured < 1.25 * rate);
+			REQUIRE(measured > 0.75 * expected);
+			REQUIRE(measured < 1.25 * expected);
+		}
+	}
+}
@@ -0,0 +1,124 @@
+#include "any-set.h"
+#include "anyset/SetOperations.h"
+#include <random>
+#include <unordered_set>
+
+TEST_CASE("Open Addressing", "[open_addressing]") {
+
+	using namespace te;
+	using namespace std::literals;
+
+	SECTION("Random inserts and erases agree with std::unordered_set") {
+		std::mt19937 gen(0);
+		std::uniform_int_distribution<int> dist(0, 2000);
+		std::unordered_set<int> expect;
+		oa_set_t set;
+		for(int i = 0; i < 20000; ++i)
+		{
+			int v = dist(gen);
+			if(i % 3 == 0)
+			{
+				REQUIRE(set.erase(v) == expect.erase(v));
+				set.erase(std::to_string(v));
+			}
+			else
+			{
+				REQUIRE(set.insert(v).second == expect.insert(v).second);
+				set.insert(std::to_string(v));
+			}
+			if(i % 1000 == 0)
+				set._assert_invariants(true);
+		}
+		REQUIRE(set.size() == 2 * expect.size());
+		for(int v: expect)
+		{
+			REQUIRE(set.contains(v));
+			REQUIRE(set.count(std::to_string(v)) == 1u);
+		}
+		REQUIRE(set.load_factor() <= 0.875f);
+		set._assert_invariants(true);
+	}
+
+	SECTION("Each bucket holds at most one element") {
+		oa_set_t set{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+		size_type total = 0;
+		for(size_type i = 0; i < set.bucket_count(); ++i)
+		{
+			REQUIRE(set.bucket_size(i) <= 1u);
+			total += set.bucket_size(i);
+			for(auto pos = set.begin(i); pos != set.end(i); ++pos)
+				REQUIRE(set.bucket(*pos) == i);
+		}
+		REQUIRE(total == set.size());
+	}
+
+	SECTION("Rehashing does not invalidate iterators") {
+		oa_set_t set;
+		auto [pos, ins] = set.insert("first"s);
+		REQUIRE(ins);
+		for(int i = 0; i < 1000; ++i)
+			set.insert(i);
+		REQUIRE(as<std::string>(*pos) == "first");
+		set.rehash(4096);
+		REQUIRE(as<std::string>(*pos) == "first");
+		set.max_load_factor(2.0);
+		set.rehash(0);
+		REQUIRE(set.load_factor() <= 0.875f);
+		REQUIRE(set.find("first"s) == pos);
+		set._assert_invariants(true);
+	}
+
+	SECTION("Node interface") {
+		oa_set_t a{1, 2, 3};
+		oa_set_t b{3, 4, 5};
+		auto [node, next] = a.pop(a.find(2));
+		REQUIRE(as<int>(*node) == 2);
+		REQUIRE(not a.contains(2));
+		a._assert_invariants();
+		REQUIRE(not b.push(std::move(node)).second);
+		REQUIRE(b.contains(2));
+		auto [ins, nxt, moved] = a.splice(b, b.find(4));
+		REQUIRE(moved);
+		REQUIRE(as<int>(*ins) == 4);
+		REQUIRE(not b.contains(4));
+		std::tie(ins, nxt, moved) = a.splice(b, b.find(3));
+		REQUIRE(not moved);
+		a._assert_invariants();
+		b._assert_invariants();
+		REQUIRE(a == (oa_set_t{1, 3, 4}));
+		REQUIRE(b == (oa_set_t{2, 3, 5}));
+	}
+
+	SECTION("Copy, move, and swap") {
+		auto a = make_anyset<AnyHash, std::equal_to<>, std::allocator<value_type>, OpenAddressing>(1, 2, 3, "a"s, "b"s);
+		oa_set_t b(a);
+		REQUIRE(a == b);
+		oa_set_t c(std::move(b));
+		REQUIRE(c == a);
+		REQUIRE(b.empty());
+		b.insert(10);
+		REQUIRE(b.contains(10));
+		b._assert_invariants();
+		swap(b, c);
+		REQUIRE(b == a);
+		REQUIRE(c == (oa_set_t{10}));
+		b._assert_invariants();
+		c._assert_invariants();
+		c = std::move(b);
+		REQUIRE(c == a);
+		c.clear();
+		REQUIRE(c.empty());
+		REQUIRE(not c.contains(1));
+		c._assert_invariants();
+	}
+
+	SECTION("Set operations") {
+		oa_set_t a{1, 2, 3, 4};
+		oa_set_t b{3, 4, 5, 6};
+		REQUIRE((a | b) == (oa_set_t{1, 2, 3, 4, 5, 6}));
+		REQUIRE((a & b) == (oa_set_t{3, 4}));
+		REQUIRE((a - b) == (oa_set_t{1, 2}));
+		REQUIRE((a ^ b) == (oa_set_t{1, 2, 5, 6}));
+		REQUIRE(is_subset_of((oa_set_t{1, 2}), a));
+	}
+}
@@ -0,0 +1,180 @@
+#include "any-set.h"
+#include "anyset/SetOperations.h"
+#include <forward_list>
+
+namespace {
+
+// Equality and hashing only look at 'key', so equal elements can be told apart by 'tag'.
+struct Tagged
+{
+	int key;
+	int tag;
+
+	friend bool operator==(const Tagged& l, const Tagged& r)
+	{ return l.key == r.key; }
+};
+
+struct ThrowingCopy
+{
+	ThrowingCopy(int v): value(v) { }
+	ThrowingCopy(const ThrowingCopy& other): value(other.value)
+	{
+		if(value == 777)
+			throw std::runtime_error("ThrowingCopy");
+	}
+	friend bool operator==(const ThrowingCopy& l, const ThrowingCopy& r)
+	{ return l.value == r.value; }
+	int value;
+};
+
+struct ThrowingEqual
+{
+	int value;
+
+	friend bool operator==(const ThrowingEqual& l, const ThrowingEqual& r)
+	{
+		if(l.value == 13 and r.value == 13)
+			throw std::runtime_error("ThrowingEqual");
+		return l.value == r.value;
+	}
+};
+
+} /* namespace */
+
+template <>
+struct std::hash<ThrowingEqual>
+{
+	std::size_t operator()(const ThrowingEqual& v) const
+	{ return std::hash<int>{}(v.value); }
+};
+
+template <>
+struct std::hash<Tagged>
+{
+	std::size_t operator()(const Tagged& v) const
+	{ return std::hash<int>{}(v.key); }
+};
+
+template <>
+struct std::hash<ThrowingCopy>
+{
+	std::size_t operator()(const ThrowingCopy& v) const
+	{ return std::hash<int>{}(v.value); }
+};
+
+namespace {
+
+template <class Set>
+void check_parallel_insert(bool open_addressing)
+{
+	using namespace std::literals;
+	const te::ParallelPolicy policy(4);
+	std::vector<int> ints;
+	for(int i = 0; i < 20000; ++i)
+		ints.push_back((i * 7919) % 15000);
+
+	// Same result as sequential range construction.
+	Set expect(ints.begin(), ints.end());
+	Set set(policy, ints.begin(), ints.end());
+	REQUIRE(set.size() == 15000u);
+	REQUIRE(set == expect);
+	set._assert_invariants(true);
+
+	// Into a set that already has elements, some of them equal to the new ones.
+	std::vector<std::string> strings;
+	for(int i = 0; i < 5000; ++i)
+		strings.push_back(std::to_string(i % 4000));
+	expect.insert(strings.begin(), strings.end());
+	REQUIRE(set.insert(policy, strings.begin(), strings.end()) == 4000u);
+	REQUIRE(set == expect);
+	REQUIRE(set.insert(policy, ints.begin(), ints.end()) == 0u);
+	REQUIRE(set == expect);
+	set._assert_invariants(true);
+
+	// References stay valid.
+	const value_type* zero = std::addressof(*set.find(0));
+	std::vector<long> longs(10000);
+	std::iota(longs.begin(), longs.end(), 0L);
+	REQUIRE(set.insert(policy, longs.begin(), longs.end()) == 10000u);
+	REQUIRE(std::addressof(*set.find(0)) == zero);
+	set._assert_invariants(true);
+
+	// The first of several equal elements is the one kept, including elements already in the set.
+	Set tagged;
+	tagged.insert(Tagged{5, -1});
+	std::vector<Tagged> tags;
+	for(int i = 0; i < 3000; ++i)
+		tags.push_back(Tagged{i % 1000, i});
+	REQUIRE(tagged.insert(policy, tags.begin(), tags.end()) == 999u);
+	for(int k = 0; k < 1000; ++k)
+		REQUIRE(te::as<Tagged>(*tagged.find(Tagged{k, 0})).tag == (k == 5 ? -1 : k));
+	tagged._assert_invariants(true);
+
+	// Forward iterators and move iterators.
+	std::forward_list<std::string> list{"a"s, "b"s, "a"s, "c"s};
+	Set from_list(policy, list.begin(), list.end());
+	REQUIRE(from_list.size() == 3u);
+	std::vector<std::string> moved{"x"s, "y"s};
+	REQUIRE(from_list.insert(policy, std::make_move_iterator(moved.begin()), std::make_move_iterator(moved.end())) == 2u);
+	REQUIRE(from_list.contains("x"s));
+	REQUIRE(moved[0].empty());
+
+	// Empty ranges.
+	Set none(policy, ints.begin(), ints.begin());
+	REQUIRE(none.empty());
+	none._assert_invariants();
+
+	// A throwing copy leaves the set as it was.
+	std::vector<ThrowingCopy> throwing(1000, ThrowingCopy(1));
+	for(int i = 0; i < 1000; ++i)
+		throwing[i].value = i;
+	Set before;
+	for(int i = 0; i < 100; ++i)
+		before.insert(ThrowingCopy(i + 500));
+	Set unchanged = before;
+	REQUIRE_THROWS_AS(unchanged.insert(policy, throwing.begin(), throwing.end()), const std::runtime_error&);
+	REQUIRE(unchanged == before);
+	unchanged._assert_invariants(true);
+
+	// So does a throwing comparison, after the current elements have been relinked.
+	// OpenAddressing sets link the new elements in one at a time, so they keep the ones
+	// linked before the comparison threw.
+	std::vector<ThrowingEqual> equals;
+	for(int i = 0; i < 1000; ++i)
+		equals.push_back(ThrowingEqual{i % 500});
+	REQUIRE_THROWS_AS(unchanged.insert(policy, equals.begin(), equals.end()), const std::runtime_error&);
+	if(not open_addressing)
+		REQUIRE(unchanged == before);
+	unchanged._assert_invariants(true);
+}
+
+} /* namespace */
+
+TEST_CASE("Parallel insertion", "[parallel-insert]") {
+
+	using namespace te;
+
+	SECTION("Chained buckets") {
+		check_parallel_insert<any_set_t>(false);
+	}
+	SECTION("Open addressing") {
+		check_parallel_insert<oa_set_t>(true);
+	}
+	SECTION("Incremental rehashing") {
+		check_parallel_insert<ir_set_t>(false);
+	}
+	SECTION("A user-supplied executor") {
+		struct Inline
+		{
+			std::size_t concurrency() const { return 2; }
+			void run(std::size_t n, const std::function<void(std::size_t)>& task) const
+			{
+				for(std::size_t i = 0; i < n; ++i)
+					task(i);
+			}
+		};
+		std::vector<int> v{3, 1, 4, 1, 5, 9, 2, 6};
+		any_set_t set(Inline{}, v.begin(), v.end());
+		REQUIRE(set == any_set_t(v.begin(), v.end()));
+	}
+}
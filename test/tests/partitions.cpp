@@ -0,0 +1,85 @@
+#include "any-set.h"
+#include <atomic>
+#include <set>
+
+namespace {
+
+template <class Set>
+void check_partitions(bool balanced)
+{
+	using namespace std::literals;
+	Set set;
+	for(int i = 0; i < 5000; ++i)
+		set.insert(i);
+	set.insert("abc"s);
+
+	for(std::size_t count: {std::size_t(0), std::size_t(1), std::size_t(7), std::size_t(64), set.bucket_count() * 2})
+	{
+		auto parts = set.partitions(count);
+		REQUIRE(parts.size() == std::clamp<std::size_t>(count, 1u, set.bucket_count()));
+		REQUIRE(parts.front().first_bucket() == 0u);
+		REQUIRE(parts.back().last_bucket() == set.bucket_count());
+		std::size_t total = 0;
+		std::set<const value_type*> seen;
+		for(std::size_t i = 0; i < parts.size(); ++i)
+		{
+			if(i > 0)
+				REQUIRE(parts[i].first_bucket() == parts[i - 1].last_bucket());
+			for(auto pos = parts[i].begin(); pos != parts[i].end(); ++pos)
+			{
+				auto buck = set.bucket(*pos);
+				REQUIRE(buck >= parts[i].first_bucket());
+				REQUIRE(buck < parts[i].last_bucket());
+				REQUIRE(seen.insert(std::addressof(*pos)).second);
+				++total;
+			}
+		}
+		REQUIRE(total == set.size());
+	}
+
+	// Partitions are balanced.
+	auto parts = set.partitions(8);
+	for(const auto& part: parts)
+	{
+		if(not balanced)
+			break;
+		auto size = std::distance(part.begin(), part.end());
+		REQUIRE(size > 400);
+		REQUIRE(size < 900);
+	}
+
+	std::atomic<long> sum{0};
+	std::atomic<std::size_t> count{0};
+	set.for_each(te::ParallelPolicy(4), [&](const value_type& v) {
+		if(const int* p = te::try_as<int>(v))
+			sum += *p;
+		++count;
+	});
+	REQUIRE(count == set.size());
+	REQUIRE(sum == 4999L * 5000L / 2L);
+}
+
+} /* namespace */
+
+TEST_CASE("Partitions", "[partitions]") {
+
+	using namespace te;
+
+	SECTION("Chained buckets") {
+		check_partitions<any_set_t>(true);
+	}
+	SECTION("Open addressing") {
+		check_partitions<oa_set_t>(true);
+	}
+	SECTION("Incremental rehashing") {
+		// Not necessarily balanced while a rehash is in progress.
+		check_partitions<ir_set_t>(false);
+	}
+	SECTION("Empty set") {
+		any_set_t set;
+		auto parts = set.partitions(4);
+		REQUIRE(parts.size() == 1u);
+		REQUIRE(parts[0].begin() == parts[0].end());
+		set.for_each(par, [](const auto&) { REQUIRE(false); });
+	}
+}
@@ -0,0 +1,350 @@
+#include "any-set.h"
+#include "anyset/PersistentAnySet.h"
+#include "anyset/SetOperations.h"
+#include <random>
+#include <set>
+#include <thread>
+
+namespace {
+
+// Every Collider has the same hash code.
+struct Collider
+{
+	int value;
+
+	friend bool operator==(const Collider& l, const Collider& r)
+	{ return l.value == r.value; }
+};
+
+// Counts live instances, to check that versions share elements instead of copying them.
+struct Counted
+{
+	Counted(int v): value(v) { ++live; }
+	Counted(const Counted& other): value(other.value) { ++live; ++copies; }
+	~Counted() { --live; }
+
+	friend bool operator==(const Counted& l, const Counted& r)
+	{ return l.value == r.value; }
+
+	int value;
+	static inline int live = 0;
+	static inline int copies = 0;
+};
+
+} /* namespace */
+
+template <>
+struct std::hash<Collider>
+{
+	std::size_t operator()(const Collider&) const
+	{ return 777u; }
+};
+
+template <>
+struct std::hash<Counted>
+{
+	std::size_t operator()(const Counted& v) const
+	{ return std::hash<int>{}(v.value); }
+};
+
+namespace {
+
+using persistent_set_t = te::PersistentAnySet<>;
+using pmr_persistent_set_t = te::PersistentAnySet<
+	te::AnyHash, std::equal_to<>, std::pmr::polymorphic_allocator<value_type>
+>;
+
+template <class Set>
+std::set<const value_type*> addresses(const Set& set)
+{
+	std::set<const value_type*> result;
+	for(const auto& v: set)
+		REQUIRE(result.insert(std::addressof(v)).second);
+	return result;
+}
+
+} /* namespace */
+
+TEST_CASE("PersistentAnySet", "[persistent]") {
+
+	using namespace std::literals;
+
+	SECTION("Empty set") {
+		persistent_set_t set;
+		set._assert_invariants();
+		REQUIRE(set.empty());
+		REQUIRE(set.size() == 0u);
+		REQUIRE(set.begin() == set.end());
+		REQUIRE(not set.contains(1));
+		REQUIRE(set.find(1) == set.end());
+		REQUIRE(set.erase(1).empty());
+	}
+	SECTION("Insert returns a new version") {
+		persistent_set_t v0;
+		auto v1 = v0.insert(1);
+		auto v2 = v1.insert("two"s);
+		auto v3 = v2.insert(1);
+		for(const auto* v: {&v0, &v1, &v2, &v3})
+			v->_assert_invariants();
+		REQUIRE(v0.empty());
+		REQUIRE(v1.size() == 1u);
+		REQUIRE(v1.contains(1));
+		REQUIRE(not v1.contains("two"s));
+		REQUIRE(v2.size() == 2u);
+		REQUIRE(v2.contains(1));
+		REQUIRE(v2.contains("two"s));
+		REQUIRE(v3 == v2);
+		// Inserting an element that is already there shares the whole set.
+		REQUIRE(addresses(v3) == addresses(v2));
+		// Same value, different type.
+		REQUIRE(not v2.contains(1L));
+	}
+	SECTION("Emplace") {
+		persistent_set_t v0;
+		auto v1 = v0.emplace<std::string>(3u, 'a');
+		REQUIRE(v1.contains("aaa"s));
+		auto v2 = v1.emplace<std::string>("aaa");
+		REQUIRE(v2.size() == 1u);
+		REQUIRE(v2 == v1);
+	}
+	SECTION("Erase returns a new version") {
+		persistent_set_t v0;
+		for(int i = 0; i < 1000; ++i)
+			v0 = v0.insert(i);
+		v0._assert_invariants();
+		auto v1 = v0.erase(500);
+		auto v2 = v1.erase(500);
+		v1._assert_invariants();
+		REQUIRE(v0.size() == 1000u);
+		REQUIRE(v0.contains(500));
+		REQUIRE(v1.size() == 999u);
+		REQUIRE(not v1.contains(500));
+		REQUIRE(v2 == v1);
+		auto v3 = v1;
+		for(int i = 0; i < 1000; ++i)
+		{
+			v3 = v3.erase(i);
+			v3._assert_invariants();
+		}
+		REQUIRE(v3.empty());
+		REQUIRE(v0.size() == 1000u);
+		REQUIRE(v1.size() == 999u);
+	}
+	SECTION("Versions share elements") {
+		Counted::live = 0;
+		Counted::copies = 0;
+		{
+			persistent_set_t v0;
+			for(int i = 0; i < 100; ++i)
+				v0 = v0.emplace<Counted>(i);
+			REQUIRE(Counted::live == 100);
+			std::vector<persistent_set_t> versions{v0};
+			for(int i = 0; i < 100; ++i)
+				versions.push_back(versions.back().erase(Counted(i)).insert(i));
+			REQUIRE(Counted::copies == 0);
+			REQUIRE(Counted::live == 100);
+			auto before = addresses(v0);
+			auto after = addresses(versions.back());
+			// All of the elements of the last version are ints now.
+			REQUIRE(versions.back().size() == 100u);
+			for(const auto* p: after)
+				REQUIRE(before.count(p) == 0u);
+			// Unchanged elements are shared.
+			auto middle = addresses(versions[50]);
+			std::size_t shared = std::count_if(middle.begin(), middle.end(), [&](auto p) { return before.count(p) > 0u; });
+			REQUIRE(shared == 50u);
+		}
+		REQUIRE(Counted::live == 0);
+	}
+	SECTION("Equal hash codes") {
+		persistent_set_t set;
+		for(int i = 0; i < 40; ++i)
+			set = set.insert(Collider{i}).insert(i);
+		set._assert_invariants();
+		REQUIRE(set.size() == 80u);
+		for(int i = 0; i < 40; ++i)
+		{
+			REQUIRE(set.contains(Collider{i}));
+			REQUIRE(te::as<Collider>(*set.find(Collider{i})).value == i);
+		}
+		REQUIRE(not set.contains(Collider{40}));
+		auto fewer = set;
+		for(int i = 0; i < 40; i += 2)
+			fewer = fewer.erase(Collider{i});
+		fewer._assert_invariants();
+		REQUIRE(fewer.size() == 60u);
+		for(int i = 0; i < 40; ++i)
+			REQUIRE(fewer.contains(Collider{i}) == (i % 2 == 1));
+		for(int i = 1; i < 40; i += 2)
+			fewer = fewer.erase(Collider{i});
+		fewer._assert_invariants();
+		REQUIRE(fewer.size() == 40u);
+		REQUIRE(set.size() == 80u);
+	}
+	SECTION("Iteration and find") {
+		std::mt19937_64 gen(1);
+		persistent_set_t set;
+		std::set<std::uint64_t> expected;
+		for(int i = 0; i < 5000; ++i)
+		{
+			auto v = gen();
+			set = set.insert(v);
+			expected.insert(v);
+		}
+		set._assert_invariants();
+		REQUIRE(set.size() == expected.size());
+		std::set<std::uint64_t> seen;
+		for(const auto& v: set)
+			REQUIRE(seen.insert(te::as<std::uint64_t>(v)).second);
+		REQUIRE(seen == expected);
+		for(auto v: expected)
+		{
+			auto pos = set.find(v);
+			REQUIRE(pos != set.end());
+			REQUIRE(te::as<std::uint64_t>(*pos) == v);
+			REQUIRE(set.contains(set.hashed(v)));
+		}
+		// Iterating from a found element visits the rest of the elements.
+		auto pos = set.find(*expected.begin());
+		std::size_t rest = std::distance(pos, set.end());
+		std::size_t before = std::distance(set.begin(), pos);
+		REQUIRE(rest + before == set.size());
+	}
+	SECTION("Conversion") {
+		any_set_t any_set;
+		for(int i = 0; i < 3000; ++i)
+			any_set.insert(i, std::to_string(i));
+		any_set.insert(Collider{1}, Collider{2}, Collider{3});
+		persistent_set_t set(any_set);
+		set._assert_invariants();
+		REQUIRE(set.size() == any_set.size());
+		for(const auto& v: any_set)
+			REQUIRE(set.contains_value(v));
+		auto back = set.to_any_set();
+		REQUIRE(back == any_set);
+		auto oa = set.to_any_set<te::OpenAddressing>();
+		REQUIRE(oa.size() == any_set.size());
+		for(const auto& v: any_set)
+			REQUIRE(oa.contains_value(v));
+
+		any_set.emplace<UniqueInt>(UniqueInt::make(1));
+		REQUIRE_THROWS_AS(persistent_set_t(any_set), const te::NoCopyConstructorError<UniqueInt>&);
+	}
+	SECTION("Concurrent snapshots") {
+		persistent_set_t base;
+		for(int i = 0; i < 1000; ++i)
+			base = base.insert(i);
+		std::vector<std::thread> threads;
+		std::vector<std::size_t> sizes(4, 0u);
+		for(std::size_t t = 0; t < sizes.size(); ++t)
+		{
+			threads.emplace_back([&, t]() {
+				auto mine = base;
+				for(int i = 0; i < 1000; ++i)
+				{
+					auto next = mine.insert(static_cast<int>(1000 * (t + 1) + i));
+					mine = next.erase(i);
+				}
+				sizes[t] = mine.size();
+			});
+		}
+		for(auto& th: threads)
+			th.join();
+		for(auto n: sizes)
+			REQUIRE(n == 1000u);
+		REQUIRE(base.size() == 1000u);
+		base._assert_invariants();
+	}
+	SECTION("Set operations") {
+		persistent_set_t a, b, c;
+		for(int i = 0; i < 100; ++i)
+		{
+			a = a.insert(i);
+			if(i % 2 == 0)
+				b = b.insert(i);
+			if(i % 3 == 0)
+				c = c.insert(i);
+		}
+		auto any_a = a.to_any_set(), any_b = b.to_any_set(), any_c = c.to_any_set();
+
+		auto u = te::union_of(b, c);
+		u._assert_invariants();
+		REQUIRE(u.to_any_set() == te::union_of(any_b, any_c));
+		auto i = te::intersection_of(a, b, c);
+		i._assert_invariants();
+		REQUIRE(i.to_any_set() == te::intersection_of(any_a, any_b, any_c));
+		auto s = te::symmetric_difference_of(a, b, c);
+		s._assert_invariants();
+		REQUIRE(s.to_any_set() == te::symmetric_difference_of(any_a, any_b, any_c));
+		auto d = te::difference_of(a, b, any_c);
+		d._assert_invariants();
+		REQUIRE(d.to_any_set() == te::difference_of(any_a, any_b, any_c));
+		REQUIRE(te::difference_of(any_a, b, c) == te::difference_of(any_a, any_b, any_c));
+
+		REQUIRE(te::is_subset_of(b, a));
+		REQUIRE(te::is_subset_of(any_b, a));
+		REQUIRE(te::is_superset_of(a, any_c));
+		REQUIRE(not te::is_subset_of(a, b));
+
+		// The union shares the elements of its arguments.
+		auto in_b = addresses(b);
+		auto in_c = addresses(c);
+		for(const auto* p: addresses(u))
+			REQUIRE((in_b.count(p) + in_c.count(p)) > 0u);
+	}
+
+	SECTION("Versions with different memory resources") {
+		CountingResource res_a;
+		CountingResource res_b;
+		{
+			using alloc_t = std::pmr::polymorphic_allocator<value_type>;
+			pmr_persistent_set_t a(te::AnyHash{}, std::equal_to<>{}, alloc_t{&res_a});
+			pmr_persistent_set_t b(te::AnyHash{}, std::equal_to<>{}, alloc_t{&res_b});
+			for(int i = 0; i < 50; ++i)
+				a = a.insert(i);
+			a = a.erase_if([](const auto& v) { return as<int>(v) % 10 == 0; });
+			b = b.insert("b"s);
+			std::size_t b_allocs = res_b.allocations;
+
+			// Sets only share elements with sets that have the same resource.
+			pmr_persistent_set_t copy(te::AnyHash{}, std::equal_to<>{}, alloc_t{&res_b});
+			copy = a;
+			copy._assert_invariants();
+			REQUIRE(copy == a);
+			REQUIRE(copy.get_allocator().resource() == &res_b);
+			REQUIRE(res_b.allocations > b_allocs + 45u);
+			auto in_a = addresses(a);
+			for(const auto* p: addresses(copy))
+				REQUIRE(in_a.count(p) == 0u);
+			pmr_persistent_set_t snapshot(te::AnyHash{}, std::equal_to<>{}, alloc_t{&res_b});
+			snapshot = copy;
+			REQUIRE(addresses(snapshot) == addresses(copy));
+
+			pmr_persistent_set_t moved(std::move(a), alloc_t{&res_b});
+			REQUIRE(moved.get_allocator().resource() == &res_b);
+			REQUIRE(moved == copy);
+			a = moved.insert(100);
+			REQUIRE(a.get_allocator().resource() == &res_a);
+			REQUIRE(a.size() == 46u);
+
+			auto u = b.update(a);
+			u._assert_invariants();
+			REQUIRE(u.size() == 47u);
+			auto in_u = addresses(u);
+			for(const auto* p: addresses(a))
+				REQUIRE(in_u.count(p) == 0u);
+			auto empty_u = pmr_persistent_set_t(te::AnyHash{}, std::equal_to<>{}, alloc_t{&res_b}).update(a);
+			REQUIRE(empty_u == a);
+			REQUIRE(te::union_of(b, a) == u);
+			REQUIRE(te::symmetric_difference_of(b, a) == u);
+			REQUIRE(te::intersection_of(a, moved).size() == 45u);
+
+			swap(b, u);
+			REQUIRE(b.size() == 47u);
+		}
+		REQUIRE(res_a.allocations == res_a.deallocations);
+		REQUIRE(res_b.allocations == res_b.deallocations);
+		REQUIRE(res_a.bytes_in_use == 0u);
+		REQUIRE(res_b.bytes_in_use == 0u);
+	}
+}
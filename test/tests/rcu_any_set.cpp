@@ -0,0 +1,156 @@
+#include "any-set.h"
+#include "anyset/RcuAnySet.h"
+#include <atomic>
+#include <thread>
+#include <memory_resource>
+
+using rcu_set_t = te::RcuAnySet<>;
+
+TEST_CASE("RCU AnySet", "[rcu]") {
+
+	using namespace te;
+	using namespace std::literals;
+
+	SECTION("Batches are applied in order and published together") {
+		rcu_set_t set(any_set_t{1, 2, 3});
+		auto reader = set.make_reader();
+		REQUIRE(reader.contains(1));
+		REQUIRE(reader.read()->size() == 3u);
+
+		auto batch = set.make_batch();
+		REQUIRE(batch.empty());
+		batch.insert(4);
+		batch.insert("five"s);
+		batch.emplace<std::string>(3u, 'a');
+		batch.erase(1);
+		batch.insert(1);
+		batch.erase(2);
+		batch.erase(100);
+		REQUIRE(batch.size() == 7u);
+		REQUIRE(not reader.contains(4));
+		set.publish(std::move(batch));
+
+		for(int i = 0; i < 2; ++i)
+		{
+			auto view = reader.read();
+			REQUIRE(view->size() == 5u);
+			REQUIRE(view->contains(1));
+			REQUIRE(not view->contains(2));
+			REQUIRE(view->contains(3));
+			REQUIRE(view->contains(4));
+			REQUIRE(view->contains("five"s));
+			REQUIRE(view->contains("aaa"s));
+			view->_assert_invariants();
+		}
+	}
+
+	SECTION("Both copies stay equal") {
+		rcu_set_t set;
+		auto reader = set.make_reader();
+		any_set_t expect;
+		for(int i = 0; i < 200; ++i)
+		{
+			// Each publish swaps which copy readers see.
+			if(i % 3 == 2)
+			{
+				set.erase(i - 1);
+				expect.erase(i - 1);
+			}
+			else
+			{
+				set.insert(i);
+				expect.insert(i);
+			}
+			REQUIRE(*reader.read() == expect);
+		}
+		any_set_t other{"a"s, "b"s};
+		other.insert(0);
+		set.update(other);
+		expect.update(other);
+		REQUIRE(*reader.read() == expect);
+		set.insert(-1);
+		expect.insert(-1);
+		REQUIRE(*reader.read() == expect);
+		set.assign(other);
+		REQUIRE(*reader.read() == other);
+		set.insert(-1);
+		REQUIRE(reader.read()->size() == 4u);
+		REQUIRE(reader.contains("a"s));
+	}
+
+	SECTION("Batches allocate nodes with the set's allocator") {
+		using pmr_set_t = te::pmr::AnySet<>;
+		using pmr_rcu_set_t = RcuAnySet<AnyHash, std::equal_to<>, pmr_set_t::allocator_type>;
+		std::pmr::monotonic_buffer_resource res;
+		pmr_rcu_set_t set(pmr_set_t(pmr_set_t::allocator_type{&res}));
+		auto reader = set.make_reader();
+		alignas(std::max_align_t) char buffer[4096];
+		{
+			std::pmr::monotonic_buffer_resource other_res(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+			pmr_set_t other(pmr_set_t::allocator_type{&other_res});
+			other.insert(1, 2, "three"s);
+			set.update(other);
+		}
+		// None of the elements were allocated in the other set's buffer.
+		auto view = reader.read();
+		REQUIRE(view->size() == 3u);
+		for(const auto& v: *view)
+		{
+			auto addr = reinterpret_cast<std::uintptr_t>(std::addressof(v));
+			REQUIRE((addr < reinterpret_cast<std::uintptr_t>(buffer) or addr >= reinterpret_cast<std::uintptr_t>(buffer + sizeof(buffer))));
+		}
+		REQUIRE(view->contains("three"s));
+	}
+
+	SECTION("Reader slots are reused") {
+		rcu_set_t set;
+		{
+			auto r1 = set.make_reader();
+			auto r2 = std::move(r1);
+			REQUIRE(not r2.contains(1));
+		}
+		auto r3 = set.make_reader();
+		set.insert(1);
+		REQUIRE(r3.count(1) == 1u);
+	}
+
+	SECTION("Concurrent readers and writer") {
+		rcu_set_t set;
+		constexpr int reader_count = 4;
+		constexpr int batch_count = 200;
+		constexpr int batch_size = 16;
+		std::atomic<bool> done{false};
+		std::atomic<bool> views_ok{true};
+		std::vector<std::thread> readers;
+		for(int t = 0; t < reader_count; ++t)
+		{
+			readers.emplace_back([&]() {
+				auto reader = set.make_reader();
+				while(not done.load())
+				{
+					// Batch b inserts [b * batch_size, (b + 1) * batch_size), so every
+					// published version holds a prefix of the integers.
+					auto view = reader.read();
+					int n = static_cast<int>(view->size());
+					if(n % batch_size != 0 or (n > 0 and not view->contains(n - 1)) or view->contains(n))
+						views_ok = false;
+				}
+			});
+		}
+		for(int b = 0; b < batch_count; ++b)
+		{
+			auto batch = set.make_batch();
+			for(int i = b * batch_size; i < (b + 1) * batch_size; ++i)
+				batch.insert(i);
+			set.publish(std::move(batch));
+		}
+		done = true;
+		for(auto& t: readers)
+			t.join();
+		REQUIRE(views_ok);
+		auto reader = set.make_reader();
+		auto view = reader.read();
+		REQUIRE(view->size() == std::size_t(batch_count * batch_size));
+		view->_assert_invariants();
+	}
+}
@@ -32,4 +32,29 @@ TEST_CASE("Rehash", "[rehash]") {
 		REQUIRE(set.bucket_count() > 0u);
 		REQUIRE(load_factor_satisfied(set));
 	}
+
+	SECTION("Growing and shrinking preserves the elements and bucket ordering") {
+		any_set_t set;
+		for(int i = 0; i < 1000; ++i)
+		{
+			set.insert(i);
+			set.insert(std::to_string(i));
+		}
+		set.max_load_factor(0.25);
+		set.rehash(0);
+		REQUIRE(set.bucket_count() >= 8000u);
+		set._assert_invariants();
+		set.max_load_factor(4.0);
+		set.rehash(0);
+		REQUIRE(set.bucket_count() <= 1024u);
+		set._assert_invariants();
+		set.rehash(set.bucket_count() * 64);
+		set._assert_invariants();
+		REQUIRE(set.size() == 2000u);
+		for(int i = 0; i < 1000; ++i)
+		{
+			REQUIRE(set.contains(i));
+			REQUIRE(set.contains(std::to_string(i)));
+		}
+	}
 }
@@ -0,0 +1,157 @@
+#include "../any-set.h"
+#include "anyset/SetOperations.h"
+#include <random>
+#include <set>
+
+namespace {
+
+// Every Collider with the same 'group' has the same hash code.
+struct Collider
+{
+	int group;
+	int value;
+
+	friend bool operator==(const Collider& l, const Collider& r)
+	{ return l.group == r.group and l.value == r.value; }
+};
+
+using reference_t = std::set<std::pair<int, int>>;
+
+// Ints are stored as {-1, value}, Colliders as {group, value}.
+template <class Set>
+reference_t contents(const Set& set)
+{
+	reference_t result;
+	for(const auto& v: set)
+	{
+		if(const int* i = te::try_as<int>(v))
+			REQUIRE(result.emplace(-1, *i).second);
+		else
+			REQUIRE(result.emplace(te::as<Collider>(v).group, te::as<Collider>(v).value).second);
+	}
+	return result;
+}
+
+template <class Set>
+Set make_set(const reference_t& values)
+{
+	Set set;
+	for(auto [group, value]: values)
+	{
+		if(group < 0)
+			set.insert(value);
+		else
+			set.insert(Collider{group, value});
+	}
+	return set;
+}
+
+reference_t random_values(std::mt19937& gen, int count, int range)
+{
+	std::uniform_int_distribution<int> dist(0, range);
+	reference_t values;
+	for(int i = 0; i < count; ++i)
+	{
+		int v = dist(gen);
+		// A few groups of colliding values, one of them large.
+		if(v % 10 == 0)
+			values.emplace(v % 3, v);
+		else
+			values.emplace(-1, v);
+	}
+	return values;
+}
+
+} /* namespace */
+
+template <>
+struct std::hash<Collider>
+{
+	std::size_t operator()(const Collider& c) const
+	{ return 1000u + static_cast<std::size_t>(c.group); }
+};
+
+namespace {
+
+template <class Policy>
+void check_batches()
+{
+	using set_t = te::AnySet<te::AnyHash, std::equal_to<>, std::allocator<te::AnyValue<te::AnyHash, std::equal_to<>>>, Policy>;
+	std::mt19937 gen(42);
+
+	// Lookups are done a batch at a time, so try sizes on both sides of the batch size.
+	for(int count: {0, 1, 15, 16, 17, 33, 1200})
+	{
+		const int range = 4 * count + 4;
+		auto left_values = random_values(gen, count, range);
+		auto right_values = random_values(gen, count, range);
+		auto other_values = random_values(gen, count, range);
+		const auto left = make_set<set_t>(left_values);
+		const auto right = make_set<set_t>(right_values);
+		const auto other = make_set<set_t>(other_values);
+
+		reference_t expected_union, expected_intersection, expected_difference, expected_symdiff;
+		reference_t expected_intersection3, expected_difference3;
+		std::set_union(left_values.begin(), left_values.end(), right_values.begin(), right_values.end(),
+			std::inserter(expected_union, expected_union.end()));
+		std::set_intersection(left_values.begin(), left_values.end(), right_values.begin(), right_values.end(),
+			std::inserter(expected_intersection, expected_intersection.end()));
+		std::set_difference(left_values.begin(), left_values.end(), right_values.begin(), right_values.end(),
+			std::inserter(expected_difference, expected_difference.end()));
+		std::set_symmetric_difference(left_values.begin(), left_values.end(), right_values.begin(), right_values.end(),
+			std::inserter(expected_symdiff, expected_symdiff.end()));
+		std::set_intersection(expected_intersection.begin(), expected_intersection.end(), other_values.begin(), other_values.end(),
+			std::inserter(expected_intersection3, expected_intersection3.end()));
+		std::set_difference(expected_difference.begin(), expected_difference.end(), other_values.begin(), other_values.end(),
+			std::inserter(expected_difference3, expected_difference3.end()));
+
+		auto updated = left;
+		updated.update(right);
+		updated._assert_invariants(true);
+		REQUIRE(contents(updated) == expected_union);
+
+		auto moved_from = right;
+		auto move_updated = left;
+		move_updated.update(std::move(moved_from));
+		move_updated._assert_invariants(true);
+		moved_from._assert_invariants(true);
+		REQUIRE(contents(move_updated) == expected_union);
+		REQUIRE(contents(moved_from) == expected_intersection);
+
+		auto intersection = te::intersection_of(set_t(left), right);
+		intersection._assert_invariants();
+		REQUIRE(contents(intersection) == expected_intersection);
+		REQUIRE(contents(te::intersection_of(left, right, other)) == expected_intersection3);
+
+		auto difference = te::difference_of(left, right);
+		difference._assert_invariants();
+		REQUIRE(contents(difference) == expected_difference);
+		REQUIRE(contents(te::difference_of(set_t(left), right)) == expected_difference);
+		REQUIRE(contents(te::difference_of(left, right, other)) == expected_difference3);
+		const te::FrozenAnySet<> frozen(right);
+		REQUIRE(contents(te::difference_of(left, frozen, other)) == expected_difference3);
+
+		auto symdiff = left;
+		symdiff ^= right;
+		symdiff._assert_invariants(true);
+		REQUIRE(contents(symdiff) == expected_symdiff);
+
+		REQUIRE(contents(left) == left_values);
+		REQUIRE(contents(right) == right_values);
+	}
+}
+
+} /* namespace */
+
+TEST_CASE("Batched set operations", "[batched][set-operations]") {
+
+	SECTION("ChainedBuckets") {
+		check_batches<te::ChainedBuckets>();
+	}
+	SECTION("OpenAddressing") {
+		check_batches<te::OpenAddressing>();
+	}
+	SECTION("IncrementalRehash") {
+		check_batches<te::IncrementalRehash>();
+	}
+}
@@ -0,0 +1,72 @@
+#include "../any-set.h"
+#include "anyset/SetOperations.h"
+
+TEST_CASE("Set cardinality functions", "[cardinality][set-operations]") {
+
+	using namespace te;
+	using namespace std::literals;
+
+	any_set_t a({0, 1, 2, 3, 4});
+	any_set_t b({3, 4, 5, 6});
+	any_set_t c({7, 8});
+	any_set_t empty;
+	a.insert("3"s);
+
+	SECTION("The counts match the sizes of the computed sets") {
+		for(const any_set_t* l: {&a, &b, &c, &empty})
+		{
+			for(const any_set_t* r: {&a, &b, &c, &empty})
+			{
+				REQUIRE(intersection_size(*l, *r) == intersection_of(*l, *r).size());
+				REQUIRE(union_size(*l, *r) == union_of(*l, *r).size());
+				REQUIRE(difference_size(*l, *r) == difference_of(*l, *r).size());
+				REQUIRE(is_disjoint(*l, *r) == (intersection_of(*l, *r).size() == 0u));
+			}
+		}
+		REQUIRE(intersection_size(a, b) == 2u);
+		REQUIRE(union_size(a, b) == 8u);
+		REQUIRE(difference_size(a, b) == 4u);
+		REQUIRE(difference_size(b, a) == 2u);
+		REQUIRE(not is_disjoint(a, b));
+		REQUIRE(is_disjoint(a, c));
+		REQUIRE(is_disjoint(empty, empty));
+	}
+
+	SECTION("jaccard_index() divides the intersection size by the union size") {
+		REQUIRE(jaccard_index(a, b) == Approx(2.0 / 8.0));
+		REQUIRE(jaccard_index(b, a) == Approx(2.0 / 8.0));
+		REQUIRE(jaccard_index(a, a) == 1.0);
+		REQUIRE(jaccard_index(a, c) == 0.0);
+		REQUIRE(jaccard_index(a, empty) == 0.0);
+		REQUIRE(jaccard_index(empty, empty) == 1.0);
+	}
+
+	SECTION("Large sets are counted a batch at a time") {
+		any_set_t big, other;
+		for(int i = 0; i < 1000; ++i)
+			big.insert(i);
+		for(int i = 0; i < 1000; i += 3)
+			other.insert(i);
+		for(int i = 2000; i < 2017; ++i)
+			other.insert(i);
+		REQUIRE(intersection_size(big, other) == 334u);
+		REQUIRE(intersection_size(other, big) == 334u);
+		REQUIRE(union_size(big, other) == 1017u);
+		REQUIRE(difference_size(other, big) == 17u);
+		REQUIRE(not is_disjoint(big, other));
+		other.erase(999);
+		REQUIRE(intersection_size(big, other) == 333u);
+	}
+
+	SECTION("Any kind of set may be counted") {
+		const FrozenAnySet<> frozen(b);
+		const PersistentAnySet<> persistent(a);
+		const CowAnySet<> cow(c);
+		REQUIRE(intersection_size(a, frozen) == 2u);
+		REQUIRE(intersection_size(frozen, persistent) == 2u);
+		REQUIRE(union_size(persistent, cow) == 8u);
+		REQUIRE(difference_size(frozen, a) == 2u);
+		REQUIRE(is_disjoint(cow, frozen));
+		REQUIRE(jaccard_index(persistent, b) == Approx(2.0 / 8.0));
+	}
+}
@@ -0,0 +1,107 @@
+#include "../any-set.h"
+#include "anyset/SetOperations.h"
+
+namespace {
+
+// A user-supplied executor that runs the tasks in reverse order on the calling thread.
+struct ReverseExecutor
+{
+	std::size_t concurrency() const
+	{ return 3; }
+
+	template <class Task>
+	void run(std::size_t task_count, Task&& task) const
+	{
+		while(task_count > 0u)
+			task(--task_count);
+	}
+};
+
+template <class Set>
+Set make_range_set(int first, int last)
+{
+	Set set;
+	for(int i = first; i < last; ++i)
+	{
+		set.insert(i);
+		if(i % 3 == 0)
+			set.insert(std::to_string(i));
+	}
+	return set;
+}
+
+template <class Set, class Policy>
+void check_parallel_set_operations(const Policy& policy)
+{
+	const Set a = make_range_set<Set>(0, 3000);
+	const Set b = make_range_set<Set>(2000, 5000);
+	const Set c = make_range_set<Set>(-500, 2500);
+	const Set empty;
+
+	auto check = [](const Set& result, const Set& expect) {
+		REQUIRE(result == expect);
+		result._assert_invariants();
+	};
+
+	check(union_of(policy, a, b, c), union_of(a, b, c));
+	check(union_of(policy, a, empty), a);
+	check(union_of(policy, Set(a), b), union_of(a, b));
+	check(intersection_of(policy, a, b, c), intersection_of(a, b, c));
+	check(intersection_of(policy, a, empty), empty);
+	check(intersection_of(policy, Set(a), c), intersection_of(a, c));
+	check(difference_of(policy, a, b, c), difference_of(a, b, c));
+	check(difference_of(policy, Set(a), b), difference_of(a, b));
+	check(difference_of(policy, a, empty), a);
+	check(symmetric_difference_of(policy, a, b, c), symmetric_difference_of(a, b, c));
+	check(symmetric_difference_of(policy, Set(b), a), symmetric_difference_of(a, b));
+	check(symmetric_difference_of(policy, a, a), empty);
+
+	// Inputs that are lvalues are left alone.
+	REQUIRE(a == make_range_set<Set>(0, 3000));
+	REQUIRE(b == make_range_set<Set>(2000, 5000));
+}
+
+struct ThrowOnCopy
+{
+	ThrowOnCopy(int v): value(v) { }
+	ThrowOnCopy(const ThrowOnCopy& other): value(other.value)
+	{
+		if(value == 7)
+			throw std::runtime_error("ThrowOnCopy");
+	}
+	friend bool operator==(const ThrowOnCopy& l, const ThrowOnCopy& r)
+	{ return l.value == r.value; }
+	int value;
+};
+
+} /* namespace */
+
+template <>
+struct std::hash<ThrowOnCopy>
+{
+	std::size_t operator()(const ThrowOnCopy& v) const
+	{ return std::hash<int>{}(v.value); }
+};
+
+TEST_CASE("Parallel set operations", "[parallel-set-operations]") {
+
+	using namespace te;
+
+	SECTION("Parallel overloads give the same results as the sequential ones") {
+		check_parallel_set_operations<any_set_t>(ParallelPolicy(4));
+		check_parallel_set_operations<any_set_t>(par);
+		check_parallel_set_operations<any_set_t>(ReverseExecutor{});
+		check_parallel_set_operations<oa_set_t>(ParallelPolicy(4));
+		check_parallel_set_operations<ir_set_t>(ParallelPolicy(4));
+	}
+
+	SECTION("Exceptions thrown by tasks are rethrown") {
+		any_set_t a;
+		for(int i = 0; i < 100; ++i)
+			a.emplace<ThrowOnCopy>(i);
+		any_set_t b{1, 2};
+		REQUIRE_THROWS_AS(union_of(ParallelPolicy(4), a, b), const std::runtime_error&);
+		REQUIRE_THROWS_AS(difference_of(ParallelPolicy(4), a, b), const std::runtime_error&);
+		REQUIRE(a.size() == 100u);
+	}
+}
@@ -0,0 +1,129 @@
+#include "../any-set.h"
+#include "anyset/SetViews.h"
+#include <algorithm>
+
+TEST_CASE("Set views", "[views][set-operations]") {
+
+	using namespace te;
+	using namespace std::literals;
+
+	auto is_perm = [](const auto& a, std::initializer_list<int> b) {
+		return std::is_permutation(a.begin(), a.end(), begin(b), end(b))
+			and static_cast<std::size_t>(std::distance(a.begin(), a.end())) == b.size();
+	};
+
+	any_set_t a({0, 1, 2, 3, 4});
+	any_set_t b({3, 4, 5, 6});
+	any_set_t c({0, 4, 6, 8});
+	any_set_t empty;
+
+	SECTION("Views iterate the result of the operation") {
+		REQUIRE(is_perm(views::set_union(a, b), {0, 1, 2, 3, 4, 5, 6}));
+		REQUIRE(is_perm(views::set_intersection(a, b), {3, 4}));
+		REQUIRE(is_perm(views::set_difference(a, b), {0, 1, 2}));
+		REQUIRE(is_perm(views::set_symmetric_difference(a, b), {0, 1, 2, 5, 6}));
+
+		REQUIRE(is_perm(views::set_union(a, empty), {0, 1, 2, 3, 4}));
+		REQUIRE(is_perm(views::set_union(empty, b), {3, 4, 5, 6}));
+		REQUIRE(views::set_intersection(a, empty).empty());
+		REQUIRE(views::set_difference(a, a).empty());
+		REQUIRE(views::set_symmetric_difference(empty, empty).empty());
+		REQUIRE(not views::set_union(empty, b).empty());
+	}
+
+	SECTION("Views answer contains() without iterating") {
+		auto u = views::set_union(a, b);
+		REQUIRE(u.contains(0));
+		REQUIRE(u.contains(6));
+		REQUIRE(not u.contains(7));
+		REQUIRE(not u.contains("0"s));
+		REQUIRE(u.count(5) == 1u);
+
+		auto i = views::set_intersection(a, b);
+		REQUIRE(i.contains(3));
+		REQUIRE(not i.contains(0));
+		REQUIRE(not i.contains(5));
+
+		auto d = views::set_difference(a, b);
+		REQUIRE(d.contains(1));
+		REQUIRE(not d.contains(3));
+		REQUIRE(not d.contains(5));
+
+		auto s = views::set_symmetric_difference(a, b);
+		REQUIRE(s.contains(1));
+		REQUIRE(s.contains(5));
+		REQUIRE(not s.contains(4));
+
+		REQUIRE(u.contains_value(*b.find(6)));
+		REQUIRE(not i.contains_value(*b.find(6)));
+	}
+
+	SECTION("Views can be operands of other views") {
+		// (a | b) - c
+		auto v = views::set_difference(views::set_union(a, b), c);
+		REQUIRE(is_perm(v, {1, 2, 3, 5}));
+		REQUIRE(v.contains(5));
+		REQUIRE(not v.contains(4));
+
+		// (a & b) | (c - a)
+		auto w = views::set_union(views::set_intersection(a, b), views::set_difference(c, a));
+		REQUIRE(is_perm(w, {3, 4, 6, 8}));
+		REQUIRE(w.contains(8));
+		REQUIRE(not w.contains(0));
+
+		// ((a ^ b) ^ c) & (a | c)
+		auto x = views::set_intersection(
+			views::set_symmetric_difference(views::set_symmetric_difference(a, b), c),
+			views::set_union(a, c)
+		);
+		REQUIRE(is_perm(x, {1, 2, 4, 8}));
+
+		// A named view may be used as an operand more than once.
+		auto u = views::set_union(a, c);
+		REQUIRE(is_perm(views::set_intersection(u, views::set_difference(u, b)), {0, 1, 2, 8}));
+	}
+
+	SECTION("Views read the operands when they are used, not when they are made") {
+		auto v = views::set_intersection(a, b);
+		REQUIRE(is_perm(v, {3, 4}));
+		b.insert(0);
+		a.erase(4);
+		REQUIRE(is_perm(v, {0, 3}));
+		REQUIRE(v.contains(0));
+		REQUIRE(not v.contains(4));
+	}
+
+	SECTION("materialize() copies the view into an AnySet") {
+		auto v = views::set_difference(views::set_union(a, b), c);
+		any_set_t result = v.materialize();
+		result._assert_invariants();
+		REQUIRE(result == any_set_t({1, 2, 3, 5}));
+		REQUIRE(result == difference_of(union_of(a, b), c));
+
+		auto open = views::set_symmetric_difference(a, b).materialize<oa_set_t>();
+		open._assert_invariants();
+		REQUIRE(open.size() == 5u);
+		REQUIRE(open.contains(6));
+		REQUIRE(not open.contains(3));
+
+		REQUIRE(views::set_intersection(a, empty).materialize().empty());
+
+		// Elements of non-copyable types can be viewed, but not materialized.
+		any_set_t unique;
+		unique.insert(UniqueInt::make(1));
+		auto u = views::set_union(unique, a);
+		REQUIRE(std::distance(u.begin(), u.end()) == 6);
+		REQUIRE_THROWS_AS(u.materialize(), const NoCopyConstructorError<UniqueInt>&);
+	}
+
+	SECTION("Views accept the other kinds of sets") {
+		const FrozenAnySet<> frozen(b);
+		const PersistentAnySet<> persistent(c);
+		const CowAnySet<> cow(a);
+		REQUIRE(is_perm(views::set_intersection(frozen, persistent), {4, 6}));
+		REQUIRE(is_perm(views::set_union(cow, frozen), {0, 1, 2, 3, 4, 5, 6}));
+		REQUIRE(is_perm(views::set_difference(a, views::set_union(frozen, persistent)), {1, 2}));
+		any_set_t result = views::set_difference(persistent, cow).materialize();
+		REQUIRE(result == any_set_t({6, 8}));
+	}
+}
@@ -0,0 +1,122 @@
+#include "any-set.h"
+#include "anyset/SetOperations.h"
+#include "anyset/ShardedAnySet.h"
+#include <thread>
+
+using sharded_set_t = te::ShardedAnySet<8>;
+
+TEST_CASE("Sharded AnySet", "[sharded]") {
+
+	using namespace te;
+	using namespace std::literals;
+
+	SECTION("Single-threaded operations") {
+		sharded_set_t set;
+		REQUIRE(set.empty());
+		for(int i = 0; i < 1000; ++i)
+		{
+			REQUIRE(set.insert(i));
+			REQUIRE(set.emplace<std::string>(std::to_string(i)));
+		}
+		REQUIRE(set.size() == 2000u);
+		for(int i = 0; i < 1000; ++i)
+		{
+			REQUIRE(not set.insert(i));
+			REQUIRE(not set.try_emplace<std::string>(std::to_string(i)));
+			REQUIRE(set.contains(i));
+			REQUIRE(set.count(std::to_string(i)) == 1u);
+			REQUIRE(not set.contains(long(i)));
+		}
+		for(int i = 0; i < 1000; i += 2)
+			REQUIRE(set.erase(i) == 1u);
+		REQUIRE(set.erase(0) == 0u);
+		REQUIRE(set.size() == 1500u);
+
+		auto node = set.pop(1);
+		REQUIRE(node);
+		REQUIRE(as<int>(*node) == 1);
+		REQUIRE(not set.contains(1));
+		REQUIRE(not set.pop(1));
+		REQUIRE(not set.push(std::move(node)));
+		REQUIRE(set.contains(1));
+
+		auto key = "abc"s;
+		auto hk = set.hashed(key);
+		REQUIRE(set.insert(hk));
+		REQUIRE(set.contains(hk));
+		REQUIRE(set.erase(hk) == 1u);
+		set.clear();
+		REQUIRE(set.empty());
+	}
+
+	SECTION("Elements are spread over the shards") {
+		std::vector<std::size_t> counts(sharded_set_t::shard_count());
+		for(int i = 0; i < 8000; ++i)
+			++counts[sharded_set_t::shard_index(AnyHash{}(i))];
+		for(auto c: counts)
+			REQUIRE(c > 500u);
+	}
+
+	SECTION("Splicing from an AnySet") {
+		sharded_set_t set;
+		set.insert(1);
+		any_set_t other{1, 2, 3};
+		other.insert("four"s);
+		REQUIRE(set.splice(other) == 3u);
+		REQUIRE(other.size() == 1u);
+		REQUIRE(other.contains(1));
+		REQUIRE(set.size() == 4u);
+		REQUIRE(set.contains("four"s));
+	}
+
+	SECTION("for_each() and snapshot()") {
+		sharded_set_t set;
+		for(int i = 0; i < 100; ++i)
+			set.insert(i);
+		int sum = 0;
+		std::size_t count = 0;
+		set.for_each([&](const auto& v) {
+			sum += as<int>(v);
+			++count;
+		});
+		REQUIRE(count == 100u);
+		REQUIRE(sum == 4950);
+		auto snap = set.snapshot();
+		REQUIRE(snap.size() == 100u);
+		for(int i = 0; i < 100; ++i)
+			REQUIRE(snap.contains(i));
+		snap._assert_invariants();
+	}
+
+	SECTION("Concurrent insertion, lookup, and erasure") {
+		sharded_set_t set;
+		constexpr int thread_count = 8;
+		constexpr int per_thread = 2000;
+		std::atomic<int> inserted{0};
+		std::atomic<int> erased{0};
+		std::vector<std::thread> threads;
+		for(int t = 0; t < thread_count; ++t)
+		{
+			threads.emplace_back([&, t]() {
+				// Pairs of threads insert the same values; one of each pair also erases odd values.
+				int first = (t / 2) * per_thread;
+				for(int i = first; i < first + per_thread; ++i)
+				{
+					inserted += set.insert(i);
+					if(t % 2 == 0 and i % 2 == 1)
+						erased += static_cast<int>(set.erase(i));
+					set.contains(i);
+				}
+			});
+		}
+		threads.emplace_back([&]() {
+			for(int i = 0; i < 20; ++i)
+				(void)set.snapshot();
+		});
+		for(auto& t: threads)
+			t.join();
+		REQUIRE(static_cast<std::size_t>(inserted - erased) == set.size());
+		for(int i = 0; i < (thread_count / 2) * per_thread; i += 2)
+			REQUIRE(set.contains(i));
+	}
+}
@@ -0,0 +1,125 @@
+#include "any-set.h"
+#include "anyset/SetOperations.h"
+#include <memory_resource>
+
+namespace {
+
+struct Immovable
+{
+	explicit Immovable(int v): value(v) {}
+	Immovable(const Immovable&) = delete;
+	Immovable(Immovable&&) = delete;
+
+	int value;
+
+	friend bool operator==(const Immovable& l, const Immovable& r)
+	{ return l.value == r.value; }
+};
+
+} /* namespace */
+
+template <>
+struct te::Hash<Immovable>
+{
+	std::size_t operator()(const Immovable& v) const
+	{ return std::hash<int>{}(v.value); }
+};
+
+using pmr_set_t = te::pmr::AnySet<>;
+using pmr_oa_set_t = te::pmr::AnySet<te::AnyHash, std::equal_to<>, te::OpenAddressing>;
+using pmr_ir_set_t = te::pmr::AnySet<te::AnyHash, std::equal_to<>, te::IncrementalRehash>;
+
+namespace {
+
+template <class Set>
+void check_try_emplace()
+{
+	using namespace std::literals;
+	using te::as;
+	CountingResource res;
+	Set set(64, std::pmr::polymorphic_allocator<typename Set::value_type>{&res});
+	for(int i = 0; i < 20; ++i)
+		set.insert(std::to_string(i));
+
+	// Duplicates don't allocate.
+	{
+		auto before = res.allocations;
+		for(int i = 0; i < 20; ++i)
+		{
+			auto [pos, inserted] = set.template try_emplace<std::string>(std::to_string(i));
+			REQUIRE(not inserted);
+			REQUIRE(as<std::string>(*pos) == std::to_string(i));
+			// Same value constructed from different arguments.
+			REQUIRE(not set.template try_emplace<std::string>(1u, char('0' + i % 10)).second);
+		}
+		REQUIRE(res.allocations == before);
+	}
+
+	// New elements are inserted.
+	{
+		auto before = res.allocations;
+		auto [pos, inserted] = set.template try_emplace<std::string>(3u, 'x');
+		REQUIRE(inserted);
+		REQUIRE(as<std::string>(*pos) == "xxx"s);
+		REQUIRE(res.allocations == before + 1u);
+		REQUIRE(set.contains("xxx"s));
+		set._assert_invariants();
+	}
+
+	// Key-then-construct.
+	{
+		auto key = "abc"s;
+		auto hk = set.hashed(key);
+		auto before = res.allocations;
+		auto [pos, inserted] = set.try_emplace(hk, "abc");
+		REQUIRE(inserted);
+		REQUIRE(as<std::string>(*pos) == key);
+		REQUIRE(res.allocations == before + 1u);
+		auto [pos2, inserted2] = set.try_emplace(hk, "abc");
+		REQUIRE(not inserted2);
+		REQUIRE(pos2 == pos);
+		REQUIRE(not set.template try_emplace<std::string>(hk).second);
+		REQUIRE(res.allocations == before + 1u);
+
+		auto other = "def"s;
+		REQUIRE(set.try_emplace(set.hashed(other)).second);
+		REQUIRE(set.contains(other));
+		auto third = "ghi"s;
+		REQUIRE(set.template try_emplace<std::string>(set.hashed(third), "ghi").second);
+		REQUIRE(set.contains("ghi"s));
+		set._assert_invariants();
+	}
+
+	// Types that can't be moved are emplaced directly.
+	{
+		REQUIRE(set.template try_emplace<Immovable>(5).second);
+		REQUIRE(not set.template try_emplace<Immovable>(5).second);
+		REQUIRE(set.contains(Immovable(5)));
+	}
+
+	// Many insertions rehash correctly.
+	{
+		for(int i = 0; i < 1000; ++i)
+			set.template try_emplace<int>(i % 500);
+		for(int i = 0; i < 500; ++i)
+			REQUIRE(set.contains(i));
+		set._assert_invariants(true);
+	}
+}
+
+} /* namespace */
+
+TEST_CASE("Try Emplace", "[try_emplace]") {
+
+	SECTION("Chained buckets") {
+		check_try_emplace<pmr_set_t>();
+	}
+
+	SECTION("Open addressing") {
+		check_try_emplace<pmr_oa_set_t>();
+	}
+
+	SECTION("Incremental rehash") {
+		check_try_emplace<pmr_ir_set_t>();
+	}
+}
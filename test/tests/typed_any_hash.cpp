@@ -0,0 +1,41 @@
+#include "any-set.h"
+
+using typed_set_t = te::AnySet<
+	te::TypedAnyHash,
+	std::equal_to<>,
+	std::allocator<te::AnyValue<te::TypedAnyHash, std::equal_to<>>>
+>;
+
+TEST_CASE("TypedAnyHash", "[typed-any-hash]") {
+
+	using namespace te;
+	using namespace std::literals;
+
+	SECTION("Equal values of different types have different hash codes") {
+		TypedAnyHash h;
+		REQUIRE(h(1) != h(1l));
+		REQUIRE(h(1) != h(1u));
+		REQUIRE(h(1) != h(char(1)));
+		REQUIRE(h(1) != h(true));
+		REQUIRE(h(1l) != h(1ul));
+		REQUIRE(h(1) == h(1));
+		REQUIRE(h("a"s) == h("a"s));
+	}
+
+	SECTION("Sets using TypedAnyHash find elements of the right type") {
+		typed_set_t set(std::make_tuple(1, 1l, 1u, char(1), true, "1"s));
+		REQUIRE(set.size() == 6u);
+		REQUIRE(set.contains(1));
+		REQUIRE(set.contains(1l));
+		REQUIRE(set.contains(1u));
+		REQUIRE(set.contains(char(1)));
+		REQUIRE(set.contains(true));
+		REQUIRE(not set.contains(1ll));
+		REQUIRE(not set.contains(false));
+		REQUIRE(as<long>(*set.find(1l)) == 1l);
+		REQUIRE(set.erase(1u) == 1u);
+		REQUIRE(not set.contains(1u));
+		REQUIRE(set.contains(1));
+		set._assert_invariants();
+	}
+}